@@ -0,0 +1,91 @@
+#include "parser.h"
+#include "scanner.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+extern FILE *yyin;
+extern int yylineno;
+int yylex(void);
+void yyrestart(FILE *input_file);
+
+// a program of many small functions, with the statements and expressions
+// common in generated sources
+static void generate(FILE *out, int functions) {
+    fprintf(out, "int g[100];\n");
+    for (int i = 0; i < functions; i++) {
+        fprintf(out,
+                "int f%d(int a, int b[], float c) {\n"
+                "    int i = 0, s = a * 2 + 1;\n"
+                "    while (i < a && s != 3 || !b[i]) {\n"
+                "        if (b[i] > s) s = s + b[i] * (i - 1) %% 7;\n"
+                "        else { s = s - g[i / 2]; }\n"
+                "        i = i + 1;\n"
+                "    }\n"
+                "    return s + f%d(i, b, c * 1.5);\n"
+                "}\n",
+                i, i > 0 ? i - 1 : 0);
+    }
+    fprintf(out, "int main() { return f%d(1, g, 2.0); }\n", functions - 1);
+}
+
+// the best time to parse the file, read as a stream or through a mapping
+static double run(const std::string &path, bool is_mapped, int repeats) {
+    double best = 0;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        FILE *stream = nullptr;
+        if (is_mapped) {
+            scanner_open(path);
+        } else {
+            stream = fopen(path.c_str(), "r");
+            yyin = stream;
+            yyrestart(yyin);
+            yylineno = 1;
+        }
+        auto root = std::make_shared<CompUnits>();
+        yyparse(root);
+        if (is_mapped) {
+            scanner_close();
+        } else {
+            fclose(stream);
+            yyin = nullptr;
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    int functions = argc > 1 ? std::stoi(argv[1]) : 4000;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    char path[] = "/tmp/bench_parser_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *input = fdopen(fd, "w");
+    generate(input, functions);
+    fclose(input);
+
+    long tokens = 0;
+    scanner_open(path);
+    while (yylex() != 0) {
+        tokens++;
+    }
+    scanner_close();
+    std::cout << "tokens: " << tokens << std::endl;
+
+    for (bool is_mapped : {false, true}) {
+        auto best = run(path, is_mapped, repeats);
+        std::cout << (is_mapped ? "mapped" : "stream") << ", best of "
+                  << repeats << ": " << best * 1000 << " ms, "
+                  << (long)(tokens / best) << " tokens/s" << std::endl;
+    }
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,480 @@
+#include "error.h"
+#include "opt/pass/pipelines.h"
+#include "parser.h"
+#include "scanner.h"
+#include "target/generator.h"
+#include "visitor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cxxabi.h>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// the time of each stage in seconds, in the order first run
+using Stages = std::vector<std::pair<std::string, double>>;
+
+static void add_time(Stages &stages, const std::string &stage, double time) {
+    for (auto &[name, total] : stages) {
+        if (name == stage) {
+            total += time;
+            return;
+        }
+    }
+    stages.push_back({stage, time});
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+// the name of a pass without its namespace, e.g. `GVNPass`
+template <typename P> static std::string pass_name() {
+    int status;
+    char *demangled =
+        abi::__cxa_demangle(typeid(P).name(), nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : typeid(P).name();
+    free(demangled);
+    auto colon = name.rfind("::");
+    return colon == std::string::npos ? name : name.substr(colon + 2);
+}
+
+// run a pass, or the passes of a pipeline one by one, with the time of each
+// pass summed by its name, as the same pass runs many times
+template <typename P> struct TimedPipeline {
+    static void run(ir::Module &module, Stages &stages) {
+        P pass;
+        auto start = std::chrono::steady_clock::now();
+        pass.run(module);
+        add_time(stages, "passes." + pass_name<P>(), seconds_since(start));
+    }
+};
+
+template <typename... Ps> struct TimedPipeline<opt::PassPipeline<Ps...>> {
+    static void run(ir::Module &module, Stages &stages) {
+        (TimedPipeline<Ps>::run(module, stages), ...);
+    }
+};
+
+struct Shape {
+    const char *name;
+    const char *unit;
+    int base; // the smallest size, doubled at each step
+    std::string (*generate)(int size);
+};
+
+// many small functions, all called from main
+static std::string generate_functions(int size) {
+    std::ostringstream out;
+    out << "int g[64];\n";
+    for (int i = 0; i < size; i++) {
+        out << "int f" << i << "(int a, int b[]) {\n"
+            << "    int i = 0, s = a * 2 + " << i << ";\n"
+            << "    while (i < a) {\n"
+            << "        if (b[i] > s) s = s + b[i] % 7;\n"
+            << "        else s = s - g[i / 2];\n"
+            << "        i = i + 1;\n"
+            << "    }\n"
+            << "    return s;\n"
+            << "}\n";
+    }
+    out << "int main() {\n"
+        << "    int s = getint();\n";
+    for (int i = 0; i < size; i++) {
+        out << "    s = f" << i << "(s, g);\n";
+    }
+    out << "    return s;\n"
+        << "}\n";
+    return out.str();
+}
+
+// one function of many statements, with as many values live across them
+static std::string generate_long_function(int size) {
+    std::ostringstream out;
+    out << "int main() {\n"
+        << "    int a[16] = {};\n"
+        << "    int x = getint(), y = getint();\n";
+    for (int i = 0; i < size; i++) {
+        out << "    int v" << i << " = x * " << i + 3 << " + a[" << i % 16
+            << "];\n"
+            << "    if (v" << i << " > y) a[" << (i + 5) % 16 << "] = v" << i
+            << " - y;\n";
+        if (i > 0) {
+            out << "    x = x + v" << i - 1 << " / 3;\n";
+        }
+    }
+    out << "    int s = 0;\n";
+    for (int i = 0; i < size; i++) {
+        out << "    s = s + v" << i << ";\n";
+    }
+    out << "    return s;\n"
+        << "}\n";
+    return out.str();
+}
+
+// alternating ifs and loops nested in each other
+static std::string generate_nesting(int size) {
+    std::ostringstream out;
+    out << "int main() {\n"
+        << "    int x = getint(), s = 0;\n";
+    for (int i = 0; i < size; i++) {
+        out << "    int i" << i << " = 0;\n";
+    }
+    for (int i = 0; i < size; i++) {
+        if (i % 2 == 0) {
+            out << "if (x > " << i << ") {\n";
+        } else {
+            out << "while (i" << i << " < " << i + 2 << ") {\n"
+                << "i" << i << " = i" << i << " + 1;\n";
+        }
+        out << "s = s + x * " << i << ";\n";
+    }
+    for (int i = 0; i < size; i++) {
+        out << "}\n";
+    }
+    out << "    return s;\n"
+        << "}\n";
+    return out.str();
+}
+
+// global and local arrays with initializers of so many elements
+static std::string generate_initializer(int size) {
+    std::ostringstream out;
+    auto initializer = [&]() {
+        out << "{";
+        for (int i = 0; i < size; i++) {
+            out << (i > 0 ? ", " : "") << (i * 7 + 3) % 101;
+        }
+        out << "}";
+    };
+    out << "int g[" << size << "] = ";
+    initializer();
+    out << ";\n"
+        << "int main() {\n"
+        << "    int l[" << size << "] = ";
+    initializer();
+    out << ";\n"
+        << "    int i = 0, s = 0;\n"
+        << "    while (i < " << size << ") {\n"
+        << "        s = s + g[i] * l[i];\n"
+        << "        i = i + 1;\n"
+        << "    }\n"
+        << "    return s;\n"
+        << "}\n";
+    return out.str();
+}
+
+// a function of many nested loops over arrays in sequence
+static std::string generate_loops(int size) {
+    std::ostringstream out;
+    out << "int a[100], b[100], c[100][100];\n"
+        << "int main() {\n"
+        << "    int i, j, s = 0;\n";
+    for (int k = 0; k < size; k++) {
+        out << "    i = 0;\n"
+            << "    while (i < 100) {\n"
+            << "        j = 0;\n"
+            << "        while (j < 100) {\n"
+            << "            c[i][j] = c[i][j] + a[i] * b[j] + " << k << ";\n"
+            << "            s = s + c[i][j] % " << k + 2 << ";\n"
+            << "            j = j + 1;\n"
+            << "        }\n"
+            << "        a[i] = s;\n"
+            << "        i = i + 1;\n"
+            << "    }\n";
+    }
+    out << "    return s;\n"
+        << "}\n";
+    return out.str();
+}
+
+static const Shape shapes[] = {
+    {"functions", "functions", 64, generate_functions},
+    {"long_function", "statements", 64, generate_long_function},
+    {"nesting", "depth", 16, generate_nesting},
+    {"initializer", "elements", 1024, generate_initializer},
+    {"loops", "loops", 8, generate_loops},
+};
+
+// compile the source as the driver does, and write the time of each stage
+// and the peak memory as lines of "stage value"
+static void compile(const std::string &source, bool optimize, int fd) {
+    Stages stages;
+
+    auto start = std::chrono::steady_clock::now();
+    auto root = std::make_shared<CompUnits>();
+    scanner_open_string(source);
+    yyparse(root);
+    scanner_close();
+    add_time(stages, "parse", seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    ir::Module module;
+    Visitor visitor(module, optimize);
+    visitor.visit(*root);
+    root.reset();
+    add_time(stages, "visitor", seconds_since(start));
+    if (has_error()) {
+        _exit(1);
+    }
+
+    if (optimize) {
+        TimedPipeline<opt::SSAPasses>::run(module, stages);
+        TimedPipeline<opt::Passes>::run(module, stages);
+        TimedPipeline<opt::InstSelectPasses>::run(module, stages);
+    }
+    TimedPipeline<opt::RegisterPasses>::run(module, stages);
+
+    // the generator includes the allocator and the peephole optimizer
+    start = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    target::Generator generator(out, optimize);
+    generator.generate(module);
+    auto generate_time = seconds_since(start);
+    add_time(stages, "regalloc", generator.regalloc_time);
+    add_time(stages, "generator", generate_time - generator.regalloc_time -
+                                      generator.peephole_time);
+    if (optimize) {
+        add_time(stages, "peephole", generator.peephole_time);
+    }
+
+    double total = 0;
+    for (auto &[name, time] : stages) {
+        total += time;
+    }
+    add_time(stages, "total", total);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::ostringstream result;
+    result.precision(9);
+    for (auto &[name, time] : stages) {
+        result << name << ' ' << time << '\n';
+    }
+    result << "peak_rss_kb " << usage.ru_maxrss << '\n';
+    auto text = result.str();
+    for (size_t written = 0; written < text.size();) {
+        auto n = write(fd, text.data() + written, text.size() - written);
+        if (n <= 0) {
+            _exit(1);
+        }
+        written += n;
+    }
+}
+
+struct Point {
+    int size;
+    size_t lines;
+    Stages stages;
+    long peak_rss_kb = 0;
+    bool failed = false;
+};
+
+// compile in a child process, so that the peak memory is of this size alone
+static Point measure(const Shape &shape, int size, bool optimize) {
+    Point point;
+    point.size = size;
+    auto source = shape.generate(size);
+    point.lines = std::count(source.begin(), source.end(), '\n');
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        point.failed = true;
+        return point;
+    }
+    auto pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        compile(source, optimize, fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+
+    std::string text;
+    char buffer[4096];
+    for (ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) > 0;) {
+        text.append(buffer, n);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+        point.failed = true;
+        return point;
+    }
+
+    std::istringstream lines(text);
+    std::string name;
+    double value;
+    while (lines >> name >> value) {
+        if (name == "peak_rss_kb") {
+            point.peak_rss_kb = value;
+        } else {
+            point.stages.push_back({name, value});
+        }
+    }
+    return point;
+}
+
+static double stage_time(const Point &point, const std::string &stage) {
+    for (auto &[name, time] : point.stages) {
+        if (name == stage) {
+            return time;
+        }
+    }
+    return 0;
+}
+
+// stages shorter than this at the largest size are too noisy to fit
+static const double MIN_FIT_TIME = 5e-3;
+// growth with a larger exponent than this is reported as superlinear
+static const double SUPERLINEAR_EXPONENT = 1.5;
+
+// the exponent k of time ~ size^k between the two largest sizes
+static double exponent(const Point &smaller, const Point &larger,
+                       const std::string &stage) {
+    auto t0 = stage_time(smaller, stage), t1 = stage_time(larger, stage);
+    if (t1 < MIN_FIT_TIME || t0 <= 0) {
+        return NAN;
+    }
+    return std::log(t1 / t0) / std::log((double)larger.size / smaller.size);
+}
+
+// print the stages as a JSON object, with the passes in an object of their
+// own
+static void print_stages(
+    const Stages &stages,
+    const std::function<void(const std::string &, double)> &print_value) {
+    std::cout << "{";
+    const char *separator = "";
+    bool in_passes = false;
+    for (auto &[name, value] : stages) {
+        bool is_pass = name.rfind("passes.", 0) == 0;
+        if (in_passes && !is_pass) {
+            std::cout << "}";
+            in_passes = false;
+        } else if (!in_passes && is_pass) {
+            std::cout << separator << "\"passes\": {";
+            separator = "";
+            in_passes = true;
+        }
+        std::cout << separator << "\""
+                  << (is_pass ? name.substr(strlen("passes.")) : name)
+                  << "\": ";
+        print_value(name, value);
+        separator = ", ";
+    }
+    std::cout << (in_passes ? "}}" : "}");
+}
+
+int main(int argc, char *argv[]) {
+    int steps = 4;
+    bool optimize = true;
+    std::vector<const Shape *> selected;
+    for (int i = 1; i < argc; i++) {
+        const Shape *found = nullptr;
+        for (auto &shape : shapes) {
+            if (strcmp(shape.name, argv[i]) == 0) {
+                found = &shape;
+            }
+        }
+        if (found) {
+            selected.push_back(found);
+        } else if (strcmp(argv[i], "-O0") == 0) {
+            optimize = false;
+        } else if (isdigit(argv[i][0])) {
+            steps = std::stoi(argv[i]);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [-O0] [steps] [shape...]"
+                      << std::endl
+                      << "shapes:";
+            for (auto &shape : shapes) {
+                std::cerr << " " << shape.name;
+            }
+            std::cerr << std::endl;
+            return 1;
+        }
+    }
+    if (selected.empty()) {
+        for (auto &shape : shapes) {
+            selected.push_back(&shape);
+        }
+    }
+
+    std::vector<std::string> superlinear;
+    bool failed = false;
+    std::cout.precision(4);
+    std::cout << "{\"optimize\": " << (optimize ? "true" : "false")
+              << ", \"time_unit\": \"ms\", \"shapes\": [";
+    for (size_t s = 0; s < selected.size(); s++) {
+        auto &shape = *selected[s];
+        std::vector<Point> points;
+        for (int step = 0, size = shape.base; step < steps;
+             step++, size *= 2) {
+            std::cerr << shape.name << ": " << size << " " << shape.unit
+                      << std::endl;
+            points.push_back(measure(shape, size, optimize));
+            if (points.back().failed) {
+                std::cerr << shape.name << ": failed to compile" << std::endl;
+                failed = true;
+                break;
+            }
+        }
+
+        std::cout << (s > 0 ? "," : "") << "\n{\"name\": \"" << shape.name
+                  << "\", \"unit\": \"" << shape.unit << "\",\n \"points\": [";
+        for (size_t p = 0; p < points.size(); p++) {
+            auto &point = points[p];
+            std::cout << (p > 0 ? "," : "") << "\n  {\"size\": " << point.size
+                      << ", \"lines\": " << point.lines;
+            if (point.failed) {
+                std::cout << ", \"failed\": true}";
+                continue;
+            }
+            std::cout << ", \"peak_rss_kb\": " << point.peak_rss_kb
+                      << ", \"stages\": ";
+            print_stages(point.stages, [](const std::string &, double time) {
+                std::cout << time * 1000;
+            });
+            std::cout << "}";
+        }
+        std::cout << "]";
+
+        // how each stage scales, between the two largest sizes
+        if (points.size() >= 2 && !points.back().failed) {
+            auto &smaller = points[points.size() - 2];
+            auto &larger = points.back();
+            std::cout << ",\n \"exponents\": ";
+            print_stages(larger.stages, [&](const std::string &stage, double) {
+                auto k = exponent(smaller, larger, stage);
+                if (std::isnan(k)) {
+                    std::cout << "null";
+                    return;
+                }
+                std::cout << k;
+                if (k > SUPERLINEAR_EXPONENT) {
+                    superlinear.push_back(std::string(shape.name) + ": " +
+                                          stage);
+                }
+            });
+        }
+        std::cout << "}";
+    }
+    std::cout << "\n],\n\"superlinear\": [";
+    for (size_t i = 0; i < superlinear.size(); i++) {
+        std::cout << (i > 0 ? ", " : "") << "\"" << superlinear[i] << "\"";
+    }
+    std::cout << "]}" << std::endl;
+    return failed ? 1 : 0;
+}
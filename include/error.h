@@ -16,3 +16,10 @@ bool has_error();
  * error
  */
 void error(int lineno, const std::string &msg);
+
+/**
+ * @brief Clear the flag set by `error`, before compiling another input
+ * @note The flag is kept per thread, so inputs compiled in parallel do not
+ * see the errors of each other
+ */
+void reset_error();
@@ -24,6 +24,8 @@ class Folder {
     ValuePtr fold_swtof(ValuePtr value);
     ValuePtr fold_extsw(ValuePtr value);
 
+    ValuePtr fold_sel(ValuePtr cond, ValuePtr value);
+
   private:
     /**
      * @brief Convert a value to a constant bits pointer.
@@ -44,6 +44,14 @@ struct Address : public Const {
 
     static std::shared_ptr<Address> get(std::string name);
 
+    /**
+     * @brief Drop the cached addresses, whose `ref_func` refer to the
+     * functions of the last module, before building another module.
+     * @param limit Up to so many addresses are kept instead, with their
+     * `ref_func` reset
+     */
+    static void clear_cache(size_t limit = 0);
+
     void emit(std::ostream &out) const override { out << "$" << name; }
 
     Type get_type() const override { return Type::L; }
@@ -51,7 +59,9 @@ struct Address : public Const {
     std::string get_asm_value() override { return name; }
 
   private:
-    static std::unordered_map<std::string, std::shared_ptr<Address>>
+    // caches are kept per thread, as modules may be built in parallel
+    static thread_local std::unordered_map<std::string,
+                                           std::shared_ptr<Address>>
         addrcon_cache;
 };
 
@@ -62,6 +72,16 @@ struct ConstBits : public Const {
 
     template <typename T> static std::shared_ptr<ConstBits> get(T value);
 
+    /**
+     * @brief Drop the cached constants if there are more than `limit`.
+     */
+    static void clear_cache(size_t limit = 0) {
+        if (floatcon_cache.size() + intcon_cache.size() > limit) {
+            floatcon_cache.clear();
+            intcon_cache.clear();
+        }
+    }
+
     void emit(std::ostream &out) const override;
 
     Type get_type() const override;
@@ -100,8 +120,10 @@ struct ConstBits : public Const {
     }
 
   private:
-    static std::unordered_map<float, std::shared_ptr<ConstBits>> floatcon_cache;
-    static std::unordered_map<int, std::shared_ptr<ConstBits>> intcon_cache;
+    static thread_local std::unordered_map<float, std::shared_ptr<ConstBits>>
+        floatcon_cache;
+    static thread_local std::unordered_map<int, std::shared_ptr<ConstBits>>
+        intcon_cache;
 };
 
 template <typename T>
@@ -141,6 +163,7 @@ struct Inst {
     // fields below are used for optimization
     int number;          // for linear scan register allocation
     bool marked = false; // for dead code elimination
+    int offset = 0;      // displacement of the address of loads and stores
 
     static std::shared_ptr<Inst> create(InstType insttype, Type ty,
                                         std::shared_ptr<Value> arg0,
@@ -198,6 +221,7 @@ struct Block {
         live_out; // liveness
     std::unordered_set<std::shared_ptr<Temp>> temps_in_block;
     int rpo_id; // number of reverse post order (use in cooper's fill dom)
+    long long freq = -1; // execution count from profile, -1 if unknown
     // dominator tree
     std::shared_ptr<Block> idom;                // father node
     std::vector<std::shared_ptr<Block>> doms;   // child nodes
@@ -208,6 +232,13 @@ struct Block {
 
     void emit(std::ostream &out) const;
 
+    /**
+     * @brief Release the contents of the block and its references to other
+     * blocks, so that a block removed from the function does not keep the
+     * remaining blocks alive.
+     */
+    void release();
+
     std::string get_name() const {
         return name + (id ? "." + std::to_string(id) : "");
     }
@@ -230,6 +261,7 @@ struct Function {
     std::unordered_set<std::shared_ptr<Temp>> temps_in_func;
     bool is_leaf = false;   // whether the function is a leaf function
     bool is_inline = false; // whether the function should be inlined
+    bool is_pure = false;   // whether the result depends on args only
 
     using TempPtrList = std::vector<std::shared_ptr<Temp>>;
     using FunctionPtr = std::shared_ptr<Function>;
@@ -245,6 +277,13 @@ struct Function {
 
     void emit(std::ostream &out) const;
 
+    /**
+     * @brief Release the body of the function.
+     * The function itself is kept, with its signature and summaries like
+     * `is_pure`, since calls in other functions refer to it.
+     */
+    void release();
+
     std::shared_ptr<Address> get_address() {
         auto addr = Address::get(name);
         addr->ref_func = this;
@@ -349,9 +388,65 @@ struct Data {
     std::shared_ptr<Address> get_address() const { return Address::get(name); }
 };
 
+struct VectorNode {
+    enum Kind {
+        ARRAY,  // element k of an array argument
+        SCALAR, // a scalar argument
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        REM,
+        NEG,
+    } kind;
+    int arg = -1;   // argument index of ARRAY and SCALAR
+    int stride = 4; // bytes between adjacent elements of ARRAY
+    std::shared_ptr<VectorNode> left, right;
+
+    void emit(std::ostream &out) const;
+};
+
+/**
+ * @brief A loop `for (k = 0; k < n; k++)` over arrays, which is called like a
+ * builtin function and generated with vector instructions by the target.
+ * Argument 0 is `n`, and the other arguments are referred by the nodes. The
+ * kernel either stores `exp` to `dst` for each `k`, or returns the sum of
+ * `exp` added to argument `acc` in order. If `dst` may partially overlap other
+ * arrays, the overlap is checked at runtime, and elements are processed one
+ * by one on overlap.
+ */
+struct VectorKernel {
+    std::string name; // name without $
+    Type ty;          // type of elements, either w or s
+    std::vector<Type> params;
+    std::shared_ptr<VectorNode> dst, exp;
+    int acc = -1; // argument index of the accumulator, -1 if not reduction
+    bool check_overlap = false;
+
+    /**
+     * @brief Emit the kernel as a comment, since it has no IR body.
+     */
+    void emit(std::ostream &out) const;
+
+    /**
+     * @brief Get the array arguments read more than once by `exp`, in order,
+     * which the target loads once per round.
+     */
+    std::vector<int> get_reused_arrays() const;
+
+    /**
+     * @brief Count the vector registers the target needs to evaluate `exp`,
+     * including those holding the reused arrays.
+     */
+    int count_vector_regs() const;
+
+    std::shared_ptr<Address> get_address() const { return Address::get(name); }
+};
+
 struct Module {
     std::vector<std::shared_ptr<Data>> datas;
     std::vector<std::shared_ptr<Function>> functions;
+    std::vector<std::shared_ptr<VectorKernel>> vector_kernels;
     uint block_counter = 1;
 
     void add_function(std::shared_ptr<Function> func) {
@@ -374,5 +469,7 @@ using BlockPtr = std::shared_ptr<Block>;
 using PhiPtr = std::shared_ptr<Phi>;
 using FunctionPtr = std::shared_ptr<Function>;
 using DataPtr = std::shared_ptr<Data>;
+using VectorNodePtr = std::shared_ptr<VectorNode>;
+using VectorKernelPtr = std::shared_ptr<VectorKernel>;
 
 } // namespace ir
@@ -49,6 +49,9 @@ OP(ICLTS, "clts")
 OP(ICGES, "cges")
 OP(ICGTS, "cgts")
 
+/* select, %v if %c is non-zero, otherwise 0 */
+OP(ISEL, "sel")
+
 /* conversions */
 OP(IEXTSW, "extsw")
 OP(ISTOSI, "stosi")
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "opt/pass/base.h"
+
+namespace opt {
+
+/**
+ * @brief A pass that folds constant offsets of addresses into the
+ * displacement of loads and stores.
+ * An address `add l base, const` used by a load or store is replaced by
+ * `base`, and the constant is kept in `Inst::offset`, if it fits in
+ * `[min_offset, max_offset]`. The base must hold the same value at the access
+ * as at the add, i.e. it is defined only once, or not redefined between them
+ * in the same block. The adds are then dead if all their uses are folded.
+ * Array elements like `a[i + c]` in a block share the address of `a[i]`, with
+ * the offset `c * scale` folded, assuming the index never overflows.
+ * @note Requires `FillUsesPass`.
+ * @note This pass should run right before register allocation, as
+ * `Inst::offset` is only known by the backend.
+ */
+class AddressFoldingPass : public FunctionPass {
+public:
+    AddressFoldingPass(int min_offset = -2048, int max_offset = 2047)
+        : _min_offset(min_offset), _max_offset(max_offset) {}
+
+    bool run_on_function(ir::Function &func) override;
+
+private:
+    static int _get_address_index(const ir::Inst &inst);
+    bool _reassociate(ir::Function &func, ir::Block &block);
+    bool _fold(ir::Block &block, ir::InstPtr inst, int index);
+
+    int _min_offset, _max_offset;
+};
+
+} // namespace opt
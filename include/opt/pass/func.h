@@ -17,6 +17,20 @@ private:
     bool _is_leaf_function(ir::Function &func);
 };
 
+/**
+ * @brief A pass that fills the `is_pure` field of each function.
+ * A function is pure if it does not access memory and only calls pure
+ * functions, so that its result depends on its arguments only.
+ * @note Nothing is required before this pass.
+ */
+class FillPurePass : public ModulePass {
+public:
+    bool run_on_module(ir::Module &module) override;
+
+private:
+    bool _is_pure_function(const ir::Function &func);
+};
+
 /**
  * @brief A pass that fills the `is_inline` field of each function.
  * @note Nothing is required before this pass.
@@ -31,6 +45,7 @@ private:
 
 /**
  * @brief A pass that performs function inlining.
+ * Calls in blocks never executed in the profile are not inlined.
  * @note Requires `FillInlinePass`.
  * @note This pass will break every CFG-related pass.
  */
@@ -45,13 +60,25 @@ private:
                     ir::TempPtr ret_target);
 };
 
+/**
+ * @brief A pass that turns tail recursion into loop.
+ * Besides `return f(...)`, accumulative recursion like `return n * f(n - 1)`
+ * or `return f(n - 1) + g(x)` is also eliminated by an accumulator.
+ * @note Requires `FillPurePass`.
+ * @note This pass runs after SSA destruction.
+ */
 class TailRecursionElimination : public FunctionPass {
 public:
     bool run_on_function(ir::Function &func) override;
 
 private:
     void _create_jump_target_block(ir::Function &func);
+    void _replace_args(ir::Function &func, ir::Block &block,
+                       const std::vector<ir::TempPtr> &pars);
     bool _is_tail_recursive(const ir::Function &func, const ir::Block &block);
+    bool _is_self_call(const ir::Function &func, const ir::Inst &inst);
+    bool _is_accumulative(const ir::Function &func, const ir::Block &block,
+                          ir::InstType &op);
 };
 
 } // namespace opt
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "opt/pass/base.h"
+
+namespace opt {
+
+/**
+ * @brief A pass that promotes scalar globals to local variables.
+ * In each function accessing a scalar global, the global is replaced by an
+ * alloca, which is loaded from the global at entry and written back on
+ * return. It is also written back before calls that may access the global,
+ * and reloaded after calls that may modify it. So the value can stay in
+ * register across call-free regions after SSA construction. In `main`, the
+ * alloca is initialized with the initial value of the global directly and
+ * never written back on return. A global is only promoted when it saves
+ * memory accesses, weighted by loop depth.
+ * @note Requires `FillPredsPass` and `CooperFillDominatorsPass`.
+ * @note This pass should run before `SSAConstructPass`.
+ */
+class GlobalPromotionPass : public ModulePass {
+public:
+    bool run_on_module(ir::Module &module) override;
+
+private:
+    using AddressSet = std::unordered_set<ir::AddressPtr>;
+    using LoopDepth = std::unordered_map<ir::BlockPtr, int>;
+
+    void _find_scalar_globals(ir::Module &module);
+    void _fill_accessed_globals(ir::Module &module);
+    bool _is_profitable(const ir::Function &func, ir::AddressPtr global,
+                        bool is_entry, const LoopDepth &loop_depth);
+    bool _is_syncing_call(ir::InstPtr inst, ir::AddressPtr global);
+    bool _is_modifying_call(ir::InstPtr inst, ir::AddressPtr global);
+    void _promote(ir::Function &func, ir::AddressPtr global, bool is_entry);
+
+    // type and initial value of each scalar global
+    std::unordered_map<ir::AddressPtr, std::pair<ir::Type, ir::ConstPtr>>
+        _scalars;
+    // globals accessed by each function directly or by calls
+    std::unordered_map<ir::Function *, AddressSet> _direct, _accessed;
+    // globals stored by each function directly or by calls
+    std::unordered_map<ir::Function *, AddressSet> _modified;
+};
+
+} // namespace opt
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "opt/pass/base.h"
+
+namespace opt {
+
+/**
+ * @brief A pass that turns small diamonds and triangles of `jnz` into
+ * branchless code.
+ * Instructions in the branches are speculated into the head block, and each
+ * `w` or `l` phi in the join block becomes `b + sel(c, a - b)`, where `sel`
+ * yields its second argument if the first one is non-zero, and 0 otherwise.
+ * Branches with memory accesses, calls or divisions, branches that add too
+ * many instructions to the path through the head block, and branches biased
+ * in profile are kept.
+ * @note Requires SSA form and `FillPredsPass`.
+ * @warning This pass will break use-def relationship filled by `FillUsesPass`.
+ */
+class IfConversionPass : public FunctionPass {
+public:
+    bool run_on_function(ir::Function &func) override;
+
+private:
+    // phi = values[1] + sel(cond, diff), where diff = values[0] - values[1]
+    struct Select {
+        ir::PhiPtr phi;
+        ir::ValuePtr values[2] = {nullptr, nullptr};
+        ir::ValuePtr diff = nullptr;
+    };
+
+    bool _convert(ir::Function &func, ir::BlockPtr head);
+    static int _plan_select(Select &select, ir::BlockPtr sides[2]);
+    static bool _is_biased(ir::BlockPtr head, ir::BlockPtr sides[2]);
+    static bool _is_zero(ir::ValuePtr value);
+    static bool _can_speculate(const ir::Block &block, int &cost);
+};
+
+} // namespace opt
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "opt/pass/base.h"
+#include "opt/pass/loop.h"
+
+namespace opt {
+
+/**
+ * @brief A pass that reorders the blocks of a function to maximize
+ * fall-through on hot edges.
+ * Block frequencies are estimated from loop depth, and branch probabilities
+ * from static heuristics: back edges are taken, loop exits are not, and
+ * branches into returning blocks are unlikely. Both come from the `freq` of
+ * blocks instead if the function is profiled. Blocks are then merged into
+ * chains along the heaviest edges and the chains are placed greedily, which
+ * moves cold blocks out of the way. Finally, call-free loops entered by a
+ * conditional header are rotated, so that the branch is at the bottom of the
+ * loop. Loops with calls are left alone, since they are often short ones from
+ * tail recursion elimination.
+ * @note Requires `FillPredsPass` and `CooperFillDominatorsPass`.
+ * @note Fall-through jumps are turned into explicit `jmp`, so this pass should
+ * run after CFG simplification.
+ */
+class BlockLayoutPass : public FunctionPass {
+public:
+    bool run_on_function(ir::Function &func) override;
+
+private:
+    struct Edge {
+        ir::BlockPtr from, to;
+        double weight;
+    };
+
+    std::vector<Edge> _get_edges(ir::Function &func);
+    std::vector<ir::BlockPtr> _place_chains(ir::Function &func,
+                                            const std::vector<Edge> &edges);
+    static bool _has_call(const std::unordered_set<ir::BlockPtr> &loop);
+    void _rotate_loops(ir::Function &func, std::vector<ir::BlockPtr> &order);
+
+    std::vector<NaturalLoop> _loops;
+};
+
+} // namespace opt
@@ -2,12 +2,46 @@
 
 #include "opt/pass/base.h"
 #include "opt/pass/cfg.h"
+#include <algorithm>
 #include <list>
 #include <utility>
 #include <vector>
 
 namespace opt {
 
+/**
+ * @brief A natural loop, with the blocks reaching its back edges without
+ * passing the header, including the header.
+ */
+struct NaturalLoop {
+    ir::BlockPtr header;
+    std::unordered_set<ir::BlockPtr> blocks;
+};
+
+/**
+ * @brief Whether `dom` dominates `block`, following `idom` of blocks.
+ */
+bool dominates(ir::BlockPtr dom, ir::BlockPtr block);
+
+/**
+ * @brief Find the natural loops of a function, one for each header, in the
+ * order of headers.
+ * @note Requires `FillPredsPass` and `CooperFillDominatorsPass`.
+ */
+std::vector<NaturalLoop> find_natural_loops(const ir::Function &func);
+
+/**
+ * @brief Count the loops containing each block.
+ */
+std::unordered_map<ir::BlockPtr, int>
+get_loop_depth(const ir::Function &func, const std::vector<NaturalLoop> &loops);
+
+/**
+ * @brief Estimate how many times a block at `depth` runs per function call,
+ * assuming each loop runs 8 times, up to 4 levels.
+ */
+inline int get_loop_weight(int depth) { return 1 << (3 * std::min(depth, 4)); }
+
 /**
  * @brief It will fill all indirect dominate blocks for each block.
  * @note This pass requires `FillDominanceFrontierPass`, and Mem2Reg must be
@@ -41,6 +75,54 @@ class LicmPass : public FunctionPass {
     Loop _fill_loop(ir::BlockPtr header, ir::BlockPtr back);
 };
 
+/**
+ * @brief A pass that rotates loops into guarded do-while form.
+ * The header is copied into a guard block before the loop, which either
+ * skips the loop or enters it through a new preheader. The original header is
+ * then only reached from the latches, so each iteration ends with a single
+ * conditional branch, and `LicmPass` hoists invariants into the preheader.
+ * @note Requires `FillPredsPass` and `CooperFillDominatorsPass`, and must run
+ * after SSA destruction, as the header is copied with the same temps.
+ * @warning This pass will break dominators and use-def relationship.
+ */
+class LoopRotationPass : public FunctionPass {
+  public:
+    bool run_on_function(ir::Function &func) override;
+
+  private:
+    using LoopBlocks = std::unordered_set<ir::BlockPtr>;
+
+    bool _rotate(ir::Function &func, ir::BlockPtr header,
+                 const LoopBlocks &loop_blocks);
+    std::unordered_set<ir::ValuePtr> _find_local_temps(ir::Function &func,
+                                                       ir::BlockPtr header);
+
+    // loops of the function, updated with the blocks inserted by rotation
+    std::vector<NaturalLoop> _loops;
+};
+
+/**
+ * @brief A pass that replaces loops filling or copying an array by a call to
+ * memset or memcpy.
+ * It matches counted loops in SSA form like
+ *     while (i < n) { a[i] = C; i = i + 1; }   (C is 0, 0.0 or -1)
+ *     while (i < n) { a[i] = b[i]; i = i + 1; }
+ * also unrolled by a constant factor, where `n` is an int not changed in the
+ * loop. The body is replaced by a single call and leaves the loop, where `i`
+ * is `n`. Copies are limited to distinct arrays, so the regions cannot
+ * overlap.
+ * @note Requires `FillPredsPass` and `FillUsesPass`, and must run before SSA
+ * destruction.
+ * @warning This pass will break use-def relationship.
+ */
+class LoopIdiomPass : public FunctionPass {
+  public:
+    bool run_on_function(ir::Function &func) override;
+
+  private:
+    bool _replace(ir::Function &func, ir::BlockPtr header, ir::BlockPtr body);
+};
+
 using LoopInvariantCodeMotionPass =
     PassPipeline<FillIndirectDominatePass, LicmPass>;
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "opt/pass/base.h"
+#include "opt/pass/range.h"
+
+namespace opt {
+
+/**
+ * @brief A pass that memoizes pure recursive functions.
+ * Results are cached in a `.bss` table indexed by the arguments. Only
+ * functions whose argument ranges are proved by `RangeAnalysis` to fit in
+ * `budget` table entries are memoized.
+ * @note Requires SSA form, `FillPurePass`, `FillPredsPass`,
+ * `FillReversePostOrderPass`, `CooperFillDominatorsPass` and `FillUsesPass`.
+ * @note This pass will break every CFG-related pass.
+ */
+class MemoizationPass : public ModulePass {
+public:
+    MemoizationPass(int budget = 65536) : _budget(budget) {}
+
+    bool run_on_module(ir::Module &module) override;
+
+private:
+    using ParamRanges = std::unordered_map<ir::Function *, std::vector<Range>>;
+
+    bool _is_candidate(const ir::Function &func);
+    bool _infer_param_ranges(ir::Module &module, ParamRanges &ranges);
+    void _memoize(ir::Function &func, const std::vector<Range> &ranges,
+                  ir::Module &module);
+
+    int _budget;
+};
+
+} // namespace opt
@@ -1,12 +1,19 @@
 #pragma once
 
+#include "opt/pass/addr.h"
 #include "opt/pass/base.h"
 #include "opt/pass/cfg.h"
 #include "opt/pass/dead.h"
 #include "opt/pass/func.h"
+#include "opt/pass/global.h"
 #include "opt/pass/gvn.h"
+#include "opt/pass/if_conversion.h"
+#include "opt/pass/layout.h"
 #include "opt/pass/live.h"
 #include "opt/pass/loop.h"
+#include "opt/pass/memo.h"
+#include "opt/pass/profile.h"
 #include "opt/pass/propa.h"
+#include "opt/pass/range.h"
 #include "opt/pass/simplify_cfg.h"
 #include "opt/pass/ssa.h"
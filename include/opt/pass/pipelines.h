@@ -0,0 +1,56 @@
+// This file defines the pass pipelines of the compiler, shared by the driver
+// and the benchmarks.
+
+#pragma once
+
+#include "opt/pass/pass.h"
+
+namespace opt {
+
+using SSAPasses = PassPipeline<
+    FillPredsPass, SimplifyCFGPass, FillPredsPass, FillInlinePass,
+    FunctionInliningPass, FillPredsPass, FillReversePostOrderPass,
+    CooperFillDominatorsPass, GlobalPromotionPass, ScalarReplacementPass,
+    FillUsesPass, FillDominanceFrontierPass, SSAConstructPass, FillUsesPass,
+    GVNPass, FillUsesPass, SimpleDeadCodeEliminationPass>;
+
+// `SSAPasses` without the passes that need the whole program, i.e. inlining
+// and promotion of globals, for `--stream`
+using StreamSSAPasses = PassPipeline<
+    FillPredsPass, SimplifyCFGPass, FillPredsPass, FillReversePostOrderPass,
+    CooperFillDominatorsPass, ScalarReplacementPass, FillUsesPass,
+    FillDominanceFrontierPass, SSAConstructPass, FillUsesPass, GVNPass,
+    FillUsesPass, SimpleDeadCodeEliminationPass>;
+
+using MemoizationPasses =
+    PassPipeline<FillPurePass, FillPredsPass, FillReversePostOrderPass,
+                 CooperFillDominatorsPass, FillUsesPass>;
+
+using Passes = PassPipeline<
+    FillUsesPass, FillPredsPass, LoopIdiomPass, FillUsesPass, FillPredsPass,
+    IfConversionPass, FillUsesPass,
+    FillPredsPass, SSADestructPass, FillUsesPass,
+    SimpleRemoveCopyAfterSSADestructPass, LocalConstAndCopyPropagationPass,
+    FillUsesPass, SimpleDeadCodeEliminationPass, FillPredsPass,
+    SimplifyCFGPass, LocalConstAndCopyPropagationPass, FillUsesPass,
+    SimpleDeadCodeEliminationPass, FillPredsPass, SimplifyCFGPass,
+    FillPredsPass, FillReversePostOrderPass, CooperFillDominatorsPass,
+    LoopRotationPass, FillPredsPass, FillReversePostOrderPass,
+    CooperFillDominatorsPass, FillDominanceFrontierPass,
+    FloatConstMaterializationPass, LivenessAnalysisPass, FillUsesPass,
+    LoopInvariantCodeMotionPass, SimpleDeadCodeEliminationPass, FillUsesPass,
+    FloatConstMergePass, FillPredsPass, SimplifyCFGPass, FillPurePass,
+    TailRecursionElimination, FillPredsPass, SimplifyCFGPass, FillPredsPass,
+    FillReversePostOrderPass, CooperFillDominatorsPass, BlockLayoutPass>;
+
+using InstSelectPasses =
+    PassPipeline<FillUsesPass, AddressFoldingPass, FillUsesPass,
+                 SimpleDeadCodeEliminationPass>;
+
+// dominators are filled for the loop depth used by the stack manager
+using RegisterPasses =
+    PassPipeline<FillLeafPass, FillUsesPass, FillPredsPass,
+                 FillReversePostOrderPass, CooperFillDominatorsPass,
+                 LivenessAnalysisPass, FillIntervalPass>;
+
+} // namespace opt
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "opt/pass/base.h"
+
+namespace opt {
+
+/**
+ * @brief A pass that counts the executions of each block.
+ * Counters are 64-bit integers in the table `$__sysyc.prof`, which is written
+ * to `path` by a handler registered with `atexit` at the entry of `main`. The
+ * table starts with a header of magic, CFG checksum and counter count, so that
+ * `ProfileAnnotatePass` can tell whether the profile matches the program.
+ * @note This pass should run right after IR generation.
+ */
+class ProfileInstrumentPass : public ModulePass {
+public:
+    ProfileInstrumentPass(std::string path) : _path(path) {}
+
+    bool run_on_module(ir::Module &module) override;
+
+private:
+    void _create_dump_function(ir::Module &module, ir::DataPtr table,
+                               int bytes);
+
+    std::string _path;
+};
+
+/**
+ * @brief A pass that fills the `freq` field of each block with the execution
+ * count recorded by the program built with `ProfileInstrumentPass`.
+ * @note This pass should run right after IR generation, with the same options
+ * as the instrumented build.
+ * @note Returns false if the profile does not match the program, and no block
+ * is annotated then.
+ */
+class ProfileAnnotatePass : public ModulePass {
+public:
+    /**
+     * @brief Read the profile written by the instrumented program.
+     * @return False if the file cannot be read.
+     */
+    bool load(const std::string &path);
+
+    bool run_on_module(ir::Module &module) override;
+
+private:
+    uint _checksum = 0;
+    std::vector<long long> _counts;
+};
+
+} // namespace opt
@@ -30,4 +30,28 @@ public:
     bool run_on_function(ir::Function &func) override;
 };
 
+/**
+ * @brief A pass that materializes float constants as copies to temps.
+ * Float constants are loaded from memory, so each distinct constant used in a
+ * block is loaded once into a temp, which `LicmPass` can then hoist out of
+ * loops to keep in a register.
+ * @note Nothing is required before this pass, and it must run after SSA
+ * destruction, or the copies will be propagated back.
+ */
+class FloatConstMaterializationPass : public FunctionPass {
+public:
+    bool run_on_function(ir::Function &func) override;
+};
+
+/**
+ * @brief A pass that merges copies of the same float constant in a block,
+ * e.g. those hoisted to the same preheader by `LicmPass`.
+ * @note This pass requires `FillUsesPass`.
+ * @warning This pass will break use-def relationship filled by `FillUsesPass`
+ */
+class FloatConstMergePass : public FunctionPass {
+public:
+    bool run_on_function(ir::Function &func) override;
+};
+
 } // namespace opt
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ir/ir.h"
+#include <climits>
+
+namespace opt {
+
+/**
+ * @brief A closed interval of 32-bit integers, empty when `lo > hi`.
+ */
+struct Range {
+    long long lo, hi;
+
+    static Range full() { return {INT_MIN, INT_MAX}; }
+    static Range empty() { return {1, 0}; }
+    static Range of(long long value) { return {value, value}; }
+
+    bool is_empty() const { return lo > hi; }
+    bool is_full() const { return lo <= INT_MIN && hi >= INT_MAX; }
+    long long size() const { return is_empty() ? 0 : hi - lo + 1; }
+
+    Range join(const Range &other) const;
+    Range meet(const Range &other) const;
+
+    bool operator==(const Range &other) const {
+        return (is_empty() && other.is_empty()) ||
+               (lo == other.lo && hi == other.hi);
+    }
+    bool operator!=(const Range &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief A helper class that computes value ranges of `w` temps.
+ * The range of a temp at a use is refined by the conditions of the `jnz`
+ * edges dominating that use, e.g. `n` is known to be `>= 2` in the false
+ * branch of `if (n < 2)`. Loops are handled by widening and then narrowing.
+ * @note Requires SSA form, `FillPredsPass`, `FillReversePostOrderPass`,
+ * `CooperFillDominatorsPass` and `FillUsesPass`.
+ */
+class RangeAnalysis {
+public:
+    /**
+     * @brief Analyze the function, assuming the i-th `par` lies in
+     * `params[i]`. Missing params are assumed to be full.
+     */
+    void run(const ir::Function &func, const std::vector<Range> &params);
+
+    /**
+     * @brief Get the range of the value when it is used in the block.
+     */
+    Range get(ir::ValuePtr value, ir::BlockPtr block) const;
+
+private:
+    Range _get_base(ir::ValuePtr value) const;
+    Range _eval_inst(ir::InstPtr inst, ir::BlockPtr block) const;
+    Range _eval_phi(const ir::Phi &phi, ir::BlockPtr block) const;
+    Range _refine_by_edge(ir::TempPtr temp, Range range, ir::BlockPtr pred,
+                          ir::BlockPtr succ) const;
+
+    std::unordered_map<ir::TempPtr, Range> _ranges;
+    std::unordered_map<ir::InstPtr, int> _par_index;
+    std::vector<Range> _params;
+};
+
+} // namespace opt
@@ -21,6 +21,37 @@ private:
     bool _is_able_to_reg(ir::InstPtr alloc_inst);
 };
 
+/**
+ * @brief A pass that splits small local arrays into scalars.
+ * An array whose elements are only loaded and stored at constant offsets is
+ * replaced by one alloca per element, so that `MemoryToRegisterPass` can
+ * promote them.
+ * @note Nothing is required before this pass.
+ * @note This pass should run before `MemoryToRegisterPass`.
+ */
+class ScalarReplacementPass : public FunctionPass {
+public:
+    // arrays larger than this are not split
+    static constexpr int MAX_BYTES = 128;
+
+    bool run_on_function(ir::Function &func) override;
+
+private:
+    using OffsetMap = std::unordered_map<ir::TempPtr, int>;
+
+    bool _replace(ir::Function &func, ir::InstPtr alloc_inst);
+    bool _fill_offsets(ir::InstPtr alloc_inst, OffsetMap &offsets);
+
+    // instructions using each temp, temps used by phis and jumps, and the
+    // number of definitions of each temp
+    std::unordered_map<ir::TempPtr, std::vector<ir::InstPtr>> _users;
+    std::unordered_set<ir::TempPtr> _escaped;
+    std::unordered_map<ir::TempPtr, int> _def_count;
+    // address instructions to remove, and the scalars replacing each alloca
+    std::unordered_set<ir::InstPtr> _removed;
+    std::unordered_map<ir::InstPtr, std::vector<ir::InstPtr>> _replaced;
+};
+
 /**
  * @brief A pass that inserts phi nodes to make the function in SSA form.
  * However, this pass does not rename variables.
@@ -1,8 +1,9 @@
 /* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison GLR parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 2002-2015, 2018-2021 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -30,23 +31,27 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_INCLUDE_PARSER_H_INCLUDED
 # define YY_YY_INCLUDE_PARSER_H_INCLUDED
 /* Debug traces.  */
 #ifndef YYDEBUG
-# define YYDEBUG 1
+# define YYDEBUG 0
 #endif
 #if YYDEBUG
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 6 "parser.y"
+#line 4 "parser.y"
 
     #include "ast.h"
     #include <memory>
     void yyerror(std::shared_ptr<CompUnits>, const char*);
 
-#line 50 "include/parser.h"
+#line 55 "include/parser.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -84,11 +89,11 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 32 "parser.y"
+#line 35 "parser.y"
 
     int int_val;
     float float_val;
-    char* str_val;
+    const std::string *ident;
     ASTType type;
     CompUnit *comp_unit;
     Decl* decl;
@@ -109,7 +114,7 @@ union YYSTYPE
     Number *number;
     FuncRParams *rparams;
 
-#line 113 "include/parser.h"
+#line 118 "include/parser.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -120,6 +125,8 @@ typedef union YYSTYPE YYSTYPE;
 
 extern YYSTYPE yylval;
 
+
 int yyparse (std::shared_ptr<CompUnits> comp_units);
 
+
 #endif /* !YY_YY_INCLUDE_PARSER_H_INCLUDED  */
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Open a source file for the scanner
+ * @param path The path of the file, or `-` for the standard input
+ * @return true if the file is opened, false otherwise
+ * @note A regular file is mapped into memory and scanned in place, and other
+ * files are read as streams. The file is closed by `scanner_close` or by the
+ * next `scanner_open`.
+ */
+bool scanner_open(const std::string &path);
+
+/**
+ * @brief Open source text in memory for the scanner
+ * @param source The source text, which is copied
+ */
+void scanner_open_string(const std::string &source);
+
+/**
+ * @brief Close the source opened by `scanner_open` or `scanner_open_string`
+ * @note The scanner and the parser keep their state in globals, so only one
+ * source can be open at a time, even across threads.
+ */
+void scanner_close();
+
+/**
+ * @brief Get the unique copy of an identifier
+ * @param name The identifier
+ * @return The interned string, which lives until `clear_interned`
+ */
+const std::string *intern(std::string_view name);
+
+/**
+ * @brief Drop the interned identifiers if there are more than `limit`, so
+ * that a long-running process reuses them across sources within a bound
+ * @param limit The number of identifiers kept
+ */
+void clear_interned(size_t limit = 0);
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "target/mir.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace target {
+
+/**
+ * @brief An assembler that encodes the assembly of `Generator` into a
+ * relocatable ELF64 object for RISC-V (lp64d), without an external toolchain.
+ * Only the instructions, pseudo instructions and directives emitted by
+ * `Generator` are supported, and a `std::runtime_error` is thrown for others.
+ * Branches and jumps to local labels are resolved here, and conditional
+ * branches out of range are relaxed to an inverted branch over a `j`. No
+ * `R_RISCV_RELAX` is emitted, so the linker keeps the code as is.
+ */
+class Assembler {
+  public:
+    void assemble(std::istream &in);
+    void write(std::ostream &out);
+
+  private:
+    enum SectionId { TEXT, DATA, BSS, RODATA, SECTION_COUNT, NONE = -1 };
+
+    struct Reloc {
+        uint64_t offset;
+        uint32_t type;
+        std::string symbol;
+        int64_t addend;
+    };
+
+    struct Section {
+        std::string name;
+        uint32_t type;
+        uint64_t flags;
+        uint64_t align = 1;
+        std::vector<uint8_t> bytes = {};
+        uint64_t size = 0; // of bytes, or of the section if it is `.bss`
+        std::vector<Reloc> relocs = {};
+    };
+
+    struct Symbol {
+        std::string name;
+        int section = NONE; // undefined if none
+        uint64_t value = 0;
+        uint64_t size = 0;
+        bool is_global = false;
+        uint8_t type = 0; // STT_NOTYPE
+    };
+
+    struct TextItem {
+        MachineInst inst;
+        int line;
+        uint64_t offset = 0;
+        bool is_relaxed = false; // whether a branch is relaxed
+    };
+
+    void _parse_line(const std::string &line);
+    void _parse_directive(const std::string &name,
+                          const std::vector<std::string> &args);
+    void _define_label(const std::string &name);
+    void _append_data(const std::string &value, int bytes);
+
+    void _layout_text();
+    int _get_size(const TextItem &item) const;
+    uint64_t _get_label_offset(const std::string &label) const;
+    bool _is_local_label(const std::string &label) const;
+    void _encode_text();
+    void _encode(const TextItem &item);
+    void _encode_vector(const TextItem &item);
+    void _emit(uint32_t word);
+    void _emit_li(int reg, int64_t value);
+    void _emit_reloc(uint32_t type, const std::string &expr);
+
+    Symbol &_get_symbol(const std::string &name);
+
+    Section _sections[SECTION_COUNT] = {
+        {".text", 1, 0x6, 4}, // SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR
+        {".data", 1, 0x3},    // SHT_PROGBITS, SHF_ALLOC | SHF_WRITE
+        {".bss", 8, 0x3},     // SHT_NOBITS, SHF_ALLOC | SHF_WRITE
+        {".rodata", 1, 0x2},  // SHT_PROGBITS, SHF_ALLOC
+    };
+    int _current = NONE;
+    bool _has_stack_note = false;
+
+    std::vector<Symbol> _symbols;
+    std::unordered_map<std::string, int> _symbol_index;
+    // labels starting with `.L` are not symbols, by section and offset
+    std::unordered_map<std::string, std::pair<int, uint64_t>> _local_labels;
+
+    std::vector<TextItem> _text;
+    // labels in `.text` by the index of the item they are at
+    std::unordered_map<std::string, size_t> _text_labels;
+    // `.size sym, .-sym` in `.text`, by the index of item
+    std::vector<std::pair<std::string, size_t>> _text_sizes;
+    int _pcrel_count = 0;
+    int _line = 0;
+};
+
+} // namespace target
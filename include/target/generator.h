@@ -3,9 +3,11 @@
 #include "ir/ir.h"
 #include "ostream"
 #include "target/mem.h"
-#include "target/peephole.h"
+#include "target/mir.h"
+#include <chrono>
 #include <cmath>
 #include <functional>
+#include <map>
 #include <set>
 
 namespace target {
@@ -19,6 +21,16 @@ class Generator {
 
     void generate_data(const ir::Data &data);
     void generate_func(const ir::Function &func);
+    void generate_vector_kernel(const ir::VectorKernel &kernel);
+
+    // generate the vector kernels and data left after the functions, which
+    // `generate` does at last, for functions generated one by one
+    void finish(const ir::Module &module);
+
+    // seconds spent in register allocation and in the peephole optimizer
+    // over the functions generated, for the benchmarks
+    double regalloc_time = 0;
+    double peephole_time = 0;
 
     bool is_power_of_two(int x) { return x > 0 && (x & (x - 1)) == 0; }
 
@@ -61,34 +73,53 @@ class Generator {
     void _generate_load_inst(const ir::Inst &inst);
     void _generate_store_inst(const ir::Inst &inst);
     void _generate_arithmetic_inst(const ir::Inst &inst);
+    void _generate_arithmetic(const ir::Inst &inst, const MachineOperand &to);
     void _generate_compare_inst(const ir::Inst &inst);
     void _generate_float_compare_inst(const ir::Inst &inst);
     void _generate_unary_inst(const ir::Inst &inst);
+    void _generate_move(const MachineOperand &to, ir::ValuePtr value,
+                        std::function<int(ir::Type, int)> get_temp_reg =
+                            nullptr);
+    void _generate_float_const(const MachineOperand &reg,
+                               ir::ConstBitsPtr constbits);
     void _generate_convert_inst(const ir::Inst &inst);
+    void _generate_select_inst(const ir::Inst &inst);
 
     void _generate_call_inst(const ir::Inst &inst,
                              const std::vector<ir::ValuePtr> &args);
+    bool _is_sibling_call(const ir::Inst &inst, const ir::Jump &jump,
+                          const std::vector<ir::ValuePtr> &args);
+    void _generate_tail_call_inst(const ir::Inst &inst,
+                                  const std::vector<ir::ValuePtr> &args);
+    void _generate_call_args(const std::vector<ir::ValuePtr> &args);
     void _generate_arguments(const std::vector<ir::ValuePtr> &args, int pass);
     void _generate_par_inst(const ir::Inst &inst, int par_count);
-    void _generate_jump_inst(const ir::Jump &jump);
-
-    std::string _get_asm_arg(
+    void _generate_prologue();
+    void _generate_epilogue(int scratch);
+    ir::InstPtr _select_branch(const ir::Block &block);
+    void _select_deferred_defs(const ir::Block &block);
+    void _generate_branch(const ir::Inst &cond, const ir::Jump &jump);
+    void _generate_jump_inst(const ir::Jump &jump, ir::InstPtr cond = nullptr);
+
+    MachineOperand _get_asm_arg(
         ir::ValuePtr arg, int no,
-        std::function<int(ir::Type, int)> get_temp_reg = _get_temp_reg);
+        std::function<int(ir::Type, int)> get_temp_reg = nullptr);
 
-    std::tuple<std::string, bool> _get_asm_arg_or_w_constbits(ir::ValuePtr arg,
-                                                              int no);
-    std::string _get_asm_addr(ir::ValuePtr addr, int no);
+    std::tuple<MachineOperand, bool>
+    _get_asm_arg_or_w_constbits(ir::ValuePtr arg, int no);
+    MachineOperand _get_asm_addr(ir::ValuePtr addr, int no, int offset = 0);
 
-    std::tuple<std::string, std::function<void(std::ostream &)>>
+    std::tuple<MachineOperand, std::function<void(std::ostream &)>>
     _get_asm_to(ir::TempPtr to,
-                std::function<int(ir::Type, int)> get_temp_reg = _get_temp_reg);
+                std::function<int(ir::Type, int)> get_temp_reg = nullptr);
 
-    static int _get_temp_reg(ir::Type type, int no);
+    int _get_temp_reg(ir::Type type, int no);
 
     std::ostream &_out = std::cout;
     StackManager _stack_manager;
     std::vector<ir::DataPtr> _local_data;
+    // labels of float constants in local data, by bit pattern
+    std::unordered_map<std::string, std::string> _float_consts;
 
     struct RegReach {
         int reg;
@@ -96,9 +127,13 @@ class Generator {
     };
     std::set<RegReach, std::function<bool(const RegReach &, const RegReach &)>>
         _reg_reach;
+    // arithmetics and constants of the block computed into the register of
+    // their only use, by their temps
+    std::unordered_map<ir::TempPtr, ir::InstPtr> _deferred_defs;
 
     bool _opt;
-    PeepholeBuffer _buffer;
+    bool _in_frame = true;
+    MachineFunction _mfunc;
 };
 
 } // namespace target
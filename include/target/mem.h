@@ -23,6 +23,8 @@ namespace target {
  * - s registers should be saved if used in the function
  * - arguments more than 8 should be passed on the stack in reverse order
  * - stack should be aligned to 16 bytes
+ * - local variables and spilled registers never live at the same time share
+ *   a slot, and the most accessed slots are placed closest to sp
  */
 
 class StackManager {
@@ -47,27 +49,77 @@ public:
         return _caller_saved_regs_offset;
     }
 
+    /**
+     * @brief Move the prologue from the entry to the nearest block
+     * dominating all blocks that need the frame, i.e. those making calls or
+     * accessing stack slots and callee saved registers. So early returns like
+     * base cases of recursion leave without touching the stack.
+     * @note Only the blocks dominated by that block may have the frame, which
+     * must be left by returning only.
+     */
+    void shrink_wrap(const ir::Function &func);
+
+    /**
+     * @brief Get the block starting with the prologue, or `nullptr` if the
+     * prologue is at the function entry or not needed at all.
+     */
+    ir::BlockPtr get_prologue_block() const { return _prologue_block; }
+
+    bool is_in_frame(ir::BlockPtr block) const {
+        return _frame_blocks.count(block);
+    }
+
+    /**
+     * @brief Get the params kept in their argument registers outside the
+     * frame, which are moved to their allocated registers by the prologue.
+     */
+    const std::unordered_map<ir::TempPtr, int> &get_deferred_pars() const {
+        return _deferred_pars;
+    }
+
 private:
     int _frame_size = 0;
     std::unordered_map<int, int> _callee_saved_regs_offset;
     std::unordered_map<ir::TempPtr, int> _local_var_offset;
     std::unordered_map<ir::TempPtr, int> _spilled_temps_offset;
     std::unordered_map<int, int> _caller_saved_regs_offset;
+    ir::BlockPtr _prologue_block = nullptr;
+    std::unordered_set<ir::BlockPtr> _frame_blocks;
+    std::unordered_map<ir::TempPtr, int> _deferred_pars;
 
     // function infos below
     std::unordered_set<int> _callee_saved_regs;
     struct LocalVar {
         int align;
         int bytes;
+        long long weight = 0;                 // accesses weighted by freq
+        std::unordered_set<ir::BlockPtr> lives; // blocks where it is live
     };
     std::unordered_map<ir::TempPtr, LocalVar> _local_vars;
     std::unordered_set<ir::TempPtr> _spilled_temps;
     std::unordered_set<int> _caller_saved_regs;
     int _max_func_call_args = 0;
+    std::unordered_map<ir::BlockPtr, long long> _block_weights;
+    std::unordered_map<ir::BlockPtr, std::vector<ir::BlockPtr>> _succs, _preds;
+
+    // objects sharing the same stack slot
+    struct Slot {
+        int align;
+        int bytes;
+        long long weight;
+        std::vector<ir::TempPtr> temps;
+    };
 
     void _collect_function_info(const ir::Function &func);
 
     void _collect_block_info(const ir::Block &block);
+
+    void _fill_cfg(const ir::Function &func);
+    void _fill_block_weights(const ir::Function &func);
+    void _fill_local_var_lives(const ir::Function &func);
+    std::vector<Slot> _color_local_vars();
+    std::vector<Slot> _color_spilled_temps();
+    bool _is_frame_needed(const ir::Block &block);
 };
 
 } // namespace target
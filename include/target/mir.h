@@ -0,0 +1,184 @@
+#pragma once
+
+#include <list>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace target {
+
+// registers numbered from here are virtual, and are assigned to physical
+// registers by `ScratchRegisterAllocator` before peephole optimization
+static const int FIRST_VIRTUAL_REG = 64;
+
+inline bool is_virtual_reg(int reg) { return reg >= FIRST_VIRTUAL_REG; }
+
+// physical registers named in generated code, numbered as in `regno2string`
+enum PhysicalReg {
+    ZERO, RA, SP, GP, TP, T0, T1, T2, S0, S1,
+    A0, A1, A2, A3, A4, A5, A6, A7,
+    T3 = 28, T4, T5, T6,
+    FA0 = 42, FA1, FA2, FA3, FA4, FA5, FA6, FA7,
+};
+
+/**
+ * @brief An operand of a machine instruction.
+ * A register is a physical register number (see `regno2string`) or a virtual
+ * register. A memory operand is a base register with a displacement, which
+ * is symbolic for `%lo(...)`. Everything else, such as labels, function names
+ * and vector types, is kept as a symbol.
+ */
+struct MachineOperand {
+    enum Kind { REG, IMM, MEM, SYM } kind;
+    int reg = 0;       // the register, or the base register of memory
+    long long imm = 0; // the immediate, or the displacement of memory
+    std::string sym;   // the symbol, or the symbolic displacement of memory
+
+    static MachineOperand reg_of(int reg) { return {REG, reg, 0, {}}; }
+    static MachineOperand imm_of(long long imm) { return {IMM, 0, imm, {}}; }
+    static MachineOperand mem_of(int base, long long disp) {
+        return {MEM, base, disp, {}};
+    }
+    static MachineOperand mem_of(int base, std::string disp) {
+        return {MEM, base, 0, std::move(disp)};
+    }
+    static MachineOperand sym_of(std::string sym) {
+        return {SYM, 0, 0, std::move(sym)};
+    }
+
+    /**
+     * @brief Parse an operand in assembly syntax.
+     */
+    static MachineOperand parse(const std::string &text);
+
+    std::string to_string() const;
+
+    bool is_reg() const { return kind == REG; }
+    bool is_imm() const { return kind == IMM; }
+    bool is_mem() const { return kind == MEM; }
+    bool is_sym() const { return kind == SYM; }
+
+    // whether the operand reads or writes the register, as itself or as the
+    // base of memory
+    bool has_reg() const { return kind == REG || kind == MEM; }
+
+    bool operator==(const MachineOperand &other) const {
+        return kind == other.kind && reg == other.reg && imm == other.imm &&
+               sym == other.sym;
+    }
+    bool operator!=(const MachineOperand &other) const {
+        return !(*this == other);
+    }
+};
+
+struct MachineInst {
+    enum { INST, LABEL } type;
+    enum { ENTRY, BODY, EXIT } region;
+    std::string opcode; // the mnemonic, or the name of label
+    std::vector<MachineOperand> operands;
+    // registers read or written besides operands, such as arguments of calls
+    std::vector<int> implicit_uses, implicit_defs;
+
+    MachineInst(std::string opcode, std::vector<MachineOperand> operands)
+        : type(INST), region(BODY), opcode(std::move(opcode)),
+          operands(std::move(operands)) {}
+
+    static MachineInst label(std::string name) {
+        MachineInst inst(std::move(name), {});
+        inst.type = LABEL;
+        return inst;
+    }
+
+    std::string to_string() const;
+
+    /**
+     * @brief Get the registers read by the instruction.
+     */
+    std::vector<int> uses() const;
+
+    /**
+     * @brief Get the registers written by the instruction.
+     */
+    std::vector<int> defs() const;
+
+    bool is_inst() const { return type == MachineInst::INST; }
+    bool is_label() const { return type == MachineInst::LABEL; }
+
+    bool is_entry() const { return region == ENTRY; }
+    void set_entry() { region = ENTRY; }
+    bool is_body() const { return region == BODY; }
+    void set_body() { region = BODY; }
+    bool is_exit() const { return region == EXIT; }
+    void set_exit() { region = EXIT; }
+
+    const std::string &op() const { return opcode; }
+    void op(const std::string &op) { opcode = op; }
+    const MachineOperand &arg0() const { return operands[0]; }
+    void arg0(const MachineOperand &arg) { operands[0] = arg; }
+    const MachineOperand &arg1() const { return operands[1]; }
+    void arg1(const MachineOperand &arg) { operands[1] = arg; }
+    const MachineOperand &arg2() const { return operands[2]; }
+    void arg2(const MachineOperand &arg) { operands[2] = arg; }
+
+    void swap(int i, int j) { std::swap(operands[i], operands[j]); }
+
+  private:
+    // whether the first operand is written
+    bool _has_def() const;
+};
+
+/**
+ * @brief A straight-line range of instructions starting from a label, or
+ * from the beginning of the function.
+ */
+struct MachineBlock {
+    std::list<MachineInst>::iterator begin, end;
+    std::vector<int> succs; // indices of successor blocks
+};
+
+/**
+ * @brief The instructions of a function, in layout order.
+ * Blocks are delimited by labels and may fall through to the next one, so
+ * the instructions are kept in a single list.
+ */
+class MachineFunction {
+  public:
+    struct VirtualReg {
+        bool is_float;
+        int hint; // physical register preferred, or -1 if none
+    };
+
+    std::list<MachineInst> insts;
+    std::vector<VirtualReg> vregs;
+
+    MachineInst &append(std::string op, std::vector<MachineOperand> operands) {
+        return insts.emplace_back(std::move(op), std::move(operands));
+    }
+
+    MachineInst &append(std::string label) {
+        return insts.emplace_back(MachineInst::label(std::move(label)));
+    }
+
+    /**
+     * @brief Create a virtual register preferring the physical register.
+     */
+    int new_vreg(bool is_float, int hint = -1) {
+        vregs.push_back({is_float, hint});
+        return FIRST_VIRTUAL_REG + vregs.size() - 1;
+    }
+
+    const VirtualReg &get_vreg(int reg) const {
+        return vregs.at(reg - FIRST_VIRTUAL_REG);
+    }
+
+    std::vector<MachineBlock> blocks();
+
+    void clear() {
+        insts.clear();
+        vregs.clear();
+    }
+
+    void emit(std::ostream &out) const;
+};
+
+} // namespace target
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ir/ir.h"
+#include "target/mir.h"
 #include <unordered_set>
 
 namespace target {
@@ -8,6 +9,7 @@ namespace target {
 #define STACK -2
 #define SPILL -1
 #define NO_REGISTER -3
+#define REMAT -4 // recomputed at each use
 
 class RegisterAllocator {
 public:
@@ -39,8 +41,45 @@ private:
                          std::vector<ir::TempPtr> &f_local_intervals);
 
     static bool _is_local(const ir::TempPtr &temp);
+    static int _get_spill_mode(const ir::TempPtr &temp);
+    static bool _is_rematerializable(const ir::TempPtr &temp);
+    static long long _get_spill_cost(const ir::TempPtr &temp);
 
     std::unordered_set<ir::TempPtr> _global_temps;
 };
 
+/**
+ * @brief An allocator that assigns virtual registers of machine instructions
+ * to scratch registers (a4-a7 and fa4-fa7). Virtual registers are short-lived
+ * values within a block, such as spilled temps reloaded right before their
+ * use, so they are assigned greedily in the order of definition, preferring
+ * their hints and avoiding scratch registers live at the same time.
+ */
+class ScratchRegisterAllocator {
+public:
+    void allocate(MachineFunction &func);
+
+    /**
+     * @brief Whether the register may be assigned to virtual registers, and
+     * is thus clobbered between the instructions of a block.
+     */
+    static bool is_scratch(int reg);
+
+private:
+    // a half-open range [begin, end) of instruction indices
+    struct Range {
+        int begin, end;
+
+        bool overlaps(const Range &other) const {
+            return begin < other.end && other.begin < end;
+        }
+    };
+
+    void _fill_scratch_ranges(MachineFunction &func);
+    void _fill_vreg_ranges(MachineFunction &func);
+
+    std::unordered_map<int, std::vector<Range>> _busy;
+    std::vector<Range> _vreg_ranges;
+};
+
 } // namespace target
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "target/assembler.h"
 #include "target/generator.h"
 #include "target/mem.h"
 #include "target/regalloc.h"
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "target/mir.h"
 #include <string>
+#include <unordered_map>
 
 namespace target {
 
@@ -21,12 +23,31 @@ inline std::string regno2string(int number) {
         return "stack";
     } else if (number == -3) {
         return "no_register";
-    } else if (number < 0 || number >= 64) {
+    } else if (is_virtual_reg(number)) {
+        return "%v" + std::to_string(number);
+    } else if (number < 0) {
         return "unknown";
     }
     return regnames[number];
 }
 
+// Returns -1 if the name is not a register.
+inline int string2regno(const std::string &name) {
+    if (name.size() > 2 && name[0] == '%' && name[1] == 'v' &&
+        name.find_first_not_of("0123456789", 2) == std::string::npos) {
+        return std::stoi(name.substr(2));
+    }
+    static const auto numbers = [] {
+        std::unordered_map<std::string, int> numbers;
+        for (int number = 0; number < FIRST_VIRTUAL_REG; number++) {
+            numbers[regno2string(number)] = number;
+        }
+        return numbers;
+    }();
+    auto it = numbers.find(name);
+    return it == numbers.end() ? -1 : it->second;
+}
+
 // This method should only be called when there is no register allocation.
 inline int get_temp_reg() {
     static int choice = 0;
@@ -36,15 +36,18 @@ private:
     int _require_const_lval = 0;
 
     bool _optimize = false;
+    bool _vectorize = false;
 
     std::unordered_map<ir::ValuePtr, ir::ValuePtr> _last_store;
     bool _in_unroll_loop = false;
 
+    // vector kernels created, indexed by their shape
+    std::unordered_map<std::string, ir::VectorKernelPtr> _vector_kernels;
+
 public:
-    Visitor(ir::Module &module, bool optimize = false)
-        : _module(module),
-          _current_scope(std::make_shared<sym::SymbolTable>(nullptr)),
-          _optimize(optimize) {
+    Visitor(ir::Module &module, bool optimize = false, bool vectorize = false)
+        : _current_scope(std::make_shared<sym::SymbolTable>(nullptr)),
+          _module(module), _optimize(optimize), _vectorize(vectorize) {
         _add_builtin_funcs();
     }
 
@@ -56,6 +59,12 @@ public:
      */
     void visit(const CompUnits &node);
 
+    /**
+     * @brief Visit a declaration or a function definition at the top level
+     * @param node The node of the top level
+     */
+    void visit_comp_unit(const CompUnit &node);
+
     void visit_decl(const Decl &node);
     void visit_var_def(const VarDef &node, ASTType btype, bool is_const);
     sym::InitializerPtr visit_init_val(const InitVal &node, sym::Type &type,
@@ -149,5 +158,12 @@ private:
 
     bool _can_unroll_loop(const WhileStmt &node, int &from, int &to, bool &is_mini_loop);
 
+    /**
+     * @brief Lower a counted loop over arrays to a call of vector kernel
+     * @param node The while statement
+     * @return true if the loop is lowered, false otherwise
+     */
+    bool _vectorize_loop(const WhileStmt &node);
+
     bool _has_control_stmt(const Stmt &node);
 };
\ No newline at end of file
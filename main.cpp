@@ -1,55 +1,90 @@
 #include "ast.h"
 #include "error.h"
 #include "ir/ir.h"
-#include "opt/pass/pass.h"
+#include "opt/pass/pipelines.h"
 #include "parser.h"
+#include "scanner.h"
 #include "target/target.h"
 #include "visitor.h"
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <getopt.h>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
 
-using Passes = opt::PassPipeline<
-    opt::FillPredsPass, opt::SimplifyCFGPass, opt::FillPredsPass,
-    opt::FillInlinePass, opt::FunctionInliningPass, opt::FillPredsPass,
-    opt::FillReversePostOrderPass, opt::FillUsesPass,
-    opt::CooperFillDominatorsPass, opt::FillDominanceFrontierPass,
-    opt::SSAConstructPass, opt::FillUsesPass, opt::GVNPass, opt::FillUsesPass,
-    opt::SimpleDeadCodeEliminationPass, opt::FillPredsPass,
-    opt::SSADestructPass, opt::FillUsesPass,
-    opt::SimpleRemoveCopyAfterSSADestructPass,
-    opt::LocalConstAndCopyPropagationPass, opt::FillUsesPass,
-    opt::SimpleDeadCodeEliminationPass, opt::FillPredsPass,
-    opt::SimplifyCFGPass, opt::LocalConstAndCopyPropagationPass,
-    opt::FillUsesPass, opt::SimpleDeadCodeEliminationPass, opt::FillPredsPass,
-    opt::SimplifyCFGPass, opt::FillPredsPass, opt::FillReversePostOrderPass,
-    opt::CooperFillDominatorsPass, opt::FillDominanceFrontierPass,
-    opt::LivenessAnalysisPass, opt::FillUsesPass,
-    opt::LoopInvariantCodeMotionPass, opt::SimpleDeadCodeEliminationPass,
-    opt::FillPredsPass, opt::SimplifyCFGPass, opt::TailRecursionElimination,
-    opt::FillPredsPass, opt::SimplifyCFGPass>;
-
-using RegisterPasses =
-    opt::PassPipeline<opt::FillLeafPass, opt::FillUsesPass,
-                      opt::FillReversePostOrderPass, opt::LivenessAnalysisPass,
-                      opt::FillIntervalPass>;
+const char *DEFAULT_PROFILE = "sysyc.profdata";
 
 struct Options {
     bool optimize = false;
     bool emit_ast = false;
     bool emit_ir = false;
     bool emit_asm = false;
+    bool emit_obj = false;
+    bool stream = false;
+    bool memoize = false;
+    int memo_budget = 65536;
+    bool vectorize = false;
+    std::string profile_generate;
+    std::string profile_use;
     std::string output;
+    std::string output_dir;
+    std::string manifest;
+    int jobs = 1;
+    std::string server;
+    std::string connect;
 };
 
 void usage(const char *name) {
-    std::cerr << "Usage: " << name << " [options] [file]" << std::endl;
+    std::cerr << "Usage: " << name << " [options] [file...]" << std::endl;
+    std::cerr << "  file: Source file, or - for standard input" << std::endl;
     std::cerr << "Options:" << std::endl;
     std::cerr << "  -h, --help: Show this help message" << std::endl;
     std::cerr << "  -O1: Enable optimization" << std::endl;
+    std::cerr << "  --memoize: Memoize pure recursive functions (with -O1)"
+              << std::endl;
+    std::cerr << "  --memo-budget: Max entries of a memo table" << std::endl;
+    std::cerr << "  -march: Target ISA, e.g. rv64gcv to vectorize loops (with "
+                 "-O1)"
+              << std::endl;
+    std::cerr << "  -fprofile-generate[=file]: Count block executions into "
+                 "file (default: sysyc.profdata)"
+              << std::endl;
+    std::cerr << "  -fprofile-use[=file]: Optimize with the counts of "
+                 "-fprofile-generate"
+              << std::endl;
     std::cerr << "  --emit-ast: Emit AST as JSON" << std::endl;
     std::cerr << "  --emit-ir: Emit IR as JSON" << std::endl;
     std::cerr << "  -S, --emit-asm: Emit assembly" << std::endl;
-    std::cerr << "  -o, --output: Output file" << std::endl;
+    std::cerr << "  -c, --emit-obj: Emit object file (ELF)" << std::endl;
+    std::cerr << "  --stream: Compile function by function in bounded memory, "
+                 "without inlining and promotion of globals"
+              << std::endl;
+    std::cerr << "  -o, --output: Output file, or `-` for the standard output"
+              << std::endl;
+    std::cerr << "  --output-dir: Compile several files in one process, each "
+                 "into dir/<name>.s, .o, .ssa or .json"
+              << std::endl;
+    std::cerr << "  --manifest: File listing an input, and optionally its "
+                 "output, per line to compile in one process"
+              << std::endl;
+    std::cerr << "  -j, --jobs: Number of files compiled in parallel "
+                 "(default: 1)"
+              << std::endl;
+    std::cerr << "  --server: Serve compile requests on a Unix socket until "
+                 "killed"
+              << std::endl;
+    std::cerr << "  --connect: Compile the file by the server on a Unix socket"
+              << std::endl;
 }
 
 void cmd_error(const char *name, const std::string &msg, int exitcode = 1) {
@@ -57,54 +92,201 @@ void cmd_error(const char *name, const std::string &msg, int exitcode = 1) {
     exit(exitcode);
 }
 
-extern FILE *yyin;
+// a failure to compile an input, which fails only that input in batch mode
+struct CompileError : public std::runtime_error {
+    int exitcode;
 
-void compile(const char *name, const Options &options,
-             const std::string &input) {
-    std::ofstream outfile;
-    auto output = options.output;
+    CompileError(const std::string &msg, int exitcode)
+        : std::runtime_error(msg), exitcode(exitcode) {}
+};
+
+// the scanner and the parser keep their state in globals
+static std::mutex parser_mutex;
+
+// whether the ISA string has the vector extension, e.g. rv64gcv or rv64gc_v
+bool has_vector_extension(const std::string &march) {
+    if (march.rfind("rv64", 0) != 0) {
+        return false;
+    }
+    auto base = march.substr(4, march.find('_') - 4);
+    return base.find('v') != std::string::npos ||
+           march.find("_v") != std::string::npos;
+}
+
+// the extension of the output, after the kind of output in options
+std::string output_extension(const Options &options) {
+    if (options.emit_ast) {
+        return ".json";
+    } else if (options.emit_ir) {
+        return ".ssa";
+    } else if (options.emit_asm) {
+        return ".s";
+    } else {
+        return ".o";
+    }
+}
+
+// opens the output when there is something to write, so that a failed
+// compilation leaves no output behind
+using OutputOpener = std::function<std::ostream &()>;
+
+// write the assembly, or the object assembled from it
+void write_output(const Options &options, const OutputOpener &open_output,
+                  const std::function<void(std::ostream &)> &generate) {
+    if (options.emit_asm) {
+        generate(open_output());
+        return;
+    }
+
+    if (options.emit_obj) {
+        std::stringstream assembly;
+        generate(assembly);
+
+        target::Assembler assembler;
+        try {
+            assembler.assemble(assembly);
+        } catch (const std::runtime_error &e) {
+            throw CompileError(std::string("failed to assemble: ") + e.what(),
+                               7);
+        }
+        assembler.write(open_output());
+        return;
+    }
 
-    yyin = fopen(input.c_str(), "r");
+    throw CompileError("nothing to do", 6);
+}
+
+// lower, optimize and generate each function as soon as it is visited, and
+// release its AST and IR then, so that the IR in memory is bounded by the
+// largest function rather than the whole program
+void compile_stream(const Options &options, CompUnits &units,
+                    std::ostream &out) {
+    ir::Module module;
+    Visitor visitor(module, options.optimize,
+                    options.optimize && options.vectorize);
+    target::Generator generator(out, options.optimize);
 
-    if (yyin == nullptr) {
-        cmd_error(name, "failed to open file: " + input, 4);
+    size_t generated = 0;
+    for (auto &unit : units) {
+        visitor.visit_comp_unit(*unit);
+        unit.reset();
+        if (has_error()) {
+            throw CompileError("compilation failed", 5);
+        }
+
+        for (auto &data : module.datas) {
+            generator.generate_data(*data);
+        }
+        module.datas.clear();
+
+        for (; generated < module.functions.size(); generated++) {
+            auto &func = module.functions[generated];
+
+            // passes see the function alone, and functions it calls are
+            // defined before it, so their summaries like `is_pure` are ready
+            ir::Module function_module;
+            function_module.functions.push_back(func);
+            if (options.optimize) {
+                opt::StreamSSAPasses ssa_pass;
+                ssa_pass.run(function_module);
+                opt::Passes pass;
+                pass.run(function_module);
+                opt::InstSelectPasses isel_pass;
+                isel_pass.run(function_module);
+            }
+            opt::RegisterPasses reg_pass;
+            reg_pass.run(function_module);
+
+            generator.generate_func(*func);
+            func->release();
+        }
     }
 
+    generator.finish(module);
+}
+
+// compile the source opened by `open_source` with the scanner, where up to
+// `cache_limit` interned identifiers and constants are kept from the last
+// input
+void compile(const char *name, const Options &options,
+             const std::function<void()> &open_source,
+             const OutputOpener &open_output, size_t cache_limit = 0) {
+    // state left by the last input compiled in this thread
+    reset_error();
+    ir::Address::clear_cache(cache_limit);
+    ir::ConstBits::clear_cache(cache_limit);
+
     auto root = std::make_shared<CompUnits>();
-    yyparse(root);
+    {
+        std::lock_guard<std::mutex> lock(parser_mutex);
+        clear_interned(cache_limit);
+        open_source();
+        yyparse(root);
+        scanner_close();
+    }
 
     if (options.emit_ast) {
-        if (output.length() == 0) {
-            output = "out.json";
-        }
-        outfile.open(output, std::ios::out);
-        print_ast(outfile, *root);
+        print_ast(open_output(), *root);
+        return;
+    }
+
+    if (options.stream) {
+        write_output(options, open_output, [&](std::ostream &out) {
+            compile_stream(options, *root, out);
+        });
         return;
     }
 
     ir::Module module;
-    Visitor visitor(module, options.optimize);
+    Visitor visitor(module, options.optimize,
+                    options.optimize && options.vectorize);
     visitor.visit(*root);
 
     if (has_error()) {
-        cmd_error(name, "compilation failed", 5);
+        throw CompileError("compilation failed", 5);
+    }
+
+    if (options.profile_generate.length() != 0) {
+        opt::ProfileInstrumentPass profile_pass(options.profile_generate);
+        profile_pass.run(module);
+    } else if (options.profile_use.length() != 0) {
+        opt::ProfileAnnotatePass profile_pass;
+        if (!profile_pass.load(options.profile_use)) {
+            throw CompileError(
+                "failed to open profile: " + options.profile_use, 4);
+        }
+        if (!profile_pass.run(module)) {
+            std::cerr << name << ": warning: profile does not match, ignored"
+                      << std::endl;
+        }
     }
 
     if (options.optimize) {
-        Passes pass;
+        opt::SSAPasses ssa_pass;
+        ssa_pass.run(module);
+
+        if (options.memoize) {
+            opt::MemoizationPasses memo_prepare_pass;
+            memo_prepare_pass.run(module);
+            opt::MemoizationPass memo_pass(options.memo_budget);
+            memo_pass.run(module);
+        }
+
+        opt::Passes pass;
         pass.run(module);
     }
 
     if (options.emit_ir) {
-        if (output.length() == 0) {
-            output = "out.ssa";
-        }
-        outfile.open(output, std::ios::out);
-        module.emit(outfile);
+        module.emit(open_output());
         return;
     }
 
-    RegisterPasses reg_pass;
+    if (options.optimize) {
+        opt::InstSelectPasses isel_pass;
+        isel_pass.run(module);
+    }
+
+    opt::RegisterPasses reg_pass;
     reg_pass.run(module);
 
     // std::cerr << "Register allocation:" << std::endl;
@@ -141,18 +323,301 @@ void compile(const char *name, const Options &options,
     //     }
     // }
 
-    if (options.emit_asm) {
-        if (output.length() == 0) {
-            output = "out.s";
+    write_output(options, open_output, [&](std::ostream &out) {
+        target::Generator generator(out, options.optimize);
+        generator.generate(module);
+    });
+}
+
+// compile a source file into the output file, or out.s and so on by default
+void compile_file(const char *name, const Options &options,
+                  const std::string &input, std::string output) {
+    if (output.length() == 0) {
+        output = "out" + output_extension(options);
+    }
+
+    std::ofstream outfile;
+    compile(
+        name, options,
+        [&]() {
+            if (!scanner_open(input)) {
+                throw CompileError("failed to open file: " + input, 4);
+            }
+        },
+        [&]() -> std::ostream & {
+            if (output == "-") {
+                return std::cout;
+            }
+            outfile.open(output, std::ios::out | std::ios::binary);
+            return outfile;
+        });
+}
+
+// the output of an input in batch mode, named after the input
+std::string batch_output(const Options &options, const std::string &input) {
+    auto name = std::filesystem::path(input).stem().string() +
+                output_extension(options);
+    return (std::filesystem::path(options.output_dir) / name).string();
+}
+
+// compile each pair of input and output in one process, with `options.jobs`
+// threads, and return the exit code of the first input that fails
+int compile_batch(
+    const char *name, const Options &options,
+    const std::vector<std::pair<std::string, std::string>> &units) {
+    std::vector<int> exitcodes(units.size(), 0);
+    std::atomic<size_t> next = 0;
+
+    auto work = [&]() {
+        for (size_t i; (i = next++) < units.size();) {
+            auto &[input, output] = units[i];
+            try {
+                compile_file(name, options, input, output);
+            } catch (const CompileError &e) {
+                std::cerr << name << ": " << input << ": " << e.what()
+                          << std::endl;
+                exitcodes[i] = e.exitcode;
+            }
         }
-        outfile.open(output, std::ios::out);
-        target::Generator generator(outfile, options.optimize);
+    };
 
-        generator.generate(module);
-        return;
+    std::vector<std::thread> threads;
+    for (int i = 1; i < std::min<int>(options.jobs, units.size()); i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
     }
 
-    cmd_error(name, "nothing to do", 6);
+    for (auto exitcode : exitcodes) {
+        if (exitcode != 0) {
+            return exitcode;
+        }
+    }
+    return 0;
+}
+
+// messages between the client and the server are strings, each after its
+// length
+bool write_message(int fd, const std::string &message) {
+    uint32_t length = message.size();
+    std::string data(reinterpret_cast<const char *>(&length), sizeof(length));
+    data += message;
+    for (size_t done = 0; done < data.size();) {
+        // a client gone away must not kill the server with SIGPIPE
+        auto n = send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+bool read_bytes(int fd, char *data, size_t size) {
+    for (size_t done = 0; done < size;) {
+        auto n = read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+bool read_message(int fd, std::string &message) {
+    // sources and outputs are far below this, anything larger is garbage
+    const uint32_t MAX_MESSAGE = 1 << 30;
+
+    uint32_t length;
+    if (!read_bytes(fd, reinterpret_cast<char *>(&length), sizeof(length)) ||
+        length > MAX_MESSAGE) {
+        return false;
+    }
+    message.resize(length);
+    return read_bytes(fd, message.data(), length);
+}
+
+// the options that matter to compiling a source, as sent by the client
+std::string encode_options(const Options &options) {
+    std::ostringstream out;
+    out << options.optimize << ' ' << options.emit_ast << ' '
+        << options.emit_ir << ' ' << options.emit_asm << ' '
+        << options.emit_obj << ' ' << options.stream << ' '
+        << options.memoize << ' ' << options.memo_budget << ' '
+        << options.vectorize << '\n'
+        << options.profile_generate << '\n'
+        << options.profile_use << '\n';
+    return out.str();
+}
+
+bool decode_options(const std::string &message, Options &options) {
+    std::istringstream in(message);
+    in >> options.optimize >> options.emit_ast >> options.emit_ir >>
+        options.emit_asm >> options.emit_obj >> options.stream >>
+        options.memoize >> options.memo_budget >> options.vectorize;
+    in.ignore();
+    std::getline(in, options.profile_generate);
+    std::getline(in, options.profile_use);
+    return !in.fail();
+}
+
+int open_socket(const char *name, const std::string &path, sockaddr_un &addr) {
+    if (path.size() >= sizeof(addr.sun_path)) {
+        cmd_error(name, "socket path too long: " + path, 2);
+    }
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        cmd_error(name, std::string("failed to create socket: ") +
+                            strerror(errno),
+                  4);
+    }
+    return fd;
+}
+
+static std::string server_path;
+
+// identifiers and constants in each cache kept warm across requests
+static const size_t SERVER_CACHE_LIMIT = 1 << 16;
+
+void stop_server(int) {
+    unlink(server_path.c_str());
+    _exit(0);
+}
+
+// compile the requests of clients one by one, until killed. Each request is
+// the options and the source, and each response is the exit code, the
+// diagnostics and the output
+void serve(const char *name, const std::string &path) {
+    sockaddr_un addr;
+    int fd = open_socket(name, path, addr);
+
+    // a socket left by a server killed before is replaced
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path.c_str());
+    }
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        cmd_error(name, "failed to listen on " + path + ": " + strerror(errno),
+                  4);
+    }
+    server_path = path;
+    signal(SIGINT, stop_server);
+    signal(SIGTERM, stop_server);
+
+    for (;;) {
+        int conn = accept(fd, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            cmd_error(name, std::string("failed to accept: ") +
+                                strerror(errno),
+                      4);
+        }
+
+        Options options;
+        std::string message, source;
+        if (read_message(conn, message) && decode_options(message, options) &&
+            read_message(conn, source)) {
+            std::stringstream output, diagnostics;
+            int exitcode = 0;
+
+            // errors are reported to the client, not to the terminal of the
+            // server
+            auto cerr_buf = std::cerr.rdbuf(diagnostics.rdbuf());
+            try {
+                compile(
+                    name, options, [&]() { scanner_open_string(source); },
+                    [&]() -> std::ostream & { return output; },
+                    SERVER_CACHE_LIMIT);
+            } catch (const CompileError &e) {
+                std::cerr << name << ": " << e.what() << std::endl;
+                exitcode = e.exitcode;
+            } catch (const std::exception &e) {
+                // the next request starts from a clean state anyway
+                std::cerr << name << ": internal error: " << e.what()
+                          << std::endl;
+                exitcode = 1;
+            }
+            std::cerr.rdbuf(cerr_buf);
+
+            for (auto &message :
+                 {std::to_string(exitcode), diagnostics.str(), output.str()}) {
+                if (!write_message(conn, message)) {
+                    break;
+                }
+            }
+        }
+        close(conn);
+    }
+}
+
+// send the source to the server, and write what it returns as if compiled
+// here
+int connect_server(const char *name, const Options &options,
+                   const std::string &path, const std::string &input,
+                   std::string output) {
+    std::ostringstream source;
+    if (input == "-") {
+        source << std::cin.rdbuf();
+    } else {
+        std::ifstream file(input, std::ios::in | std::ios::binary);
+        if (!file) {
+            cmd_error(name, "failed to open file: " + input, 4);
+        }
+        source << file.rdbuf();
+    }
+
+    // the server may run elsewhere in the file system
+    auto server_options = options;
+    if (server_options.profile_use.length() != 0) {
+        server_options.profile_use =
+            std::filesystem::absolute(options.profile_use).string();
+    }
+
+    sockaddr_un addr;
+    int fd = open_socket(name, path, addr);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        cmd_error(name,
+                  "failed to connect to " + path + ": " + strerror(errno), 4);
+    }
+
+    std::string exitcode, diagnostics, result;
+    if (!write_message(fd, encode_options(server_options)) ||
+        !write_message(fd, source.str()) || !read_message(fd, exitcode) ||
+        !read_message(fd, diagnostics) || !read_message(fd, result)) {
+        cmd_error(name, "lost connection to " + path, 4);
+    }
+    close(fd);
+
+    std::cerr << diagnostics;
+    if (exitcode != "0") {
+        return std::stoi(exitcode);
+    }
+
+    if (output.length() == 0) {
+        output = "out" + output_extension(options);
+    }
+    if (output == "-") {
+        std::cout << result;
+        return 0;
+    }
+    std::ofstream outfile(output, std::ios::out | std::ios::binary);
+    outfile << result;
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
@@ -162,7 +627,19 @@ int main(int argc, char *argv[]) {
         EMIT_IR,
         EMIT_AST,
         EMIT_ASM,
+        EMIT_OBJ,
         OUTPUT,
+        MEMOIZE,
+        MEMO_BUDGET,
+        MARCH,
+        PROFILE_GENERATE,
+        PROFILE_USE,
+        STREAM,
+        OUTPUT_DIR,
+        MANIFEST,
+        JOBS,
+        SERVER,
+        CONNECT,
     };
     const struct option long_options[] = {
         {"help", no_argument, 0, HELP},
@@ -170,14 +647,26 @@ int main(int argc, char *argv[]) {
         {"emit-ast", no_argument, 0, EMIT_AST},
         {"emit-ir", no_argument, 0, EMIT_IR},
         {"emit-asm", no_argument, 0, EMIT_ASM},
+        {"emit-obj", no_argument, 0, EMIT_OBJ},
         {"output", required_argument, 0, OUTPUT},
+        {"memoize", no_argument, 0, MEMOIZE},
+        {"memo-budget", required_argument, 0, MEMO_BUDGET},
+        {"march", required_argument, 0, MARCH},
+        {"fprofile-generate", optional_argument, 0, PROFILE_GENERATE},
+        {"fprofile-use", optional_argument, 0, PROFILE_USE},
+        {"stream", no_argument, 0, STREAM},
+        {"output-dir", required_argument, 0, OUTPUT_DIR},
+        {"manifest", required_argument, 0, MANIFEST},
+        {"jobs", required_argument, 0, JOBS},
+        {"server", required_argument, 0, SERVER},
+        {"connect", required_argument, 0, CONNECT},
         {0, 0, 0, 0}};
 
     Options options;
     int opt;
 
-    while ((opt = getopt_long_only(argc, argv, "hSo:", long_options, NULL)) !=
-           -1) {
+    while ((opt = getopt_long_only(argc, argv, "hcSo:j:", long_options,
+                                   NULL)) != -1) {
         switch (opt) {
         case 'h':
         case HELP:
@@ -196,22 +685,158 @@ int main(int argc, char *argv[]) {
         case EMIT_ASM:
             options.emit_asm = true;
             break;
+        case 'c':
+        case EMIT_OBJ:
+            options.emit_obj = true;
+            break;
         case 'o':
         case OUTPUT:
             options.output = optarg;
             break;
+        case MEMOIZE:
+            options.memoize = true;
+            break;
+        case MEMO_BUDGET:
+            options.memo_budget = atoi(optarg);
+            break;
+        case MARCH:
+            if (std::string(optarg).rfind("rv64", 0) != 0) {
+                cmd_error(argv[0], "unsupported target ISA", 2);
+            }
+            options.vectorize = has_vector_extension(optarg);
+            break;
+        case PROFILE_GENERATE:
+            options.profile_generate = optarg ? optarg : DEFAULT_PROFILE;
+            break;
+        case PROFILE_USE:
+            options.profile_use = optarg ? optarg : DEFAULT_PROFILE;
+            break;
+        case STREAM:
+            options.stream = true;
+            break;
+        case OUTPUT_DIR:
+            options.output_dir = optarg;
+            break;
+        case MANIFEST:
+            options.manifest = optarg;
+            break;
+        case 'j':
+        case JOBS:
+            options.jobs = atoi(optarg);
+            if (options.jobs < 1) {
+                cmd_error(argv[0], "invalid number of jobs", 2);
+            }
+            break;
+        case SERVER:
+            options.server = optarg;
+            break;
+        case CONNECT:
+            options.connect = optarg;
+            break;
         case '?':
             cmd_error(argv[0], "unknown option", 2);
             return 1;
         }
     }
 
-    if (argv[optind] == nullptr) {
+    if (options.stream &&
+        (options.memoize || options.emit_ir || options.profile_generate != "" ||
+         options.profile_use != "")) {
+        cmd_error(argv[0],
+                  "--stream cannot be used with --memoize, --emit-ir or "
+                  "profiles",
+                  2);
+    }
+
+    if (options.server.length() != 0) {
+        if (optind != argc) {
+            cmd_error(argv[0], "--server takes no input file", 2);
+        }
+        serve(argv[0], options.server);
+    }
+
+    // inputs with the outputs given in the manifest, if any
+    std::vector<std::pair<std::string, std::string>> units;
+    for (int i = optind; i < argc; i++) {
+        units.push_back({argv[i], ""});
+    }
+    if (options.manifest.length() != 0) {
+        std::ifstream manifest(options.manifest);
+        if (!manifest) {
+            cmd_error(argv[0], "failed to open manifest: " + options.manifest,
+                      4);
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            std::istringstream fields(line);
+            std::string input, output;
+            if (fields >> input) {
+                fields >> output;
+                units.push_back({input, output});
+            }
+        }
+    }
+
+    if (units.empty()) {
         cmd_error(argv[0], "no input file", 3);
         return 1;
     }
 
-    compile(argv[0], options, argv[optind]);
+    if (options.connect.length() != 0) {
+        if (units.size() != 1 || options.manifest.length() != 0 ||
+            options.output_dir.length() != 0) {
+            cmd_error(argv[0], "--connect takes one input file", 2);
+        }
+        return connect_server(argv[0], options, options.connect,
+                              units[0].first, options.output);
+    }
+
+    if (units.size() == 1 && options.manifest.length() == 0 &&
+        options.output_dir.length() == 0) {
+        try {
+            compile_file(argv[0], options, units[0].first, options.output);
+        } catch (const CompileError &e) {
+            cmd_error(argv[0], e.what(), e.exitcode);
+        }
+        return 0;
+    }
 
-    return 0;
+    if (options.output.length() != 0) {
+        cmd_error(argv[0], "-o cannot be used with several inputs", 2);
+    }
+    if (!options.emit_ast && !options.emit_ir && !options.emit_asm &&
+        !options.emit_obj) {
+        cmd_error(argv[0], "nothing to do", 6);
+    }
+
+    std::set<std::string> outputs;
+    for (auto &[input, output] : units) {
+        if (input == "-") {
+            cmd_error(argv[0], "standard input cannot be used with several "
+                               "inputs",
+                      2);
+        }
+        if (output.length() == 0) {
+            if (options.output_dir.length() == 0) {
+                cmd_error(argv[0], "no output for " + input +
+                                       ", use --output-dir",
+                          2);
+            }
+            output = batch_output(options, input);
+        }
+        if (!outputs.insert(output).second) {
+            cmd_error(argv[0], "duplicate output: " + output, 2);
+        }
+    }
+    if (options.output_dir.length() != 0) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.output_dir, ec);
+        if (ec) {
+            cmd_error(argv[0], "failed to create directory: " +
+                                   options.output_dir,
+                      4);
+        }
+    }
+
+    return compile_batch(argv[0], options, units);
 }
@@ -1,5 +1,3 @@
-%define parse.trace
-
 /* return from param */
 %parse-param {std::shared_ptr<CompUnits> comp_units}
 
@@ -23,16 +21,21 @@
 
     template <typename P, typename T>
     P* ptr2variant(T *ptr) {
-        auto rt = new P(*ptr);
+        auto rt = new P(std::move(*ptr));
         delete ptr;
         return rt;
     }
+
+    /* copy the identifier interned by the scanner */
+    Ident to_ident(const std::string *ident) {
+        return *ident;
+    }
 }
 
 %union {
     int int_val;
     float float_val;
-    char* str_val;
+    const std::string *ident;
     ASTType type;
     CompUnit *comp_unit;
     Decl* decl;
@@ -61,7 +64,7 @@
     <var_def> ConstDef VarDef
     <init_val> ConstInitVal InitVal
     <init_vals> ConstInitVals InitVals
-    <type> BType FuncType
+    <type> BType
     <dims> Dims FuncDims
     <func_def> FuncDef
     <fparams> FuncFParams
@@ -78,7 +81,7 @@
 %define api.token.prefix {TK_}
 
 %token
-    <str_val>
+    <ident>
     IDENT
     <int_val>
     INT_CONST
@@ -105,9 +108,8 @@
 /* prevent shift/reduce conflict caused by optional "else" */
 %right ELSE ')'
 
-/* prevent reduce/reduce conflict caused by look-ahead(1) */
-%glr-parser
-%expect-rr 2
+/* the grammar is LALR(1), a conflict is an error */
+%expect 0
 
 %%
 CompUnits:
@@ -137,11 +139,11 @@ VarDefs:
     | VarDefs ',' VarDef { $$ = $1; $$->push_back(sp<VarDef>($3)); }
 
 ConstDef:
-    IDENT Dims '=' ConstInitVal { $$ = new VarDef{Ident($1), sp<Dims>($2), sp<InitVal>($4)}; }
+    IDENT Dims '=' ConstInitVal { $$ = new VarDef{to_ident($1), sp<Dims>($2), sp<InitVal>($4)}; }
 
 VarDef:
-    IDENT Dims { $$ = new VarDef{Ident($1), sp<Dims>($2), nullptr}; }
-    | IDENT Dims '=' InitVal { $$ = new VarDef{Ident($1), sp<Dims>($2), sp<InitVal>($4)}; }
+    IDENT Dims { $$ = new VarDef{to_ident($1), sp<Dims>($2), nullptr}; }
+    | IDENT Dims '=' InitVal { $$ = new VarDef{to_ident($1), sp<Dims>($2), sp<InitVal>($4)}; }
 
 ConstInitVal:
     ConstExp { $$ = ptr2variant<InitVal>($1); }
@@ -165,11 +167,6 @@ BType:
     "int" { $$ = ASTType::INT; }
     | "float" { $$ = ASTType::FLOAT; }
 
-FuncType:
-    "void" { $$ = ASTType::VOID; }
-    | "int" { $$ = ASTType::INT; }
-    | "float" { $$ = ASTType::FLOAT; }
-
 Dims:
     %empty { $$ = new Dims{}; }
     | Dims '[' ConstExp ']' { $$ = $1; $$->push_back(sp<Exp>($3)); }
@@ -178,17 +175,21 @@ FuncDims:
     '[' ']' { $$ = new Dims{nullptr}; }
     | FuncDims '[' Exp ']' { $$ = $1; $$->push_back(sp<Exp>($3)); }
 
+/* the return type is not reduced to a `FuncType` as it would need two
+   look-ahead tokens to tell `int f(` from `int x` */
 FuncDef:
-    FuncType IDENT '(' ')' Block { $$ = new FuncDef{$1, Ident($2), std::make_shared<FuncFParams>(), sp<BlockItems>($5)}; }
-    | FuncType IDENT '(' FuncFParams ')' Block { $$ = new FuncDef{$1, Ident($2), sp<FuncFParams>($4), sp<BlockItems>($6)}; }
+    BType IDENT '(' ')' Block { $$ = new FuncDef{$1, to_ident($2), std::make_shared<FuncFParams>(), sp<BlockItems>($5)}; }
+    | BType IDENT '(' FuncFParams ')' Block { $$ = new FuncDef{$1, to_ident($2), sp<FuncFParams>($4), sp<BlockItems>($6)}; }
+    | "void" IDENT '(' ')' Block { $$ = new FuncDef{ASTType::VOID, to_ident($2), std::make_shared<FuncFParams>(), sp<BlockItems>($5)}; }
+    | "void" IDENT '(' FuncFParams ')' Block { $$ = new FuncDef{ASTType::VOID, to_ident($2), sp<FuncFParams>($4), sp<BlockItems>($6)}; }
 
 FuncFParams:
     FuncFParam { $$ = new FuncFParams{sp<FuncFParam>($1)}; }
     | FuncFParams ',' FuncFParam { $$ = $1; $$->push_back(sp<FuncFParam>($3)); }
 
 FuncFParam:
-    BType IDENT { $$ = new FuncFParam{$1, Ident($2), std::make_shared<Dims>()}; }
-    | BType IDENT FuncDims { $$ = new FuncFParam{$1, Ident($2), sp<Dims>($3)}; }
+    BType IDENT { $$ = new FuncFParam{$1, to_ident($2), std::make_shared<Dims>()}; }
+    | BType IDENT FuncDims { $$ = new FuncFParam{$1, to_ident($2), sp<Dims>($3)}; }
 
 Block:
     '{' BlockItems '}' { $$ = $2; }
@@ -221,7 +222,7 @@ Cond:
     LOrExp { $$ = $1; }
 
 LVal:
-    IDENT { $$ = new LVal(Ident($1)); }
+    IDENT { $$ = new LVal(to_ident($1)); }
     | LVal '[' Exp ']' { $$ = new LVal(Index{sp<LVal>($1), sp<Exp>($3)}); }
 
 PrimaryExp:
@@ -235,8 +236,8 @@ Number:
 
 UnaryExp:
     PrimaryExp { $$ = $1; }
-    | IDENT '(' ')' { $$ = new Exp(CallExp{Ident($1), std::make_shared<FuncRParams>()}); }
-    | IDENT '(' FuncRParams ')' { $$ = new Exp(CallExp{Ident($1), sp<FuncRParams>($3)}); }
+    | IDENT '(' ')' { $$ = new Exp(CallExp{to_ident($1), std::make_shared<FuncRParams>()}); }
+    | IDENT '(' FuncRParams ')' { $$ = new Exp(CallExp{to_ident($1), sp<FuncRParams>($3)}); }
     | '+' UnaryExp { $$ = new Exp(UnaryExp{UnaryExp::ADD, sp<Exp>($2)}); }
     | '-' UnaryExp { $$ = new Exp(UnaryExp{UnaryExp::SUB, sp<Exp>($2)}); }
     | '!' UnaryExp { $$ = new Exp(UnaryExp{UnaryExp::NOT, sp<Exp>($2)}); }
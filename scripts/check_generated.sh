@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# this script checks that the checked-in scanner and parser are what
+# `scripts/pre_build.sh` generates from `scanner.l` and `parser.y`
+
+# Usage: check_generated.sh <source dir> <flex or "-"> <bison or "-">
+# A tool given as "-" is not found, and its output is not checked.
+
+SOURCE_DIR=$1
+FLEX=$2
+BISON=$3
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# the same relative paths as pre_build.sh, for the same #line directives
+mkdir -p "$work/src" "$work/include"
+cp "$SOURCE_DIR/scanner.l" "$SOURCE_DIR/parser.y" "$work"
+
+status=0
+check() {
+    if ! cmp -s "$work/$1" "$SOURCE_DIR/$1"; then
+        echo "$1 is out of date, run scripts/pre_build.sh" 1>&2
+        status=1
+    fi
+}
+
+if [ "$FLEX" != "-" ]; then
+    (cd "$work" && "$FLEX" -o src/scanner.cpp scanner.l) || exit 1
+    check src/scanner.cpp
+fi
+if [ "$BISON" != "-" ]; then
+    (cd "$work" && "$BISON" parser.y -o src/parser.cpp --header=include/parser.h) || exit 1
+    check src/parser.cpp
+    check include/parser.h
+fi
+
+exit $status
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# this script checks compiling many files in one process against compiling
+# them one by one
+
+# Usage: test_batch.sh <sysyc>
+
+SYSYC=$1
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 1
+
+status=0
+fail() {
+    echo "$1" 1>&2
+    status=1
+}
+
+printf 'int main() {\n    putint(1);\n    return 0;\n}\n' > a.sy
+printf 'int f(int x) { return x * 2; }\nint main() { return f(getint()); }\n' > b.sy
+printf 'int main() { return 1 +; }\n' > bad.sy
+: > empty.sy
+
+# a failing input is reported by name, and does not stop the others
+"$SYSYC" -S -O1 -j 2 --output-dir out a.sy bad.sy empty.sy b.sy 2> errors
+code=$?
+[ $code -eq 5 ] || fail "batch exited with $code instead of 5"
+grep -q "bad.sy: compilation failed" errors || fail "bad.sy is not reported"
+grep -q "empty.sy: compilation failed" errors || fail "empty.sy is not reported"
+[ ! -e out/bad.s ] && [ ! -e out/empty.s ] || fail "failed inputs have output"
+
+# the same output as compiling each file alone
+for name in a b; do
+    "$SYSYC" -S -O1 -o "$name.s" "$name.sy" || fail "$name.sy fails alone"
+    cmp -s "$name.s" "out/$name.s" || fail "out/$name.s differs"
+done
+
+# the standard input, written to the standard output
+"$SYSYC" -S -O1 -o - - < b.sy > stdin.s || fail "the standard input fails"
+cmp -s stdin.s b.s || fail "the standard input differs"
+
+# inputs listed in a manifest, with and without their output
+mkdir listed
+printf 'a.sy listed/first.s\nb.sy\n' > manifest
+"$SYSYC" -S -O1 -j 2 --manifest manifest --output-dir out2 ||
+    fail "the manifest fails"
+cmp -s a.s listed/first.s || fail "listed/first.s differs"
+cmp -s b.s out2/b.s || fail "out2/b.s differs"
+
+exit $status
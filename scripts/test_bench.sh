@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# this script checks the compile-time benchmark on its smallest sizes, so
+# every synthetic input keeps compiling and the report keeps its shape
+
+# Usage: test_bench.sh <sysyc_bench>
+
+BENCH=$1
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 1
+
+status=0
+fail() {
+    echo "$1" 1>&2
+    status=1
+}
+
+shapes="functions long_function nesting initializer loops"
+
+# two sizes of every shape, with and without optimization
+for level in -O0 -O1; do
+    args=2
+    [ $level = -O0 ] && args="-O0 2"
+    $BENCH $args > report 2> progress
+    code=$?
+    [ $code -eq 0 ] || fail "$level exited with $code"
+    grep -q "failed" report progress && fail "$level fails to compile"
+    for shape in $shapes; do
+        grep -q "\"name\": \"$shape\"" report ||
+            fail "$level has no $shape"
+    done
+    [ "$(grep -c '"exponents"' report)" -eq 5 ] ||
+        fail "$level has no exponents for some shape"
+    grep -q '"superlinear": \[' report || fail "$level has no superlinear"
+done
+
+# a single shape, and an unknown one
+$BENCH -O0 1 loops > report 2> /dev/null || fail "a single shape fails"
+[ "$(grep -c '"name"' report)" -eq 1 ] || fail "a single shape runs others"
+$BENCH nosuch > /dev/null 2> errors && fail "an unknown shape succeeds"
+grep -q "usage" errors || fail "an unknown shape has no usage"
+
+exit $status
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# this script checks compiling files through the compile server against
+# compiling them directly
+
+# Usage: test_server.sh <sysyc>
+
+SYSYC=$1
+
+work=$(mktemp -d)
+cd "$work" || exit 1
+
+"$SYSYC" --server "$work/server.sock" &
+server=$!
+trap 'kill $server; wait $server 2> /dev/null; rm -rf "$work"' EXIT
+for i in $(seq 50); do
+    [ -S server.sock ] && break
+    sleep 0.1
+done
+
+status=0
+fail() {
+    echo "$1" 1>&2
+    status=1
+}
+
+printf 'int a = 3;\nint main() {\n    putint(a);\n    return 0;\n}\n' > a.sy
+printf 'float f(float x) { return x * 1.5; }\nint main() { return f(2.0); }\n' > b.sy
+printf 'int main() { return 1 +; }\n' > bad.sy
+: > empty.sy
+
+# requests reusing the identifiers and constants kept from the ones before,
+# and failing ones in between, give the same output as direct compiles
+for name in a b a bad empty b a; do
+    "$SYSYC" --connect server.sock -S -o "$name.server.s" "$name.sy" 2> errors
+    code=$?
+    if [ "$name" = bad ] || [ "$name" = empty ]; then
+        [ $code -eq 5 ] || fail "$name.sy exited with $code instead of 5"
+        grep -q "syntax error" errors || fail "$name.sy is not reported"
+        continue
+    fi
+    [ $code -eq 0 ] || fail "$name.sy exited with $code"
+    "$SYSYC" -S -o "$name.s" "$name.sy"
+    cmp -s "$name.s" "$name.server.s" || fail "$name.sy differs"
+done
+
+# optimized, from the standard input to the standard output
+"$SYSYC" --connect server.sock -S -O1 -o - - < b.sy > b.server.s ||
+    fail "the standard input fails"
+grep -q "^main:" b.server.s || fail "the standard output has no main"
+
+exit $status
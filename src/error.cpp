@@ -2,7 +2,7 @@
 
 #include <iostream>
 
-static bool has_error_flag = false;
+static thread_local bool has_error_flag = false;
 
 bool has_error() { return has_error_flag; }
 
@@ -10,3 +10,5 @@ void error(int lineno, const std::string &msg) {
     has_error_flag = true;
     std::cerr << lineno << ": " << msg << std::endl;
 }
+
+void reset_error() { has_error_flag = false; }
@@ -383,6 +383,21 @@ ValuePtr Folder::fold_extsw(ValuePtr value) {
     return nullptr;
 }
 
+ValuePtr Folder::fold_sel(ValuePtr cond, ValuePtr value) {
+    auto cond_const = _convert_to_const_bits(cond);
+    if (cond_const && cond_const->get_type() == Type::W) {
+        return std::get<int>(cond_const->value) ? value : ConstBits::get(0);
+    }
+
+    auto value_const = _convert_to_const_bits(value);
+    if (value_const && value_const->get_type() == Type::W &&
+        std::get<int>(value_const->value) == 0) {
+        return value_const;
+    }
+
+    return nullptr;
+}
+
 ConstBitsPtr Folder::_convert_to_const_bits(ValuePtr value) {
     if (auto constant = std::dynamic_pointer_cast<ConstBits>(value)) {
         return constant;
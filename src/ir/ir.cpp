@@ -1,6 +1,9 @@
 #include "ir/ir.h"
+#include <algorithm>
+#include <functional>
 #include <iomanip>
 #include <limits>
+#include <map>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -15,8 +18,10 @@ std::unordered_map<InstType, std::string> inst2name = {
 #undef OP
 };
 
-std::unordered_map<float, std::shared_ptr<ConstBits>> ConstBits::floatcon_cache;
-std::unordered_map<int, std::shared_ptr<ConstBits>> ConstBits::intcon_cache;
+thread_local std::unordered_map<float, std::shared_ptr<ConstBits>>
+    ConstBits::floatcon_cache;
+thread_local std::unordered_map<int, std::shared_ptr<ConstBits>>
+    ConstBits::intcon_cache;
 
 void ConstBits::emit(std::ostream &out) const {
     std::visit(overloaded{
@@ -116,6 +121,22 @@ std::shared_ptr<Block> Block::create(std::string name, Function &func) {
     }
 }
 
+void Block::release() {
+    phis.clear();
+    insts.clear();
+    jump = {.type = Jump::NONE};
+    next = nullptr;
+    preds.clear();
+    live_def.clear();
+    live_in.clear();
+    live_out.clear();
+    temps_in_block.clear();
+    idom = nullptr;
+    doms.clear();
+    dfron.clear();
+    indoms.clear();
+}
+
 void Block::emit(std::ostream &out) const {
     out << "@" << get_name() << std::endl;
 
@@ -194,6 +215,89 @@ Function::create(bool is_export, std::string name, Type ty,
     return std::make_tuple(func, params_temps);
 }
 
+void Function::release() {
+    // blocks, phis, instructions and temps refer to each other, and temps
+    // still refer to the phis and instructions removed by passes, so every
+    // block and temp reachable from the body is cleared to break the cycles
+    std::unordered_set<BlockPtr> blocks;
+    std::unordered_set<TempPtr> temps;
+    std::vector<TempPtr> worklist;
+    auto add_block = [&](const BlockPtr &block) {
+        if (block != nullptr) {
+            blocks.insert(block);
+        }
+    };
+    auto add_temp = [&](const ValuePtr &value) {
+        auto temp = std::dynamic_pointer_cast<Temp>(value);
+        if (temp != nullptr && temps.insert(temp).second) {
+            worklist.push_back(temp);
+        }
+    };
+    auto add_phi = [&](const PhiPtr &phi, const BlockPtr &block) {
+        add_block(block);
+        add_temp(phi->to);
+        for (auto &[from, arg] : phi->args) {
+            add_block(from);
+            add_temp(arg);
+        }
+    };
+    auto add_inst = [&](const InstPtr &inst, const BlockPtr &block) {
+        add_block(block);
+        add_temp(inst->to);
+        add_temp(inst->arg[0]);
+        add_temp(inst->arg[1]);
+    };
+
+    for (auto &temp : temps_in_func) {
+        add_temp(temp);
+    }
+    for (auto block = start; block; block = block->next) {
+        for (auto &phi : block->phis) {
+            add_phi(phi, block);
+        }
+        for (auto &inst : block->insts) {
+            add_inst(inst, block);
+        }
+        add_block(block);
+        add_temp(block->jump.arg);
+    }
+    while (!worklist.empty()) {
+        auto temp = worklist.back();
+        worklist.pop_back();
+        for (auto &def : temp->defs) {
+            if (auto phi_def = std::get_if<PhiDef>(&def)) {
+                add_phi(phi_def->phi, phi_def->blk);
+            } else {
+                auto &inst_def = std::get<InstDef>(def);
+                add_inst(inst_def.ins, inst_def.blk);
+            }
+        }
+        for (auto &use : temp->uses) {
+            if (auto phi_use = std::get_if<PhiUse>(&use)) {
+                add_phi(phi_use->phi, phi_use->blk);
+            } else if (auto inst_use = std::get_if<InstUse>(&use)) {
+                add_inst(inst_use->ins, inst_use->blk);
+            } else {
+                add_block(std::get<JmpUse>(use).blk);
+            }
+        }
+    }
+
+    for (auto &temp : temps) {
+        temp->defs.clear();
+        temp->uses.clear();
+    }
+    // the chain of `next` is cut as well, as releasing a long chain at once
+    // would overflow the stack
+    for (auto &block : blocks) {
+        block->release();
+    }
+    start = end = nullptr;
+    rpo.clear();
+    temps_in_func.clear();
+    is_inline = false;
+}
+
 void Function::emit(std::ostream &out) const {
     if (is_export) {
         out << "export" << std::endl;
@@ -257,7 +361,120 @@ void Data::emit(std::ostream &out) const {
     out << "}" << std::endl;
 }
 
+void VectorNode::emit(std::ostream &out) const {
+    static const char *kind2name[] = {"", "", "add", "sub", "mul",
+                                      "div", "rem", "neg"};
+    switch (kind) {
+    case ARRAY:
+        out << "%a" << arg << "[" << stride << "]";
+        break;
+    case SCALAR:
+        out << "%a" << arg;
+        break;
+    default:
+        out << kind2name[kind] << "(";
+        left->emit(out);
+        if (right) {
+            out << ", ";
+            right->emit(out);
+        }
+        out << ")";
+        break;
+    }
+}
+
+void VectorKernel::emit(std::ostream &out) const {
+    out << "# vector kernel " << type_to_string(ty) << " $" << name << "(";
+    for (size_t i = 0; i < params.size(); i++) {
+        out << type_to_string(params[i]) << " %a" << i << ", ";
+    }
+    out << ") { ";
+    if (dst) {
+        dst->emit(out);
+        out << " = ";
+    } else {
+        out << "%a" << acc << " + sum ";
+    }
+    exp->emit(out);
+    out << " }" << (check_overlap ? " checking overlap" : "") << std::endl;
+}
+
+std::vector<int> VectorKernel::get_reused_arrays() const {
+    std::map<int, int> reads;
+    std::function<void(const VectorNode &)> collect =
+        [&](const VectorNode &node) {
+            if (node.kind == VectorNode::ARRAY) {
+                reads[node.arg]++;
+            }
+            if (node.left) {
+                collect(*node.left);
+            }
+            if (node.right) {
+                collect(*node.right);
+            }
+        };
+    collect(*exp);
+
+    std::vector<int> reused;
+    for (auto [arg, count] : reads) {
+        if (count > 1) {
+            reused.push_back(arg);
+        }
+    }
+    return reused;
+}
+
+int VectorKernel::count_vector_regs() const {
+    auto reused = get_reused_arrays();
+    auto is_reused = [&reused](const VectorNode &node) {
+        return node.kind == VectorNode::ARRAY &&
+               std::find(reused.begin(), reused.end(), node.arg) !=
+                   reused.end();
+    };
+
+    // returns the peak count of registers and whether the result is in a
+    // register of its own, in the order of evaluation of the target, where an
+    // operation writes to the register of an operand of its own if any
+    std::function<std::tuple<int, bool>(const VectorNode &)> count =
+        [&](const VectorNode &node) -> std::tuple<int, bool> {
+        if (node.kind == VectorNode::SCALAR || is_reused(node)) {
+            return {0, false};
+        } else if (node.kind == VectorNode::ARRAY) {
+            return {1, true};
+        } else if (node.kind == VectorNode::NEG) {
+            auto [peak, is_owned] = count(*node.left);
+            return {std::max(peak, 1), true};
+        }
+
+        auto [left_peak, is_left_owned] = count(*node.left);
+        auto [right_peak, is_right_owned] = count(*node.right);
+        int peak = std::max(left_peak, is_left_owned + right_peak);
+        bool is_commutative =
+            node.kind == VectorNode::ADD || node.kind == VectorNode::MUL;
+        bool is_reversible = node.kind == VectorNode::SUB ||
+                             (ty == Type::S && node.kind == VectorNode::DIV);
+        if (node.left->kind == VectorNode::SCALAR && !is_commutative &&
+            !is_reversible) {
+            // the scalar is broadcast while the right operand is held
+            peak = std::max(peak, is_right_owned + 1);
+        } else if (!is_left_owned && !is_right_owned) {
+            peak = std::max(peak, 1);
+        }
+        return {peak, true};
+    };
+
+    auto [peak, is_owned] = count(*exp);
+    if (dst && exp->kind == VectorNode::SCALAR) {
+        peak = 1; // broadcast to be stored
+    }
+    return reused.size() + peak;
+}
+
 void Module::emit(std::ostream &out) const {
+    for (auto &kernel : vector_kernels) {
+        kernel->emit(out);
+    }
+
     for (auto &data : datas) {
         data->emit(out);
     }
@@ -267,7 +484,7 @@ void Module::emit(std::ostream &out) const {
     }
 }
 
-std::unordered_map<std::string, std::shared_ptr<Address>>
+thread_local std::unordered_map<std::string, std::shared_ptr<Address>>
     Address::addrcon_cache;
 
 std::shared_ptr<Address> Address::get(std::string name) {
@@ -278,4 +495,14 @@ std::shared_ptr<Address> Address::get(std::string name) {
     }
 }
 
+void Address::clear_cache(size_t limit) {
+    if (addrcon_cache.size() > limit) {
+        addrcon_cache.clear();
+        return;
+    }
+    for (auto &[name, addr] : addrcon_cache) {
+        addr->ref_func = nullptr;
+    }
+}
+
 } // namespace ir
@@ -0,0 +1,225 @@
+#include "opt/pass/addr.h"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+namespace opt {
+
+bool AddressFoldingPass::run_on_function(ir::Function &func) {
+    bool changed = false;
+    for (auto block = func.start; block; block = block->next) {
+        changed |= _reassociate(func, *block);
+        for (auto inst : block->insts) {
+            int index = _get_address_index(*inst);
+            while (index >= 0 && _fold(*block, inst, index)) {
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+int AddressFoldingPass::_get_address_index(const ir::Inst &inst) {
+    switch (inst.insttype) {
+    case ir::InstType::ILOADW:
+    case ir::InstType::ILOADL:
+    case ir::InstType::ILOADS:
+        return 0;
+    case ir::InstType::ISTOREW:
+    case ir::InstType::ISTOREL:
+    case ir::InstType::ISTORES:
+        return 1;
+    default:
+        return -1;
+    }
+}
+
+// split an `add` or `mul` into its non-constant and constant operands
+static bool split_const(ir::InstPtr inst, ir::InstType insttype,
+                        ir::ValuePtr &value, int &constant) {
+    if (inst == nullptr || inst->insttype != insttype) {
+        return false;
+    }
+    for (int i = 0; i < 2; i++) {
+        auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(inst->arg[i]);
+        if (constbits && std::holds_alternative<int>(constbits->value)) {
+            value = inst->arg[1 - i];
+            constant = std::get<int>(constbits->value);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AddressFoldingPass::_reassociate(ir::Function &func, ir::Block &block) {
+    // the defining inst and its position in block of each temp defined once
+    std::unordered_map<ir::ValuePtr, std::pair<ir::InstPtr, int>> defs;
+    std::unordered_map<ir::ValuePtr, int> last_defs;
+    auto get_def = [&defs](ir::ValuePtr value) -> ir::InstPtr {
+        auto temp = std::dynamic_pointer_cast<ir::Temp>(value);
+        if (temp == nullptr || temp->defs.size() != 1 ||
+            defs.find(temp) == defs.end()) {
+            return nullptr;
+        }
+        return defs[temp].first;
+    };
+    // whether the value is unchanged since the position
+    auto is_unchanged = [&last_defs](ir::ValuePtr value, int pos) {
+        auto it = last_defs.find(value);
+        return it == last_defs.end() || it->second < pos;
+    };
+
+    // base + extsw(index) * scale, by {base, index, scale}
+    std::map<std::tuple<ir::ValuePtr, ir::ValuePtr, int>, ir::TempPtr> bases;
+    // extsw(index) * scale, by {index, scale}
+    std::map<std::pair<ir::ValuePtr, int>, ir::ValuePtr> offsets;
+
+    bool changed = false;
+    std::vector<ir::InstPtr> insts;
+    for (auto inst : block.insts) {
+        int index = _get_address_index(*inst);
+
+        // match `base + extsw(index + c) * scale`, where base and index are
+        // unchanged since used
+        ir::ValuePtr base, index_value, ext;
+        int scale = 0, c = 0;
+        auto add = index >= 0 ? get_def(inst->arg[index]) : nullptr;
+        if (add && add->insttype == ir::InstType::IADD &&
+            is_unchanged(add->arg[0], defs[add->to].second) &&
+            split_const(get_def(add->arg[1]), ir::InstType::IMUL, ext,
+                        scale)) {
+            auto extsw = get_def(ext);
+            if (extsw && extsw->insttype == ir::InstType::IEXTSW &&
+                is_unchanged(extsw->arg[0], defs[ext].second)) {
+                base = add->arg[0];
+                index_value = extsw->arg[0];
+
+                ir::ValuePtr inner;
+                int inner_c;
+                for (auto index_add = get_def(index_value);
+                     split_const(index_add, ir::InstType::IADD, inner,
+                                 inner_c) &&
+                     is_unchanged(inner, defs[index_value].second) &&
+                     std::abs(c + (long long)inner_c) <= _max_offset;
+                     index_add = get_def(index_value)) {
+                    index_value = inner;
+                    c += inner_c;
+                }
+            }
+        }
+
+        long long disp = (long long)c * scale + inst->offset;
+        if (index_value && std::dynamic_pointer_cast<ir::Temp>(index_value) &&
+            disp >= _min_offset && disp <= _max_offset) {
+            auto key = std::make_tuple(base, index_value, scale);
+            auto it = bases.find(key);
+            if (it != bases.end()) {
+                inst->arg[index] = it->second;
+                inst->offset = disp;
+                changed = true;
+            } else if (c == 0) {
+                bases[key] = std::static_pointer_cast<ir::Temp>(
+                    inst->arg[index]);
+                offsets[{index_value, scale}] = add->arg[1];
+            } else {
+                auto create_inst = [&func, &insts](ir::InstType insttype,
+                                                   ir::ValuePtr arg0,
+                                                   ir::ValuePtr arg1) {
+                    auto inst =
+                        ir::Inst::create(insttype, ir::Type::L, arg0, arg1);
+                    inst->to->id = func.temp_counter++;
+                    insts.push_back(inst);
+                    return inst->to;
+                };
+                auto &new_offset = offsets[{index_value, scale}];
+                if (new_offset == nullptr) {
+                    auto new_ext = create_inst(ir::InstType::IEXTSW,
+                                               index_value, nullptr);
+                    new_offset = create_inst(ir::InstType::IMUL, new_ext,
+                                             ir::ConstBits::get(scale));
+                }
+                auto new_addr =
+                    create_inst(ir::InstType::IADD, base, new_offset);
+                bases[key] = new_addr;
+                inst->arg[index] = new_addr;
+                inst->offset = disp;
+                changed = true;
+            }
+        }
+
+        insts.push_back(inst);
+        if (inst->to) {
+            defs[inst->to] = {inst, insts.size() - 1};
+            last_defs[inst->to] = insts.size() - 1;
+            // addresses computed from the old value are stale
+            for (auto it = bases.begin(); it != bases.end();) {
+                auto &[key_base, key_index, key_scale] = it->first;
+                if (key_base == inst->to || key_index == inst->to) {
+                    it = bases.erase(it);
+                } else {
+                    it++;
+                }
+            }
+            for (auto it = offsets.begin(); it != offsets.end();) {
+                if (it->first.first == inst->to) {
+                    it = offsets.erase(it);
+                } else {
+                    it++;
+                }
+            }
+        }
+    }
+    block.insts = std::move(insts);
+    return changed;
+}
+
+bool AddressFoldingPass::_fold(ir::Block &block, ir::InstPtr inst,
+                               int index) {
+    auto addr = std::dynamic_pointer_cast<ir::Temp>(inst->arg[index]);
+    if (addr == nullptr || addr->defs.size() != 1) {
+        return false;
+    }
+    auto def = std::get_if<ir::InstDef>(&addr->defs[0]);
+    if (def == nullptr || addr->get_type() != ir::Type::L) {
+        return false;
+    }
+
+    ir::ValuePtr base;
+    int constant;
+    if (!split_const(def->ins, ir::InstType::IADD, base, constant)) {
+        return false;
+    }
+    long long offset = (long long)inst->offset + constant;
+    if (offset < _min_offset || offset > _max_offset) {
+        return false;
+    }
+
+    // the base is either constant or defined before the add dominating the
+    // access, so it only changes if it has other defs
+    if (auto base_temp = std::dynamic_pointer_cast<ir::Temp>(base)) {
+        if (base_temp->defs.size() != 1) {
+            if (def->blk.get() != &block) {
+                return false;
+            }
+            auto add_it =
+                std::find(block.insts.begin(), block.insts.end(), def->ins);
+            auto inst_it = std::find(add_it, block.insts.end(), inst);
+            if (inst_it == block.insts.end() ||
+                std::any_of(add_it, inst_it, [&base_temp](ir::InstPtr inst) {
+                    return inst->to == base_temp;
+                })) {
+                return false;
+            }
+        }
+    } else if (std::dynamic_pointer_cast<ir::Address>(base) == nullptr ||
+               def->blk.get() != &block) {
+        // a global address hoisted out of the block is already in register
+        return false;
+    }
+
+    inst->arg[index] = base;
+    inst->offset = offset;
+    return true;
+}
+
+} // namespace opt
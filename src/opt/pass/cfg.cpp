@@ -29,6 +29,12 @@ bool FillPredsPass::run_on_function(ir::Function &func) {
 }
 
 bool FillUsesPass::run_on_function(ir::Function &func) {
+    // temps removed since the last run still refer to their removed
+    // instructions and blocks
+    for (auto &temp : func.temps_in_func) {
+        temp->defs.clear();
+        temp->uses.clear();
+    }
     func.temps_in_func.clear();
 
     for (auto block = func.start; block; block = block->next) {
@@ -21,6 +21,56 @@ bool FillLeafPass::_is_leaf_function(ir::Function &func) {
     return true;
 }
 
+bool FillPurePass::run_on_module(ir::Module &module) {
+    // assume all functions are pure, then remove impure ones until fixpoint
+    for (auto &func : module.functions) {
+        func->is_pure = true;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto &func : module.functions) {
+            if (func->is_pure && !_is_pure_function(*func)) {
+                func->is_pure = false;
+                changed = true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool FillPurePass::_is_pure_function(const ir::Function &func) {
+    for (auto block = func.start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            switch (inst->insttype) {
+            case ir::InstType::ISTORES:
+            case ir::InstType::ISTOREL:
+            case ir::InstType::ISTOREW:
+            case ir::InstType::ILOADS:
+            case ir::InstType::ILOADL:
+            case ir::InstType::ILOADW:
+            case ir::InstType::IALLOC4:
+            case ir::InstType::IALLOC8:
+                return false;
+            case ir::InstType::ICALL: {
+                // builtin functions do io, so they are never pure
+                auto addr =
+                    std::static_pointer_cast<ir::Address>(inst->arg[0]);
+                if (addr->ref_func == nullptr || !addr->ref_func->is_pure) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+    return true;
+}
+
 } // namespace opt
 
 bool opt::FillInlinePass::run_on_function(ir::Function &func) {
@@ -61,11 +111,14 @@ bool opt::FunctionInliningPass::run_on_function(ir::Function &func) {
                 ret = inst->to;
                 auto addr =
                     std::dynamic_pointer_cast<ir::Address>(inst->arg[0]);
-                if (addr->ref_func != nullptr && addr->ref_func->is_inline) {
+                // calls never executed in profile are not worth the code size
+                if (addr->ref_func != nullptr && addr->ref_func->is_inline &&
+                    block->freq != 0) {
                     // do inline
                     uint *block_counter_ptr = func.block_counter_ptr;
                     auto new_block = std::shared_ptr<ir::Block>(
                         new ir::Block{(*block_counter_ptr)++, "inline_join"});
+                    new_block->freq = block->freq;
                     // insert new block
                     new_block->next = block->next;
                     block->next = new_block;
@@ -111,6 +164,12 @@ void opt::FunctionInliningPass::_do_inline(
         auto new_name = block->get_name();
         auto new_block = std::shared_ptr<ir::Block>(
             new ir::Block{(*block_counter_ptr)++, new_name});
+        // scale the profile of callee to this call site
+        if (block->freq >= 0 && prev->freq >= 0 &&
+            inline_func.start->freq > 0) {
+            new_block->freq = (double)block->freq * prev->freq /
+                              inline_func.start->freq;
+        }
         // insert block
         new_block->next = p->next;
         p->next = new_block;
@@ -225,6 +284,23 @@ void opt::FunctionInliningPass::_do_inline(
 }
 
 bool opt::TailRecursionElimination::run_on_function(ir::Function &func) {
+    // find out recursive calls to eliminate before changing anything
+    std::vector<ir::BlockPtr> tail_blocks, acc_blocks;
+    ir::InstType acc_op;
+    for (auto block = func.start; block; block = block->next) {
+        ir::InstType op;
+        if (_is_tail_recursive(func, *block)) {
+            tail_blocks.push_back(block);
+        } else if (_is_accumulative(func, *block, op) &&
+                   (acc_blocks.empty() || op == acc_op)) {
+            acc_blocks.push_back(block);
+            acc_op = op;
+        }
+    }
+    if (tail_blocks.empty() && acc_blocks.empty()) {
+        return false;
+    }
+
     _create_jump_target_block(func);
     auto target = func.start->next;
 
@@ -235,37 +311,128 @@ bool opt::TailRecursionElimination::run_on_function(ir::Function &func) {
         }
     }
 
-    for (auto block = func.start; block; block = block->next) {
-        if (_is_tail_recursive(func, *block)) {
-            // replace args
-            // before: arg %arg
-            // after: %par =t copy %arg
-            for (int i = 0; i < args.size(); i++) {
-                auto dst_idx = args.size() - i - 1;
-                auto src_idx = block->insts.size() - i - 2;
-                auto inst = block->insts[src_idx];
-                auto arg = args[dst_idx];
-                *inst = {
-                    .insttype = ir::InstType::ICOPY,
-                    .to = arg,
-                    .arg = {inst->arg[0]},
-                };
-            }
+    for (auto block : tail_blocks) {
+        // don't forget to remove the last call
+        block->insts.pop_back();
+        _replace_args(func, *block, args);
 
-            // don't forget to remove the last call
-            block->insts.pop_back();
+        // replace jump
+        block->jump = {
+            .type = ir::Jump::JMP,
+            .blk = {target, nullptr},
+        };
+    }
 
-            // replace jump
-            block->jump = {
-                .type = ir::Jump::JMP,
-                .blk = {target, nullptr},
-            };
+    if (acc_blocks.empty()) {
+        return false;
+    }
+
+    // before: return f(...) op x
+    // after: %acc = op %acc, x; jmp @tail_recursion_target
+    // and every other return becomes: ret %acc op value
+    auto identity = ir::ConstBits::get(acc_op == ir::InstType::IMUL ? 1 : 0);
+    auto acc =
+        std::make_shared<ir::Temp>("acc", func.ty, std::vector<ir::Def>{});
+    acc->id = func.temp_counter++;
+    func.start->insts.push_back(std::shared_ptr<ir::Inst>(new ir::Inst{
+        .insttype = ir::InstType::ICOPY,
+        .to = acc,
+        .arg = {identity},
+    }));
+
+    for (auto block = func.start; block; block = block->next) {
+        if (block->jump.type != ir::Jump::RET ||
+            std::find(acc_blocks.begin(), acc_blocks.end(), block) !=
+                acc_blocks.end()) {
+            continue;
+        }
+        if (block->jump.arg == identity) {
+            block->jump.arg = acc;
+            continue;
         }
+        auto inst = ir::Inst::create(acc_op, func.ty, acc, block->jump.arg);
+        inst->to->id = func.temp_counter++;
+        block->insts.push_back(inst);
+        block->jump.arg = inst->to;
+    }
+
+    for (auto block : acc_blocks) {
+        auto acc_inst = block->insts.back();
+        block->insts.pop_back();
+        auto call_it = std::find_if(block->insts.rbegin(),
+                                    block->insts.rend(),
+                                    [&](const ir::InstPtr &inst) {
+                                        return _is_self_call(func, *inst);
+                                    })
+                           .base() -
+                       1;
+        auto result = (*call_it)->to;
+
+        // insts between call and accumulation do not depend on the call,
+        // move them before args
+        std::vector<ir::InstPtr> moved(call_it + 1, block->insts.end());
+        block->insts.erase(call_it, block->insts.end());
+        block->insts.insert(block->insts.end() - args.size(), moved.begin(),
+                            moved.end());
+
+        acc_inst->to = acc;
+        acc_inst->arg[acc_inst->arg[0] == result ? 0 : 1] = acc;
+        block->insts.insert(block->insts.end() - args.size(), acc_inst);
+
+        _replace_args(func, *block, args);
+        block->jump = {
+            .type = ir::Jump::JMP,
+            .blk = {target, nullptr},
+        };
     }
 
     return false;
 }
 
+void opt::TailRecursionElimination::_replace_args(
+    ir::Function &func, ir::Block &block, const std::vector<ir::TempPtr> &pars) {
+    // before: arg %arg
+    // after: %par =t copy %arg
+    // the copies are parallel, so a par read by a later arg after it is
+    // overwritten must be saved first
+    auto first_arg = block.insts.end() - pars.size();
+    std::vector<ir::ValuePtr> values;
+    for (auto it = first_arg; it != block.insts.end(); it++) {
+        values.push_back((*it)->arg[0]);
+    }
+    block.insts.erase(first_arg, block.insts.end());
+
+    for (size_t i = 0; i < pars.size(); i++) {
+        bool overwritten = false;
+        for (size_t j = 0; j < i; j++) {
+            overwritten |= values[j] != pars[j] && values[i] == pars[j];
+        }
+        if (!overwritten) {
+            continue;
+        }
+        auto save = std::make_shared<ir::Temp>("", pars[i]->get_type(),
+                                               std::vector<ir::Def>{});
+        save->id = func.temp_counter++;
+        block.insts.push_back(std::shared_ptr<ir::Inst>(new ir::Inst{
+            .insttype = ir::InstType::ICOPY,
+            .to = save,
+            .arg = {values[i]},
+        }));
+        values[i] = save;
+    }
+
+    for (size_t i = 0; i < pars.size(); i++) {
+        if (values[i] == pars[i]) {
+            continue;
+        }
+        block.insts.push_back(std::shared_ptr<ir::Inst>(new ir::Inst{
+            .insttype = ir::InstType::ICOPY,
+            .to = pars[i],
+            .arg = {values[i]},
+        }));
+    }
+}
+
 void opt::TailRecursionElimination::_create_jump_target_block(
     ir::Function &func) {
     // create a new block after start
@@ -311,5 +478,92 @@ bool opt::TailRecursionElimination::_is_tail_recursive(const ir::Function &func,
 
     auto inst = block.insts.back();
     auto addr = std::static_pointer_cast<ir::Address>(inst->arg[0]);
-    return addr->name == func_name && func.start->next;
+    return addr->name == func_name && func.start->next &&
+           (block.jump.arg == nullptr || block.jump.arg == inst->to);
+}
+
+bool opt::TailRecursionElimination::_is_self_call(const ir::Function &func,
+                                                 const ir::Inst &inst) {
+    return inst.insttype == ir::InstType::ICALL &&
+           std::static_pointer_cast<ir::Address>(inst.arg[0])->ref_func ==
+               &func;
+}
+
+bool opt::TailRecursionElimination::_is_accumulative(const ir::Function &func,
+                                                     const ir::Block &block,
+                                                     ir::InstType &op) {
+    // integer add and mul are associative and commutative even on overflow
+    if (func.ty != ir::Type::W || block.jump.type != ir::Jump::RET ||
+        block.insts.empty() || block.insts.back()->to != block.jump.arg) {
+        return false;
+    }
+    auto acc_inst = block.insts.back();
+    op = acc_inst->insttype;
+    if (op != ir::InstType::IADD && op != ir::InstType::IMUL) {
+        return false;
+    }
+
+    // find the last recursive call, calls to other functions after it are
+    // checked below
+    auto call_it = std::find_if(block.insts.rbegin(), block.insts.rend(),
+                                [&](const ir::InstPtr &inst) {
+                                    return _is_self_call(func, *inst);
+                                });
+    if (call_it == block.insts.rend()) {
+        return false;
+    }
+    auto call = *call_it;
+    if (call->to == nullptr ||
+        (acc_inst->arg[0] == call->to) == (acc_inst->arg[1] == call->to)) {
+        return false;
+    }
+
+    // args of the call must be right before it
+    int arg_count = 0;
+    for (auto inst : func.start->insts) {
+        arg_count += inst->insttype == ir::InstType::IPAR;
+    }
+    auto first_arg = call_it.base() - 1 - block.insts.begin() - arg_count;
+    if (first_arg < 0) {
+        return false;
+    }
+    std::unordered_set<ir::ValuePtr> arg_values;
+    for (int i = first_arg; i < first_arg + arg_count; i++) {
+        if (block.insts[i]->insttype != ir::InstType::IARG) {
+            return false;
+        }
+        arg_values.insert(block.insts[i]->arg[0]);
+    }
+
+    // insts between the call and the accumulation will be moved before args,
+    // they must not depend on the call or have side effects
+    for (auto it = call_it.base(); it != block.insts.end() - 1; it++) {
+        auto inst = *it;
+        switch (inst->insttype) {
+        case ir::InstType::ISTORES:
+        case ir::InstType::ISTOREL:
+        case ir::InstType::ISTOREW:
+        case ir::InstType::ILOADS:
+        case ir::InstType::ILOADL:
+        case ir::InstType::ILOADW:
+        case ir::InstType::IALLOC4:
+        case ir::InstType::IALLOC8:
+            return false;
+        case ir::InstType::ICALL: {
+            auto addr = std::static_pointer_cast<ir::Address>(inst->arg[0]);
+            if (addr->ref_func == nullptr || !addr->ref_func->is_pure) {
+                return false;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        if (inst->arg[0] == call->to || inst->arg[1] == call->to ||
+            (inst->to && (inst->to == call->to || arg_values.count(inst->to)))) {
+            return false;
+        }
+    }
+
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,344 @@
+#include "opt/pass/global.h"
+#include "opt/pass/loop.h"
+#include <algorithm>
+
+namespace opt {
+
+bool GlobalPromotionPass::run_on_module(ir::Module &module) {
+    _scalars.clear();
+    _direct.clear();
+    _accessed.clear();
+    _modified.clear();
+
+    _find_scalar_globals(module);
+    if (_scalars.empty()) {
+        return false;
+    }
+    _fill_accessed_globals(module);
+
+    // main is the entry only when no one calls it
+    ir::Function *entry = nullptr;
+    for (auto &func : module.functions) {
+        if (func->name == "main") {
+            entry = func.get();
+        }
+    }
+    for (auto &func : module.functions) {
+        for (auto block = func->start; block; block = block->next) {
+            for (auto inst : block->insts) {
+                if (inst->insttype == ir::InstType::ICALL &&
+                    std::static_pointer_cast<ir::Address>(inst->arg[0])
+                            ->ref_func == entry) {
+                    entry = nullptr;
+                }
+            }
+        }
+    }
+
+    AddressSet promoted_in_entry;
+    for (auto &func : module.functions) {
+        auto loop_depth = get_loop_depth(*func, find_natural_loops(*func));
+        for (auto global : _direct[func.get()]) {
+            bool is_entry = func.get() == entry;
+            if (_is_profitable(*func, global, is_entry, loop_depth)) {
+                _promote(*func, global, is_entry);
+                if (is_entry) {
+                    promoted_in_entry.insert(global);
+                }
+            }
+        }
+    }
+
+    // globals only used in entry are no longer needed
+    module.datas.erase(
+        std::remove_if(module.datas.begin(), module.datas.end(),
+                       [&](const ir::DataPtr &data) {
+                           auto addr = data->get_address();
+                           if (promoted_in_entry.count(addr) == 0) {
+                               return false;
+                           }
+                           for (auto &func : module.functions) {
+                               if (func.get() != entry &&
+                                   _accessed[func.get()].count(addr)) {
+                                   return false;
+                               }
+                           }
+                           return true;
+                       }),
+        module.datas.end());
+
+    return false;
+}
+
+void GlobalPromotionPass::_find_scalar_globals(ir::Module &module) {
+    for (auto &data : module.datas) {
+        if (data->items.size() != 1) {
+            continue;
+        }
+        auto item = data->items[0].get();
+        if (auto const_data = dynamic_cast<ir::ConstData *>(item);
+            const_data && const_data->values.size() == 1 &&
+            (const_data->ty == ir::Type::W || const_data->ty == ir::Type::S)) {
+            _scalars[data->get_address()] = {const_data->ty,
+                                             const_data->values[0]};
+        } else if (auto zero_data = dynamic_cast<ir::ZeroData *>(item);
+                   zero_data && zero_data->bytes == 4) {
+            // type is unknown until it is accessed
+            _scalars[data->get_address()] = {ir::Type::X, nullptr};
+        }
+    }
+
+    // a scalar global must only be accessed by load and store of its type
+    std::unordered_set<ir::AddressPtr> escaped;
+    for (auto &func : module.functions) {
+        auto &direct = _direct[func.get()];
+        for (auto block = func->start; block; block = block->next) {
+            for (auto inst : block->insts) {
+                for (int i = 0; i < 2; i++) {
+                    auto addr =
+                        std::dynamic_pointer_cast<ir::Address>(inst->arg[i]);
+                    if (addr == nullptr || _scalars.count(addr) == 0) {
+                        continue;
+                    }
+
+                    ir::Type ty = ir::Type::X;
+                    switch (inst->insttype) {
+                    case ir::InstType::ILOADW:
+                        ty = i == 0 ? ir::Type::W : ir::Type::X;
+                        break;
+                    case ir::InstType::ILOADS:
+                        ty = i == 0 ? ir::Type::S : ir::Type::X;
+                        break;
+                    case ir::InstType::ISTOREW:
+                        ty = i == 1 ? ir::Type::W : ir::Type::X;
+                        break;
+                    case ir::InstType::ISTORES:
+                        ty = i == 1 ? ir::Type::S : ir::Type::X;
+                        break;
+                    default:
+                        break;
+                    }
+
+                    auto &[global_ty, init] = _scalars.at(addr);
+                    if (global_ty == ir::Type::X) {
+                        global_ty = ty;
+                    }
+                    if (ty == ir::Type::X || ty != global_ty) {
+                        escaped.insert(addr);
+                    }
+                    direct.insert(addr);
+                    if (ty != ir::Type::X && i == 1) {
+                        _modified[func.get()].insert(addr);
+                    }
+                }
+            }
+            if (auto addr =
+                    std::dynamic_pointer_cast<ir::Address>(block->jump.arg);
+                addr) {
+                escaped.insert(addr);
+            }
+        }
+    }
+
+    for (auto it = _scalars.begin(); it != _scalars.end();) {
+        auto &[addr, value] = *it;
+        if (escaped.count(addr) || value.first == ir::Type::X) {
+            it = _scalars.erase(it);
+            continue;
+        }
+        if (value.second == nullptr) {
+            value.second = value.first == ir::Type::W
+                               ? ir::ConstBits::get(0)
+                               : ir::ConstBits::get(0.0f);
+        }
+        it++;
+    }
+
+    for (auto globals_map : {&_direct, &_modified}) {
+        for (auto &[func, globals] : *globals_map) {
+            for (auto it = globals.begin(); it != globals.end();) {
+                if (_scalars.count(*it)) {
+                    it++;
+                } else {
+                    it = globals.erase(it);
+                }
+            }
+        }
+    }
+}
+
+void GlobalPromotionPass::_fill_accessed_globals(ir::Module &module) {
+    for (auto &func : module.functions) {
+        _accessed[func.get()] = _direct[func.get()];
+        _modified[func.get()];
+    }
+
+    // builtin functions never access globals of the program
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto &func : module.functions) {
+            auto &accessed = _accessed[func.get()];
+            for (auto block = func->start; block; block = block->next) {
+                for (auto inst : block->insts) {
+                    if (inst->insttype != ir::InstType::ICALL) {
+                        continue;
+                    }
+                    auto callee =
+                        std::static_pointer_cast<ir::Address>(inst->arg[0])
+                            ->ref_func;
+                    if (callee == nullptr || callee == func.get()) {
+                        continue;
+                    }
+                    for (auto global : _accessed[callee]) {
+                        changed |= accessed.insert(global).second;
+                    }
+                    for (auto global : _modified[callee]) {
+                        changed |= _modified[func.get()].insert(global).second;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool GlobalPromotionPass::_is_profitable(const ir::Function &func,
+                                         ir::AddressPtr global, bool is_entry,
+                                         const LoopDepth &loop_depth) {
+    // estimate memory accesses by loop depth
+    auto weight = [&loop_depth](ir::BlockPtr block) {
+        return get_loop_weight(loop_depth.at(block));
+    };
+
+    int before = 0, after = is_entry ? 0 : 1;
+    for (auto block = func.start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            if (inst->arg[0] == global || inst->arg[1] == global) {
+                before += weight(block);
+            } else if (_is_syncing_call(inst, global)) {
+                after += (1 + _is_modifying_call(inst, global)) * weight(block);
+            }
+        }
+        if (block->jump.type == ir::Jump::RET && !is_entry) {
+            after += weight(block);
+        }
+    }
+    return after < before;
+}
+
+bool GlobalPromotionPass::_is_syncing_call(ir::InstPtr inst,
+                                           ir::AddressPtr global) {
+    if (inst->insttype != ir::InstType::ICALL) {
+        return false;
+    }
+    auto callee =
+        std::static_pointer_cast<ir::Address>(inst->arg[0])->ref_func;
+    return callee != nullptr && _accessed[callee].count(global);
+}
+
+bool GlobalPromotionPass::_is_modifying_call(ir::InstPtr inst,
+                                             ir::AddressPtr global) {
+    auto callee =
+        std::static_pointer_cast<ir::Address>(inst->arg[0])->ref_func;
+    return callee != nullptr && _modified[callee].count(global);
+}
+
+void GlobalPromotionPass::_promote(ir::Function &func, ir::AddressPtr global,
+                                  bool is_entry) {
+    auto [ty, init] = _scalars.at(global);
+    auto load_type = ty == ir::Type::W ? ir::InstType::ILOADW
+                                       : ir::InstType::ILOADS;
+    auto store_type = ty == ir::Type::W ? ir::InstType::ISTOREW
+                                        : ir::InstType::ISTORES;
+
+    auto alloc =
+        ir::Inst::create(ir::InstType::IALLOC4, ir::Type::L,
+                         ir::ConstBits::get(4), nullptr);
+    alloc->to->id = func.temp_counter++;
+    auto local = alloc->to;
+
+    // before: load/store $global
+    // after: load/store %local
+    for (auto block = func.start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            for (int i = 0; i < 2; i++) {
+                if (inst->arg[i] == global) {
+                    inst->arg[i] = local;
+                }
+            }
+        }
+    }
+
+    // %value =t load from, store %value, to
+    auto create_copy = [&](ir::ValuePtr from, ir::ValuePtr to) {
+        auto load = ir::Inst::create(load_type, ty, from, nullptr);
+        load->to->id = func.temp_counter++;
+        auto store = ir::Inst::create(store_type, ir::Type::X, load->to, to);
+        return std::vector<ir::InstPtr>{load, store};
+    };
+
+    for (auto block = func.start; block; block = block->next) {
+        // a call followed by return needs no reload and write back, so that
+        // tail calls are kept
+        auto tail_call = block->insts.end();
+        if (block->jump.type == ir::Jump::RET) {
+            for (auto it = block->insts.begin(); it != block->insts.end();
+                 it++) {
+                if ((*it)->arg[0] == local || (*it)->arg[1] == local) {
+                    tail_call = block->insts.end();
+                } else if (_is_syncing_call(*it, global)) {
+                    tail_call = it;
+                }
+            }
+        }
+
+        std::vector<ir::InstPtr> insts;
+        for (auto it = block->insts.begin(); it != block->insts.end(); it++) {
+            auto inst = *it;
+            if (!_is_syncing_call(inst, global)) {
+                insts.push_back(inst);
+                continue;
+            }
+
+            // write back before args of the call, and reload after the call
+            // if it may modify the global
+            auto first_arg = insts.end();
+            while (first_arg != insts.begin() &&
+                   (*(first_arg - 1))->insttype == ir::InstType::IARG) {
+                first_arg--;
+            }
+            auto write_back = create_copy(local, global);
+            insts.insert(first_arg, write_back.begin(), write_back.end());
+            insts.push_back(inst);
+            if (it != tail_call && _is_modifying_call(inst, global)) {
+                auto reload = create_copy(global, local);
+                insts.insert(insts.end(), reload.begin(), reload.end());
+            }
+        }
+
+        if (block->jump.type == ir::Jump::RET && !is_entry &&
+            tail_call == block->insts.end()) {
+            auto write_back = create_copy(local, global);
+            insts.insert(insts.end(), write_back.begin(), write_back.end());
+        }
+        block->insts = std::move(insts);
+    }
+
+    // initialize after pars
+    std::vector<ir::InstPtr> init_insts = {alloc};
+    if (is_entry) {
+        init_insts.push_back(
+            ir::Inst::create(store_type, ir::Type::X, init, local));
+    } else {
+        auto load = create_copy(global, local);
+        init_insts.insert(init_insts.end(), load.begin(), load.end());
+    }
+    auto &start_insts = func.start->insts;
+    auto pos = std::find_if(start_insts.begin(), start_insts.end(),
+                            [](const ir::InstPtr &inst) {
+                                return inst->insttype != ir::InstType::IPAR;
+                            });
+    start_insts.insert(pos, init_insts.begin(), init_insts.end());
+}
+
+} // namespace opt
@@ -268,6 +268,8 @@ ir::ValuePtr opt::GVNPass::_fold_if_can(const ir::Inst &inst) {
         return _folder.fold_gt(inst.arg[0], inst.arg[1]);
     case ir::InstType::IEXTSW:
         return _folder.fold_extsw(inst.arg[0]);
+    case ir::InstType::ISEL:
+        return _folder.fold_sel(inst.arg[0], inst.arg[1]);
     default:
         return nullptr;
     }
@@ -0,0 +1,248 @@
+#include "opt/pass/if_conversion.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace opt {
+
+// instructions added to the path through head, including speculated ones
+static const int MAX_COST = 4;
+// a select takes `neg` and `and` in target
+static const int SELECT_COST = 2;
+// a side taken less than once in so many times in profile is well predicted
+static const int BIASED_RATIO = 8;
+
+bool IfConversionPass::run_on_function(ir::Function &func) {
+    bool changed = false;
+    // converting an inner diamond may make an outer one convertible
+    bool converted;
+    do {
+        converted = false;
+        for (auto block = func.start; block; block = block->next) {
+            converted |= _convert(func, block);
+        }
+        changed |= converted;
+    } while (converted);
+
+    return changed;
+}
+
+bool IfConversionPass::_convert(ir::Function &func, ir::BlockPtr head) {
+    auto &jump = head->jump;
+    if (jump.type != ir::Jump::JNZ || jump.blk[0] == jump.blk[1]) {
+        return false;
+    }
+
+    // a side block is only reached from head, and jumps to join
+    auto is_side = [&head](ir::BlockPtr block) {
+        return block != head && block->preds.size() == 1 &&
+               block->phis.empty() && block->jump.type == ir::Jump::JMP;
+    };
+
+    // sides[0] is taken when the condition is true, sides[1] otherwise. a
+    // triangle has one side only, and the other edge goes to join directly
+    ir::BlockPtr sides[2] = {nullptr, nullptr};
+    ir::BlockPtr join = nullptr;
+    auto t = jump.blk[0], f = jump.blk[1];
+    if (is_side(t) && is_side(f) && t->jump.blk[0] == f->jump.blk[0]) {
+        sides[0] = t, sides[1] = f, join = t->jump.blk[0];
+    } else if (is_side(t) && t->jump.blk[0] == f) {
+        sides[0] = t, join = f;
+    } else if (is_side(f) && f->jump.blk[0] == t) {
+        sides[1] = f, join = t;
+    } else {
+        return false;
+    }
+    if (join == head || join->preds.size() != 2) {
+        return false;
+    }
+
+    int cost = 0;
+    for (auto side : sides) {
+        if (side && !_can_speculate(*side, cost)) {
+            return false;
+        }
+    }
+    if (_is_biased(head, sides)) {
+        return false;
+    }
+
+    // the block where the value comes from on each path
+    ir::BlockPtr from[2] = {sides[0] ? sides[0] : head,
+                            sides[1] ? sides[1] : head};
+    std::vector<Select> selects;
+    for (auto phi : join->phis) {
+        auto ty = phi->to->get_type();
+        if ((ty != ir::Type::W && ty != ir::Type::L) || phi->args.size() != 2) {
+            return false;
+        }
+        Select select{.phi = phi};
+        for (auto &[block, value] : phi->args) {
+            select.values[block == from[0] ? 0 : 1] = value;
+        }
+        // a variable not stored on one path is undefined there, so the phi
+        // may take the value from the other path
+        auto &values = select.values;
+        if (values[0] == nullptr && values[1] == nullptr) {
+            return false;
+        } else if (values[0] == nullptr || values[1] == nullptr) {
+            values[0] = values[1] = values[0] ? values[0] : values[1];
+        }
+        cost += _plan_select(select, sides);
+        selects.push_back(select);
+    }
+    if (cost > MAX_COST) {
+        return false;
+    }
+
+    // before: head: jnz %c, @t, @f; @t: ...; @f: ...; @join: %x =t phi ...
+    // after: head: ...; %d =t sub %a, %b; %s =t sel %c, %d; %x =t add %b, %s
+    for (auto side : sides) {
+        if (side) {
+            head->insts.insert(head->insts.end(), side->insts.begin(),
+                               side->insts.end());
+        }
+    }
+
+    auto create_inst = [&func, &head](ir::InstType insttype, ir::Type ty,
+                                      ir::ValuePtr arg0, ir::ValuePtr arg1,
+                                      ir::TempPtr to = nullptr) {
+        auto inst = ir::Inst::create(insttype, ty, arg0, arg1);
+        if (to) {
+            inst->to = to;
+        } else {
+            inst->to->id = func.temp_counter++;
+        }
+        head->insts.push_back(inst);
+        return inst->to;
+    };
+    auto cond = jump.arg;
+    for (auto &[phi, values, diff] : selects) {
+        auto ty = phi->to->get_type();
+        if (values[0] == values[1]) {
+            create_inst(ir::InstType::ICOPY, ty, values[0], nullptr, phi->to);
+        } else if (_is_zero(values[1])) {
+            create_inst(ir::InstType::ISEL, ty, cond, values[0], phi->to);
+        } else if (_is_zero(values[0])) {
+            auto sel = create_inst(ir::InstType::ISEL, ty, cond, values[1]);
+            create_inst(ir::InstType::ISUB, ty, values[1], sel, phi->to);
+        } else {
+            if (diff == nullptr) {
+                diff = create_inst(ir::InstType::ISUB, ty, values[0],
+                                   values[1]);
+            }
+            auto sel = create_inst(ir::InstType::ISEL, ty, cond, diff);
+            create_inst(ir::InstType::IADD, ty, values[1], sel, phi->to);
+        }
+    }
+    join->phis.clear();
+
+    jump = {.type = ir::Jump::JMP, .blk = {join, nullptr}};
+    join->preds = {head};
+
+    // unlink side blocks
+    std::unordered_set<ir::BlockPtr> removed;
+    for (auto side : sides) {
+        if (side) {
+            removed.insert(side);
+        }
+    }
+    for (auto block = func.start; block; block = block->next) {
+        while (block->next && removed.count(block->next)) {
+            block->next = block->next->next;
+        }
+        if (block->next == nullptr) {
+            func.end = block;
+        }
+    }
+    for (auto side : removed) {
+        side->release();
+    }
+
+    return true;
+}
+
+int IfConversionPass::_plan_select(Select &select, ir::BlockPtr sides[2]) {
+    auto &values = select.values;
+    if (values[0] == values[1]) {
+        return 0;
+    } else if (_is_zero(values[1])) {
+        return SELECT_COST;
+    } else if (_is_zero(values[0])) {
+        return SELECT_COST + 1;
+    }
+
+    // a conditional increment adds the increment itself
+    for (auto side : {sides[0], sides[1]}) {
+        if (side == nullptr) {
+            continue;
+        }
+        for (auto inst : side->insts) {
+            if (inst->to != values[0] ||
+                inst->insttype != ir::InstType::IADD) {
+                continue;
+            }
+            if (inst->arg[0] == values[1]) {
+                select.diff = inst->arg[1];
+            } else if (inst->arg[1] == values[1]) {
+                select.diff = inst->arg[0];
+            }
+        }
+    }
+    return select.diff ? SELECT_COST + 1 : SELECT_COST + 2;
+}
+
+bool IfConversionPass::_is_biased(ir::BlockPtr head, ir::BlockPtr sides[2]) {
+    if (head->freq <= 0) {
+        return false;
+    }
+    long long taken[2];
+    for (int i = 0; i < 2; i++) {
+        if (sides[i] && sides[i]->freq < 0) {
+            return false;
+        }
+        taken[i] = sides[i] ? sides[i]->freq : -1;
+    }
+    // a triangle takes the direct edge whenever it skips the side
+    for (int i = 0; i < 2; i++) {
+        if (taken[i] < 0) {
+            taken[i] = head->freq - taken[1 - i];
+        }
+    }
+    return std::min(taken[0], taken[1]) * BIASED_RATIO < head->freq;
+}
+
+bool IfConversionPass::_is_zero(ir::ValuePtr value) {
+    auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(value);
+    if (constbits == nullptr) {
+        return false;
+    }
+    auto int_val = std::get_if<int>(&constbits->value);
+    return int_val && *int_val == 0;
+}
+
+bool IfConversionPass::_can_speculate(const ir::Block &block, int &cost) {
+    for (auto inst : block.insts) {
+        switch (inst->insttype) {
+        case ir::InstType::IADD:
+        case ir::InstType::ISUB:
+        case ir::InstType::INEG:
+        case ir::InstType::IMUL:
+        case ir::InstType::ICEQW:
+        case ir::InstType::ICNEW:
+        case ir::InstType::ICSLEW:
+        case ir::InstType::ICSLTW:
+        case ir::InstType::ICSGEW:
+        case ir::InstType::ICSGTW:
+        case ir::InstType::IEXTSW:
+        case ir::InstType::ISEL:
+        case ir::InstType::ICOPY:
+            cost++;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace opt
@@ -0,0 +1,259 @@
+#include "opt/pass/layout.h"
+#include <algorithm>
+
+namespace opt {
+
+// probability of taking a branch predicted by loop heuristics
+static const double LOOP_BRANCH_PROB = 0.88;
+// probability of taking a branch predicted by return heuristic
+static const double RETURN_BRANCH_PROB = 0.72;
+
+// estimate the count of a block created after profiling, which is mostly
+// on a split edge, by its neighbours
+static long long estimate_freq(ir::BlockPtr block) {
+    if (block->preds.size() == 1 && block->preds[0]->freq >= 0) {
+        auto pred = block->preds[0];
+        auto &jump = pred->jump;
+        if (jump.type != ir::Jump::JNZ || jump.blk[0] == jump.blk[1]) {
+            return pred->freq;
+        }
+        auto other = jump.blk[0] == block ? jump.blk[1] : jump.blk[0];
+        if (other->preds.size() == 1 && other->freq >= 0) {
+            return std::max(pred->freq - other->freq, 0LL);
+        }
+    }
+    auto succ = block->jump.blk[0];
+    if (block->jump.type == ir::Jump::JMP && succ->preds.size() == 1 &&
+        succ->freq >= 0) {
+        return succ->freq;
+    }
+
+    long long pred_freq = -1, succ_freq = -1;
+    for (auto pred : block->preds) {
+        pred_freq = std::max(pred_freq, pred->freq);
+    }
+    for (auto succ : block->jump.blk) {
+        if (succ) {
+            succ_freq = std::max(succ_freq, succ->freq);
+        }
+    }
+    if (pred_freq >= 0 && succ_freq >= 0) {
+        return std::min(pred_freq, succ_freq);
+    }
+    return std::max({pred_freq, succ_freq, 0LL});
+}
+
+bool BlockLayoutPass::run_on_function(ir::Function &func) {
+    // fall through is not preserved after reordering
+    bool changed = false;
+    for (auto block = func.start; block; block = block->next) {
+        if (block->jump.type == ir::Jump::NONE) {
+            if (block->next == nullptr) {
+                throw std::logic_error("fall through at the end of function");
+            }
+            block->jump = {.type = ir::Jump::JMP, .blk = {block->next}};
+            changed = true;
+        }
+    }
+
+    auto edges = _get_edges(func);
+    auto order = _place_chains(func, edges);
+    _rotate_loops(func, order);
+
+    int i = 0;
+    for (auto block = func.start; block; block = block->next, i++) {
+        changed |= block != order[i];
+    }
+    for (size_t i = 0; i + 1 < order.size(); i++) {
+        order[i]->next = order[i + 1];
+    }
+    order.back()->next = nullptr;
+    func.end = order.back();
+
+    return changed;
+}
+
+std::vector<BlockLayoutPass::Edge>
+BlockLayoutPass::_get_edges(ir::Function &func) {
+    _loops = find_natural_loops(func);
+    auto loop_depth = get_loop_depth(func, _loops);
+
+    // whether the edge leaves a loop containing its source
+    auto is_exit = [this](ir::BlockPtr from, ir::BlockPtr to) {
+        for (auto &[header, loop] : _loops) {
+            if (loop.count(from) && !loop.count(to)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto is_return = [](ir::BlockPtr block) {
+        return block->jump.type == ir::Jump::RET;
+    };
+
+    bool profiled = func.start->freq >= 0;
+    auto get_freq = [profiled, &loop_depth](ir::BlockPtr block) -> double {
+        if (!profiled) {
+            return get_loop_weight(loop_depth[block]);
+        }
+        return block->freq >= 0 ? block->freq : estimate_freq(block);
+    };
+
+    std::vector<Edge> edges;
+    for (auto block = func.start; block; block = block->next) {
+        double freq = get_freq(block);
+
+        auto &jump = block->jump;
+        if (jump.type == ir::Jump::JMP ||
+            (jump.type == ir::Jump::JNZ && jump.blk[0] == jump.blk[1])) {
+            edges.push_back({block, jump.blk[0], freq});
+            continue;
+        } else if (jump.type != ir::Jump::JNZ) {
+            continue;
+        }
+
+        // probability of taking the true branch
+        auto t = jump.blk[0], f = jump.blk[1];
+        double prob = 0.5;
+        if (profiled) {
+            // a successor with single predecessor counts its edge exactly
+            double t_freq = t->preds.size() == 1 ? get_freq(t) : -1;
+            double f_freq = f->preds.size() == 1 ? get_freq(f) : -1;
+            if (t_freq < 0 && f_freq < 0) {
+                t_freq = get_freq(t), f_freq = get_freq(f);
+            } else if (t_freq < 0) {
+                t_freq = std::max(freq - f_freq, 0.0);
+            } else if (f_freq < 0) {
+                f_freq = std::max(freq - t_freq, 0.0);
+            }
+            if (t_freq + f_freq > 0) {
+                prob = t_freq / (t_freq + f_freq);
+            }
+        } else if (dominates(t, block) != dominates(f, block)) {
+            prob =
+                dominates(t, block) ? LOOP_BRANCH_PROB : 1 - LOOP_BRANCH_PROB;
+        } else if (is_exit(block, t) != is_exit(block, f)) {
+            prob = is_exit(block, f) ? LOOP_BRANCH_PROB : 1 - LOOP_BRANCH_PROB;
+        } else if (is_return(t) != is_return(f)) {
+            prob = is_return(f) ? RETURN_BRANCH_PROB : 1 - RETURN_BRANCH_PROB;
+        }
+        edges.push_back({block, t, freq * prob});
+        edges.push_back({block, f, freq * (1 - prob)});
+    }
+
+    return edges;
+}
+
+std::vector<ir::BlockPtr>
+BlockLayoutPass::_place_chains(ir::Function &func,
+                               const std::vector<Edge> &edges) {
+    std::vector<std::vector<ir::BlockPtr>> chains;
+    std::unordered_map<ir::BlockPtr, int> chain_of;
+    for (auto block = func.start; block; block = block->next) {
+        chain_of[block] = chains.size();
+        chains.push_back({block});
+    }
+
+    // merge chains along the heaviest edges, so that they fall through. back
+    // edges come last, loops are rotated later if profitable
+    std::vector<Edge> sorted = edges;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Edge &a, const Edge &b) {
+                         bool a_back = dominates(a.to, a.from);
+                         bool b_back = dominates(b.to, b.from);
+                         if (a_back != b_back) {
+                             return b_back;
+                         }
+                         return a.weight > b.weight;
+                     });
+    for (auto &edge : sorted) {
+        int from = chain_of[edge.from], to = chain_of[edge.to];
+        if (from == to || edge.to == func.start ||
+            chains[from].back() != edge.from ||
+            chains[to].front() != edge.to) {
+            continue;
+        }
+        for (auto block : chains[to]) {
+            chain_of[block] = from;
+            chains[from].push_back(block);
+        }
+        chains[to].clear();
+    }
+
+    // place the entry chain first, then the chain most connected to the
+    // placed blocks, and then the chain first in original order
+    std::unordered_map<ir::BlockPtr, std::vector<const Edge *>> out_edges;
+    for (auto &edge : edges) {
+        out_edges[edge.from].push_back(&edge);
+    }
+    std::vector<double> connection(chains.size(), 0);
+    std::vector<bool> placed(chains.size(), false);
+    std::vector<ir::BlockPtr> order;
+    for (int cur = chain_of[func.start]; cur != -1;) {
+        placed[cur] = true;
+        for (auto block : chains[cur]) {
+            order.push_back(block);
+            for (auto edge : out_edges[block]) {
+                connection[chain_of[edge->to]] += edge->weight;
+            }
+        }
+
+        cur = -1;
+        for (int i = 0; i < (int)chains.size(); i++) {
+            if (!placed[i] && !chains[i].empty() &&
+                (cur == -1 || connection[i] > connection[cur])) {
+                cur = i;
+            }
+        }
+    }
+
+    return order;
+}
+
+bool BlockLayoutPass::_has_call(const std::unordered_set<ir::BlockPtr> &loop) {
+    for (auto block : loop) {
+        for (auto inst : block->insts) {
+            if (inst->insttype == ir::InstType::ICALL) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void BlockLayoutPass::_rotate_loops(ir::Function &func,
+                                    std::vector<ir::BlockPtr> &order) {
+    // before: header: jnz body, exit; body: ...; latch: jmp header
+    // after: body: ...; latch; header: jnz body, exit
+    // the jump in latch is saved in each iteration, at the cost of a jump
+    // into the loop
+    for (auto &[header, loop] : _loops) {
+        if (header == func.start || header->jump.type != ir::Jump::JNZ ||
+            _has_call(loop)) {
+            continue;
+        }
+        int first = std::find(order.begin(), order.end(), header) - order.begin();
+        int last = first;
+        while (last + 1 < (int)order.size() && loop.count(order[last + 1])) {
+            last++;
+        }
+        if (last == first) {
+            continue;
+        }
+
+        auto body = order[first + 1];
+        auto &jump = header->jump;
+        bool exits = (jump.blk[0] == body && !loop.count(jump.blk[1])) ||
+                     (jump.blk[1] == body && !loop.count(jump.blk[0]));
+        auto latch = order[last];
+        if (!exits || latch->jump.type != ir::Jump::JMP ||
+            latch->jump.blk[0] != header) {
+            continue;
+        }
+
+        std::rotate(order.begin() + first, order.begin() + first + 1,
+                    order.begin() + last + 1);
+    }
+}
+
+} // namespace opt
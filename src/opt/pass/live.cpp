@@ -152,6 +152,7 @@ void FillIntervalPass::_find_intervals_in_block(
     std::unordered_map<ir::TempPtr, int> &last_use, int &number) {
 
     // insts
+    std::vector<ir::TempPtr> call_args;
     for (auto inst : block.insts) {
         for (int i = 0; i < 2; i++)
             if (auto temp = std::dynamic_pointer_cast<ir::Temp>(inst->arg[i]);
@@ -159,6 +160,18 @@ void FillIntervalPass::_find_intervals_in_block(
                 last_use[temp] = number;
             }
 
+        // arguments are only read when the call is made
+        if (inst->insttype == ir::InstType::IARG) {
+            if (auto temp = std::dynamic_pointer_cast<ir::Temp>(inst->arg[0])) {
+                call_args.push_back(temp);
+            }
+        } else if (inst->insttype == ir::InstType::ICALL) {
+            for (auto temp : call_args) {
+                last_use[temp] = number;
+            }
+            call_args.clear();
+        }
+
         if (inst->to) {
             auto temp = inst->to;
             if (first_def.find(temp) == first_def.end()) {
@@ -1,5 +1,6 @@
 #include "opt/pass/loop.h"
 #include <algorithm>
+#include <cmath>
 #include <queue>
 #include <unordered_set>
 
@@ -27,6 +28,58 @@ static bool in(const std::unordered_set<T> &container, T &elem) {
            container.end();
 }
 
+bool dominates(ir::BlockPtr dom, ir::BlockPtr block) {
+    for (; block; block = block->idom) {
+        if (block == dom) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<NaturalLoop> find_natural_loops(const ir::Function &func) {
+    std::vector<NaturalLoop> loops;
+    for (auto header = func.start; header; header = header->next) {
+        // a back edge goes to its dominator
+        std::vector<ir::BlockPtr> worklist;
+        for (auto pred : header->preds) {
+            if (dominates(header, pred)) {
+                worklist.push_back(pred);
+            }
+        }
+        if (worklist.empty()) {
+            continue;
+        }
+
+        NaturalLoop loop = {header, {header}};
+        while (!worklist.empty()) {
+            auto block = worklist.back();
+            worklist.pop_back();
+            if (loop.blocks.insert(block).second) {
+                worklist.insert(worklist.end(), block->preds.begin(),
+                                block->preds.end());
+            }
+        }
+        loops.push_back(std::move(loop));
+    }
+    return loops;
+}
+
+std::unordered_map<ir::BlockPtr, int>
+get_loop_depth(const ir::Function &func,
+               const std::vector<NaturalLoop> &loops) {
+    std::unordered_map<ir::BlockPtr, int> loop_depth;
+    for (auto block = func.start; block; block = block->next) {
+        loop_depth[block] = 0;
+    }
+    for (auto &loop : loops) {
+        for (auto block : loop.blocks) {
+            loop_depth[block]++;
+        }
+    }
+    return loop_depth;
+}
+
 std::vector<ir::BlockPtr> static find_dominates(ir::BlockPtr block) {
     std::vector<ir::BlockPtr> dominates;
     std::queue<ir::BlockPtr> queue;
@@ -128,6 +181,17 @@ static void insert_before(ir::Function &func, ir::BlockPtr before,
 
 static ir::BlockPtr insert_pre_header(ir::Function &func, ir::BlockPtr header,
                                       ir::BlockPtr body, ir::BlockPtr back) {
+    // reuse the preheader of a loop rotated by `LoopRotationPass`
+    std::vector<ir::BlockPtr> entries;
+    for (auto pred : header->preds) {
+        if (pred != back) {
+            entries.push_back(pred);
+        }
+    }
+    if (entries.size() == 1 && entries[0]->jump.type == ir::Jump::JMP) {
+        return entries[0];
+    }
+
     auto pre_header = std::shared_ptr<ir::Block>(
         new ir::Block{(*func.block_counter_ptr)++, "pre_header"});
 
@@ -446,4 +510,521 @@ LicmPass::Loop LicmPass::_fill_loop(ir::BlockPtr header, ir::BlockPtr back) {
     return loop;
 }
 
+// copying a larger header costs more code than the saved jump
+static const int MAX_ROTATE_HEADER_INSTS = 8;
+
+bool LoopRotationPass::run_on_function(ir::Function &func) {
+    // make fall-throughs explicit, as blocks are inserted before loops
+    for (auto block = func.start; block; block = block->next) {
+        if (block->jump.type == ir::Jump::NONE && block->next) {
+            block->jump = {ir::Jump::JMP, nullptr, {block->next, nullptr}};
+        }
+    }
+
+    _loops = find_natural_loops(func);
+
+    bool changed = false;
+    for (auto &[header, loop_blocks] : _loops) {
+        changed |= _rotate(func, header, loop_blocks);
+    }
+    _loops.clear();
+
+    return changed;
+}
+
+bool LoopRotationPass::_rotate(ir::Function &func, ir::BlockPtr header,
+                               const LoopBlocks &loop_blocks) {
+    auto &jump = header->jump;
+    if (header == func.start || jump.type != ir::Jump::JNZ ||
+        !header->phis.empty() ||
+        header->insts.size() > MAX_ROTATE_HEADER_INSTS) {
+        return false;
+    }
+    bool inside[2] = {loop_blocks.count(jump.blk[0]) > 0,
+                      loop_blocks.count(jump.blk[1]) > 0};
+    if (inside[0] == inside[1]) {
+        return false;
+    }
+    auto body = inside[0] ? jump.blk[0] : jump.blk[1];
+    auto exit = inside[0] ? jump.blk[1] : jump.blk[0];
+    if (body == header) {
+        return false;
+    }
+
+    std::vector<ir::BlockPtr> entries, latches;
+    for (auto pred : header->preds) {
+        if (loop_blocks.count(pred)) {
+            latches.push_back(pred);
+        } else {
+            entries.push_back(pred);
+        }
+    }
+    if (entries.empty()) {
+        return false;
+    }
+
+    // before: entry -> header: jnz body, exit; latch -> header
+    // after: entry -> guard: jnz pre_header, exit; pre_header -> body;
+    // latch -> header: jnz body, exit
+    auto guard = std::shared_ptr<ir::Block>(
+        new ir::Block{(*func.block_counter_ptr)++, "loop_guard"});
+    auto pre_header = std::shared_ptr<ir::Block>(
+        new ir::Block{(*func.block_counter_ptr)++, "pre_header"});
+    insert_before(func, body, guard);
+    guard->next = pre_header;
+    pre_header->next = body;
+
+    // invariants in header are only computed in guard
+    std::unordered_map<ir::ValuePtr, int> loop_defs;
+    for (auto block : loop_blocks) {
+        for (auto inst : block->insts) {
+            loop_defs[inst->to]++;
+        }
+    }
+    std::unordered_set<ir::ValuePtr> invariants;
+    auto is_invariant = [&loop_defs, &invariants](ir::InstPtr inst) {
+        if (inst->to == nullptr || loop_defs[inst->to] != 1 ||
+            in(non_invariant_insts, inst->insttype) ||
+            inst->insttype == ir::InstType::IALLOC4 ||
+            inst->insttype == ir::InstType::IALLOC8) {
+            return false;
+        }
+        for (auto arg : inst->arg) {
+            if (arg && loop_defs.count(arg) && !invariants.count(arg)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // temps only living in header are renamed in guard, so that they do not
+    // live across the loop
+    auto local_temps = _find_local_temps(func, header);
+    std::unordered_map<ir::ValuePtr, ir::ValuePtr> renamed;
+    auto rename = [&renamed](ir::ValuePtr value) {
+        auto it = renamed.find(value);
+        return it == renamed.end() ? value : it->second;
+    };
+    std::vector<ir::InstPtr> variants;
+    for (auto inst : header->insts) {
+        if (is_invariant(inst)) {
+            invariants.insert(inst->to);
+            guard->insts.push_back(inst);
+            continue;
+        }
+        variants.push_back(inst);
+
+        auto copy = std::make_shared<ir::Inst>(*inst);
+        copy->arg[0] = rename(copy->arg[0]);
+        copy->arg[1] = rename(copy->arg[1]);
+        if (copy->to && local_temps.count(copy->to)) {
+            auto temp = std::make_shared<ir::Temp>(
+                copy->to->name, copy->to->type, std::vector<ir::Def>{});
+            temp->id = func.temp_counter++;
+            renamed[copy->to] = temp;
+            copy->to = temp;
+        }
+        guard->insts.push_back(copy);
+    }
+    header->insts = std::move(variants);
+    guard->jump = jump;
+    guard->jump.arg = rename(jump.arg);
+    guard->jump.blk[inside[0] ? 0 : 1] = pre_header;
+    pre_header->jump = {ir::Jump::JMP, nullptr, {body, nullptr}};
+
+    for (auto entry : entries) {
+        for (int i = 0; i < 2; i++) {
+            if (entry->jump.blk[i] == header) {
+                entry->jump.blk[i] = guard;
+            }
+        }
+    }
+    guard->preds = entries;
+    pre_header->preds = {guard};
+    header->preds = latches;
+    body->preds.push_back(pre_header);
+    exit->preds.push_back(guard);
+
+    // the new blocks are inside the loops enclosing this one
+    for (auto &[other, other_blocks] : _loops) {
+        if (other != header && other_blocks.count(header)) {
+            other_blocks.insert(guard);
+            other_blocks.insert(pre_header);
+        }
+    }
+
+    return true;
+}
+
+std::unordered_set<ir::ValuePtr>
+LoopRotationPass::_find_local_temps(ir::Function &func, ir::BlockPtr header) {
+    // temps defined in header before any use there
+    std::unordered_set<ir::ValuePtr> local_temps, used;
+    for (auto inst : header->insts) {
+        for (auto arg : inst->arg) {
+            used.insert(arg);
+        }
+        if (inst->to && !used.count(inst->to)) {
+            local_temps.insert(inst->to);
+        }
+    }
+
+    // which are not used in other blocks
+    for (auto block = func.start; block; block = block->next) {
+        if (block == header) {
+            continue;
+        }
+        for (auto inst : block->insts) {
+            local_temps.erase(inst->arg[0]);
+            local_temps.erase(inst->arg[1]);
+        }
+        local_temps.erase(block->jump.arg);
+    }
+
+    return local_temps;
+}
+
+// a value in the body of a counted loop, as a function of the counter i
+struct IdiomValue {
+    enum Kind {
+        INDEX,      // i + delta, as word
+        LONG_INDEX, // i + delta, as long
+        OFFSET,     // (i + delta) * scale
+        ADDRESS,    // base + (i + delta) * scale
+        LOAD,       // load from base + (i + delta) * scale
+    } kind;
+    int delta = 0;
+    int scale = 1;
+    ir::ValuePtr base = nullptr;
+};
+
+static bool get_int(ir::ValuePtr value, int &result) {
+    auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(value);
+    if (constbits == nullptr ||
+        !std::holds_alternative<int>(constbits->value)) {
+        return false;
+    }
+    result = std::get<int>(constbits->value);
+    return true;
+}
+
+bool LoopIdiomPass::run_on_function(ir::Function &func) {
+    bool changed = false;
+    for (auto header = func.start; header; header = header->next) {
+        // header: jnz body, exit; body -> header
+        auto body = header->jump.blk[0];
+        if (header->jump.type != ir::Jump::JNZ || body == header ||
+            header->preds.size() != 2 || body->preds.size() != 1 ||
+            body->preds[0] != header) {
+            continue;
+        }
+        if ((body->jump.type == ir::Jump::JMP &&
+             body->jump.blk[0] == header) ||
+            (body->jump.type == ir::Jump::NONE && body->next == header)) {
+            changed |= _replace(func, header, body);
+        }
+    }
+    return changed;
+}
+
+bool LoopIdiomPass::_replace(ir::Function &func, ir::BlockPtr header,
+                             ir::BlockPtr body) {
+    // %i =w phi @pre <init>, @body <next>; %c =w csltw %i, <n>; jnz %c
+    if (header->phis.size() != 1 || header->insts.size() != 1) {
+        return false;
+    }
+    auto phi = header->phis[0];
+    auto cmp = header->insts[0];
+    if (cmp->insttype != ir::InstType::ICSLTW || cmp->arg[0] != phi->to ||
+        header->jump.arg != cmp->to) {
+        return false;
+    }
+    ir::ValuePtr init = nullptr, next = nullptr;
+    for (auto &[block, value] : phi->args) {
+        (block == body ? next : init) = value;
+    }
+    auto exit = header->jump.blk[1];
+    if (init == nullptr || next == nullptr || exit->preds.size() != 1) {
+        return false;
+    }
+
+    std::unordered_set<ir::ValuePtr> loop_temps = {phi->to, cmp->to};
+    for (auto inst : body->insts) {
+        if (inst->to) {
+            loop_temps.insert(inst->to);
+        }
+    }
+    auto is_invariant = [&loop_temps](ir::ValuePtr value) {
+        return std::dynamic_pointer_cast<ir::Address>(value) ||
+               (std::dynamic_pointer_cast<ir::Temp>(value) &&
+                loop_temps.count(value) == 0);
+    };
+    auto n = cmp->arg[1];
+    int init_int, n_int;
+    bool is_const_init = get_int(init, init_int);
+    bool is_const_n = get_int(n, n_int);
+    if (!is_const_n && !is_invariant(n)) {
+        return false;
+    }
+
+    // every instruction of the body must compute an address of the array, or
+    // load or store an element
+    std::unordered_map<ir::ValuePtr, IdiomValue> values;
+    values[phi->to] = {IdiomValue::INDEX};
+    auto get = [&values](ir::ValuePtr value, IdiomValue::Kind kind) {
+        auto it = values.find(value);
+        return it != values.end() && it->second.kind == kind ? &it->second
+                                                             : nullptr;
+    };
+    std::vector<std::pair<IdiomValue, ir::ValuePtr>> stores;
+    for (auto inst : body->insts) {
+        auto &[arg0, arg1] = inst->arg;
+        int c;
+        IdiomValue *value;
+        switch (inst->insttype) {
+        case ir::InstType::IADD:
+            for (int k = 0; k < 2; k++) {
+                auto other = inst->arg[1 - k];
+                if ((value = get(inst->arg[k], IdiomValue::INDEX)) &&
+                    get_int(other, c)) {
+                    values[inst->to] = {IdiomValue::INDEX, value->delta + c};
+                } else if ((value = get(inst->arg[k], IdiomValue::OFFSET)) &&
+                           is_invariant(other)) {
+                    values[inst->to] = {IdiomValue::ADDRESS, value->delta,
+                                        value->scale, other};
+                } else if ((value = get(inst->arg[k], IdiomValue::ADDRESS)) &&
+                           get_int(other, c) && c % value->scale == 0) {
+                    values[inst->to] = {IdiomValue::ADDRESS,
+                                        value->delta + c / value->scale,
+                                        value->scale, value->base};
+                } else {
+                    continue;
+                }
+                break;
+            }
+            break;
+        case ir::InstType::IEXTSW:
+            if ((value = get(arg0, IdiomValue::INDEX))) {
+                values[inst->to] = {IdiomValue::LONG_INDEX, value->delta};
+            }
+            break;
+        case ir::InstType::IMUL:
+            for (int k = 0; k < 2; k++) {
+                if ((value = get(inst->arg[k], IdiomValue::LONG_INDEX)) &&
+                    get_int(inst->arg[1 - k], c) && c > 0) {
+                    values[inst->to] = {IdiomValue::OFFSET, value->delta, c};
+                    break;
+                }
+            }
+            break;
+        case ir::InstType::ILOADW:
+        case ir::InstType::ILOADS:
+            if ((value = get(arg0, IdiomValue::ADDRESS)) &&
+                value->scale == 4) {
+                values[inst->to] = *value;
+                values[inst->to].kind = IdiomValue::LOAD;
+            }
+            break;
+        case ir::InstType::ISTOREW:
+        case ir::InstType::ISTORES:
+            if ((value = get(arg1, IdiomValue::ADDRESS)) &&
+                value->scale == 4) {
+                stores.push_back({*value, arg0});
+                continue;
+            }
+            return false;
+        default:
+            return false;
+        }
+        if (values.count(inst->to) == 0) {
+            return false;
+        }
+    }
+
+    // each iteration stores a[i + d] to a[i + d + k - 1], then i = i + k
+    auto step = get(next, IdiomValue::INDEX);
+    int k = stores.size();
+    if (k == 0 || step == nullptr || step->delta != k) {
+        return false;
+    }
+    std::vector<int> deltas;
+    for (auto &[dst, _] : stores) {
+        deltas.push_back(dst.delta);
+    }
+    std::sort(deltas.begin(), deltas.end());
+    for (int j = 0; j < k; j++) {
+        if (deltas[j] != deltas[0] + j) {
+            return false;
+        }
+    }
+    // an unrolled loop must not run past n
+    if (k > 1 &&
+        !(is_const_init && is_const_n && (n_int - init_int) % k == 0)) {
+        return false;
+    }
+
+    auto &[first_dst, first_value] = stores[0];
+    auto first_src = get(first_value, IdiomValue::LOAD);
+    for (auto &[dst, value] : stores) {
+        if (dst.base != first_dst.base) {
+            return false;
+        }
+        if (first_src == nullptr) {
+            // memset can only fill bytes, so only 0 and -1 are supported
+            auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(value);
+            if (value != first_value || constbits == nullptr) {
+                return false;
+            }
+            if (auto int_val = std::get_if<int>(&constbits->value);
+                int_val && *int_val != 0 && *int_val != -1) {
+                return false;
+            }
+            if (auto float_val = std::get_if<float>(&constbits->value);
+                float_val && (*float_val != 0.0f || std::signbit(*float_val))) {
+                return false;
+            }
+        } else {
+            auto src = get(value, IdiomValue::LOAD);
+            if (src == nullptr || src->base != first_src->base ||
+                src->delta - dst.delta != first_src->delta - first_dst.delta) {
+                return false;
+            }
+        }
+    }
+
+    // loop copying between overlapping arrays is not memcpy, so only global
+    // and local arrays are copied, and pointer params are rejected
+    if (first_src) {
+        auto is_array = [&func](ir::ValuePtr base) {
+            if (std::dynamic_pointer_cast<ir::Address>(base)) {
+                return true;
+            }
+            for (auto inst : func.start->insts) {
+                if (inst->to == base &&
+                    (inst->insttype == ir::InstType::IALLOC4 ||
+                     inst->insttype == ir::InstType::IALLOC8)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        if (first_src->base == first_dst.base || !is_array(first_dst.base) ||
+            !is_array(first_src->base)) {
+            return false;
+        }
+    }
+
+    // before: header: %i =w phi @pre <init>, @body <next>; jnz body, exit;
+    // body: ...; jmp header
+    // after: header: %i =w phi @pre <init>; jnz body, exit;
+    // body: memset/memcpy(&a[init + d], ..., (n - init) * 4); jmp exit;
+    // exit: %i.exit =w phi @header %i, @body <n>
+    std::vector<ir::InstPtr> insts;
+    auto create = [&func, &insts](ir::InstType insttype, ir::Type ty,
+                                  ir::ValuePtr arg0, ir::ValuePtr arg1) {
+        auto inst = ir::Inst::create(insttype, ty, arg0, arg1);
+        if (inst->to) {
+            inst->to->id = func.temp_counter++;
+        }
+        insts.push_back(inst);
+        return inst->to;
+    };
+    // constants are folded here, as products are not folded later
+    ir::ValuePtr offset = nullptr;
+    if (!is_const_init) {
+        auto index = create(ir::InstType::IEXTSW, ir::Type::L, init, nullptr);
+        offset = create(ir::InstType::IMUL, ir::Type::L, index,
+                        ir::ConstBits::get(4));
+    }
+    auto get_address = [&](ir::ValuePtr base, int delta) {
+        if (is_const_init) {
+            return create(ir::InstType::IADD, ir::Type::L, base,
+                          ir::ConstBits::get((init_int + delta) * 4));
+        }
+        auto address = create(ir::InstType::IADD, ir::Type::L, base, offset);
+        if (delta == 0) {
+            return address;
+        }
+        return create(ir::InstType::IADD, ir::Type::L, address,
+                      ir::ConstBits::get(delta * 4));
+    };
+    ir::ValuePtr bytes;
+    if (is_const_init && is_const_n) {
+        bytes = ir::ConstBits::get((n_int - init_int) * 4);
+    } else {
+        auto count = create(ir::InstType::ISUB, ir::Type::W, n, init);
+        bytes = create(ir::InstType::IEXTSW, ir::Type::L,
+                       create(ir::InstType::IMUL, ir::Type::W, count,
+                              ir::ConstBits::get(4)),
+                       nullptr);
+    }
+
+    std::vector<ir::ValuePtr> args = {get_address(first_dst.base, deltas[0])};
+    if (first_src == nullptr) {
+        auto constbits = std::static_pointer_cast<ir::ConstBits>(first_value);
+        args.push_back(constbits->to_int());
+    } else {
+        args.push_back(get_address(first_src->base,
+                                   deltas[0] + first_src->delta -
+                                       first_dst.delta));
+    }
+    args.push_back(bytes);
+    for (auto arg : args) {
+        create(ir::InstType::IARG, ir::Type::X, arg, nullptr);
+    }
+    create(ir::InstType::ICALL, ir::Type::X,
+           ir::Address::get(first_src ? "memcpy" : "memset"), nullptr);
+    body->insts = std::move(insts);
+
+    // the body runs at most once now, so it leaves the loop with i = n
+    auto exit_to = std::make_shared<ir::Temp>("", ir::Type::W,
+                                              std::vector<ir::Def>{});
+    exit_to->id = func.temp_counter++;
+    auto uses = phi->to->uses;
+    for (auto &use : uses) {
+        if (auto phi_use = std::get_if<ir::PhiUse>(&use)) {
+            if (phi_use->blk != exit) {
+                for (auto &[_, value] : phi_use->phi->args) {
+                    if (value == phi->to) {
+                        value = exit_to;
+                    }
+                }
+            }
+        } else if (auto inst_use = std::get_if<ir::InstUse>(&use)) {
+            if (inst_use->blk != header && inst_use->blk != body) {
+                for (auto &arg : inst_use->ins->arg) {
+                    if (arg == phi->to) {
+                        arg = exit_to;
+                    }
+                }
+            }
+        } else if (auto jmp_use = std::get_if<ir::JmpUse>(&use)) {
+            if (jmp_use->blk != header) {
+                jmp_use->blk->jump.arg = exit_to;
+            }
+        }
+    }
+    for (auto exit_phi : exit->phis) {
+        auto value = exit_phi->args[0].second;
+        exit_phi->args.push_back({body, value == phi->to ? n : value});
+    }
+    exit->phis.push_back(std::make_shared<ir::Phi>(
+        exit_to, decltype(ir::Phi::args){{header, phi->to}, {body, n}}));
+
+    if (is_const_init) {
+        cmp->arg[0] = init;
+        if (is_const_n) {
+            header->jump.arg = ir::ConstBits::get(init_int < n_int ? 1 : 0);
+        }
+    }
+    body->jump = {ir::Jump::JMP, nullptr, {exit, nullptr}};
+    exit->preds.push_back(body);
+    header->preds.erase(
+        std::find(header->preds.begin(), header->preds.end(), body));
+    phi->args.erase(std::find_if(
+        phi->args.begin(), phi->args.end(),
+        [&body](const auto &arg) { return arg.first == body; }));
+    return true;
+}
+
 } // namespace opt
@@ -0,0 +1,257 @@
+#include "opt/pass/memo.h"
+
+namespace opt {
+
+// give up if the argument ranges still change after so many rounds
+static const int MAX_INFER_ROUND = 16;
+
+bool MemoizationPass::run_on_module(ir::Module &module) {
+    // ranges of params start from empty, and are joined by call sites
+    ParamRanges ranges;
+    for (auto &func : module.functions) {
+        if (_is_candidate(*func)) {
+            auto &params = ranges[func.get()];
+            for (auto inst : func->start->insts) {
+                if (inst->insttype == ir::InstType::IPAR) {
+                    params.push_back(Range::empty());
+                }
+            }
+        }
+    }
+
+    if (ranges.empty() || !_infer_param_ranges(module, ranges)) {
+        return false;
+    }
+
+    bool changed = false;
+    // iterate over module to keep the order of generated data
+    for (auto &func : module.functions) {
+        auto it = ranges.find(func.get());
+        if (it == ranges.end()) {
+            continue;
+        }
+
+        long long entries = 1;
+        for (auto &range : it->second) {
+            entries *= range.size();
+            if (entries > _budget) {
+                break;
+            }
+        }
+        if (entries == 0 || entries > _budget) {
+            continue;
+        }
+
+        _memoize(*func, it->second, module);
+        changed = true;
+    }
+
+    return changed;
+}
+
+bool MemoizationPass::_is_candidate(const ir::Function &func) {
+    if (!func.is_pure || func.ty != ir::Type::W) {
+        return false;
+    }
+
+    int param_count = 0;
+    for (auto inst : func.start->insts) {
+        if (inst->insttype == ir::InstType::IPAR) {
+            if (inst->to->get_type() != ir::Type::W) {
+                return false;
+            }
+            param_count++;
+        }
+    }
+    if (param_count == 0 || param_count > 2) {
+        return false;
+    }
+
+    // a single recursive call only repeats work across outer calls, which is
+    // not worth the lookup
+    int self_call_count = 0;
+    for (auto block = func.start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            if (inst->insttype == ir::InstType::ICALL) {
+                auto addr =
+                    std::static_pointer_cast<ir::Address>(inst->arg[0]);
+                if (addr->ref_func == &func) {
+                    self_call_count++;
+                }
+            }
+        }
+    }
+    return self_call_count >= 2;
+}
+
+bool MemoizationPass::_infer_param_ranges(ir::Module &module,
+                                          ParamRanges &ranges) {
+    for (int round = 0; round < MAX_INFER_ROUND; round++) {
+        ParamRanges new_ranges;
+        for (auto &[func, params] : ranges) {
+            new_ranges[func].assign(params.size(), Range::empty());
+        }
+
+        for (auto &func : module.functions) {
+            // params of other functions are unknown
+            RangeAnalysis analysis;
+            if (auto it = ranges.find(func.get()); it != ranges.end()) {
+                analysis.run(*func, it->second);
+            } else {
+                analysis.run(*func, {});
+            }
+
+            for (auto block = func->start; block; block = block->next) {
+                std::vector<ir::ValuePtr> args;
+                for (auto inst : block->insts) {
+                    if (inst->insttype == ir::InstType::IARG) {
+                        args.push_back(inst->arg[0]);
+                        continue;
+                    } else if (inst->insttype != ir::InstType::ICALL) {
+                        continue;
+                    }
+
+                    auto addr =
+                        std::static_pointer_cast<ir::Address>(inst->arg[0]);
+                    if (auto it = new_ranges.find(addr->ref_func);
+                        it != new_ranges.end()) {
+                        auto &callee_ranges = it->second;
+                        for (size_t i = 0; i < callee_ranges.size(); i++) {
+                            callee_ranges[i] = callee_ranges[i].join(
+                                analysis.get(args[i], block));
+                        }
+                    }
+                    args.clear();
+                }
+            }
+        }
+
+        if (new_ranges == ranges) {
+            return true;
+        }
+        ranges = std::move(new_ranges);
+    }
+
+    return false;
+}
+
+void MemoizationPass::_memoize(ir::Function &func,
+                               const std::vector<Range> &ranges,
+                               ir::Module &module) {
+    auto start = func.start;
+    uint *block_counter_ptr = func.block_counter_ptr;
+
+    // each entry is {w flag, w value}
+    long long entries = 1;
+    for (auto &range : ranges) {
+        entries *= range.size();
+    }
+    auto memo = ir::Data::create(false, func.name + ".memo", 4, module);
+    memo->append_zero(entries * 8);
+
+    // before: @start -> ...
+    // after: @start -> @memo_hit | @memo_body -> ...
+    auto hit_block = std::shared_ptr<ir::Block>(
+        new ir::Block{(*block_counter_ptr)++, "memo_hit"});
+    auto body_block = std::shared_ptr<ir::Block>(
+        new ir::Block{(*block_counter_ptr)++, "memo_body"});
+    body_block->next = start->next;
+    hit_block->next = body_block;
+    start->next = hit_block;
+    if (func.end == start) {
+        func.end = body_block;
+    }
+
+    // move everything except par to body block
+    std::vector<ir::TempPtr> params;
+    for (auto inst : start->insts) {
+        if (inst->insttype == ir::InstType::IPAR) {
+            params.push_back(inst->to);
+        } else {
+            body_block->insts.push_back(inst);
+        }
+    }
+    start->insts.resize(params.size());
+    body_block->phis = std::move(start->phis);
+    start->phis.clear();
+    body_block->jump = start->jump;
+
+    // successors of body block now come from it
+    for (int i = 0; i < 2; i++) {
+        auto succ = body_block->jump.blk[i];
+        if (succ == nullptr || (i == 1 && succ == body_block->jump.blk[0])) {
+            continue;
+        }
+        for (auto phi : succ->phis) {
+            for (auto &[block, value] : phi->args) {
+                if (block == start) {
+                    block = body_block;
+                }
+            }
+        }
+    }
+
+    auto create_inst = [&func](ir::BlockPtr block, ir::InstType insttype,
+                               ir::Type ty, ir::ValuePtr arg0,
+                               ir::ValuePtr arg1) {
+        auto inst = ir::Inst::create(insttype, ty, arg0, arg1);
+        if (inst->to) {
+            inst->to->id = func.temp_counter++;
+        }
+        block->insts.push_back(inst);
+        return inst->to;
+    };
+
+    // key = (p0 - lo0) * size1 + (p1 - lo1)
+    ir::ValuePtr key = nullptr;
+    for (size_t i = 0; i < params.size(); i++) {
+        ir::ValuePtr index = params[i];
+        if (ranges[i].lo != 0) {
+            index = create_inst(start, ir::InstType::ISUB, ir::Type::W, index,
+                                ir::ConstBits::get((int)ranges[i].lo));
+        }
+        if (key != nullptr) {
+            key = create_inst(start, ir::InstType::IMUL, ir::Type::W, key,
+                              ir::ConstBits::get((int)ranges[i].size()));
+            key = create_inst(start, ir::InstType::IADD, ir::Type::W, key,
+                              index);
+        } else {
+            key = index;
+        }
+    }
+
+    auto key_ext =
+        create_inst(start, ir::InstType::IEXTSW, ir::Type::L, key, nullptr);
+    auto offset = create_inst(start, ir::InstType::IMUL, ir::Type::L, key_ext,
+                              ir::ConstBits::get(8));
+    auto flag_addr = create_inst(start, ir::InstType::IADD, ir::Type::L,
+                                 memo->get_address(), offset);
+    auto value_addr = create_inst(start, ir::InstType::IADD, ir::Type::L,
+                                  flag_addr, ir::ConstBits::get(4));
+    auto flag = create_inst(start, ir::InstType::ILOADW, ir::Type::W,
+                            flag_addr, nullptr);
+    start->jump = {
+        .type = ir::Jump::JNZ,
+        .arg = flag,
+        .blk = {hit_block, body_block},
+    };
+
+    auto value = create_inst(hit_block, ir::InstType::ILOADW, ir::Type::W,
+                             value_addr, nullptr);
+    hit_block->jump = {
+        .type = ir::Jump::RET,
+        .arg = value,
+    };
+
+    // record the result before each return
+    for (auto block = body_block; block; block = block->next) {
+        if (block->jump.type == ir::Jump::RET && block->jump.arg) {
+            create_inst(block, ir::InstType::ISTOREW, ir::Type::X,
+                        block->jump.arg, value_addr);
+            create_inst(block, ir::InstType::ISTOREW, ir::Type::X,
+                        ir::ConstBits::get(1), flag_addr);
+        }
+    }
+}
+
+} // namespace opt
@@ -0,0 +1,190 @@
+#include "opt/pass/profile.h"
+#include "ir/builder.h"
+#include <fstream>
+
+namespace opt {
+
+// "PROF" in little endian
+static const int PROFILE_MAGIC = 0x464f5250;
+// magic, checksum, counter count and padding
+static const int PROFILE_HEADER_BYTES = 16;
+
+static const char *PROFILE_TABLE = "__sysyc.prof";
+static const char *PROFILE_DUMP_FUNCTION = "__sysyc.prof.dump";
+
+// FNV-1a hash of the CFG shape, which changes with source and options
+static uint get_checksum(const ir::Module &module) {
+    uint hash = 2166136261u;
+    auto mix = [&hash](uint value) { hash = (hash ^ value) * 16777619u; };
+    for (auto &func : module.functions) {
+        for (auto c : func->name) {
+            mix(c);
+        }
+        for (auto block = func->start; block; block = block->next) {
+            mix(block->insts.size());
+            mix(block->jump.type);
+        }
+    }
+    return hash;
+}
+
+// pack a string with terminating zero into little endian words
+static std::vector<ir::ConstPtr> pack_string(const std::string &str) {
+    std::vector<ir::ConstPtr> words;
+    for (size_t i = 0; i <= str.size(); i += 4) {
+        uint word = 0;
+        for (size_t j = 0; j < 4 && i + j < str.size(); j++) {
+            word |= (uint)(unsigned char)str[i + j] << (8 * j);
+        }
+        words.push_back(ir::ConstBits::get((int)word));
+    }
+    return words;
+}
+
+bool ProfileInstrumentPass::run_on_module(ir::Module &module) {
+    int count = 0;
+    for (auto &func : module.functions) {
+        for (auto block = func->start; block; block = block->next) {
+            count++;
+        }
+    }
+
+    auto table = ir::Data::create(false, PROFILE_TABLE, 8, module);
+    table->append_const(ir::Type::W, {ir::ConstBits::get(PROFILE_MAGIC),
+                                      ir::ConstBits::get((int)get_checksum(
+                                          module)),
+                                      ir::ConstBits::get(count),
+                                      ir::ConstBits::get(0)});
+    table->append_zero(count * 8);
+
+    int offset = PROFILE_HEADER_BYTES;
+    for (auto &func : module.functions) {
+        for (auto block = func->start; block; block = block->next) {
+            // %addr =l add $table, offset
+            // %count =l loadl %addr
+            // %count.1 =l add %count, 1
+            // storel %count.1, %addr
+            std::vector<ir::InstPtr> insts;
+            auto create_inst = [&func, &insts](ir::InstType insttype,
+                                               ir::Type ty, ir::ValuePtr arg0,
+                                               ir::ValuePtr arg1) {
+                auto inst = ir::Inst::create(insttype, ty, arg0, arg1);
+                if (inst->to) {
+                    inst->to->id = func->temp_counter++;
+                }
+                insts.push_back(inst);
+                return inst->to;
+            };
+            auto addr = create_inst(ir::InstType::IADD, ir::Type::L,
+                                    table->get_address(),
+                                    ir::ConstBits::get(offset));
+            auto old_count = create_inst(ir::InstType::ILOADL, ir::Type::L,
+                                         addr, nullptr);
+            auto new_count = create_inst(ir::InstType::IADD, ir::Type::L,
+                                         old_count, ir::ConstBits::get(1));
+            create_inst(ir::InstType::ISTOREL, ir::Type::X, new_count, addr);
+            offset += 8;
+
+            if (block == func->start && func->name == "main") {
+                create_inst(ir::InstType::IARG, ir::Type::X,
+                            ir::Address::get(PROFILE_DUMP_FUNCTION), nullptr);
+                create_inst(ir::InstType::ICALL, ir::Type::W,
+                            ir::Address::get("atexit"), nullptr);
+            }
+
+            // keep params and allocs at the beginning
+            auto pos = block->insts.begin();
+            while (pos != block->insts.end() &&
+                   ((*pos)->insttype == ir::InstType::IPAR ||
+                    (*pos)->insttype == ir::InstType::IALLOC4 ||
+                    (*pos)->insttype == ir::InstType::IALLOC8)) {
+                pos++;
+            }
+            block->insts.insert(pos, insts.begin(), insts.end());
+        }
+    }
+
+    _create_dump_function(module, table, offset);
+
+    return true;
+}
+
+void ProfileInstrumentPass::_create_dump_function(ir::Module &module,
+                                                  ir::DataPtr table,
+                                                  int bytes) {
+    auto path = ir::Data::create(false, std::string(PROFILE_TABLE) + ".path",
+                                 4, module);
+    path->append_const(ir::Type::W, pack_string(_path));
+    auto mode = ir::Data::create(false, std::string(PROFILE_TABLE) + ".mode",
+                                 4, module);
+    mode->append_const(ir::Type::W, pack_string("wb"));
+
+    // if (f = fopen(path, "wb")) { fwrite(table, 1, bytes, f); fclose(f); }
+    auto [func, params] = ir::Function::create(false, PROFILE_DUMP_FUNCTION,
+                                               ir::Type::X, {}, module);
+    auto start = func->start;
+    auto write_block = ir::Block::create("write", *func);
+    auto end_block = ir::Block::create("end", *func);
+
+    ir::IRBuilder builder(func);
+    builder.set_insert_point(start);
+    auto file = builder.create_call(
+        ir::Type::L, ir::Address::get("fopen"),
+        {path->get_address(), mode->get_address()});
+    builder.create_jnz(file, write_block, end_block);
+
+    builder.set_insert_point(write_block);
+    builder.create_call(ir::Type::L, ir::Address::get("fwrite"),
+                        {table->get_address(), ir::ConstBits::get(1),
+                         ir::ConstBits::get(bytes), file});
+    builder.create_call(ir::Type::W, ir::Address::get("fclose"), {file});
+    builder.create_jmp(end_block);
+
+    builder.set_insert_point(end_block);
+    builder.create_ret(nullptr);
+}
+
+bool ProfileAnnotatePass::load(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    // a broken profile is loaded as an empty one, which matches nothing
+    int header[PROFILE_HEADER_BYTES / 4];
+    _checksum = 0;
+    _counts.clear();
+    if (!in.read((char *)header, sizeof(header)) ||
+        header[0] != PROFILE_MAGIC || header[2] < 0) {
+        return true;
+    }
+    _counts.resize(header[2]);
+    if (!in.read((char *)_counts.data(), _counts.size() * 8)) {
+        _counts.clear();
+        return true;
+    }
+    _checksum = header[1];
+    return true;
+}
+
+bool ProfileAnnotatePass::run_on_module(ir::Module &module) {
+    int count = 0;
+    for (auto &func : module.functions) {
+        for (auto block = func->start; block; block = block->next) {
+            count++;
+        }
+    }
+    if (count != (int)_counts.size() || get_checksum(module) != _checksum) {
+        return false;
+    }
+
+    int index = 0;
+    for (auto &func : module.functions) {
+        for (auto block = func->start; block; block = block->next) {
+            block->freq = _counts[index++];
+        }
+    }
+    return true;
+}
+
+} // namespace opt
@@ -1,4 +1,5 @@
 #include "opt/pass/propa.h"
+#include <algorithm>
 
 bool opt::LocalConstAndCopyPropagationPass::run_on_basic_block(ir::Block &block) {
     std::unordered_map<ir::ValuePtr, ir::ValuePtr> propagate_map;
@@ -94,6 +95,8 @@ opt::LocalConstAndCopyPropagationPass::_fold_if_can(const ir::Inst &inst) {
         return _folder.fold_gt(inst.arg[0], inst.arg[1]);
     case ir::InstType::IEXTSW:
         return _folder.fold_extsw(inst.arg[0]);
+    case ir::InstType::ISEL:
+        return _folder.fold_sel(inst.arg[0], inst.arg[1]);
     default:
         return nullptr;
     }
@@ -152,4 +155,86 @@ bool opt::CopyPropagationPass::run_on_function(ir::Function &func) {
     }
 
     return changed;
-}
\ No newline at end of file
+}
+
+bool opt::FloatConstMaterializationPass::run_on_function(ir::Function &func) {
+    bool changed = false;
+    for (auto block = func.start; block; block = block->next) {
+        std::unordered_map<std::string, ir::TempPtr> const_temps;
+        for (auto it = block->insts.begin(); it != block->insts.end(); it++) {
+            auto inst = *it;
+            if (inst->insttype == ir::InstType::ICOPY) {
+                continue;
+            }
+            for (auto &arg : inst->arg) {
+                auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(arg);
+                // zero is simply moved from the zero register
+                if (constbits == nullptr ||
+                    constbits->get_type() != ir::Type::S ||
+                    constbits->get_asm_value() == "0x0") {
+                    continue;
+                }
+
+                auto &temp = const_temps[constbits->get_asm_value()];
+                if (temp == nullptr) {
+                    auto copy = ir::Inst::create(ir::InstType::ICOPY,
+                                                 ir::Type::S, constbits, nullptr);
+                    copy->to->id = func.temp_counter++;
+                    it = std::next(block->insts.insert(it, copy));
+                    temp = copy->to;
+                }
+                arg = temp;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool opt::FloatConstMergePass::run_on_function(ir::Function &func) {
+    std::unordered_map<ir::ValuePtr, ir::ValuePtr> merged;
+    for (auto block = func.start; block; block = block->next) {
+        std::unordered_map<std::string, ir::TempPtr> const_temps;
+        for (auto inst : block->insts) {
+            if (inst->insttype != ir::InstType::ICOPY ||
+                inst->to->get_type() != ir::Type::S ||
+                inst->to->defs.size() != 1) {
+                continue;
+            }
+            auto constbits =
+                std::dynamic_pointer_cast<ir::ConstBits>(inst->arg[0]);
+            if (constbits == nullptr) {
+                continue;
+            }
+
+            auto &temp = const_temps[constbits->get_asm_value()];
+            if (temp == nullptr) {
+                temp = inst->to;
+            } else {
+                merged[inst->to] = temp;
+            }
+        }
+
+        auto it = std::remove_if(
+            block->insts.begin(), block->insts.end(),
+            [&merged](ir::InstPtr inst) { return merged.count(inst->to); });
+        block->insts.erase(it, block->insts.end());
+    }
+    if (merged.empty()) {
+        return false;
+    }
+
+    for (auto block = func.start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            for (auto &arg : inst->arg) {
+                if (auto it = merged.find(arg); it != merged.end()) {
+                    arg = it->second;
+                }
+            }
+        }
+        if (auto it = merged.find(block->jump.arg); it != merged.end()) {
+            block->jump.arg = it->second;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,352 @@
+#include "opt/pass/range.h"
+#include <algorithm>
+
+namespace opt {
+
+// rounds of plain iteration before widening the ranges of loop values
+static const int WIDEN_ROUND = 3;
+// rounds of narrowing after the widened fixpoint is reached
+static const int NARROW_ROUND = 2;
+
+static Range make_range(long long lo, long long hi) {
+    // the result may wrap around, give up
+    if (lo < INT_MIN || hi > INT_MAX) {
+        return Range::full();
+    }
+    return {lo, hi};
+}
+
+Range Range::join(const Range &other) const {
+    if (is_empty()) {
+        return other;
+    }
+    if (other.is_empty()) {
+        return *this;
+    }
+    return {std::min(lo, other.lo), std::max(hi, other.hi)};
+}
+
+Range Range::meet(const Range &other) const {
+    return {std::max(lo, other.lo), std::min(hi, other.hi)};
+}
+
+void RangeAnalysis::run(const ir::Function &func,
+                        const std::vector<Range> &params) {
+    _ranges.clear();
+    _par_index.clear();
+    _params = params;
+
+    int index = 0;
+    for (auto inst : func.start->insts) {
+        if (inst->insttype == ir::InstType::IPAR) {
+            _par_index[inst] = index++;
+        }
+    }
+
+    for (auto block : func.rpo) {
+        for (auto phi : block->phis) {
+            if (phi->to->get_type() == ir::Type::W) {
+                _ranges[phi->to] = Range::empty();
+            }
+        }
+        for (auto inst : block->insts) {
+            if (inst->to && inst->to->get_type() == ir::Type::W) {
+                _ranges[inst->to] = Range::empty();
+            }
+        }
+    }
+
+    auto update = [this](ir::TempPtr temp, Range range, bool widen) {
+        auto &old = _ranges.at(temp);
+        if (widen && !old.is_empty()) {
+            range = old.join(range);
+            if (range.lo < old.lo) {
+                range.lo = INT_MIN;
+            }
+            if (range.hi > old.hi) {
+                range.hi = INT_MAX;
+            }
+        }
+        if (range == old) {
+            return false;
+        }
+        old = range;
+        return true;
+    };
+
+    // ascending iteration, widen after some rounds to ensure termination
+    bool changed = true;
+    for (int round = 0; changed; round++) {
+        changed = false;
+        bool widen = round >= WIDEN_ROUND;
+        for (auto block : func.rpo) {
+            for (auto phi : block->phis) {
+                if (_ranges.count(phi->to)) {
+                    changed |= update(phi->to, _eval_phi(*phi, block), widen);
+                }
+            }
+            for (auto inst : block->insts) {
+                if (inst->to && _ranges.count(inst->to)) {
+                    changed |=
+                        update(inst->to, _eval_inst(inst, block), widen);
+                }
+            }
+        }
+    }
+
+    // descending iteration, recover bounds lost by widening
+    for (int round = 0; round < NARROW_ROUND; round++) {
+        for (auto block : func.rpo) {
+            for (auto phi : block->phis) {
+                if (_ranges.count(phi->to)) {
+                    _ranges.at(phi->to) = _eval_phi(*phi, block);
+                }
+            }
+            for (auto inst : block->insts) {
+                if (inst->to && _ranges.count(inst->to)) {
+                    _ranges.at(inst->to) = _eval_inst(inst, block);
+                }
+            }
+        }
+    }
+}
+
+Range RangeAnalysis::get(ir::ValuePtr value, ir::BlockPtr block) const {
+    auto range = _get_base(value);
+    auto temp = std::dynamic_pointer_cast<ir::Temp>(value);
+    if (temp == nullptr) {
+        return range;
+    }
+
+    // a block with single predecessor knows the condition of the edge, and
+    // so do all blocks it dominates
+    for (auto cur = block; cur && !range.is_empty(); cur = cur->idom) {
+        if (cur->preds.size() == 1) {
+            range = _refine_by_edge(temp, range, cur->preds[0], cur);
+        }
+    }
+    return range;
+}
+
+Range RangeAnalysis::_get_base(ir::ValuePtr value) const {
+    if (auto temp = std::dynamic_pointer_cast<ir::Temp>(value); temp) {
+        if (auto it = _ranges.find(temp); it != _ranges.end()) {
+            return it->second;
+        }
+    } else if (auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(value);
+               constbits) {
+        if (auto int_val = std::get_if<int>(&constbits->value); int_val) {
+            return Range::of(*int_val);
+        }
+    }
+    return Range::full();
+}
+
+Range RangeAnalysis::_eval_inst(ir::InstPtr inst, ir::BlockPtr block) const {
+    Range a = Range::full(), b = Range::full();
+    if (inst->arg[0]) {
+        a = get(inst->arg[0], block);
+    }
+    if (inst->arg[1]) {
+        b = get(inst->arg[1], block);
+    }
+
+    switch (inst->insttype) {
+    case ir::InstType::IPAR: {
+        auto index = _par_index.at(inst);
+        return index < (int)_params.size() ? _params[index] : Range::full();
+    }
+    case ir::InstType::ICOPY:
+        return a;
+    case ir::InstType::ICEQW:
+    case ir::InstType::ICNEW:
+    case ir::InstType::ICSLEW:
+    case ir::InstType::ICSLTW:
+    case ir::InstType::ICSGEW:
+    case ir::InstType::ICSGTW:
+    case ir::InstType::ICEQS:
+    case ir::InstType::ICNES:
+    case ir::InstType::ICLES:
+    case ir::InstType::ICLTS:
+    case ir::InstType::ICGES:
+    case ir::InstType::ICGTS:
+        return {0, 1};
+    default:
+        break;
+    }
+
+    if (a.is_empty() || b.is_empty()) {
+        return Range::empty();
+    }
+
+    switch (inst->insttype) {
+    case ir::InstType::IADD:
+        return make_range(a.lo + b.lo, a.hi + b.hi);
+    case ir::InstType::ISUB:
+        return make_range(a.lo - b.hi, a.hi - b.lo);
+    case ir::InstType::INEG:
+        return make_range(-a.hi, -a.lo);
+    case ir::InstType::IMUL: {
+        if (a.is_full() || b.is_full()) {
+            return Range::full();
+        }
+        long long products[] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo,
+                                a.hi * b.hi};
+        return make_range(*std::min_element(products, products + 4),
+                           *std::max_element(products, products + 4));
+    }
+    case ir::InstType::IDIV:
+        if (b.size() == 1 && b.lo > 0) {
+            return {a.lo / b.lo, a.hi / b.lo};
+        } else if (b.size() == 1 && b.lo < -1) {
+            return {a.hi / b.lo, a.lo / b.lo};
+        }
+        return Range::full();
+    case ir::InstType::IREM:
+        if (b.size() == 1 && b.lo != 0 && b.lo != INT_MIN) {
+            long long m = std::abs(b.lo) - 1;
+            if (a.lo >= 0) {
+                return {0, std::min(a.hi, m)};
+            } else if (a.hi <= 0) {
+                return {std::max(a.lo, -m), 0};
+            }
+            return {-m, m};
+        }
+        return Range::full();
+    default:
+        return Range::full();
+    }
+}
+
+Range RangeAnalysis::_eval_phi(const ir::Phi &phi, ir::BlockPtr block) const {
+    auto range = Range::empty();
+    for (auto &[pred, value] : phi.args) {
+        auto arg_range = get(value, pred);
+        if (auto temp = std::dynamic_pointer_cast<ir::Temp>(value); temp) {
+            arg_range = _refine_by_edge(temp, arg_range, pred, block);
+        }
+        range = range.join(arg_range);
+    }
+    return range;
+}
+
+Range RangeAnalysis::_refine_by_edge(ir::TempPtr temp, Range range,
+                                     ir::BlockPtr pred,
+                                     ir::BlockPtr succ) const {
+    auto &jump = pred->jump;
+    if (jump.type != ir::Jump::JNZ || jump.blk[0] == jump.blk[1]) {
+        return range;
+    }
+    bool taken = succ == jump.blk[0];
+
+    auto cond = std::dynamic_pointer_cast<ir::Temp>(jump.arg);
+    if (cond == nullptr) {
+        return range;
+    }
+
+    // jnz %temp, @taken, @not_taken
+    if (cond == temp) {
+        if (taken) {
+            if (range.lo == 0) {
+                range.lo = 1;
+            }
+            if (range.hi == 0) {
+                range.hi = -1;
+            }
+            return range;
+        }
+        return range.meet(Range::of(0));
+    }
+
+    if (cond->defs.size() != 1) {
+        return range;
+    }
+    auto instdef = std::get_if<ir::InstDef>(&cond->defs[0]);
+    if (instdef == nullptr) {
+        return range;
+    }
+    auto inst = instdef->ins;
+
+    auto op = inst->insttype;
+    Range other;
+    if (inst->arg[0] == temp) {
+        other = _get_base(inst->arg[1]);
+    } else if (inst->arg[1] == temp) {
+        // a < b is the same as b > a
+        other = _get_base(inst->arg[0]);
+        switch (op) {
+        case ir::InstType::ICSLTW:
+            op = ir::InstType::ICSGTW;
+            break;
+        case ir::InstType::ICSLEW:
+            op = ir::InstType::ICSGEW;
+            break;
+        case ir::InstType::ICSGTW:
+            op = ir::InstType::ICSLTW;
+            break;
+        case ir::InstType::ICSGEW:
+            op = ir::InstType::ICSLEW;
+            break;
+        default:
+            break;
+        }
+    } else {
+        return range;
+    }
+
+    if (!taken) { // negate the condition
+        switch (op) {
+        case ir::InstType::ICEQW:
+            op = ir::InstType::ICNEW;
+            break;
+        case ir::InstType::ICNEW:
+            op = ir::InstType::ICEQW;
+            break;
+        case ir::InstType::ICSLTW:
+            op = ir::InstType::ICSGEW;
+            break;
+        case ir::InstType::ICSLEW:
+            op = ir::InstType::ICSGTW;
+            break;
+        case ir::InstType::ICSGTW:
+            op = ir::InstType::ICSLEW;
+            break;
+        case ir::InstType::ICSGEW:
+            op = ir::InstType::ICSLTW;
+            break;
+        default:
+            return range;
+        }
+    }
+
+    if (other.is_empty()) {
+        return Range::empty();
+    }
+
+    switch (op) {
+    case ir::InstType::ICEQW:
+        return range.meet(other);
+    case ir::InstType::ICNEW:
+        if (other.size() == 1) {
+            if (range.lo == other.lo) {
+                range.lo++;
+            }
+            if (range.hi == other.lo) {
+                range.hi--;
+            }
+        }
+        return range;
+    case ir::InstType::ICSLTW:
+        return range.meet({INT_MIN, other.hi - 1});
+    case ir::InstType::ICSLEW:
+        return range.meet({INT_MIN, other.hi});
+    case ir::InstType::ICSGTW:
+        return range.meet({other.lo + 1, INT_MAX});
+    case ir::InstType::ICSGEW:
+        return range.meet({other.lo, INT_MAX});
+    default:
+        return range;
+    }
+}
+
+} // namespace opt
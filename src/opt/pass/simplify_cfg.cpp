@@ -61,7 +61,9 @@ bool UnreachableBlockRemovalPass::run_on_function(ir::Function &func) {
     auto block = func.start;
     while (block->next) {
         if (reachable.count(block->next) == 0) {
-            block->next = block->next->next;
+            auto removed = block->next;
+            block->next = removed->next;
+            removed->release();
             changed = true;
             continue;
         }
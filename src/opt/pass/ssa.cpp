@@ -1,5 +1,6 @@
 #include "opt/pass/ssa.h"
 #include <algorithm>
+#include <map>
 
 bool opt::MemoryToRegisterPass::run_on_function(ir::Function &func) {
     bool changed = false;
@@ -99,6 +100,229 @@ bool opt::MemoryToRegisterPass::_is_able_to_reg(ir::InstPtr alloc_inst) {
     return true;
 }
 
+bool opt::ScalarReplacementPass::run_on_function(ir::Function &func) {
+    _users.clear();
+    _escaped.clear();
+    _def_count.clear();
+    _removed.clear();
+    _replaced.clear();
+
+    // one scan for the uses and defs of all temps, so that each alloca only
+    // visits the addresses derived from it
+    std::vector<ir::InstPtr> allocs;
+    for (auto block = func.start; block; block = block->next) {
+        for (auto phi : block->phis) {
+            _def_count[phi->to]++;
+            for (auto &[_, value] : phi->args) {
+                if (auto temp = std::dynamic_pointer_cast<ir::Temp>(value)) {
+                    _escaped.insert(temp);
+                }
+            }
+        }
+        for (auto inst : block->insts) {
+            if (block == func.start &&
+                (inst->insttype == ir::InstType::IALLOC4 ||
+                 inst->insttype == ir::InstType::IALLOC8)) {
+                allocs.push_back(inst);
+            }
+            if (inst->to) {
+                _def_count[inst->to]++;
+            }
+            for (int i = 0; i < 2; i++) {
+                auto temp = std::dynamic_pointer_cast<ir::Temp>(inst->arg[i]);
+                if (temp && (i == 0 || inst->arg[0] != inst->arg[1])) {
+                    _users[temp].push_back(inst);
+                }
+            }
+        }
+        if (auto temp = std::dynamic_pointer_cast<ir::Temp>(block->jump.arg)) {
+            _escaped.insert(temp);
+        }
+    }
+
+    bool changed = false;
+    for (auto alloc_inst : allocs) {
+        changed |= _replace(func, alloc_inst);
+    }
+    if (!changed) {
+        return false;
+    }
+
+    // before: %arr =l alloc4 <bytes>, %elm =l add %arr, <offset>
+    // after: %elm.<offset> =l alloc4 4
+    for (auto block = func.start; block; block = block->next) {
+        std::vector<ir::InstPtr> insts;
+        for (auto inst : block->insts) {
+            if (auto it = _replaced.find(inst); it != _replaced.end()) {
+                insts.insert(insts.end(), it->second.begin(), it->second.end());
+            } else if (_removed.count(inst) == 0) {
+                insts.push_back(inst);
+            }
+        }
+        block->insts = std::move(insts);
+    }
+    return true;
+}
+
+bool opt::ScalarReplacementPass::_replace(ir::Function &func,
+                                          ir::InstPtr alloc_inst) {
+    auto bytes = std::dynamic_pointer_cast<ir::ConstBits>(alloc_inst->arg[0]);
+    if (bytes == nullptr || std::get<int>(bytes->value) > MAX_BYTES) {
+        return false;
+    }
+    auto size = std::get<int>(bytes->value);
+
+    OffsetMap offsets;
+    if (!_fill_offsets(alloc_inst, offsets) || offsets.size() == 1) {
+        // an alloca used directly is left to mem2reg
+        return false;
+    }
+
+    // all uses must be loads and stores of elements
+    std::map<int, ir::Type> elements;
+    auto is_derived = [&offsets](ir::ValuePtr value) {
+        auto temp = std::dynamic_pointer_cast<ir::Temp>(value);
+        return temp != nullptr && offsets.count(temp) != 0;
+    };
+    for (auto [temp, offset] : offsets) {
+        if (_escaped.count(temp)) {
+            return false;
+        }
+        auto users = _users.find(temp);
+        if (users == _users.end()) {
+            continue;
+        }
+        for (auto inst : users->second) {
+            for (int i = 0; i < 2; i++) {
+                if (inst->arg[i] != temp) {
+                    continue;
+                }
+
+                ir::Type ty;
+                switch (inst->insttype) {
+                case ir::InstType::ILOADW:
+                case ir::InstType::ILOADS:
+                case ir::InstType::ILOADL:
+                    ty = inst->to->get_type();
+                    break;
+                case ir::InstType::ISTOREW:
+                case ir::InstType::ISTORES:
+                case ir::InstType::ISTOREL:
+                    if (i != 1) { // address is stored
+                        return false;
+                    }
+                    ty = inst->arg[0]->get_type();
+                    break;
+                case ir::InstType::IADD:
+                case ir::InstType::ICOPY:
+                    if (inst->to == nullptr || !is_derived(inst->to)) {
+                        return false;
+                    }
+                    continue;
+                default:
+                    return false;
+                }
+
+                int elm_size = ty == ir::Type::L ? 8 : 4;
+                if (offset < 0 || offset + elm_size > size ||
+                    offset % elm_size != 0) {
+                    return false;
+                }
+                if (auto [it, ok] = elements.insert({offset, ty});
+                    !ok && it->second != ty) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // elements must not overlap
+    int end = 0;
+    for (auto [offset, ty] : elements) {
+        if (offset < end) {
+            return false;
+        }
+        end = offset + (ty == ir::Type::L ? 8 : 4);
+    }
+
+    std::unordered_map<int, ir::TempPtr> scalars;
+    auto &scalar_allocs = _replaced[alloc_inst];
+    for (auto [offset, ty] : elements) {
+        auto inst = ty == ir::Type::L
+                        ? ir::Inst::create(ir::InstType::IALLOC8, ir::Type::L,
+                                           ir::ConstBits::get(8), nullptr)
+                        : ir::Inst::create(ir::InstType::IALLOC4, ir::Type::L,
+                                           ir::ConstBits::get(4), nullptr);
+        inst->to->id = func.temp_counter++;
+        scalars[offset] = inst->to;
+        scalar_allocs.push_back(inst);
+    }
+
+    for (auto [temp, offset] : offsets) {
+        auto users = _users.find(temp);
+        if (users == _users.end()) {
+            continue;
+        }
+        for (auto inst : users->second) {
+            if (inst->to && is_derived(inst->to)) {
+                _removed.insert(inst); // address is no longer needed
+                continue;
+            }
+            for (int i = 0; i < 2; i++) {
+                if (inst->arg[i] == temp) {
+                    inst->arg[i] = scalars.at(offset);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool opt::ScalarReplacementPass::_fill_offsets(ir::InstPtr alloc_inst,
+                                               OffsetMap &offsets) {
+    // find addresses derived from the alloca by adding constants, following
+    // the uses from the alloca
+    offsets[alloc_inst->to] = 0;
+    std::vector<ir::TempPtr> worklist = {alloc_inst->to};
+    while (!worklist.empty()) {
+        auto temp = worklist.back();
+        worklist.pop_back();
+
+        // an address redefined elsewhere is unknown
+        if (_def_count[temp] != 1) {
+            return false;
+        }
+
+        auto users = _users.find(temp);
+        if (users == _users.end()) {
+            continue;
+        }
+        for (auto inst : users->second) {
+            if (inst->to == nullptr || offsets.count(inst->to)) {
+                continue;
+            }
+
+            int offset = 0;
+            if (inst->insttype == ir::InstType::IADD) {
+                auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(
+                    inst->arg[inst->arg[0] == temp ? 1 : 0]);
+                if (constbits == nullptr ||
+                    !std::holds_alternative<int>(constbits->value)) {
+                    continue;
+                }
+                offset = std::get<int>(constbits->value);
+            } else if (inst->insttype != ir::InstType::ICOPY) {
+                continue;
+            }
+
+            offsets[inst->to] = offsets.at(temp) + offset;
+            worklist.push_back(inst->to);
+        }
+    }
+    return true;
+}
+
 bool opt::PhiInsertingPass::run_on_function(ir::Function &func) {
     for (auto temp : func.temps_in_func) {
         std::unordered_set<ir::BlockPtr> temp_def_blocks;
@@ -178,8 +402,12 @@ void opt::VariableRenamingPass::_dom_tree_preorder_traversal(
         for (int i = 0; i < 2; i++)
             if (auto temp = std::dynamic_pointer_cast<ir::Temp>(inst->arg[i])) {
                 if (rename_stack.at(temp).empty()) {
-                    // throw std::runtime_error("use before def");
-                    continue; // TODO: maybe wrong
+                    // a variable read before it is ever stored, like `x` in
+                    // `int x; return x;`, is undefined and read as zero
+                    inst->arg[i] = temp->get_type() == ir::Type::S
+                                       ? ir::ConstBits::get(0.0f)
+                                       : ir::ConstBits::get(0);
+                    continue;
                 }
                 inst->arg[i] = rename_stack.at(temp).top();
             }
@@ -1,8 +1,9 @@
 /* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton implementation for Bison GLR parsers in C
+/* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 2002-2015, 2018-2021 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -30,12 +31,20 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* C GLR parser skeleton written by Paul Hilfinger.  */
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
 
 /* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
    especially those whose name start with YY_ or yy_.  They are
    private implementation details that can be changed or removed.  */
 
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
 /* Identify Bison output, and Bison version.  */
 #define YYBISON 30802
 
@@ -43,12 +52,16 @@
 #define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
-#define YYSKELETON_NAME "glr.c"
+#define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
 #define YYPURE 0
 
+/* Push parsers.  */
+#define YYPUSH 0
 
+/* Pull parsers.  */
+#define YYPULL 1
 
 
 
@@ -76,7 +89,6 @@
 # endif
 
 #include "parser.h"
-
 /* Symbol kind.  */
 enum yysymbol_kind_t
 {
@@ -135,43 +147,36 @@ enum yysymbol_kind_t
   YYSYMBOL_InitVal = 51,                   /* InitVal  */
   YYSYMBOL_InitVals = 52,                  /* InitVals  */
   YYSYMBOL_BType = 53,                     /* BType  */
-  YYSYMBOL_FuncType = 54,                  /* FuncType  */
-  YYSYMBOL_Dims = 55,                      /* Dims  */
-  YYSYMBOL_FuncDims = 56,                  /* FuncDims  */
-  YYSYMBOL_FuncDef = 57,                   /* FuncDef  */
-  YYSYMBOL_FuncFParams = 58,               /* FuncFParams  */
-  YYSYMBOL_FuncFParam = 59,                /* FuncFParam  */
-  YYSYMBOL_Block = 60,                     /* Block  */
-  YYSYMBOL_BlockItems = 61,                /* BlockItems  */
-  YYSYMBOL_BlockItem = 62,                 /* BlockItem  */
-  YYSYMBOL_Stmt = 63,                      /* Stmt  */
-  YYSYMBOL_Exp = 64,                       /* Exp  */
-  YYSYMBOL_Cond = 65,                      /* Cond  */
-  YYSYMBOL_LVal = 66,                      /* LVal  */
-  YYSYMBOL_PrimaryExp = 67,                /* PrimaryExp  */
-  YYSYMBOL_Number = 68,                    /* Number  */
-  YYSYMBOL_UnaryExp = 69,                  /* UnaryExp  */
-  YYSYMBOL_FuncRParams = 70,               /* FuncRParams  */
-  YYSYMBOL_MulExp = 71,                    /* MulExp  */
-  YYSYMBOL_AddExp = 72,                    /* AddExp  */
-  YYSYMBOL_RelExp = 73,                    /* RelExp  */
-  YYSYMBOL_EqExp = 74,                     /* EqExp  */
-  YYSYMBOL_LAndExp = 75,                   /* LAndExp  */
-  YYSYMBOL_LOrExp = 76,                    /* LOrExp  */
-  YYSYMBOL_ConstExp = 77                   /* ConstExp  */
+  YYSYMBOL_Dims = 54,                      /* Dims  */
+  YYSYMBOL_FuncDims = 55,                  /* FuncDims  */
+  YYSYMBOL_FuncDef = 56,                   /* FuncDef  */
+  YYSYMBOL_FuncFParams = 57,               /* FuncFParams  */
+  YYSYMBOL_FuncFParam = 58,                /* FuncFParam  */
+  YYSYMBOL_Block = 59,                     /* Block  */
+  YYSYMBOL_BlockItems = 60,                /* BlockItems  */
+  YYSYMBOL_BlockItem = 61,                 /* BlockItem  */
+  YYSYMBOL_Stmt = 62,                      /* Stmt  */
+  YYSYMBOL_Exp = 63,                       /* Exp  */
+  YYSYMBOL_Cond = 64,                      /* Cond  */
+  YYSYMBOL_LVal = 65,                      /* LVal  */
+  YYSYMBOL_PrimaryExp = 66,                /* PrimaryExp  */
+  YYSYMBOL_Number = 67,                    /* Number  */
+  YYSYMBOL_UnaryExp = 68,                  /* UnaryExp  */
+  YYSYMBOL_FuncRParams = 69,               /* FuncRParams  */
+  YYSYMBOL_MulExp = 70,                    /* MulExp  */
+  YYSYMBOL_AddExp = 71,                    /* AddExp  */
+  YYSYMBOL_RelExp = 72,                    /* RelExp  */
+  YYSYMBOL_EqExp = 73,                     /* EqExp  */
+  YYSYMBOL_LAndExp = 74,                   /* LAndExp  */
+  YYSYMBOL_LOrExp = 75,                    /* LOrExp  */
+  YYSYMBOL_ConstExp = 76                   /* ConstExp  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
-/* Default (constant) value used for initialization for null
-   right-hand sides.  Unlike the standard yacc.c template, here we set
-   the default value of $$ to a zeroed-out value.  Since the default
-   value is undefined, this behavior is technically correct.  */
-static YYSTYPE yyval_default;
-
 
 /* Unqualified %code blocks.  */
-#line 12 "parser.y"
+#line 10 "parser.y"
 
     #include <vector>
     #include <string>
@@ -186,18 +191,17 @@ static YYSTYPE yyval_default;
 
     template <typename P, typename T>
     P* ptr2variant(T *ptr) {
-        auto rt = new P(*ptr);
+        auto rt = new P(std::move(*ptr));
         delete ptr;
         return rt;
     }
 
-#line 195 "src/parser.cpp"
+    /* copy the identifier interned by the scanner */
+    Ident to_ident(const std::string *ident) {
+        return *ident;
+    }
 
-#include <stddef.h>
-#include <stdint.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#line 205 "src/parser.cpp"
 
 #ifdef short
 # undef short
@@ -269,6 +273,7 @@ typedef unsigned short yytype_uint16;
 #else
 typedef int yytype_uint16;
 #endif
+
 #ifndef YYPTRDIFF_T
 # if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
 #  define YYPTRDIFF_T __PTRDIFF_TYPE__
@@ -307,6 +312,12 @@ typedef int yytype_uint16;
 #define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
 
 
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
@@ -320,39 +331,6 @@ typedef int yytype_uint16;
 #endif
 
 
-#ifndef YYFREE
-# define YYFREE free
-#endif
-#ifndef YYMALLOC
-# define YYMALLOC malloc
-#endif
-#ifndef YYREALLOC
-# define YYREALLOC realloc
-#endif
-
-#ifdef __cplusplus
-  typedef bool yybool;
-# define yytrue true
-# define yyfalse false
-#else
-  /* When we move to stdbool, get rid of the various casts to yybool.  */
-  typedef signed char yybool;
-# define yytrue 1
-# define yyfalse 0
-#endif
-
-#ifndef YYSETJMP
-# include <setjmp.h>
-# define YYJMP_BUF jmp_buf
-# define YYSETJMP(Env) setjmp (Env)
-/* Pacify Clang and ICC.  */
-# define YYLONGJMP(Env, Val)                    \
- do {                                           \
-   longjmp (Env, Val);                          \
-   YY_ASSERT (0);                               \
- } while (yyfalse)
-#endif
-
 #ifndef YY_ATTRIBUTE_PURE
 # if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
 #  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
@@ -369,30 +347,6 @@ typedef int yytype_uint16;
 # endif
 #endif
 
-/* The _Noreturn keyword of C11.  */
-#ifndef _Noreturn
-# if (defined __cplusplus \
-      && ((201103 <= __cplusplus && !(__GNUC__ == 4 && __GNUC_MINOR__ == 7)) \
-          || (defined _MSC_VER && 1900 <= _MSC_VER)))
-#  define _Noreturn [[noreturn]]
-# elif ((!defined __cplusplus || defined __clang__) \
-        && (201112 <= (defined __STDC_VERSION__ ? __STDC_VERSION__ : 0) \
-            || (!defined __STRICT_ANSI__ \
-                && (4 < __GNUC__ + (7 <= __GNUC_MINOR__) \
-                    || (defined __apple_build_version__ \
-                        ? 6000000 <= __apple_build_version__ \
-                        : 3 < __clang_major__ + (5 <= __clang_minor__))))))
-   /* _Noreturn works as-is.  */
-# elif (2 < __GNUC__ + (8 <= __GNUC_MINOR__) || defined __clang__ \
-        || 0x5110 <= __SUNPRO_C)
-#  define _Noreturn __attribute__ ((__noreturn__))
-# elif 1200 <= (defined _MSC_VER ? _MSC_VER : 0)
-#  define _Noreturn __declspec (noreturn)
-# else
-#  define _Noreturn
-# endif
-#endif
-
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
 # define YY_USE(E) ((void) (E))
@@ -440,28 +394,151 @@ typedef int yytype_uint16;
 
 #define YY_ASSERT(E) ((void) (0 && (E)))
 
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  16
+#define YYFINAL  14
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   223
+#define YYLAST   230
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  39
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  39
+#define YYNNTS  38
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  94
+#define YYNRULES  93
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  167
-/* YYMAXRHS -- Maximum number of symbols on right-hand side of rule.  */
-#define YYMAXRHS 7
-/* YYMAXLEFT -- Maximum number of symbols to the left of a handle
-   accessed by $0, $-1, etc., in any rule.  */
-#define YYMAXLEFT 0
+#define YYNSTATES  172
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   276
 
+
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
 #define YYTRANSLATE(YYX)                                \
@@ -504,46 +581,87 @@ static const yytype_int8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   114,   114,   115,   118,   119,   122,   123,   126,   129,
-     132,   133,   136,   137,   140,   143,   144,   147,   148,   149,
-     152,   153,   156,   157,   158,   161,   162,   165,   166,   169,
-     170,   171,   174,   175,   178,   179,   182,   183,   186,   187,
-     190,   191,   194,   197,   198,   201,   202,   205,   206,   207,
-     208,   209,   210,   211,   212,   213,   214,   215,   218,   221,
-     224,   225,   228,   229,   230,   233,   234,   237,   238,   239,
-     240,   241,   242,   245,   246,   249,   250,   251,   252,   255,
-     256,   257,   260,   261,   262,   263,   264,   267,   268,   269,
-     272,   273,   276,   277,   280
+       0,   116,   116,   117,   120,   121,   124,   125,   128,   131,
+     134,   135,   138,   139,   142,   145,   146,   149,   150,   151,
+     154,   155,   158,   159,   160,   163,   164,   167,   168,   171,
+     172,   175,   176,   181,   182,   183,   184,   187,   188,   191,
+     192,   195,   198,   199,   202,   203,   206,   207,   208,   209,
+     210,   211,   212,   213,   214,   215,   216,   219,   222,   225,
+     226,   229,   230,   231,   234,   235,   238,   239,   240,   241,
+     242,   243,   246,   247,   250,   251,   252,   253,   256,   257,
+     258,   261,   262,   263,   264,   265,   268,   269,   270,   273,
+     274,   277,   278,   281
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "IDENT", "INT_CONST",
+  "FLOAT_CONST", "\"const\"", "\"int\"", "\"float\"", "\"void\"", "\"if\"",
+  "\"else\"", "\"while\"", "\"break\"", "\"continue\"", "\"return\"",
+  "\">=\"", "\"<=\"", "\"==\"", "\"!=\"", "\"&&\"", "\"||\"", "')'", "';'",
+  "','", "'='", "'{'", "'}'", "'['", "']'", "'('", "'+'", "'-'", "'!'",
+  "'*'", "'/'", "'%'", "'<'", "'>'", "$accept", "CompUnits", "CompUnit",
+  "Decl", "ConstDecl", "VarDecl", "ConstDefs", "VarDefs", "ConstDef",
+  "VarDef", "ConstInitVal", "ConstInitVals", "InitVal", "InitVals",
+  "BType", "Dims", "FuncDims", "FuncDef", "FuncFParams", "FuncFParam",
+  "Block", "BlockItems", "BlockItem", "Stmt", "Exp", "Cond", "LVal",
+  "PrimaryExp", "Number", "UnaryExp", "FuncRParams", "MulExp", "AddExp",
+  "RelExp", "EqExp", "LAndExp", "LOrExp", "ConstExp", YY_NULLPTR
 };
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
 #endif
 
-#define YYPACT_NINF (-80)
-#define YYTABLE_NINF (-29)
+#define YYPACT_NINF (-142)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      52,    14,     4,     9,   -80,    11,   -80,   -80,   -80,   -80,
-      13,    34,   -80,   -80,   -80,    38,   -80,   -80,   -80,    32,
-     -80,    15,   -80,    79,   -80,    98,   -80,    13,    41,   100,
-     -80,    38,   141,    78,   -80,    40,    70,   154,   -80,   149,
-     -80,    50,   -80,   -80,    74,    78,    78,    78,    78,   -80,
-     -80,    66,   -80,   -80,   -80,   134,   127,   127,    95,   -80,
-     -80,   109,    40,    14,   130,   -80,   -80,    65,   -80,   -80,
-     112,   120,   -80,   -80,   -80,    78,    78,    78,    78,    78,
-      78,   -80,    20,   122,   162,   -80,   -80,   -80,   -80,   114,
-     -80,   -80,   163,   141,   -80,   -80,   126,   -80,   -80,   -80,
-     134,   134,   147,   169,   177,   178,   161,   -80,   -80,   -80,
-     -80,   -80,   -80,   179,   158,   -80,    78,   149,   -80,   -80,
-      78,   -80,   -80,    78,    78,   -80,   -80,   -80,   180,   -80,
-      78,   175,   -80,   -80,   183,   127,    55,   170,   186,   187,
-     185,   -80,   188,   -80,   117,    78,    78,    78,    78,    78,
-      78,    78,    78,   117,   -80,   198,   127,   127,   127,   127,
-      55,    55,   170,   186,   -80,   117,   -80
+      14,     8,  -142,  -142,    31,    84,  -142,  -142,  -142,  -142,
+      44,  -142,    48,    56,  -142,  -142,    64,    79,  -142,  -142,
+      83,  -142,    17,    50,    40,  -142,    74,    45,  -142,    48,
+      86,   152,    47,  -142,    86,    54,   149,   180,  -142,  -142,
+     162,  -142,  -142,  -142,   128,    86,     8,  -142,    86,   129,
+    -142,  -142,    78,   180,   180,   180,   180,  -142,  -142,   132,
+    -142,  -142,  -142,    25,     9,     9,   139,   131,  -142,  -142,
+     118,   140,   145,  -142,  -142,  -142,   167,  -142,  -142,    71,
+     164,  -142,  -142,  -142,   180,   180,   180,   180,   180,   180,
+    -142,  -142,  -142,    72,   144,   157,   168,   178,   173,  -142,
+    -142,  -142,    74,  -142,  -142,  -142,   179,   112,  -142,   180,
+    -142,  -142,   105,   149,  -142,  -142,   161,  -142,  -142,  -142,
+      25,    25,   162,  -142,   180,   180,  -142,  -142,  -142,   184,
+    -142,   180,   185,  -142,   180,  -142,  -142,  -142,   186,     9,
+      -6,   120,   189,   194,   195,  -142,   193,  -142,  -142,    23,
+     180,   180,   180,   180,   180,   180,   180,   180,    23,  -142,
+     207,     9,     9,     9,     9,    -6,    -6,   120,   189,  -142,
+      23,  -142
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -551,98 +669,101 @@ static const yytype_int16 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,     0,    27,    28,    29,     0,     2,     4,     6,     7,
-       0,     0,     5,    27,    28,     0,     1,     3,    32,     0,
-      12,     0,    32,     0,    10,    15,     9,     0,     0,     0,
-       8,     0,     0,     0,    13,     0,     0,     0,    38,     0,
-      11,    60,    65,    66,     0,     0,     0,     0,     0,    16,
-      22,    63,    67,    64,    75,    79,    58,    94,     0,    43,
-      36,    40,     0,     0,     0,    14,    17,     0,    23,    25,
-       0,     0,    70,    71,    72,     0,     0,     0,     0,     0,
-       0,    33,     0,     0,    41,    37,    39,    18,    20,     0,
-      68,    73,     0,     0,    24,    62,     0,    76,    77,    78,
-      80,    81,     0,     0,     0,     0,     0,    49,    42,    45,
-      50,    44,    46,     0,    63,    34,     0,     0,    19,    69,
-       0,    26,    61,     0,     0,    54,    55,    56,     0,    48,
-       0,     0,    21,    74,     0,    82,    87,    90,    92,    59,
-       0,    57,     0,    35,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,    47,    51,    86,    85,    83,    84,
-      88,    89,    91,    93,    53,     0,    52
+       0,     0,    27,    28,     0,     0,     2,     4,     6,     7,
+       0,     5,     0,     0,     1,     3,    29,     0,    12,    29,
+       0,    10,     0,     0,    15,     9,     0,     0,     8,     0,
+       0,     0,     0,    37,     0,     0,     0,     0,    29,    13,
+       0,    11,    42,    35,    39,     0,     0,    33,     0,    59,
+      64,    65,     0,     0,     0,     0,     0,    16,    22,    62,
+      66,    63,    74,    78,    57,    93,     0,     0,    14,    17,
+       0,     0,    40,    36,    38,    34,     0,    23,    25,     0,
+       0,    69,    70,    71,     0,     0,     0,     0,     0,     0,
+      30,    18,    20,     0,     0,     0,     0,     0,     0,    48,
+      41,    44,     0,    49,    43,    45,     0,    62,    31,     0,
+      67,    72,     0,     0,    24,    61,     0,    75,    76,    77,
+      79,    80,     0,    19,     0,     0,    53,    54,    55,     0,
+      47,     0,     0,    68,     0,    26,    60,    21,     0,    81,
+      86,    89,    91,    58,     0,    56,     0,    32,    73,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    46,
+      50,    85,    84,    82,    83,    87,    88,    90,    92,    52,
+       0,    51
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -80,   -80,   205,   131,   -80,   -80,   -80,   -80,   181,   189,
-     -60,   -80,   -39,   -80,     1,   -80,   192,   -80,   -80,   -80,
-     152,   -20,   -80,   -80,   -77,   -31,    93,   -79,   -80,   -80,
-     -38,   -80,   116,   -33,    48,    67,    68,   -80,   190
+    -142,  -142,   214,   150,  -142,  -142,  -142,  -142,   192,   196,
+     -60,  -142,   -46,  -142,     4,   204,  -142,  -142,   201,   181,
+      18,  -142,  -142,  -141,   -34,   100,   -69,  -142,  -142,   -42,
+    -142,    58,   -37,   -12,    70,    73,  -142,   191
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_uint8 yydefgoto[] =
 {
-       0,     5,     6,     7,     8,     9,    23,    19,    24,    20,
-      65,    89,    49,    70,    10,    11,    25,    84,    12,    37,
-      38,   110,    82,   111,   112,   113,   134,    51,    52,    53,
-      54,    92,    55,    56,   136,   137,   138,   139,    66
+       0,     5,     6,     7,     8,     9,    20,    17,    21,    18,
+      68,    93,    57,    79,    31,    24,    72,    11,    32,    33,
+     103,    70,   104,   105,   106,   138,    59,    60,    61,    62,
+     112,    63,    64,   140,   141,   142,   143,    69
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
    positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_int16 yytable[] =
-{
-      57,    50,    15,   114,    88,    69,    57,   -27,    72,    73,
-      74,    16,   -28,    50,    71,    60,    18,     1,     2,     3,
-       4,    13,    14,    41,    42,    43,     1,    13,    14,    36,
-     102,    57,   103,   104,   105,   106,    91,    21,    97,    98,
-      99,    22,    85,   107,    96,    28,    59,   108,    13,    14,
-      45,    46,    47,    48,   121,    26,    27,   132,     1,     2,
-       3,     4,    50,    35,    36,   114,    59,   155,    41,    42,
-      43,   145,   146,    61,   114,   128,   164,    41,    42,    43,
-      67,    41,    42,    43,    57,   131,   114,    90,   166,   133,
-     135,   135,   147,   148,    75,    45,    46,    47,    48,   142,
-      44,    68,    30,    31,    45,    46,    47,    48,    45,    46,
-      47,    48,   156,   157,   158,   159,   135,   135,   135,   135,
-      41,    42,    43,    32,    81,    39,    33,   102,    33,   103,
-     104,   105,   106,    41,    42,    43,    93,    83,   117,    94,
-     107,   118,    95,    59,    41,    42,    43,    45,    46,    47,
-      48,   115,    41,    42,    43,   122,    64,    87,    79,    80,
-      45,    46,    47,    48,    41,    42,    43,    44,    76,    77,
-      78,    45,    46,    47,    48,    64,    62,   123,    63,    45,
-      46,    47,    48,   130,   127,   119,    75,   120,   149,   150,
-     116,    45,    46,    47,    48,   100,   101,   160,   161,   124,
-     125,   126,   129,   141,   143,   144,   151,   153,   152,   165,
-      17,   154,    40,   109,    29,    86,    34,   140,   162,     0,
-     163,     0,     0,    58
+static const yytype_uint8 yytable[] =
+{
+      65,   107,    58,    65,    10,    12,    78,    92,   160,    10,
+     150,   151,    81,    82,    83,     2,     3,   169,    58,    80,
+       1,     2,     3,     4,     2,     3,    49,    50,    51,   171,
+      65,   152,   153,    94,    13,    95,    96,    97,    98,    30,
+      88,    89,   111,   117,   118,   119,    99,    16,    43,    42,
+     116,    19,    47,    53,    54,    55,    56,     2,     3,    85,
+      86,    87,   137,    73,   129,    36,    75,   135,    37,    45,
+      40,    46,    34,    37,   102,   132,    48,    38,    46,    58,
+     107,    49,    50,    51,    14,    65,    22,   139,   139,   107,
+       1,     2,     3,     4,    23,   113,   122,   146,   114,   123,
+     148,   107,    25,    26,    52,    77,    28,    29,    53,    54,
+      55,    56,    42,   161,   162,   163,   164,   139,   139,   139,
+     139,    49,    50,    51,     1,     2,     3,   133,    94,   134,
+      95,    96,    97,    98,    49,    50,    51,   131,   154,   155,
+      84,    99,   165,   166,    42,   100,   120,   121,    53,    54,
+      55,    56,    49,    50,    51,    44,    71,    67,    91,    76,
+      84,    53,    54,    55,    56,    49,    50,    51,    90,   108,
+      49,    50,    51,   109,   124,    52,    49,    50,    51,    53,
+      54,    55,    56,    49,    50,    51,   115,   125,    67,   110,
+     136,   126,    53,    54,    55,    56,   128,    53,    54,    55,
+      56,   127,   130,    53,    54,    55,    56,   145,   149,   156,
+      53,    54,    55,    56,   147,   157,   159,   158,   170,    15,
+     101,    41,    39,    27,    35,   144,   167,    74,    66,     0,
+     168
 };
 
 static const yytype_int16 yycheck[] =
 {
-      33,    32,     1,    82,    64,    44,    39,     3,    46,    47,
-      48,     0,     3,    44,    45,    35,     3,     6,     7,     8,
-       9,     7,     8,     3,     4,     5,     6,     7,     8,    28,
-      10,    64,    12,    13,    14,    15,    67,     3,    76,    77,
-      78,     3,    62,    23,    75,    30,    26,    27,     7,     8,
-      30,    31,    32,    33,    93,    23,    24,   117,     6,     7,
-       8,     9,    93,    22,    63,   144,    26,   144,     3,     4,
-       5,    16,    17,     3,   153,   106,   153,     3,     4,     5,
-      30,     3,     4,     5,   117,   116,   165,    22,   165,   120,
-     123,   124,    37,    38,    28,    30,    31,    32,    33,   130,
-      26,    27,    23,    24,    30,    31,    32,    33,    30,    31,
-      32,    33,   145,   146,   147,   148,   149,   150,   151,   152,
-       3,     4,     5,    25,    29,    25,    28,    10,    28,    12,
-      13,    14,    15,     3,     4,     5,    24,    28,    24,    27,
-      23,    27,    22,    26,     3,     4,     5,    30,    31,    32,
-      33,    29,     3,     4,     5,    29,    26,    27,    31,    32,
-      30,    31,    32,    33,     3,     4,     5,    26,    34,    35,
-      36,    30,    31,    32,    33,    26,    22,    30,    24,    30,
-      31,    32,    33,    25,    23,    22,    28,    24,    18,    19,
-      28,    30,    31,    32,    33,    79,    80,   149,   150,    30,
-      23,    23,    23,    23,    29,    22,    20,    22,    21,    11,
-       5,    23,    31,    82,    22,    63,    27,   124,   151,    -1,
-     152,    -1,    -1,    33
+      37,    70,    36,    40,     0,     1,    52,    67,   149,     5,
+      16,    17,    54,    55,    56,     7,     8,   158,    52,    53,
+       6,     7,     8,     9,     7,     8,     3,     4,     5,   170,
+      67,    37,    38,    10,     3,    12,    13,    14,    15,    22,
+      31,    32,    76,    85,    86,    87,    23,     3,    30,    26,
+      84,     3,    34,    30,    31,    32,    33,     7,     8,    34,
+      35,    36,   122,    45,    98,    25,    48,   113,    28,    22,
+      25,    24,    22,    28,    70,   109,    22,     3,    24,   113,
+     149,     3,     4,     5,     0,   122,    30,   124,   125,   158,
+       6,     7,     8,     9,    30,    24,    24,   131,    27,    27,
+     134,   170,    23,    24,    26,    27,    23,    24,    30,    31,
+      32,    33,    26,   150,   151,   152,   153,   154,   155,   156,
+     157,     3,     4,     5,     6,     7,     8,    22,    10,    24,
+      12,    13,    14,    15,     3,     4,     5,    25,    18,    19,
+      28,    23,   154,   155,    26,    27,    88,    89,    30,    31,
+      32,    33,     3,     4,     5,     3,    28,    26,    27,    30,
+      28,    30,    31,    32,    33,     3,     4,     5,    29,    29,
+       3,     4,     5,    28,    30,    26,     3,     4,     5,    30,
+      31,    32,    33,     3,     4,     5,    22,    30,    26,    22,
+      29,    23,    30,    31,    32,    33,    23,    30,    31,    32,
+      33,    23,    23,    30,    31,    32,    33,    23,    22,    20,
+      30,    31,    32,    33,    29,    21,    23,    22,    11,     5,
+      70,    29,    26,    19,    23,   125,   156,    46,    37,    -1,
+     157
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -650,22 +771,23 @@ static const yytype_int16 yycheck[] =
 static const yytype_int8 yystos[] =
 {
        0,     6,     7,     8,     9,    40,    41,    42,    43,    44,
-      53,    54,    57,     7,     8,    53,     0,    41,     3,    46,
-      48,     3,     3,    45,    47,    55,    23,    24,    30,    55,
-      23,    24,    25,    28,    48,    22,    53,    58,    59,    25,
-      47,     3,     4,     5,    26,    30,    31,    32,    33,    51,
-      64,    66,    67,    68,    69,    71,    72,    72,    77,    26,
-      60,     3,    22,    24,    26,    49,    77,    30,    27,    51,
-      52,    64,    69,    69,    69,    28,    34,    35,    36,    31,
-      32,    29,    61,    28,    56,    60,    59,    27,    49,    50,
-      22,    64,    70,    24,    27,    22,    64,    69,    69,    69,
-      71,    71,    10,    12,    13,    14,    15,    23,    27,    42,
-      60,    62,    63,    64,    66,    29,    28,    24,    27,    22,
-      24,    51,    29,    30,    30,    23,    23,    23,    64,    23,
-      25,    64,    49,    64,    65,    72,    73,    74,    75,    76,
-      65,    23,    64,    29,    22,    16,    17,    37,    38,    18,
-      19,    20,    21,    22,    23,    63,    72,    72,    72,    72,
-      73,    73,    74,    75,    63,    11,    63
+      53,    56,    53,     3,     0,    41,     3,    46,    48,     3,
+      45,    47,    30,    30,    54,    23,    24,    54,    23,    24,
+      22,    53,    57,    58,    22,    57,    25,    28,     3,    48,
+      25,    47,    26,    59,     3,    22,    24,    59,    22,     3,
+       4,     5,    26,    30,    31,    32,    33,    51,    63,    65,
+      66,    67,    68,    70,    71,    71,    76,    26,    49,    76,
+      60,    28,    55,    59,    58,    59,    30,    27,    51,    52,
+      63,    68,    68,    68,    28,    34,    35,    36,    31,    32,
+      29,    27,    49,    50,    10,    12,    13,    14,    15,    23,
+      27,    42,    53,    59,    61,    62,    63,    65,    29,    28,
+      22,    63,    69,    24,    27,    22,    63,    68,    68,    68,
+      70,    70,    24,    27,    30,    30,    23,    23,    23,    63,
+      23,    25,    63,    22,    24,    51,    29,    49,    64,    71,
+      72,    73,    74,    75,    64,    23,    63,    29,    63,    22,
+      16,    17,    37,    38,    18,    19,    20,    21,    22,    23,
+      62,    71,    71,    71,    71,    72,    72,    73,    74,    62,
+      11,    62
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
@@ -674,13 +796,13 @@ static const yytype_int8 yyr1[] =
        0,    39,    40,    40,    41,    41,    42,    42,    43,    44,
       45,    45,    46,    46,    47,    48,    48,    49,    49,    49,
       50,    50,    51,    51,    51,    52,    52,    53,    53,    54,
-      54,    54,    55,    55,    56,    56,    57,    57,    58,    58,
-      59,    59,    60,    61,    61,    62,    62,    63,    63,    63,
-      63,    63,    63,    63,    63,    63,    63,    63,    64,    65,
-      66,    66,    67,    67,    67,    68,    68,    69,    69,    69,
-      69,    69,    69,    70,    70,    71,    71,    71,    71,    72,
-      72,    72,    73,    73,    73,    73,    73,    74,    74,    74,
-      75,    75,    76,    76,    77
+      54,    55,    55,    56,    56,    56,    56,    57,    57,    58,
+      58,    59,    60,    60,    61,    61,    62,    62,    62,    62,
+      62,    62,    62,    62,    62,    62,    62,    63,    64,    65,
+      65,    66,    66,    66,    67,    67,    68,    68,    68,    68,
+      68,    68,    69,    69,    70,    70,    70,    70,    71,    71,
+      71,    72,    72,    72,    72,    72,    73,    73,    73,    74,
+      74,    75,    75,    76
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
@@ -688,335 +810,79 @@ static const yytype_int8 yyr2[] =
 {
        0,     2,     1,     2,     1,     1,     1,     1,     4,     3,
        1,     3,     1,     3,     4,     2,     4,     1,     2,     3,
-       1,     3,     1,     2,     3,     1,     3,     1,     1,     1,
-       1,     1,     0,     4,     2,     4,     5,     6,     1,     3,
-       2,     3,     3,     0,     2,     1,     1,     4,     2,     1,
-       1,     5,     7,     5,     2,     2,     2,     3,     1,     1,
-       1,     4,     3,     1,     1,     1,     1,     1,     3,     4,
-       2,     2,     2,     1,     3,     1,     3,     3,     3,     1,
-       3,     3,     1,     3,     3,     3,     3,     1,     3,     3,
-       1,     3,     1,     3,     1
-};
-
-
-/* YYDPREC[RULE-NUM] -- Dynamic precedence of rule #RULE-NUM (0 if none).  */
-static const yytype_int8 yydprec[] =
-{
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0
-};
-
-/* YYMERGER[RULE-NUM] -- Index of merging function for rule #RULE-NUM.  */
-static const yytype_int8 yymerger[] =
-{
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0
-};
-
-/* YYIMMEDIATE[RULE-NUM] -- True iff rule #RULE-NUM is not to be deferred, as
-   in the case of predicates.  */
-static const yybool yyimmediate[] =
-{
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0
-};
-
-/* YYCONFLP[YYPACT[STATE-NUM]] -- Pointer into YYCONFL of start of
-   list of conflicting reductions corresponding to action entry for
-   state STATE-NUM in yytable.  0 means no conflicts.  The list in
-   yyconfl is terminated by a rule number of 0.  */
-static const yytype_int8 yyconflp[] =
-{
-       0,     0,     0,     0,     0,     0,     0,     1,     0,     0,
-       0,     0,     3,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0
-};
-
-/* YYCONFL[I] -- lists of conflicting rule numbers, each terminated by
-   0, pointed into by YYCONFLP.  */
-static const short yyconfl[] =
-{
-       0,    30,     0,    31,     0
+       1,     3,     1,     2,     3,     1,     3,     1,     1,     0,
+       4,     2,     4,     5,     6,     5,     6,     1,     3,     2,
+       3,     3,     0,     2,     1,     1,     4,     2,     1,     1,
+       5,     7,     5,     2,     2,     2,     3,     1,     1,     1,
+       4,     3,     1,     1,     1,     1,     1,     3,     4,     2,
+       2,     2,     1,     3,     1,     3,     3,     3,     1,     3,
+       3,     1,     3,     3,     3,     3,     1,     3,     3,     1,
+       3,     1,     3,     1
 };
 
 
-
-YYSTYPE yylval;
-
-int yynerrs;
-int yychar;
-
 enum { YYENOMEM = -2 };
 
-typedef enum { yyok, yyaccept, yyabort, yyerr, yynomem } YYRESULTTAG;
-
-#define YYCHK(YYE)                              \
-  do {                                          \
-    YYRESULTTAG yychk_flag = YYE;               \
-    if (yychk_flag != yyok)                     \
-      return yychk_flag;                        \
-  } while (0)
-
-/* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef YYINITDEPTH
-# define YYINITDEPTH 200
-#endif
-
-/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
-   if the built-in stack extension method is used).
-
-   Do not make this value too large; the results are undefined if
-   SIZE_MAX < YYMAXDEPTH * sizeof (GLRStackItem)
-   evaluated with infinite-precision integer arithmetic.  */
-
-#ifndef YYMAXDEPTH
-# define YYMAXDEPTH 10000
-#endif
-
-/* Minimum number of free items on the stack allowed after an
-   allocation.  This is to allow allocation and initialization
-   to be completed by functions that call yyexpandGLRStack before the
-   stack is expanded, thus insuring that all necessary pointers get
-   properly redirected to new data.  */
-#define YYHEADROOM 2
-
-#ifndef YYSTACKEXPANDABLE
-#  define YYSTACKEXPANDABLE 1
-#endif
-
-#if YYSTACKEXPANDABLE
-# define YY_RESERVE_GLRSTACK(Yystack)                   \
-  do {                                                  \
-    if (Yystack->yyspaceLeft < YYHEADROOM)              \
-      yyexpandGLRStack (Yystack);                       \
-  } while (0)
-#else
-# define YY_RESERVE_GLRSTACK(Yystack)                   \
-  do {                                                  \
-    if (Yystack->yyspaceLeft < YYHEADROOM)              \
-      yyMemoryExhausted (Yystack);                      \
-  } while (0)
-#endif
-
-/** State numbers. */
-typedef int yy_state_t;
-
-/** Rule numbers. */
-typedef int yyRuleNum;
-
-/** Item references. */
-typedef short yyItemNum;
-
-typedef struct yyGLRState yyGLRState;
-typedef struct yyGLRStateSet yyGLRStateSet;
-typedef struct yySemanticOption yySemanticOption;
-typedef union yyGLRStackItem yyGLRStackItem;
-typedef struct yyGLRStack yyGLRStack;
-
-struct yyGLRState
-{
-  /** Type tag: always true.  */
-  yybool yyisState;
-  /** Type tag for yysemantics.  If true, yyval applies, otherwise
-   *  yyfirstVal applies.  */
-  yybool yyresolved;
-  /** Number of corresponding LALR(1) machine state.  */
-  yy_state_t yylrState;
-  /** Preceding state in this stack */
-  yyGLRState* yypred;
-  /** Source position of the last token produced by my symbol */
-  YYPTRDIFF_T yyposn;
-  union {
-    /** First in a chain of alternative reductions producing the
-     *  nonterminal corresponding to this state, threaded through
-     *  yynext.  */
-    yySemanticOption* yyfirstVal;
-    /** Semantic value for this state.  */
-    YYSTYPE yyval;
-  } yysemantics;
-};
-
-struct yyGLRStateSet
-{
-  yyGLRState** yystates;
-  /** During nondeterministic operation, yylookaheadNeeds tracks which
-   *  stacks have actually needed the current lookahead.  During deterministic
-   *  operation, yylookaheadNeeds[0] is not maintained since it would merely
-   *  duplicate yychar != TK_YYEMPTY.  */
-  yybool* yylookaheadNeeds;
-  YYPTRDIFF_T yysize;
-  YYPTRDIFF_T yycapacity;
-};
-
-struct yySemanticOption
-{
-  /** Type tag: always false.  */
-  yybool yyisState;
-  /** Rule number for this reduction */
-  yyRuleNum yyrule;
-  /** The last RHS state in the list of states to be reduced.  */
-  yyGLRState* yystate;
-  /** The lookahead for this reduction.  */
-  int yyrawchar;
-  YYSTYPE yyval;
-  /** Next sibling in chain of options.  To facilitate merging,
-   *  options are chained in decreasing order by address.  */
-  yySemanticOption* yynext;
-};
-
-/** Type of the items in the GLR stack.  The yyisState field
- *  indicates which item of the union is valid.  */
-union yyGLRStackItem {
-  yyGLRState yystate;
-  yySemanticOption yyoption;
-};
-
-struct yyGLRStack {
-  int yyerrState;
-
-
-  YYJMP_BUF yyexception_buffer;
-  yyGLRStackItem* yyitems;
-  yyGLRStackItem* yynextFree;
-  YYPTRDIFF_T yyspaceLeft;
-  yyGLRState* yysplitPoint;
-  yyGLRState* yylastDeleted;
-  yyGLRStateSet yytops;
-};
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = TK_YYEMPTY)
 
-#if YYSTACKEXPANDABLE
-static void yyexpandGLRStack (yyGLRStack* yystackp);
-#endif
-
-_Noreturn static void
-yyFail (yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units, const char* yymsg)
-{
-  if (yymsg != YY_NULLPTR)
-    yyerror (comp_units, yymsg);
-  YYLONGJMP (yystackp->yyexception_buffer, 1);
-}
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-_Noreturn static void
-yyMemoryExhausted (yyGLRStack* yystackp)
-{
-  YYLONGJMP (yystackp->yyexception_buffer, 2);
-}
-
-/** Accessing symbol of state YYSTATE.  */
-static inline yysymbol_kind_t
-yy_accessing_symbol (yy_state_t yystate)
-{
-  return YY_CAST (yysymbol_kind_t, yystos[yystate]);
-}
 
-#if YYDEBUG || 0
-/* The user-facing name of the symbol whose (internal) number is
-   YYSYMBOL.  No bounds checking.  */
-static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+#define YYRECOVERING()  (!!yyerrstatus)
 
-/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
-   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
-static const char *const yytname[] =
-{
-  "\"end of file\"", "error", "\"invalid token\"", "IDENT", "INT_CONST",
-  "FLOAT_CONST", "\"const\"", "\"int\"", "\"float\"", "\"void\"", "\"if\"",
-  "\"else\"", "\"while\"", "\"break\"", "\"continue\"", "\"return\"",
-  "\">=\"", "\"<=\"", "\"==\"", "\"!=\"", "\"&&\"", "\"||\"", "')'", "';'",
-  "','", "'='", "'{'", "'}'", "'['", "']'", "'('", "'+'", "'-'", "'!'",
-  "'*'", "'/'", "'%'", "'<'", "'>'", "$accept", "CompUnits", "CompUnit",
-  "Decl", "ConstDecl", "VarDecl", "ConstDefs", "VarDefs", "ConstDef",
-  "VarDef", "ConstInitVal", "ConstInitVals", "InitVal", "InitVals",
-  "BType", "FuncType", "Dims", "FuncDims", "FuncDef", "FuncFParams",
-  "FuncFParam", "Block", "BlockItems", "BlockItem", "Stmt", "Exp", "Cond",
-  "LVal", "PrimaryExp", "Number", "UnaryExp", "FuncRParams", "MulExp",
-  "AddExp", "RelExp", "EqExp", "LAndExp", "LOrExp", "ConstExp", YY_NULLPTR
-};
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == TK_YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (comp_units, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
 
-static const char *
-yysymbol_name (yysymbol_kind_t yysymbol)
-{
-  return yytname[yysymbol];
-}
-#endif
+/* Backward compatibility with an undocumented macro.
+   Use TK_YYerror or TK_YYUNDEF. */
+#define YYERRCODE TK_YYUNDEF
 
-/** Left-hand-side symbol for rule #YYRULE.  */
-static inline yysymbol_kind_t
-yylhsNonterm (yyRuleNum yyrule)
-{
-  return YY_CAST (yysymbol_kind_t, yyr1[yyrule]);
-}
 
+/* Enable debugging if requested.  */
 #if YYDEBUG
 
 # ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYFPRINTF fprintf
 # endif
 
-# define YY_FPRINTF                             \
-  YY_IGNORE_USELESS_CAST_BEGIN YY_FPRINTF_
-
-# define YY_FPRINTF_(Args)                      \
-  do {                                          \
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
     YYFPRINTF Args;                             \
-    YY_IGNORE_USELESS_CAST_END                  \
-  } while (0)
-
-# define YY_DPRINTF                             \
-  YY_IGNORE_USELESS_CAST_BEGIN YY_DPRINTF_
+} while (0)
 
-# define YY_DPRINTF_(Args)                      \
-  do {                                          \
-    if (yydebug)                                \
-      YYFPRINTF Args;                           \
-    YY_IGNORE_USELESS_CAST_END                  \
-  } while (0)
 
 
 
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, comp_units); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
 
 
 /*-----------------------------------.
@@ -1053,2243 +919,1116 @@ yy_symbol_print (FILE *yyo,
   YYFPRINTF (yyo, ")");
 }
 
-# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                  \
-  do {                                                                  \
-    if (yydebug)                                                        \
-      {                                                                 \
-        YY_FPRINTF ((stderr, "%s ", Title));                            \
-        yy_symbol_print (stderr, Kind, Value, comp_units);        \
-        YY_FPRINTF ((stderr, "\n"));                                    \
-      }                                                                 \
-  } while (0)
-
-static inline void
-yy_reduce_print (yybool yynormal, yyGLRStackItem* yyvsp, YYPTRDIFF_T yyk,
-                 yyRuleNum yyrule, std::shared_ptr<CompUnits> comp_units);
-
-# define YY_REDUCE_PRINT(Args)          \
-  do {                                  \
-    if (yydebug)                        \
-      yy_reduce_print Args;             \
-  } while (0)
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
 
-/* Nonzero means print parse trace.  It is left uninitialized so that
-   multiple parsers can coexist.  */
-int yydebug;
-
-static void yypstack (yyGLRStack* yystackp, YYPTRDIFF_T yyk)
-  YY_ATTRIBUTE_UNUSED;
-static void yypdumpstack (yyGLRStack* yystackp)
-  YY_ATTRIBUTE_UNUSED;
-
-#else /* !YYDEBUG */
-
-# define YY_DPRINTF(Args) do {} while (yyfalse)
-# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
-# define YY_REDUCE_PRINT(Args)
-
-#endif /* !YYDEBUG */
-
-
-
-/** Fill in YYVSP[YYLOW1 .. YYLOW0-1] from the chain of states starting
- *  at YYVSP[YYLOW0].yystate.yypred.  Leaves YYVSP[YYLOW1].yystate.yypred
- *  containing the pointer to the next state in the chain.  */
-static void yyfillin (yyGLRStackItem *, int, int) YY_ATTRIBUTE_UNUSED;
 static void
-yyfillin (yyGLRStackItem *yyvsp, int yylow0, int yylow1)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
-  int i;
-  yyGLRState *s = yyvsp[yylow0].yystate.yypred;
-  for (i = yylow0-1; i >= yylow1; i -= 1)
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
     {
-#if YYDEBUG
-      yyvsp[i].yystate.yylrState = s->yylrState;
-#endif
-      yyvsp[i].yystate.yyresolved = s->yyresolved;
-      if (s->yyresolved)
-        yyvsp[i].yystate.yysemantics.yyval = s->yysemantics.yyval;
-      else
-        /* The effect of using yyval or yyloc (in an immediate rule) is
-         * undefined.  */
-        yyvsp[i].yystate.yysemantics.yyfirstVal = YY_NULLPTR;
-      s = yyvsp[i].yystate.yypred = s->yypred;
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
     }
+  YYFPRINTF (stderr, "\n");
 }
 
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
-/** If yychar is empty, fetch the next token.  */
-static inline yysymbol_kind_t
-yygetToken (int *yycharp, std::shared_ptr<CompUnits> comp_units)
-{
-  yysymbol_kind_t yytoken;
-  YY_USE (comp_units);
-  if (*yycharp == TK_YYEMPTY)
-    {
-      YY_DPRINTF ((stderr, "Reading a token\n"));
-      *yycharp = yylex ();
-    }
-  if (*yycharp <= TK_YYEOF)
-    {
-      *yycharp = TK_YYEOF;
-      yytoken = YYSYMBOL_YYEOF;
-      YY_DPRINTF ((stderr, "Now at end of input.\n"));
-    }
-  else
-    {
-      yytoken = YYTRANSLATE (*yycharp);
-      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
-    }
-  return yytoken;
-}
 
-/* Do nothing if YYNORMAL or if *YYLOW <= YYLOW1.  Otherwise, fill in
- * YYVSP[YYLOW1 .. *YYLOW-1] as in yyfillin and set *YYLOW = YYLOW1.
- * For convenience, always return YYLOW1.  */
-static inline int yyfill (yyGLRStackItem *, int *, int, yybool)
-     YY_ATTRIBUTE_UNUSED;
-static inline int
-yyfill (yyGLRStackItem *yyvsp, int *yylow, int yylow1, yybool yynormal)
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, std::shared_ptr<CompUnits> comp_units)
 {
-  if (!yynormal && yylow1 < *yylow)
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
     {
-      yyfillin (yyvsp, *yylow, yylow1);
-      *yylow = yylow1;
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], comp_units);
+      YYFPRINTF (stderr, "\n");
     }
-  return yylow1;
 }
 
-/** Perform user action for rule number YYN, with RHS length YYRHSLEN,
- *  and top stack item YYVSP.  YYLVALP points to place to put semantic
- *  value ($$), and yylocp points to place for location information
- *  (@$).  Returns yyok for normal return, yyaccept for YYACCEPT,
- *  yyerr for YYERROR, yyabort for YYABORT, yynomem for YYNOMEM.  */
-static YYRESULTTAG
-yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
-              yyGLRStack* yystackp, YYPTRDIFF_T yyk,
-              YYSTYPE* yyvalp, std::shared_ptr<CompUnits> comp_units)
-{
-  const yybool yynormal YY_ATTRIBUTE_UNUSED = yystackp->yysplitPoint == YY_NULLPTR;
-  int yylow = 1;
-  YY_USE (yyvalp);
-  YY_USE (comp_units);
-  YY_USE (yyk);
-  YY_USE (yyrhslen);
-# undef yyerrok
-# define yyerrok (yystackp->yyerrState = 0)
-# undef YYACCEPT
-# define YYACCEPT return yyaccept
-# undef YYABORT
-# define YYABORT return yyabort
-# undef YYNOMEM
-# define YYNOMEM return yynomem
-# undef YYERROR
-# define YYERROR return yyerrok, yyerr
-# undef YYRECOVERING
-# define YYRECOVERING() (yystackp->yyerrState != 0)
-# undef yyclearin
-# define yyclearin (yychar = TK_YYEMPTY)
-# undef YYFILL
-# define YYFILL(N) yyfill (yyvsp, &yylow, (N), yynormal)
-# undef YYBACKUP
-# define YYBACKUP(Token, Value)                                              \
-  return yyerror (comp_units, YY_("syntax error: cannot back up")),     \
-         yyerrok, yyerr
-
-  if (yyrhslen == 0)
-    *yyvalp = yyval_default;
-  else
-    *yyvalp = yyvsp[YYFILL (1-yyrhslen)].yystate.yysemantics.yyval;
-  /* If yyk == -1, we are running a deferred action on a temporary
-     stack.  In that case, YY_REDUCE_PRINT must not play with YYFILL,
-     so pretend the stack is "normal". */
-  YY_REDUCE_PRINT ((yynormal || yyk == -1, yyvsp, yyk, yyrule, comp_units));
-  switch (yyrule)
-    {
-  case 2: /* CompUnits: CompUnit  */
-#line 114 "parser.y"
-             { comp_units->push_back(sp<CompUnit>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.comp_unit))); }
-#line 1213 "src/parser.cpp"
-    break;
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, comp_units); \
+} while (0)
 
-  case 3: /* CompUnits: CompUnits CompUnit  */
-#line 115 "parser.y"
-                         { comp_units->push_back(sp<CompUnit>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.comp_unit))); }
-#line 1219 "src/parser.cpp"
-    break;
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
 
-  case 4: /* CompUnit: Decl  */
-#line 118 "parser.y"
-         { ((*yyvalp).comp_unit) = ptr2variant<CompUnit>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.decl)); }
-#line 1225 "src/parser.cpp"
-    break;
 
-  case 5: /* CompUnit: FuncDef  */
-#line 119 "parser.y"
-              {  ((*yyvalp).comp_unit) = ptr2variant<CompUnit>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.func_def)); }
-#line 1231 "src/parser.cpp"
-    break;
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
 
-  case 6: /* Decl: ConstDecl  */
-#line 122 "parser.y"
-              { ((*yyvalp).decl) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.decl); }
-#line 1237 "src/parser.cpp"
-    break;
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
 
-  case 7: /* Decl: VarDecl  */
-#line 123 "parser.y"
-              { ((*yyvalp).decl) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.decl); }
-#line 1243 "src/parser.cpp"
-    break;
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, std::shared_ptr<CompUnits> comp_units)
+{
+  YY_USE (yyvaluep);
+  YY_USE (comp_units);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (std::shared_ptr<CompUnits> comp_units)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = TK_YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == TK_YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= TK_YYEOF)
+    {
+      yychar = TK_YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == TK_YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = TK_YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = TK_YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* CompUnits: CompUnit  */
+#line 116 "parser.y"
+             { comp_units->push_back(sp<CompUnit>((yyvsp[0].comp_unit))); }
+#line 1289 "src/parser.cpp"
+    break;
+
+  case 3: /* CompUnits: CompUnits CompUnit  */
+#line 117 "parser.y"
+                         { comp_units->push_back(sp<CompUnit>((yyvsp[0].comp_unit))); }
+#line 1295 "src/parser.cpp"
+    break;
+
+  case 4: /* CompUnit: Decl  */
+#line 120 "parser.y"
+         { (yyval.comp_unit) = ptr2variant<CompUnit>((yyvsp[0].decl)); }
+#line 1301 "src/parser.cpp"
+    break;
+
+  case 5: /* CompUnit: FuncDef  */
+#line 121 "parser.y"
+              {  (yyval.comp_unit) = ptr2variant<CompUnit>((yyvsp[0].func_def)); }
+#line 1307 "src/parser.cpp"
+    break;
+
+  case 6: /* Decl: ConstDecl  */
+#line 124 "parser.y"
+              { (yyval.decl) = (yyvsp[0].decl); }
+#line 1313 "src/parser.cpp"
+    break;
+
+  case 7: /* Decl: VarDecl  */
+#line 125 "parser.y"
+              { (yyval.decl) = (yyvsp[0].decl); }
+#line 1319 "src/parser.cpp"
+    break;
 
   case 8: /* ConstDecl: "const" BType ConstDefs ';'  */
-#line 126 "parser.y"
-                                { ((*yyvalp).decl) = new Decl{Decl::CONST, (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.type), sp<VarDefs>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.var_defs))}; }
-#line 1249 "src/parser.cpp"
+#line 128 "parser.y"
+                                { (yyval.decl) = new Decl{Decl::CONST, (yyvsp[-2].type), sp<VarDefs>((yyvsp[-1].var_defs))}; }
+#line 1325 "src/parser.cpp"
     break;
 
   case 9: /* VarDecl: BType VarDefs ';'  */
-#line 129 "parser.y"
-                      { ((*yyvalp).decl) = new Decl{Decl::VAR, (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.type), sp<VarDefs>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.var_defs))}; }
-#line 1255 "src/parser.cpp"
+#line 131 "parser.y"
+                      { (yyval.decl) = new Decl{Decl::VAR, (yyvsp[-2].type), sp<VarDefs>((yyvsp[-1].var_defs))}; }
+#line 1331 "src/parser.cpp"
     break;
 
   case 10: /* ConstDefs: ConstDef  */
-#line 132 "parser.y"
-             { ((*yyvalp).var_defs) = new VarDefs{sp<VarDef>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.var_def))}; }
-#line 1261 "src/parser.cpp"
+#line 134 "parser.y"
+             { (yyval.var_defs) = new VarDefs{sp<VarDef>((yyvsp[0].var_def))}; }
+#line 1337 "src/parser.cpp"
     break;
 
   case 11: /* ConstDefs: ConstDefs ',' ConstDef  */
-#line 133 "parser.y"
-                             { ((*yyvalp).var_defs) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.var_defs); ((*yyvalp).var_defs)->push_back(sp<VarDef>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.var_def))); }
-#line 1267 "src/parser.cpp"
+#line 135 "parser.y"
+                             { (yyval.var_defs) = (yyvsp[-2].var_defs); (yyval.var_defs)->push_back(sp<VarDef>((yyvsp[0].var_def))); }
+#line 1343 "src/parser.cpp"
     break;
 
   case 12: /* VarDefs: VarDef  */
-#line 136 "parser.y"
-           { ((*yyvalp).var_defs) = new VarDefs{sp<VarDef>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.var_def))}; }
-#line 1273 "src/parser.cpp"
+#line 138 "parser.y"
+           { (yyval.var_defs) = new VarDefs{sp<VarDef>((yyvsp[0].var_def))}; }
+#line 1349 "src/parser.cpp"
     break;
 
   case 13: /* VarDefs: VarDefs ',' VarDef  */
-#line 137 "parser.y"
-                         { ((*yyvalp).var_defs) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.var_defs); ((*yyvalp).var_defs)->push_back(sp<VarDef>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.var_def))); }
-#line 1279 "src/parser.cpp"
+#line 139 "parser.y"
+                         { (yyval.var_defs) = (yyvsp[-2].var_defs); (yyval.var_defs)->push_back(sp<VarDef>((yyvsp[0].var_def))); }
+#line 1355 "src/parser.cpp"
     break;
 
   case 14: /* ConstDef: IDENT Dims '=' ConstInitVal  */
-#line 140 "parser.y"
-                                { ((*yyvalp).var_def) = new VarDef{Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.str_val)), sp<Dims>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.dims)), sp<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.init_val))}; }
-#line 1285 "src/parser.cpp"
+#line 142 "parser.y"
+                                { (yyval.var_def) = new VarDef{to_ident((yyvsp[-3].ident)), sp<Dims>((yyvsp[-2].dims)), sp<InitVal>((yyvsp[0].init_val))}; }
+#line 1361 "src/parser.cpp"
     break;
 
   case 15: /* VarDef: IDENT Dims  */
-#line 143 "parser.y"
-               { ((*yyvalp).var_def) = new VarDef{Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.str_val)), sp<Dims>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.dims)), nullptr}; }
-#line 1291 "src/parser.cpp"
+#line 145 "parser.y"
+               { (yyval.var_def) = new VarDef{to_ident((yyvsp[-1].ident)), sp<Dims>((yyvsp[0].dims)), nullptr}; }
+#line 1367 "src/parser.cpp"
     break;
 
   case 16: /* VarDef: IDENT Dims '=' InitVal  */
-#line 144 "parser.y"
-                             { ((*yyvalp).var_def) = new VarDef{Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.str_val)), sp<Dims>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.dims)), sp<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.init_val))}; }
-#line 1297 "src/parser.cpp"
+#line 146 "parser.y"
+                             { (yyval.var_def) = new VarDef{to_ident((yyvsp[-3].ident)), sp<Dims>((yyvsp[-2].dims)), sp<InitVal>((yyvsp[0].init_val))}; }
+#line 1373 "src/parser.cpp"
     break;
 
   case 17: /* ConstInitVal: ConstExp  */
-#line 147 "parser.y"
-             { ((*yyvalp).init_val) = ptr2variant<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp)); }
-#line 1303 "src/parser.cpp"
+#line 149 "parser.y"
+             { (yyval.init_val) = ptr2variant<InitVal>((yyvsp[0].exp)); }
+#line 1379 "src/parser.cpp"
     break;
 
   case 18: /* ConstInitVal: '{' '}'  */
-#line 148 "parser.y"
-              { ((*yyvalp).init_val) = new InitVal(ArrayInitVal{{}}); }
-#line 1309 "src/parser.cpp"
+#line 150 "parser.y"
+              { (yyval.init_val) = new InitVal(ArrayInitVal{{}}); }
+#line 1385 "src/parser.cpp"
     break;
 
   case 19: /* ConstInitVal: '{' ConstInitVals '}'  */
-#line 149 "parser.y"
-                            { ((*yyvalp).init_val) = ptr2variant<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.init_vals)); }
-#line 1315 "src/parser.cpp"
+#line 151 "parser.y"
+                            { (yyval.init_val) = ptr2variant<InitVal>((yyvsp[-1].init_vals)); }
+#line 1391 "src/parser.cpp"
     break;
 
   case 20: /* ConstInitVals: ConstInitVal  */
-#line 152 "parser.y"
-                 { ((*yyvalp).init_vals) = new ArrayInitVal{{sp<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.init_val))}};  }
-#line 1321 "src/parser.cpp"
+#line 154 "parser.y"
+                 { (yyval.init_vals) = new ArrayInitVal{{sp<InitVal>((yyvsp[0].init_val))}};  }
+#line 1397 "src/parser.cpp"
     break;
 
   case 21: /* ConstInitVals: ConstInitVals ',' ConstInitVal  */
-#line 153 "parser.y"
-                                     { ((*yyvalp).init_vals) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.init_vals); ((*yyvalp).init_vals)->items.push_back(sp<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.init_val))); }
-#line 1327 "src/parser.cpp"
+#line 155 "parser.y"
+                                     { (yyval.init_vals) = (yyvsp[-2].init_vals); (yyval.init_vals)->items.push_back(sp<InitVal>((yyvsp[0].init_val))); }
+#line 1403 "src/parser.cpp"
     break;
 
   case 22: /* InitVal: Exp  */
-#line 156 "parser.y"
-        { ((*yyvalp).init_val) = ptr2variant<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp)); }
-#line 1333 "src/parser.cpp"
+#line 158 "parser.y"
+        { (yyval.init_val) = ptr2variant<InitVal>((yyvsp[0].exp)); }
+#line 1409 "src/parser.cpp"
     break;
 
   case 23: /* InitVal: '{' '}'  */
-#line 157 "parser.y"
-              { ((*yyvalp).init_val) = new InitVal(ArrayInitVal{{}}); }
-#line 1339 "src/parser.cpp"
+#line 159 "parser.y"
+              { (yyval.init_val) = new InitVal(ArrayInitVal{{}}); }
+#line 1415 "src/parser.cpp"
     break;
 
   case 24: /* InitVal: '{' InitVals '}'  */
-#line 158 "parser.y"
-                       { ((*yyvalp).init_val) = ptr2variant<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.init_vals)); }
-#line 1345 "src/parser.cpp"
+#line 160 "parser.y"
+                       { (yyval.init_val) = ptr2variant<InitVal>((yyvsp[-1].init_vals)); }
+#line 1421 "src/parser.cpp"
     break;
 
   case 25: /* InitVals: InitVal  */
-#line 161 "parser.y"
-            { ((*yyvalp).init_vals) = new ArrayInitVal{{sp<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.init_val))}}; }
-#line 1351 "src/parser.cpp"
+#line 163 "parser.y"
+            { (yyval.init_vals) = new ArrayInitVal{{sp<InitVal>((yyvsp[0].init_val))}}; }
+#line 1427 "src/parser.cpp"
     break;
 
   case 26: /* InitVals: InitVals ',' InitVal  */
-#line 162 "parser.y"
-                           { ((*yyvalp).init_vals) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.init_vals); ((*yyvalp).init_vals)->items.push_back(sp<InitVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.init_val))); }
-#line 1357 "src/parser.cpp"
+#line 164 "parser.y"
+                           { (yyval.init_vals) = (yyvsp[-2].init_vals); (yyval.init_vals)->items.push_back(sp<InitVal>((yyvsp[0].init_val))); }
+#line 1433 "src/parser.cpp"
     break;
 
   case 27: /* BType: "int"  */
-#line 165 "parser.y"
-          { ((*yyvalp).type) = ASTType::INT; }
-#line 1363 "src/parser.cpp"
+#line 167 "parser.y"
+          { (yyval.type) = ASTType::INT; }
+#line 1439 "src/parser.cpp"
     break;
 
   case 28: /* BType: "float"  */
-#line 166 "parser.y"
-              { ((*yyvalp).type) = ASTType::FLOAT; }
-#line 1369 "src/parser.cpp"
-    break;
-
-  case 29: /* FuncType: "void"  */
-#line 169 "parser.y"
-           { ((*yyvalp).type) = ASTType::VOID; }
-#line 1375 "src/parser.cpp"
+#line 168 "parser.y"
+              { (yyval.type) = ASTType::FLOAT; }
+#line 1445 "src/parser.cpp"
     break;
 
-  case 30: /* FuncType: "int"  */
-#line 170 "parser.y"
-            { ((*yyvalp).type) = ASTType::INT; }
-#line 1381 "src/parser.cpp"
-    break;
-
-  case 31: /* FuncType: "float"  */
+  case 29: /* Dims: %empty  */
 #line 171 "parser.y"
-              { ((*yyvalp).type) = ASTType::FLOAT; }
-#line 1387 "src/parser.cpp"
+           { (yyval.dims) = new Dims{}; }
+#line 1451 "src/parser.cpp"
     break;
 
-  case 32: /* Dims: %empty  */
-#line 174 "parser.y"
-           { ((*yyvalp).dims) = new Dims{}; }
-#line 1393 "src/parser.cpp"
+  case 30: /* Dims: Dims '[' ConstExp ']'  */
+#line 172 "parser.y"
+                            { (yyval.dims) = (yyvsp[-3].dims); (yyval.dims)->push_back(sp<Exp>((yyvsp[-1].exp))); }
+#line 1457 "src/parser.cpp"
     break;
 
-  case 33: /* Dims: Dims '[' ConstExp ']'  */
+  case 31: /* FuncDims: '[' ']'  */
 #line 175 "parser.y"
-                            { ((*yyvalp).dims) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.dims); ((*yyvalp).dims)->push_back(sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp))); }
-#line 1399 "src/parser.cpp"
+            { (yyval.dims) = new Dims{nullptr}; }
+#line 1463 "src/parser.cpp"
     break;
 
-  case 34: /* FuncDims: '[' ']'  */
-#line 178 "parser.y"
-            { ((*yyvalp).dims) = new Dims{nullptr}; }
-#line 1405 "src/parser.cpp"
+  case 32: /* FuncDims: FuncDims '[' Exp ']'  */
+#line 176 "parser.y"
+                           { (yyval.dims) = (yyvsp[-3].dims); (yyval.dims)->push_back(sp<Exp>((yyvsp[-1].exp))); }
+#line 1469 "src/parser.cpp"
     break;
 
-  case 35: /* FuncDims: FuncDims '[' Exp ']'  */
-#line 179 "parser.y"
-                           { ((*yyvalp).dims) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.dims); ((*yyvalp).dims)->push_back(sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp))); }
-#line 1411 "src/parser.cpp"
+  case 33: /* FuncDef: BType IDENT '(' ')' Block  */
+#line 181 "parser.y"
+                              { (yyval.func_def) = new FuncDef{(yyvsp[-4].type), to_ident((yyvsp[-3].ident)), std::make_shared<FuncFParams>(), sp<BlockItems>((yyvsp[0].block_items))}; }
+#line 1475 "src/parser.cpp"
     break;
 
-  case 36: /* FuncDef: FuncType IDENT '(' ')' Block  */
+  case 34: /* FuncDef: BType IDENT '(' FuncFParams ')' Block  */
 #line 182 "parser.y"
-                                 { ((*yyvalp).func_def) = new FuncDef{(YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.type), Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.str_val)), std::make_shared<FuncFParams>(), sp<BlockItems>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.block_items))}; }
-#line 1417 "src/parser.cpp"
+                                            { (yyval.func_def) = new FuncDef{(yyvsp[-5].type), to_ident((yyvsp[-4].ident)), sp<FuncFParams>((yyvsp[-2].fparams)), sp<BlockItems>((yyvsp[0].block_items))}; }
+#line 1481 "src/parser.cpp"
     break;
 
-  case 37: /* FuncDef: FuncType IDENT '(' FuncFParams ')' Block  */
+  case 35: /* FuncDef: "void" IDENT '(' ')' Block  */
 #line 183 "parser.y"
-                                               { ((*yyvalp).func_def) = new FuncDef{(YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-5)].yystate.yysemantics.yyval.type), Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.str_val)), sp<FuncFParams>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.fparams)), sp<BlockItems>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.block_items))}; }
-#line 1423 "src/parser.cpp"
+                                 { (yyval.func_def) = new FuncDef{ASTType::VOID, to_ident((yyvsp[-3].ident)), std::make_shared<FuncFParams>(), sp<BlockItems>((yyvsp[0].block_items))}; }
+#line 1487 "src/parser.cpp"
     break;
 
-  case 38: /* FuncFParams: FuncFParam  */
-#line 186 "parser.y"
-               { ((*yyvalp).fparams) = new FuncFParams{sp<FuncFParam>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.fparam))}; }
-#line 1429 "src/parser.cpp"
+  case 36: /* FuncDef: "void" IDENT '(' FuncFParams ')' Block  */
+#line 184 "parser.y"
+                                             { (yyval.func_def) = new FuncDef{ASTType::VOID, to_ident((yyvsp[-4].ident)), sp<FuncFParams>((yyvsp[-2].fparams)), sp<BlockItems>((yyvsp[0].block_items))}; }
+#line 1493 "src/parser.cpp"
     break;
 
-  case 39: /* FuncFParams: FuncFParams ',' FuncFParam  */
+  case 37: /* FuncFParams: FuncFParam  */
 #line 187 "parser.y"
-                                 { ((*yyvalp).fparams) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.fparams); ((*yyvalp).fparams)->push_back(sp<FuncFParam>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.fparam))); }
-#line 1435 "src/parser.cpp"
+               { (yyval.fparams) = new FuncFParams{sp<FuncFParam>((yyvsp[0].fparam))}; }
+#line 1499 "src/parser.cpp"
     break;
 
-  case 40: /* FuncFParam: BType IDENT  */
-#line 190 "parser.y"
-                { ((*yyvalp).fparam) = new FuncFParam{(YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.type), Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.str_val)), std::make_shared<Dims>()}; }
-#line 1441 "src/parser.cpp"
+  case 38: /* FuncFParams: FuncFParams ',' FuncFParam  */
+#line 188 "parser.y"
+                                 { (yyval.fparams) = (yyvsp[-2].fparams); (yyval.fparams)->push_back(sp<FuncFParam>((yyvsp[0].fparam))); }
+#line 1505 "src/parser.cpp"
     break;
 
-  case 41: /* FuncFParam: BType IDENT FuncDims  */
+  case 39: /* FuncFParam: BType IDENT  */
 #line 191 "parser.y"
-                           { ((*yyvalp).fparam) = new FuncFParam{(YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.type), Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.str_val)), sp<Dims>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.dims))}; }
-#line 1447 "src/parser.cpp"
+                { (yyval.fparam) = new FuncFParam{(yyvsp[-1].type), to_ident((yyvsp[0].ident)), std::make_shared<Dims>()}; }
+#line 1511 "src/parser.cpp"
     break;
 
-  case 42: /* Block: '{' BlockItems '}'  */
-#line 194 "parser.y"
-                       { ((*yyvalp).block_items) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.block_items); }
-#line 1453 "src/parser.cpp"
+  case 40: /* FuncFParam: BType IDENT FuncDims  */
+#line 192 "parser.y"
+                           { (yyval.fparam) = new FuncFParam{(yyvsp[-2].type), to_ident((yyvsp[-1].ident)), sp<Dims>((yyvsp[0].dims))}; }
+#line 1517 "src/parser.cpp"
     break;
 
-  case 43: /* BlockItems: %empty  */
-#line 197 "parser.y"
-           { ((*yyvalp).block_items) = new BlockItems{}; }
-#line 1459 "src/parser.cpp"
+  case 41: /* Block: '{' BlockItems '}'  */
+#line 195 "parser.y"
+                       { (yyval.block_items) = (yyvsp[-1].block_items); }
+#line 1523 "src/parser.cpp"
     break;
 
-  case 44: /* BlockItems: BlockItems BlockItem  */
+  case 42: /* BlockItems: %empty  */
 #line 198 "parser.y"
-                           { ((*yyvalp).block_items) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.block_items); ((*yyvalp).block_items)->push_back(sp<BlockItem>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.block_item))); }
-#line 1465 "src/parser.cpp"
+           { (yyval.block_items) = new BlockItems{}; }
+#line 1529 "src/parser.cpp"
     break;
 
-  case 45: /* BlockItem: Decl  */
-#line 201 "parser.y"
-         { ((*yyvalp).block_item) = ptr2variant<BlockItem>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.decl)); }
-#line 1471 "src/parser.cpp"
+  case 43: /* BlockItems: BlockItems BlockItem  */
+#line 199 "parser.y"
+                           { (yyval.block_items) = (yyvsp[-1].block_items); (yyval.block_items)->push_back(sp<BlockItem>((yyvsp[0].block_item))); }
+#line 1535 "src/parser.cpp"
     break;
 
-  case 46: /* BlockItem: Stmt  */
+  case 44: /* BlockItem: Decl  */
 #line 202 "parser.y"
-           { ((*yyvalp).block_item) = ptr2variant<BlockItem>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.stmt)); }
-#line 1477 "src/parser.cpp"
+         { (yyval.block_item) = ptr2variant<BlockItem>((yyvsp[0].decl)); }
+#line 1541 "src/parser.cpp"
     break;
 
-  case 47: /* Stmt: LVal '=' Exp ';'  */
-#line 205 "parser.y"
-                     { ((*yyvalp).stmt) = new Stmt(AssignStmt{sp<LVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.lval)), sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp))}); }
-#line 1483 "src/parser.cpp"
+  case 45: /* BlockItem: Stmt  */
+#line 203 "parser.y"
+           { (yyval.block_item) = ptr2variant<BlockItem>((yyvsp[0].stmt)); }
+#line 1547 "src/parser.cpp"
     break;
 
-  case 48: /* Stmt: Exp ';'  */
+  case 46: /* Stmt: LVal '=' Exp ';'  */
 #line 206 "parser.y"
-              { ((*yyvalp).stmt) = new Stmt(ExpStmt{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp))}); }
-#line 1489 "src/parser.cpp"
+                     { (yyval.stmt) = new Stmt(AssignStmt{sp<LVal>((yyvsp[-3].lval)), sp<Exp>((yyvsp[-1].exp))}); }
+#line 1553 "src/parser.cpp"
     break;
 
-  case 49: /* Stmt: ';'  */
+  case 47: /* Stmt: Exp ';'  */
 #line 207 "parser.y"
-          { ((*yyvalp).stmt) = new Stmt(ExpStmt{nullptr}); }
-#line 1495 "src/parser.cpp"
+              { (yyval.stmt) = new Stmt(ExpStmt{sp<Exp>((yyvsp[-1].exp))}); }
+#line 1559 "src/parser.cpp"
     break;
 
-  case 50: /* Stmt: Block  */
+  case 48: /* Stmt: ';'  */
 #line 208 "parser.y"
-            { ((*yyvalp).stmt) = new Stmt(BlockStmt{sp<BlockItems>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.block_items))}); }
-#line 1501 "src/parser.cpp"
+          { (yyval.stmt) = new Stmt(ExpStmt{nullptr}); }
+#line 1565 "src/parser.cpp"
     break;
 
-  case 51: /* Stmt: "if" '(' Cond ')' Stmt  */
+  case 49: /* Stmt: Block  */
 #line 209 "parser.y"
-                             { ((*yyvalp).stmt) = new Stmt(IfStmt{sp<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.cond)), sp<Stmt>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.stmt)), nullptr}); }
-#line 1507 "src/parser.cpp"
+            { (yyval.stmt) = new Stmt(BlockStmt{sp<BlockItems>((yyvsp[0].block_items))}); }
+#line 1571 "src/parser.cpp"
     break;
 
-  case 52: /* Stmt: "if" '(' Cond ')' Stmt "else" Stmt  */
+  case 50: /* Stmt: "if" '(' Cond ')' Stmt  */
 #line 210 "parser.y"
-                                         { ((*yyvalp).stmt) = new Stmt(IfStmt{sp<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.cond)), sp<Stmt>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.stmt)), sp<Stmt>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.stmt))}); }
-#line 1513 "src/parser.cpp"
+                             { (yyval.stmt) = new Stmt(IfStmt{sp<Cond>((yyvsp[-2].cond)), sp<Stmt>((yyvsp[0].stmt)), nullptr}); }
+#line 1577 "src/parser.cpp"
     break;
 
-  case 53: /* Stmt: "while" '(' Cond ')' Stmt  */
+  case 51: /* Stmt: "if" '(' Cond ')' Stmt "else" Stmt  */
 #line 211 "parser.y"
-                                { ((*yyvalp).stmt) = new Stmt(WhileStmt{sp<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.cond)), sp<Stmt>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.stmt))}); }
-#line 1519 "src/parser.cpp"
+                                         { (yyval.stmt) = new Stmt(IfStmt{sp<Cond>((yyvsp[-4].cond)), sp<Stmt>((yyvsp[-2].stmt)), sp<Stmt>((yyvsp[0].stmt))}); }
+#line 1583 "src/parser.cpp"
     break;
 
-  case 54: /* Stmt: "break" ';'  */
+  case 52: /* Stmt: "while" '(' Cond ')' Stmt  */
 #line 212 "parser.y"
-                  { ((*yyvalp).stmt) = new Stmt(ControlStmt{ControlStmt::BREAK}); }
-#line 1525 "src/parser.cpp"
+                                { (yyval.stmt) = new Stmt(WhileStmt{sp<Cond>((yyvsp[-2].cond)), sp<Stmt>((yyvsp[0].stmt))}); }
+#line 1589 "src/parser.cpp"
     break;
 
-  case 55: /* Stmt: "continue" ';'  */
+  case 53: /* Stmt: "break" ';'  */
 #line 213 "parser.y"
-                     { ((*yyvalp).stmt) = new Stmt(ControlStmt{ControlStmt::CONTINUE}); }
-#line 1531 "src/parser.cpp"
+                  { (yyval.stmt) = new Stmt(ControlStmt{ControlStmt::BREAK}); }
+#line 1595 "src/parser.cpp"
     break;
 
-  case 56: /* Stmt: "return" ';'  */
+  case 54: /* Stmt: "continue" ';'  */
 #line 214 "parser.y"
-                   { ((*yyvalp).stmt) = new Stmt(ReturnStmt{nullptr}); }
-#line 1537 "src/parser.cpp"
+                     { (yyval.stmt) = new Stmt(ControlStmt{ControlStmt::CONTINUE}); }
+#line 1601 "src/parser.cpp"
     break;
 
-  case 57: /* Stmt: "return" Exp ';'  */
+  case 55: /* Stmt: "return" ';'  */
 #line 215 "parser.y"
-                       { ((*yyvalp).stmt) = new Stmt(ReturnStmt{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp))}); }
-#line 1543 "src/parser.cpp"
+                   { (yyval.stmt) = new Stmt(ReturnStmt{nullptr}); }
+#line 1607 "src/parser.cpp"
     break;
 
-  case 58: /* Exp: AddExp  */
-#line 218 "parser.y"
-           { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1549 "src/parser.cpp"
+  case 56: /* Stmt: "return" Exp ';'  */
+#line 216 "parser.y"
+                       { (yyval.stmt) = new Stmt(ReturnStmt{sp<Exp>((yyvsp[-1].exp))}); }
+#line 1613 "src/parser.cpp"
     break;
 
-  case 59: /* Cond: LOrExp  */
-#line 221 "parser.y"
-           { ((*yyvalp).cond) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.cond); }
-#line 1555 "src/parser.cpp"
+  case 57: /* Exp: AddExp  */
+#line 219 "parser.y"
+           { (yyval.exp) = (yyvsp[0].exp); }
+#line 1619 "src/parser.cpp"
     break;
 
-  case 60: /* LVal: IDENT  */
-#line 224 "parser.y"
-          { ((*yyvalp).lval) = new LVal(Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.str_val))); }
-#line 1561 "src/parser.cpp"
+  case 58: /* Cond: LOrExp  */
+#line 222 "parser.y"
+           { (yyval.cond) = (yyvsp[0].cond); }
+#line 1625 "src/parser.cpp"
     break;
 
-  case 61: /* LVal: LVal '[' Exp ']'  */
+  case 59: /* LVal: IDENT  */
 #line 225 "parser.y"
-                       { ((*yyvalp).lval) = new LVal(Index{sp<LVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.lval)), sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp))}); }
-#line 1567 "src/parser.cpp"
+          { (yyval.lval) = new LVal(to_ident((yyvsp[0].ident))); }
+#line 1631 "src/parser.cpp"
     break;
 
-  case 62: /* PrimaryExp: '(' Exp ')'  */
-#line 228 "parser.y"
-                { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.exp); }
-#line 1573 "src/parser.cpp"
+  case 60: /* LVal: LVal '[' Exp ']'  */
+#line 226 "parser.y"
+                       { (yyval.lval) = new LVal(Index{sp<LVal>((yyvsp[-3].lval)), sp<Exp>((yyvsp[-1].exp))}); }
+#line 1637 "src/parser.cpp"
     break;
 
-  case 63: /* PrimaryExp: LVal  */
+  case 61: /* PrimaryExp: '(' Exp ')'  */
 #line 229 "parser.y"
-           { ((*yyvalp).exp) = new Exp(LValExp{sp<LVal>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.lval))}); }
-#line 1579 "src/parser.cpp"
+                { (yyval.exp) = (yyvsp[-1].exp); }
+#line 1643 "src/parser.cpp"
     break;
 
-  case 64: /* PrimaryExp: Number  */
+  case 62: /* PrimaryExp: LVal  */
 #line 230 "parser.y"
-             { ((*yyvalp).exp) = ptr2variant<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.number)); }
-#line 1585 "src/parser.cpp"
+           { (yyval.exp) = new Exp(LValExp{sp<LVal>((yyvsp[0].lval))}); }
+#line 1649 "src/parser.cpp"
     break;
 
-  case 65: /* Number: INT_CONST  */
-#line 233 "parser.y"
-              { ((*yyvalp).number) = new Number((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_val)); }
-#line 1591 "src/parser.cpp"
+  case 63: /* PrimaryExp: Number  */
+#line 231 "parser.y"
+             { (yyval.exp) = ptr2variant<Exp>((yyvsp[0].number)); }
+#line 1655 "src/parser.cpp"
     break;
 
-  case 66: /* Number: FLOAT_CONST  */
+  case 64: /* Number: INT_CONST  */
 #line 234 "parser.y"
-                  { ((*yyvalp).number) = new Number((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.float_val)); }
-#line 1597 "src/parser.cpp"
+              { (yyval.number) = new Number((yyvsp[0].int_val)); }
+#line 1661 "src/parser.cpp"
     break;
 
-  case 67: /* UnaryExp: PrimaryExp  */
-#line 237 "parser.y"
-               { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1603 "src/parser.cpp"
+  case 65: /* Number: FLOAT_CONST  */
+#line 235 "parser.y"
+                  { (yyval.number) = new Number((yyvsp[0].float_val)); }
+#line 1667 "src/parser.cpp"
     break;
 
-  case 68: /* UnaryExp: IDENT '(' ')'  */
+  case 66: /* UnaryExp: PrimaryExp  */
 #line 238 "parser.y"
-                    { ((*yyvalp).exp) = new Exp(CallExp{Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.str_val)), std::make_shared<FuncRParams>()}); }
-#line 1609 "src/parser.cpp"
+               { (yyval.exp) = (yyvsp[0].exp); }
+#line 1673 "src/parser.cpp"
     break;
 
-  case 69: /* UnaryExp: IDENT '(' FuncRParams ')'  */
+  case 67: /* UnaryExp: IDENT '(' ')'  */
 #line 239 "parser.y"
-                                { ((*yyvalp).exp) = new Exp(CallExp{Ident((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.str_val)), sp<FuncRParams>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.rparams))}); }
-#line 1615 "src/parser.cpp"
+                    { (yyval.exp) = new Exp(CallExp{to_ident((yyvsp[-2].ident)), std::make_shared<FuncRParams>()}); }
+#line 1679 "src/parser.cpp"
     break;
 
-  case 70: /* UnaryExp: '+' UnaryExp  */
+  case 68: /* UnaryExp: IDENT '(' FuncRParams ')'  */
 #line 240 "parser.y"
-                   { ((*yyvalp).exp) = new Exp(UnaryExp{UnaryExp::ADD, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1621 "src/parser.cpp"
+                                { (yyval.exp) = new Exp(CallExp{to_ident((yyvsp[-3].ident)), sp<FuncRParams>((yyvsp[-1].rparams))}); }
+#line 1685 "src/parser.cpp"
     break;
 
-  case 71: /* UnaryExp: '-' UnaryExp  */
+  case 69: /* UnaryExp: '+' UnaryExp  */
 #line 241 "parser.y"
-                   { ((*yyvalp).exp) = new Exp(UnaryExp{UnaryExp::SUB, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1627 "src/parser.cpp"
+                   { (yyval.exp) = new Exp(UnaryExp{UnaryExp::ADD, sp<Exp>((yyvsp[0].exp))}); }
+#line 1691 "src/parser.cpp"
     break;
 
-  case 72: /* UnaryExp: '!' UnaryExp  */
+  case 70: /* UnaryExp: '-' UnaryExp  */
 #line 242 "parser.y"
-                   { ((*yyvalp).exp) = new Exp(UnaryExp{UnaryExp::NOT, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1633 "src/parser.cpp"
+                   { (yyval.exp) = new Exp(UnaryExp{UnaryExp::SUB, sp<Exp>((yyvsp[0].exp))}); }
+#line 1697 "src/parser.cpp"
     break;
 
-  case 73: /* FuncRParams: Exp  */
-#line 245 "parser.y"
-        { ((*yyvalp).rparams) = new FuncRParams{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}; }
-#line 1639 "src/parser.cpp"
+  case 71: /* UnaryExp: '!' UnaryExp  */
+#line 243 "parser.y"
+                   { (yyval.exp) = new Exp(UnaryExp{UnaryExp::NOT, sp<Exp>((yyvsp[0].exp))}); }
+#line 1703 "src/parser.cpp"
     break;
 
-  case 74: /* FuncRParams: FuncRParams ',' Exp  */
+  case 72: /* FuncRParams: Exp  */
 #line 246 "parser.y"
-                          { ((*yyvalp).rparams) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.rparams); ((*yyvalp).rparams)->push_back(sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))); }
-#line 1645 "src/parser.cpp"
+        { (yyval.rparams) = new FuncRParams{sp<Exp>((yyvsp[0].exp))}; }
+#line 1709 "src/parser.cpp"
     break;
 
-  case 75: /* MulExp: UnaryExp  */
-#line 249 "parser.y"
-             { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1651 "src/parser.cpp"
+  case 73: /* FuncRParams: FuncRParams ',' Exp  */
+#line 247 "parser.y"
+                          { (yyval.rparams) = (yyvsp[-2].rparams); (yyval.rparams)->push_back(sp<Exp>((yyvsp[0].exp))); }
+#line 1715 "src/parser.cpp"
     break;
 
-  case 76: /* MulExp: MulExp '*' UnaryExp  */
+  case 74: /* MulExp: UnaryExp  */
 #line 250 "parser.y"
-                          { ((*yyvalp).exp) = new Exp(BinaryExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), BinaryExp::MULT, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1657 "src/parser.cpp"
+             { (yyval.exp) = (yyvsp[0].exp); }
+#line 1721 "src/parser.cpp"
     break;
 
-  case 77: /* MulExp: MulExp '/' UnaryExp  */
+  case 75: /* MulExp: MulExp '*' UnaryExp  */
 #line 251 "parser.y"
-                          { ((*yyvalp).exp) = new Exp(BinaryExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), BinaryExp::DIV, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1663 "src/parser.cpp"
+                          { (yyval.exp) = new Exp(BinaryExp{sp<Exp>((yyvsp[-2].exp)), BinaryExp::MULT, sp<Exp>((yyvsp[0].exp))}); }
+#line 1727 "src/parser.cpp"
     break;
 
-  case 78: /* MulExp: MulExp '%' UnaryExp  */
+  case 76: /* MulExp: MulExp '/' UnaryExp  */
 #line 252 "parser.y"
-                          { ((*yyvalp).exp) = new Exp(BinaryExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), BinaryExp::MOD, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1669 "src/parser.cpp"
+                          { (yyval.exp) = new Exp(BinaryExp{sp<Exp>((yyvsp[-2].exp)), BinaryExp::DIV, sp<Exp>((yyvsp[0].exp))}); }
+#line 1733 "src/parser.cpp"
     break;
 
-  case 79: /* AddExp: MulExp  */
-#line 255 "parser.y"
-           { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1675 "src/parser.cpp"
+  case 77: /* MulExp: MulExp '%' UnaryExp  */
+#line 253 "parser.y"
+                          { (yyval.exp) = new Exp(BinaryExp{sp<Exp>((yyvsp[-2].exp)), BinaryExp::MOD, sp<Exp>((yyvsp[0].exp))}); }
+#line 1739 "src/parser.cpp"
     break;
 
-  case 80: /* AddExp: AddExp '+' MulExp  */
+  case 78: /* AddExp: MulExp  */
 #line 256 "parser.y"
-                        { ((*yyvalp).exp) = new Exp(BinaryExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), BinaryExp::ADD, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1681 "src/parser.cpp"
+           { (yyval.exp) = (yyvsp[0].exp); }
+#line 1745 "src/parser.cpp"
     break;
 
-  case 81: /* AddExp: AddExp '-' MulExp  */
+  case 79: /* AddExp: AddExp '+' MulExp  */
 #line 257 "parser.y"
-                        { ((*yyvalp).exp) = new Exp(BinaryExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), BinaryExp::SUB, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1687 "src/parser.cpp"
+                        { (yyval.exp) = new Exp(BinaryExp{sp<Exp>((yyvsp[-2].exp)), BinaryExp::ADD, sp<Exp>((yyvsp[0].exp))}); }
+#line 1751 "src/parser.cpp"
     break;
 
-  case 82: /* RelExp: AddExp  */
-#line 260 "parser.y"
-           { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1693 "src/parser.cpp"
+  case 80: /* AddExp: AddExp '-' MulExp  */
+#line 258 "parser.y"
+                        { (yyval.exp) = new Exp(BinaryExp{sp<Exp>((yyvsp[-2].exp)), BinaryExp::SUB, sp<Exp>((yyvsp[0].exp))}); }
+#line 1757 "src/parser.cpp"
     break;
 
-  case 83: /* RelExp: RelExp '<' AddExp  */
+  case 81: /* RelExp: AddExp  */
 #line 261 "parser.y"
-                        { ((*yyvalp).exp) = new Exp(CompareExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), CompareExp::LT, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1699 "src/parser.cpp"
+           { (yyval.exp) = (yyvsp[0].exp); }
+#line 1763 "src/parser.cpp"
     break;
 
-  case 84: /* RelExp: RelExp '>' AddExp  */
+  case 82: /* RelExp: RelExp '<' AddExp  */
 #line 262 "parser.y"
-                        { ((*yyvalp).exp) = new Exp(CompareExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), CompareExp::GT, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1705 "src/parser.cpp"
+                        { (yyval.exp) = new Exp(CompareExp{sp<Exp>((yyvsp[-2].exp)), CompareExp::LT, sp<Exp>((yyvsp[0].exp))}); }
+#line 1769 "src/parser.cpp"
     break;
 
-  case 85: /* RelExp: RelExp "<=" AddExp  */
+  case 83: /* RelExp: RelExp '>' AddExp  */
 #line 263 "parser.y"
-                         { ((*yyvalp).exp) = new Exp(CompareExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), CompareExp::LE, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1711 "src/parser.cpp"
+                        { (yyval.exp) = new Exp(CompareExp{sp<Exp>((yyvsp[-2].exp)), CompareExp::GT, sp<Exp>((yyvsp[0].exp))}); }
+#line 1775 "src/parser.cpp"
     break;
 
-  case 86: /* RelExp: RelExp ">=" AddExp  */
+  case 84: /* RelExp: RelExp "<=" AddExp  */
 #line 264 "parser.y"
-                         { ((*yyvalp).exp) = new Exp(CompareExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), CompareExp::GE, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1717 "src/parser.cpp"
+                         { (yyval.exp) = new Exp(CompareExp{sp<Exp>((yyvsp[-2].exp)), CompareExp::LE, sp<Exp>((yyvsp[0].exp))}); }
+#line 1781 "src/parser.cpp"
     break;
 
-  case 87: /* EqExp: RelExp  */
-#line 267 "parser.y"
-           { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1723 "src/parser.cpp"
+  case 85: /* RelExp: RelExp ">=" AddExp  */
+#line 265 "parser.y"
+                         { (yyval.exp) = new Exp(CompareExp{sp<Exp>((yyvsp[-2].exp)), CompareExp::GE, sp<Exp>((yyvsp[0].exp))}); }
+#line 1787 "src/parser.cpp"
     break;
 
-  case 88: /* EqExp: EqExp "==" RelExp  */
+  case 86: /* EqExp: RelExp  */
 #line 268 "parser.y"
-                        { ((*yyvalp).exp) = new Exp(CompareExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), CompareExp::EQ, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1729 "src/parser.cpp"
+           { (yyval.exp) = (yyvsp[0].exp); }
+#line 1793 "src/parser.cpp"
     break;
 
-  case 89: /* EqExp: EqExp "!=" RelExp  */
+  case 87: /* EqExp: EqExp "==" RelExp  */
 #line 269 "parser.y"
-                        { ((*yyvalp).exp) = new Exp(CompareExp{sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.exp)), CompareExp::NE, sp<Exp>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp))}); }
-#line 1735 "src/parser.cpp"
+                        { (yyval.exp) = new Exp(CompareExp{sp<Exp>((yyvsp[-2].exp)), CompareExp::EQ, sp<Exp>((yyvsp[0].exp))}); }
+#line 1799 "src/parser.cpp"
     break;
 
-  case 90: /* LAndExp: EqExp  */
-#line 272 "parser.y"
-          { ((*yyvalp).cond) = ptr2variant<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp)); }
-#line 1741 "src/parser.cpp"
+  case 88: /* EqExp: EqExp "!=" RelExp  */
+#line 270 "parser.y"
+                        { (yyval.exp) = new Exp(CompareExp{sp<Exp>((yyvsp[-2].exp)), CompareExp::NE, sp<Exp>((yyvsp[0].exp))}); }
+#line 1805 "src/parser.cpp"
     break;
 
-  case 91: /* LAndExp: LAndExp "&&" EqExp  */
+  case 89: /* LAndExp: EqExp  */
 #line 273 "parser.y"
-                         { ((*yyvalp).cond) = new Cond(LogicalExp{sp<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.cond)), LogicalExp::AND, sp<Cond>(ptr2variant<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp)))}); }
-#line 1747 "src/parser.cpp"
+          { (yyval.cond) = ptr2variant<Cond>((yyvsp[0].exp)); }
+#line 1811 "src/parser.cpp"
     break;
 
-  case 92: /* LOrExp: LAndExp  */
-#line 276 "parser.y"
-            { ((*yyvalp).cond) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.cond); }
-#line 1753 "src/parser.cpp"
+  case 90: /* LAndExp: LAndExp "&&" EqExp  */
+#line 274 "parser.y"
+                         { (yyval.cond) = new Cond(LogicalExp{sp<Cond>((yyvsp[-2].cond)), LogicalExp::AND, sp<Cond>(ptr2variant<Cond>((yyvsp[0].exp)))}); }
+#line 1817 "src/parser.cpp"
     break;
 
-  case 93: /* LOrExp: LOrExp "||" LAndExp  */
+  case 91: /* LOrExp: LAndExp  */
 #line 277 "parser.y"
-                          { ((*yyvalp).cond) = new Cond(LogicalExp{sp<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.cond)), LogicalExp::OR, sp<Cond>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.cond))}); }
-#line 1759 "src/parser.cpp"
+            { (yyval.cond) = (yyvsp[0].cond); }
+#line 1823 "src/parser.cpp"
+    break;
+
+  case 92: /* LOrExp: LOrExp "||" LAndExp  */
+#line 278 "parser.y"
+                          { (yyval.cond) = new Cond(LogicalExp{sp<Cond>((yyvsp[-2].cond)), LogicalExp::OR, sp<Cond>((yyvsp[0].cond))}); }
+#line 1829 "src/parser.cpp"
     break;
 
-  case 94: /* ConstExp: AddExp  */
-#line 280 "parser.y"
-           { ((*yyvalp).exp) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.exp); }
-#line 1765 "src/parser.cpp"
+  case 93: /* ConstExp: AddExp  */
+#line 281 "parser.y"
+           { (yyval.exp) = (yyvsp[0].exp); }
+#line 1835 "src/parser.cpp"
     break;
 
 
-#line 1769 "src/parser.cpp"
+#line 1839 "src/parser.cpp"
 
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yylhsNonterm (yyrule), yyvalp, yylocp);
-
-  return yyok;
-# undef yyerrok
-# undef YYABORT
-# undef YYACCEPT
-# undef YYNOMEM
-# undef YYERROR
-# undef YYBACKUP
-# undef yyclearin
-# undef YYRECOVERING
-}
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
+  goto yynewstate;
 
-static void
-yyuserMerge (int yyn, YYSTYPE* yy0, YYSTYPE* yy1)
-{
-  YY_USE (yy0);
-  YY_USE (yy1);
 
-  switch (yyn)
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == TK_YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
     {
+      ++yynerrs;
+      yyerror (comp_units, YY_("syntax error"));
+    }
 
-      default: break;
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= TK_YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == TK_YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, comp_units);
+          yychar = TK_YYEMPTY;
+        }
     }
-}
 
-                              /* Bison grammar-table manipulation.  */
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
 
-/*-----------------------------------------------.
-| Release the memory associated to this symbol.  |
-`-----------------------------------------------*/
 
-static void
-yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, std::shared_ptr<CompUnits> comp_units)
-{
-  YY_USE (yyvaluep);
-  YY_USE (comp_units);
-  if (!yymsg)
-    yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YY_USE (yykind);
-  YY_IGNORE_MAYBE_UNINITIALIZED_END
-}
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
 
-/** Number of symbols composing the right hand side of rule #RULE.  */
-static inline int
-yyrhsLength (yyRuleNum yyrule)
-{
-  return yyr2[yyrule];
-}
 
-static void
-yydestroyGLRState (char const *yymsg, yyGLRState *yys, std::shared_ptr<CompUnits> comp_units)
-{
-  if (yys->yyresolved)
-    yydestruct (yymsg, yy_accessing_symbol (yys->yylrState),
-                &yys->yysemantics.yyval, comp_units);
-  else
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
     {
-#if YYDEBUG
-      if (yydebug)
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
         {
-          if (yys->yysemantics.yyfirstVal)
-            YY_FPRINTF ((stderr, "%s unresolved", yymsg));
-          else
-            YY_FPRINTF ((stderr, "%s incomplete", yymsg));
-          YY_SYMBOL_PRINT ("", yy_accessing_symbol (yys->yylrState), YY_NULLPTR, &yys->yyloc);
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
         }
-#endif
 
-      if (yys->yysemantics.yyfirstVal)
-        {
-          yySemanticOption *yyoption = yys->yysemantics.yyfirstVal;
-          yyGLRState *yyrh;
-          int yyn;
-          for (yyrh = yyoption->yystate, yyn = yyrhsLength (yyoption->yyrule);
-               yyn > 0;
-               yyrh = yyrh->yypred, yyn -= 1)
-            yydestroyGLRState (yymsg, yyrh, comp_units);
-        }
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, comp_units);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
     }
-}
 
-#define yypact_value_is_default(Yyn) \
-  ((Yyn) == YYPACT_NINF)
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
-/** True iff LR state YYSTATE has only a default reduction (regardless
- *  of token).  */
-static inline yybool
-yyisDefaultedState (yy_state_t yystate)
-{
-  return yypact_value_is_default (yypact[yystate]);
-}
 
-/** The default reduction for YYSTATE, assuming it has one.  */
-static inline yyRuleNum
-yydefaultAction (yy_state_t yystate)
-{
-  return yydefact[yystate];
-}
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
-#define yytable_value_is_error(Yyn) \
-  0
+  yystate = yyn;
+  goto yynewstate;
 
-/** The action to take in YYSTATE on seeing YYTOKEN.
- *  Result R means
- *    R < 0:  Reduce on rule -R.
- *    R = 0:  Error.
- *    R > 0:  Shift to state R.
- *  Set *YYCONFLICTS to a pointer into yyconfl to a 0-terminated list
- *  of conflicting reductions.
- */
-static inline int
-yygetLRActions (yy_state_t yystate, yysymbol_kind_t yytoken, const short** yyconflicts)
-{
-  int yyindex = yypact[yystate] + yytoken;
-  if (yytoken == YYSYMBOL_YYerror)
-    {
-      // This is the error token.
-      *yyconflicts = yyconfl;
-      return 0;
-    }
-  else if (yyisDefaultedState (yystate)
-           || yyindex < 0 || YYLAST < yyindex || yycheck[yyindex] != yytoken)
-    {
-      *yyconflicts = yyconfl;
-      return -yydefact[yystate];
-    }
-  else if (! yytable_value_is_error (yytable[yyindex]))
-    {
-      *yyconflicts = yyconfl + yyconflp[yyindex];
-      return yytable[yyindex];
-    }
-  else
-    {
-      *yyconflicts = yyconfl + yyconflp[yyindex];
-      return 0;
-    }
-}
 
-/** Compute post-reduction state.
- * \param yystate   the current state
- * \param yysym     the nonterminal to push on the stack
- */
-static inline yy_state_t
-yyLRgotoState (yy_state_t yystate, yysymbol_kind_t yysym)
-{
-  int yyr = yypgoto[yysym - YYNTOKENS] + yystate;
-  if (0 <= yyr && yyr <= YYLAST && yycheck[yyr] == yystate)
-    return yytable[yyr];
-  else
-    return yydefgoto[yysym - YYNTOKENS];
-}
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
 
-static inline yybool
-yyisShiftAction (int yyaction)
-{
-  return 0 < yyaction;
-}
 
-static inline yybool
-yyisErrorAction (int yyaction)
-{
-  return yyaction == 0;
-}
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
 
-                                /* GLRStates */
 
-/** Return a fresh GLRStackItem in YYSTACKP.  The item is an LR state
- *  if YYISSTATE, and otherwise a semantic option.  Callers should call
- *  YY_RESERVE_GLRSTACK afterwards to make sure there is sufficient
- *  headroom.  */
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (comp_units, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
 
-static inline yyGLRStackItem*
-yynewGLRStackItem (yyGLRStack* yystackp, yybool yyisState)
-{
-  yyGLRStackItem* yynewItem = yystackp->yynextFree;
-  yystackp->yyspaceLeft -= 1;
-  yystackp->yynextFree += 1;
-  yynewItem->yystate.yyisState = yyisState;
-  return yynewItem;
-}
 
-/** Add a new semantic action that will execute the action for rule
- *  YYRULE on the semantic values in YYRHS to the list of
- *  alternative actions for YYSTATE.  Assumes that YYRHS comes from
- *  stack #YYK of *YYSTACKP. */
-static void
-yyaddDeferredAction (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyGLRState* yystate,
-                     yyGLRState* yyrhs, yyRuleNum yyrule)
-{
-  yySemanticOption* yynewOption =
-    &yynewGLRStackItem (yystackp, yyfalse)->yyoption;
-  YY_ASSERT (!yynewOption->yyisState);
-  yynewOption->yystate = yyrhs;
-  yynewOption->yyrule = yyrule;
-  if (yystackp->yytops.yylookaheadNeeds[yyk])
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != TK_YYEMPTY)
     {
-      yynewOption->yyrawchar = yychar;
-      yynewOption->yyval = yylval;
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, comp_units);
     }
-  else
-    yynewOption->yyrawchar = TK_YYEMPTY;
-  yynewOption->yynext = yystate->yysemantics.yyfirstVal;
-  yystate->yysemantics.yyfirstVal = yynewOption;
-
-  YY_RESERVE_GLRSTACK (yystackp);
-}
-
-                                /* GLRStacks */
-
-/** Initialize YYSET to a singleton set containing an empty stack.  */
-static yybool
-yyinitStateSet (yyGLRStateSet* yyset)
-{
-  yyset->yysize = 1;
-  yyset->yycapacity = 16;
-  yyset->yystates
-    = YY_CAST (yyGLRState**,
-               YYMALLOC (YY_CAST (YYSIZE_T, yyset->yycapacity)
-                         * sizeof yyset->yystates[0]));
-  if (! yyset->yystates)
-    return yyfalse;
-  yyset->yystates[0] = YY_NULLPTR;
-  yyset->yylookaheadNeeds
-    = YY_CAST (yybool*,
-               YYMALLOC (YY_CAST (YYSIZE_T, yyset->yycapacity)
-                         * sizeof yyset->yylookaheadNeeds[0]));
-  if (! yyset->yylookaheadNeeds)
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
     {
-      YYFREE (yyset->yystates);
-      return yyfalse;
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, comp_units);
+      YYPOPSTACK (1);
     }
-  memset (yyset->yylookaheadNeeds,
-          0,
-          YY_CAST (YYSIZE_T, yyset->yycapacity) * sizeof yyset->yylookaheadNeeds[0]);
-  return yytrue;
-}
-
-static void yyfreeStateSet (yyGLRStateSet* yyset)
-{
-  YYFREE (yyset->yystates);
-  YYFREE (yyset->yylookaheadNeeds);
-}
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
 
-/** Initialize *YYSTACKP to a single empty stack, with total maximum
- *  capacity for all stacks of YYSIZE.  */
-static yybool
-yyinitGLRStack (yyGLRStack* yystackp, YYPTRDIFF_T yysize)
-{
-  yystackp->yyerrState = 0;
-  yynerrs = 0;
-  yystackp->yyspaceLeft = yysize;
-  yystackp->yyitems
-    = YY_CAST (yyGLRStackItem*,
-               YYMALLOC (YY_CAST (YYSIZE_T, yysize)
-                         * sizeof yystackp->yynextFree[0]));
-  if (!yystackp->yyitems)
-    return yyfalse;
-  yystackp->yynextFree = yystackp->yyitems;
-  yystackp->yysplitPoint = YY_NULLPTR;
-  yystackp->yylastDeleted = YY_NULLPTR;
-  return yyinitStateSet (&yystackp->yytops);
+  return yyresult;
 }
 
-
-#if YYSTACKEXPANDABLE
-# define YYRELOC(YYFROMITEMS, YYTOITEMS, YYX, YYTYPE)                   \
-  &((YYTOITEMS)                                                         \
-    - ((YYFROMITEMS) - YY_REINTERPRET_CAST (yyGLRStackItem*, (YYX))))->YYTYPE
-
-/** If *YYSTACKP is expandable, extend it.  WARNING: Pointers into the
-    stack from outside should be considered invalid after this call.
-    We always expand when there are 1 or fewer items left AFTER an
-    allocation, so that we can avoid having external pointers exist
-    across an allocation.  */
-static void
-yyexpandGLRStack (yyGLRStack* yystackp)
-{
-  yyGLRStackItem* yynewItems;
-  yyGLRStackItem* yyp0, *yyp1;
-  YYPTRDIFF_T yynewSize;
-  YYPTRDIFF_T yyn;
-  YYPTRDIFF_T yysize = yystackp->yynextFree - yystackp->yyitems;
-  if (YYMAXDEPTH - YYHEADROOM < yysize)
-    yyMemoryExhausted (yystackp);
-  yynewSize = 2*yysize;
-  if (YYMAXDEPTH < yynewSize)
-    yynewSize = YYMAXDEPTH;
-  yynewItems
-    = YY_CAST (yyGLRStackItem*,
-               YYMALLOC (YY_CAST (YYSIZE_T, yynewSize)
-                         * sizeof yynewItems[0]));
-  if (! yynewItems)
-    yyMemoryExhausted (yystackp);
-  for (yyp0 = yystackp->yyitems, yyp1 = yynewItems, yyn = yysize;
-       0 < yyn;
-       yyn -= 1, yyp0 += 1, yyp1 += 1)
-    {
-      *yyp1 = *yyp0;
-      if (*YY_REINTERPRET_CAST (yybool *, yyp0))
-        {
-          yyGLRState* yys0 = &yyp0->yystate;
-          yyGLRState* yys1 = &yyp1->yystate;
-          if (yys0->yypred != YY_NULLPTR)
-            yys1->yypred =
-              YYRELOC (yyp0, yyp1, yys0->yypred, yystate);
-          if (! yys0->yyresolved && yys0->yysemantics.yyfirstVal != YY_NULLPTR)
-            yys1->yysemantics.yyfirstVal =
-              YYRELOC (yyp0, yyp1, yys0->yysemantics.yyfirstVal, yyoption);
-        }
-      else
-        {
-          yySemanticOption* yyv0 = &yyp0->yyoption;
-          yySemanticOption* yyv1 = &yyp1->yyoption;
-          if (yyv0->yystate != YY_NULLPTR)
-            yyv1->yystate = YYRELOC (yyp0, yyp1, yyv0->yystate, yystate);
-          if (yyv0->yynext != YY_NULLPTR)
-            yyv1->yynext = YYRELOC (yyp0, yyp1, yyv0->yynext, yyoption);
-        }
-    }
-  if (yystackp->yysplitPoint != YY_NULLPTR)
-    yystackp->yysplitPoint = YYRELOC (yystackp->yyitems, yynewItems,
-                                      yystackp->yysplitPoint, yystate);
-
-  for (yyn = 0; yyn < yystackp->yytops.yysize; yyn += 1)
-    if (yystackp->yytops.yystates[yyn] != YY_NULLPTR)
-      yystackp->yytops.yystates[yyn] =
-        YYRELOC (yystackp->yyitems, yynewItems,
-                 yystackp->yytops.yystates[yyn], yystate);
-  YYFREE (yystackp->yyitems);
-  yystackp->yyitems = yynewItems;
-  yystackp->yynextFree = yynewItems + yysize;
-  yystackp->yyspaceLeft = yynewSize - yysize;
-}
-#endif
-
-static void
-yyfreeGLRStack (yyGLRStack* yystackp)
-{
-  YYFREE (yystackp->yyitems);
-  yyfreeStateSet (&yystackp->yytops);
-}
-
-/** Assuming that YYS is a GLRState somewhere on *YYSTACKP, update the
- *  splitpoint of *YYSTACKP, if needed, so that it is at least as deep as
- *  YYS.  */
-static inline void
-yyupdateSplit (yyGLRStack* yystackp, yyGLRState* yys)
-{
-  if (yystackp->yysplitPoint != YY_NULLPTR && yystackp->yysplitPoint > yys)
-    yystackp->yysplitPoint = yys;
-}
-
-/** Invalidate stack #YYK in *YYSTACKP.  */
-static inline void
-yymarkStackDeleted (yyGLRStack* yystackp, YYPTRDIFF_T yyk)
-{
-  if (yystackp->yytops.yystates[yyk] != YY_NULLPTR)
-    yystackp->yylastDeleted = yystackp->yytops.yystates[yyk];
-  yystackp->yytops.yystates[yyk] = YY_NULLPTR;
-}
-
-/** Undelete the last stack in *YYSTACKP that was marked as deleted.  Can
-    only be done once after a deletion, and only when all other stacks have
-    been deleted.  */
-static void
-yyundeleteLastStack (yyGLRStack* yystackp)
-{
-  if (yystackp->yylastDeleted == YY_NULLPTR || yystackp->yytops.yysize != 0)
-    return;
-  yystackp->yytops.yystates[0] = yystackp->yylastDeleted;
-  yystackp->yytops.yysize = 1;
-  YY_DPRINTF ((stderr, "Restoring last deleted stack as stack #0.\n"));
-  yystackp->yylastDeleted = YY_NULLPTR;
-}
-
-static inline void
-yyremoveDeletes (yyGLRStack* yystackp)
-{
-  YYPTRDIFF_T yyi, yyj;
-  yyi = yyj = 0;
-  while (yyj < yystackp->yytops.yysize)
-    {
-      if (yystackp->yytops.yystates[yyi] == YY_NULLPTR)
-        {
-          if (yyi == yyj)
-            YY_DPRINTF ((stderr, "Removing dead stacks.\n"));
-          yystackp->yytops.yysize -= 1;
-        }
-      else
-        {
-          yystackp->yytops.yystates[yyj] = yystackp->yytops.yystates[yyi];
-          /* In the current implementation, it's unnecessary to copy
-             yystackp->yytops.yylookaheadNeeds[yyi] since, after
-             yyremoveDeletes returns, the parser immediately either enters
-             deterministic operation or shifts a token.  However, it doesn't
-             hurt, and the code might evolve to need it.  */
-          yystackp->yytops.yylookaheadNeeds[yyj] =
-            yystackp->yytops.yylookaheadNeeds[yyi];
-          if (yyj != yyi)
-            YY_DPRINTF ((stderr, "Rename stack %ld -> %ld.\n",
-                        YY_CAST (long, yyi), YY_CAST (long, yyj)));
-          yyj += 1;
-        }
-      yyi += 1;
-    }
-}
-
-/** Shift to a new state on stack #YYK of *YYSTACKP, corresponding to LR
- * state YYLRSTATE, at input position YYPOSN, with (resolved) semantic
- * value *YYVALP and source location *YYLOCP.  */
-static inline void
-yyglrShift (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yy_state_t yylrState,
-            YYPTRDIFF_T yyposn,
-            YYSTYPE* yyvalp)
-{
-  yyGLRState* yynewState = &yynewGLRStackItem (yystackp, yytrue)->yystate;
-
-  yynewState->yylrState = yylrState;
-  yynewState->yyposn = yyposn;
-  yynewState->yyresolved = yytrue;
-  yynewState->yypred = yystackp->yytops.yystates[yyk];
-  yynewState->yysemantics.yyval = *yyvalp;
-  yystackp->yytops.yystates[yyk] = yynewState;
-
-  YY_RESERVE_GLRSTACK (yystackp);
-}
-
-/** Shift stack #YYK of *YYSTACKP, to a new state corresponding to LR
- *  state YYLRSTATE, at input position YYPOSN, with the (unresolved)
- *  semantic value of YYRHS under the action for YYRULE.  */
-static inline void
-yyglrShiftDefer (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yy_state_t yylrState,
-                 YYPTRDIFF_T yyposn, yyGLRState* yyrhs, yyRuleNum yyrule)
-{
-  yyGLRState* yynewState = &yynewGLRStackItem (yystackp, yytrue)->yystate;
-  YY_ASSERT (yynewState->yyisState);
-
-  yynewState->yylrState = yylrState;
-  yynewState->yyposn = yyposn;
-  yynewState->yyresolved = yyfalse;
-  yynewState->yypred = yystackp->yytops.yystates[yyk];
-  yynewState->yysemantics.yyfirstVal = YY_NULLPTR;
-  yystackp->yytops.yystates[yyk] = yynewState;
-
-  /* Invokes YY_RESERVE_GLRSTACK.  */
-  yyaddDeferredAction (yystackp, yyk, yynewState, yyrhs, yyrule);
-}
-
-#if YYDEBUG
-
-/*----------------------------------------------------------------------.
-| Report that stack #YYK of *YYSTACKP is going to be reduced by YYRULE. |
-`----------------------------------------------------------------------*/
-
-static inline void
-yy_reduce_print (yybool yynormal, yyGLRStackItem* yyvsp, YYPTRDIFF_T yyk,
-                 yyRuleNum yyrule, std::shared_ptr<CompUnits> comp_units)
-{
-  int yynrhs = yyrhsLength (yyrule);
-  int yyi;
-  YY_FPRINTF ((stderr, "Reducing stack %ld by rule %d (line %d):\n",
-               YY_CAST (long, yyk), yyrule - 1, yyrline[yyrule]));
-  if (! yynormal)
-    yyfillin (yyvsp, 1, -yynrhs);
-  /* The symbols being reduced.  */
-  for (yyi = 0; yyi < yynrhs; yyi++)
-    {
-      YY_FPRINTF ((stderr, "   $%d = ", yyi + 1));
-      yy_symbol_print (stderr,
-                       yy_accessing_symbol (yyvsp[yyi - yynrhs + 1].yystate.yylrState),
-                       &yyvsp[yyi - yynrhs + 1].yystate.yysemantics.yyval                       , comp_units);
-      if (!yyvsp[yyi - yynrhs + 1].yystate.yyresolved)
-        YY_FPRINTF ((stderr, " (unresolved)"));
-      YY_FPRINTF ((stderr, "\n"));
-    }
-}
-#endif
-
-/** Pop the symbols consumed by reduction #YYRULE from the top of stack
- *  #YYK of *YYSTACKP, and perform the appropriate semantic action on their
- *  semantic values.  Assumes that all ambiguities in semantic values
- *  have been previously resolved.  Set *YYVALP to the resulting value,
- *  and *YYLOCP to the computed location (if any).  Return value is as
- *  for userAction.  */
-static inline YYRESULTTAG
-yydoAction (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
-            YYSTYPE* yyvalp, std::shared_ptr<CompUnits> comp_units)
-{
-  int yynrhs = yyrhsLength (yyrule);
-
-  if (yystackp->yysplitPoint == YY_NULLPTR)
-    {
-      /* Standard special case: single stack.  */
-      yyGLRStackItem* yyrhs
-        = YY_REINTERPRET_CAST (yyGLRStackItem*, yystackp->yytops.yystates[yyk]);
-      YY_ASSERT (yyk == 0);
-      yystackp->yynextFree -= yynrhs;
-      yystackp->yyspaceLeft += yynrhs;
-      yystackp->yytops.yystates[0] = & yystackp->yynextFree[-1].yystate;
-      return yyuserAction (yyrule, yynrhs, yyrhs, yystackp, yyk,
-                           yyvalp, comp_units);
-    }
-  else
-    {
-      yyGLRStackItem yyrhsVals[YYMAXRHS + YYMAXLEFT + 1];
-      yyGLRState* yys = yyrhsVals[YYMAXRHS + YYMAXLEFT].yystate.yypred
-        = yystackp->yytops.yystates[yyk];
-      int yyi;
-      for (yyi = 0; yyi < yynrhs; yyi += 1)
-        {
-          yys = yys->yypred;
-          YY_ASSERT (yys);
-        }
-      yyupdateSplit (yystackp, yys);
-      yystackp->yytops.yystates[yyk] = yys;
-      return yyuserAction (yyrule, yynrhs, yyrhsVals + YYMAXRHS + YYMAXLEFT - 1,
-                           yystackp, yyk, yyvalp, comp_units);
-    }
-}
-
-/** Pop items off stack #YYK of *YYSTACKP according to grammar rule YYRULE,
- *  and push back on the resulting nonterminal symbol.  Perform the
- *  semantic action associated with YYRULE and store its value with the
- *  newly pushed state, if YYFORCEEVAL or if *YYSTACKP is currently
- *  unambiguous.  Otherwise, store the deferred semantic action with
- *  the new state.  If the new state would have an identical input
- *  position, LR state, and predecessor to an existing state on the stack,
- *  it is identified with that existing state, eliminating stack #YYK from
- *  *YYSTACKP.  In this case, the semantic value is
- *  added to the options for the existing state's semantic value.
- */
-static inline YYRESULTTAG
-yyglrReduce (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
-             yybool yyforceEval, std::shared_ptr<CompUnits> comp_units)
-{
-  YYPTRDIFF_T yyposn = yystackp->yytops.yystates[yyk]->yyposn;
-
-  if (yyforceEval || yystackp->yysplitPoint == YY_NULLPTR)
-    {
-      YYSTYPE yyval;
-
-      YYRESULTTAG yyflag = yydoAction (yystackp, yyk, yyrule, &yyval, comp_units);
-      if (yyflag == yyerr && yystackp->yysplitPoint != YY_NULLPTR)
-        YY_DPRINTF ((stderr,
-                     "Parse on stack %ld rejected by rule %d (line %d).\n",
-                     YY_CAST (long, yyk), yyrule - 1, yyrline[yyrule]));
-      if (yyflag != yyok)
-        return yyflag;
-      yyglrShift (yystackp, yyk,
-                  yyLRgotoState (yystackp->yytops.yystates[yyk]->yylrState,
-                                 yylhsNonterm (yyrule)),
-                  yyposn, &yyval);
-    }
-  else
-    {
-      YYPTRDIFF_T yyi;
-      int yyn;
-      yyGLRState* yys, *yys0 = yystackp->yytops.yystates[yyk];
-      yy_state_t yynewLRState;
-
-      for (yys = yystackp->yytops.yystates[yyk], yyn = yyrhsLength (yyrule);
-           0 < yyn; yyn -= 1)
-        {
-          yys = yys->yypred;
-          YY_ASSERT (yys);
-        }
-      yyupdateSplit (yystackp, yys);
-      yynewLRState = yyLRgotoState (yys->yylrState, yylhsNonterm (yyrule));
-      YY_DPRINTF ((stderr,
-                   "Reduced stack %ld by rule %d (line %d); action deferred.  "
-                   "Now in state %d.\n",
-                   YY_CAST (long, yyk), yyrule - 1, yyrline[yyrule],
-                   yynewLRState));
-      for (yyi = 0; yyi < yystackp->yytops.yysize; yyi += 1)
-        if (yyi != yyk && yystackp->yytops.yystates[yyi] != YY_NULLPTR)
-          {
-            yyGLRState *yysplit = yystackp->yysplitPoint;
-            yyGLRState *yyp = yystackp->yytops.yystates[yyi];
-            while (yyp != yys && yyp != yysplit && yyp->yyposn >= yyposn)
-              {
-                if (yyp->yylrState == yynewLRState && yyp->yypred == yys)
-                  {
-                    yyaddDeferredAction (yystackp, yyk, yyp, yys0, yyrule);
-                    yymarkStackDeleted (yystackp, yyk);
-                    YY_DPRINTF ((stderr, "Merging stack %ld into stack %ld.\n",
-                                 YY_CAST (long, yyk), YY_CAST (long, yyi)));
-                    return yyok;
-                  }
-                yyp = yyp->yypred;
-              }
-          }
-      yystackp->yytops.yystates[yyk] = yys;
-      yyglrShiftDefer (yystackp, yyk, yynewLRState, yyposn, yys0, yyrule);
-    }
-  return yyok;
-}
-
-static YYPTRDIFF_T
-yysplitStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk)
-{
-  if (yystackp->yysplitPoint == YY_NULLPTR)
-    {
-      YY_ASSERT (yyk == 0);
-      yystackp->yysplitPoint = yystackp->yytops.yystates[yyk];
-    }
-  if (yystackp->yytops.yycapacity <= yystackp->yytops.yysize)
-    {
-      YYPTRDIFF_T state_size = YYSIZEOF (yystackp->yytops.yystates[0]);
-      YYPTRDIFF_T half_max_capacity = YYSIZE_MAXIMUM / 2 / state_size;
-      if (half_max_capacity < yystackp->yytops.yycapacity)
-        yyMemoryExhausted (yystackp);
-      yystackp->yytops.yycapacity *= 2;
-
-      {
-        yyGLRState** yynewStates
-          = YY_CAST (yyGLRState**,
-                     YYREALLOC (yystackp->yytops.yystates,
-                                (YY_CAST (YYSIZE_T, yystackp->yytops.yycapacity)
-                                 * sizeof yynewStates[0])));
-        if (yynewStates == YY_NULLPTR)
-          yyMemoryExhausted (yystackp);
-        yystackp->yytops.yystates = yynewStates;
-      }
-
-      {
-        yybool* yynewLookaheadNeeds
-          = YY_CAST (yybool*,
-                     YYREALLOC (yystackp->yytops.yylookaheadNeeds,
-                                (YY_CAST (YYSIZE_T, yystackp->yytops.yycapacity)
-                                 * sizeof yynewLookaheadNeeds[0])));
-        if (yynewLookaheadNeeds == YY_NULLPTR)
-          yyMemoryExhausted (yystackp);
-        yystackp->yytops.yylookaheadNeeds = yynewLookaheadNeeds;
-      }
-    }
-  yystackp->yytops.yystates[yystackp->yytops.yysize]
-    = yystackp->yytops.yystates[yyk];
-  yystackp->yytops.yylookaheadNeeds[yystackp->yytops.yysize]
-    = yystackp->yytops.yylookaheadNeeds[yyk];
-  yystackp->yytops.yysize += 1;
-  return yystackp->yytops.yysize - 1;
-}
-
-/** True iff YYY0 and YYY1 represent identical options at the top level.
- *  That is, they represent the same rule applied to RHS symbols
- *  that produce the same terminal symbols.  */
-static yybool
-yyidenticalOptions (yySemanticOption* yyy0, yySemanticOption* yyy1)
-{
-  if (yyy0->yyrule == yyy1->yyrule)
-    {
-      yyGLRState *yys0, *yys1;
-      int yyn;
-      for (yys0 = yyy0->yystate, yys1 = yyy1->yystate,
-           yyn = yyrhsLength (yyy0->yyrule);
-           yyn > 0;
-           yys0 = yys0->yypred, yys1 = yys1->yypred, yyn -= 1)
-        if (yys0->yyposn != yys1->yyposn)
-          return yyfalse;
-      return yytrue;
-    }
-  else
-    return yyfalse;
-}
-
-/** Assuming identicalOptions (YYY0,YYY1), destructively merge the
- *  alternative semantic values for the RHS-symbols of YYY1 and YYY0.  */
-static void
-yymergeOptionSets (yySemanticOption* yyy0, yySemanticOption* yyy1)
-{
-  yyGLRState *yys0, *yys1;
-  int yyn;
-  for (yys0 = yyy0->yystate, yys1 = yyy1->yystate,
-       yyn = yyrhsLength (yyy0->yyrule);
-       0 < yyn;
-       yys0 = yys0->yypred, yys1 = yys1->yypred, yyn -= 1)
-    {
-      if (yys0 == yys1)
-        break;
-      else if (yys0->yyresolved)
-        {
-          yys1->yyresolved = yytrue;
-          yys1->yysemantics.yyval = yys0->yysemantics.yyval;
-        }
-      else if (yys1->yyresolved)
-        {
-          yys0->yyresolved = yytrue;
-          yys0->yysemantics.yyval = yys1->yysemantics.yyval;
-        }
-      else
-        {
-          yySemanticOption** yyz0p = &yys0->yysemantics.yyfirstVal;
-          yySemanticOption* yyz1 = yys1->yysemantics.yyfirstVal;
-          while (yytrue)
-            {
-              if (yyz1 == *yyz0p || yyz1 == YY_NULLPTR)
-                break;
-              else if (*yyz0p == YY_NULLPTR)
-                {
-                  *yyz0p = yyz1;
-                  break;
-                }
-              else if (*yyz0p < yyz1)
-                {
-                  yySemanticOption* yyz = *yyz0p;
-                  *yyz0p = yyz1;
-                  yyz1 = yyz1->yynext;
-                  (*yyz0p)->yynext = yyz;
-                }
-              yyz0p = &(*yyz0p)->yynext;
-            }
-          yys1->yysemantics.yyfirstVal = yys0->yysemantics.yyfirstVal;
-        }
-    }
-}
-
-/** Y0 and Y1 represent two possible actions to take in a given
- *  parsing state; return 0 if no combination is possible,
- *  1 if user-mergeable, 2 if Y0 is preferred, 3 if Y1 is preferred.  */
-static int
-yypreference (yySemanticOption* y0, yySemanticOption* y1)
-{
-  yyRuleNum r0 = y0->yyrule, r1 = y1->yyrule;
-  int p0 = yydprec[r0], p1 = yydprec[r1];
-
-  if (p0 == p1)
-    {
-      if (yymerger[r0] == 0 || yymerger[r0] != yymerger[r1])
-        return 0;
-      else
-        return 1;
-    }
-  if (p0 == 0 || p1 == 0)
-    return 0;
-  if (p0 < p1)
-    return 3;
-  if (p1 < p0)
-    return 2;
-  return 0;
-}
-
-static YYRESULTTAG
-yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units);
-
-
-/** Resolve the previous YYN states starting at and including state YYS
- *  on *YYSTACKP. If result != yyok, some states may have been left
- *  unresolved possibly with empty semantic option chains.  Regardless
- *  of whether result = yyok, each state has been left with consistent
- *  data so that yydestroyGLRState can be invoked if necessary.  */
-static YYRESULTTAG
-yyresolveStates (yyGLRState* yys, int yyn,
-                 yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units)
-{
-  if (0 < yyn)
-    {
-      YY_ASSERT (yys->yypred);
-      YYCHK (yyresolveStates (yys->yypred, yyn-1, yystackp, comp_units));
-      if (! yys->yyresolved)
-        YYCHK (yyresolveValue (yys, yystackp, comp_units));
-    }
-  return yyok;
-}
-
-/** Resolve the states for the RHS of YYOPT on *YYSTACKP, perform its
- *  user action, and return the semantic value and location in *YYVALP
- *  and *YYLOCP.  Regardless of whether result = yyok, all RHS states
- *  have been destroyed (assuming the user action destroys all RHS
- *  semantic values if invoked).  */
-static YYRESULTTAG
-yyresolveAction (yySemanticOption* yyopt, yyGLRStack* yystackp,
-                 YYSTYPE* yyvalp, std::shared_ptr<CompUnits> comp_units)
-{
-  yyGLRStackItem yyrhsVals[YYMAXRHS + YYMAXLEFT + 1];
-  int yynrhs = yyrhsLength (yyopt->yyrule);
-  YYRESULTTAG yyflag =
-    yyresolveStates (yyopt->yystate, yynrhs, yystackp, comp_units);
-  if (yyflag != yyok)
-    {
-      yyGLRState *yys;
-      for (yys = yyopt->yystate; yynrhs > 0; yys = yys->yypred, yynrhs -= 1)
-        yydestroyGLRState ("Cleanup: popping", yys, comp_units);
-      return yyflag;
-    }
-
-  yyrhsVals[YYMAXRHS + YYMAXLEFT].yystate.yypred = yyopt->yystate;
-  {
-    int yychar_current = yychar;
-    YYSTYPE yylval_current = yylval;
-    yychar = yyopt->yyrawchar;
-    yylval = yyopt->yyval;
-    yyflag = yyuserAction (yyopt->yyrule, yynrhs,
-                           yyrhsVals + YYMAXRHS + YYMAXLEFT - 1,
-                           yystackp, -1, yyvalp, comp_units);
-    yychar = yychar_current;
-    yylval = yylval_current;
-  }
-  return yyflag;
-}
-
-#if YYDEBUG
-static void
-yyreportTree (yySemanticOption* yyx, int yyindent)
-{
-  int yynrhs = yyrhsLength (yyx->yyrule);
-  int yyi;
-  yyGLRState* yys;
-  yyGLRState* yystates[1 + YYMAXRHS];
-  yyGLRState yyleftmost_state;
-
-  for (yyi = yynrhs, yys = yyx->yystate; 0 < yyi; yyi -= 1, yys = yys->yypred)
-    yystates[yyi] = yys;
-  if (yys == YY_NULLPTR)
-    {
-      yyleftmost_state.yyposn = 0;
-      yystates[0] = &yyleftmost_state;
-    }
-  else
-    yystates[0] = yys;
-
-  if (yyx->yystate->yyposn < yys->yyposn + 1)
-    YY_FPRINTF ((stderr, "%*s%s -> <Rule %d, empty>\n",
-                 yyindent, "", yysymbol_name (yylhsNonterm (yyx->yyrule)),
-                 yyx->yyrule - 1));
-  else
-    YY_FPRINTF ((stderr, "%*s%s -> <Rule %d, tokens %ld .. %ld>\n",
-                 yyindent, "", yysymbol_name (yylhsNonterm (yyx->yyrule)),
-                 yyx->yyrule - 1, YY_CAST (long, yys->yyposn + 1),
-                 YY_CAST (long, yyx->yystate->yyposn)));
-  for (yyi = 1; yyi <= yynrhs; yyi += 1)
-    {
-      if (yystates[yyi]->yyresolved)
-        {
-          if (yystates[yyi-1]->yyposn+1 > yystates[yyi]->yyposn)
-            YY_FPRINTF ((stderr, "%*s%s <empty>\n", yyindent+2, "",
-                         yysymbol_name (yy_accessing_symbol (yystates[yyi]->yylrState))));
-          else
-            YY_FPRINTF ((stderr, "%*s%s <tokens %ld .. %ld>\n", yyindent+2, "",
-                         yysymbol_name (yy_accessing_symbol (yystates[yyi]->yylrState)),
-                         YY_CAST (long, yystates[yyi-1]->yyposn + 1),
-                         YY_CAST (long, yystates[yyi]->yyposn)));
-        }
-      else
-        yyreportTree (yystates[yyi]->yysemantics.yyfirstVal, yyindent+2);
-    }
-}
-#endif
-
-static YYRESULTTAG
-yyreportAmbiguity (yySemanticOption* yyx0,
-                   yySemanticOption* yyx1, std::shared_ptr<CompUnits> comp_units)
-{
-  YY_USE (yyx0);
-  YY_USE (yyx1);
-
-#if YYDEBUG
-  YY_FPRINTF ((stderr, "Ambiguity detected.\n"));
-  YY_FPRINTF ((stderr, "Option 1,\n"));
-  yyreportTree (yyx0, 2);
-  YY_FPRINTF ((stderr, "\nOption 2,\n"));
-  yyreportTree (yyx1, 2);
-  YY_FPRINTF ((stderr, "\n"));
-#endif
-
-  yyerror (comp_units, YY_("syntax is ambiguous"));
-  return yyabort;
-}
-
-/** Resolve the ambiguity represented in state YYS in *YYSTACKP,
- *  perform the indicated actions, and set the semantic value of YYS.
- *  If result != yyok, the chain of semantic options in YYS has been
- *  cleared instead or it has been left unmodified except that
- *  redundant options may have been removed.  Regardless of whether
- *  result = yyok, YYS has been left with consistent data so that
- *  yydestroyGLRState can be invoked if necessary.  */
-static YYRESULTTAG
-yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units)
-{
-  yySemanticOption* yyoptionList = yys->yysemantics.yyfirstVal;
-  yySemanticOption* yybest = yyoptionList;
-  yySemanticOption** yypp;
-  yybool yymerge = yyfalse;
-  YYSTYPE yyval;
-  YYRESULTTAG yyflag;
-
-  for (yypp = &yyoptionList->yynext; *yypp != YY_NULLPTR; )
-    {
-      yySemanticOption* yyp = *yypp;
-
-      if (yyidenticalOptions (yybest, yyp))
-        {
-          yymergeOptionSets (yybest, yyp);
-          *yypp = yyp->yynext;
-        }
-      else
-        {
-          switch (yypreference (yybest, yyp))
-            {
-            case 0:
-              return yyreportAmbiguity (yybest, yyp, comp_units);
-              break;
-            case 1:
-              yymerge = yytrue;
-              break;
-            case 2:
-              break;
-            case 3:
-              yybest = yyp;
-              yymerge = yyfalse;
-              break;
-            default:
-              /* This cannot happen so it is not worth a YY_ASSERT (yyfalse),
-                 but some compilers complain if the default case is
-                 omitted.  */
-              break;
-            }
-          yypp = &yyp->yynext;
-        }
-    }
-
-  if (yymerge)
-    {
-      yySemanticOption* yyp;
-      int yyprec = yydprec[yybest->yyrule];
-      yyflag = yyresolveAction (yybest, yystackp, &yyval, comp_units);
-      if (yyflag == yyok)
-        for (yyp = yybest->yynext; yyp != YY_NULLPTR; yyp = yyp->yynext)
-          {
-            if (yyprec == yydprec[yyp->yyrule])
-              {
-                YYSTYPE yyval_other;
-                yyflag = yyresolveAction (yyp, yystackp, &yyval_other, comp_units);
-                if (yyflag != yyok)
-                  {
-                    yydestruct ("Cleanup: discarding incompletely merged value for",
-                                yy_accessing_symbol (yys->yylrState),
-                                &yyval, comp_units);
-                    break;
-                  }
-                yyuserMerge (yymerger[yyp->yyrule], &yyval, &yyval_other);
-              }
-          }
-    }
-  else
-    yyflag = yyresolveAction (yybest, yystackp, &yyval, comp_units);
-
-  if (yyflag == yyok)
-    {
-      yys->yyresolved = yytrue;
-      yys->yysemantics.yyval = yyval;
-    }
-  else
-    yys->yysemantics.yyfirstVal = YY_NULLPTR;
-  return yyflag;
-}
-
-static YYRESULTTAG
-yyresolveStack (yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units)
-{
-  if (yystackp->yysplitPoint != YY_NULLPTR)
-    {
-      yyGLRState* yys;
-      int yyn;
-
-      for (yyn = 0, yys = yystackp->yytops.yystates[0];
-           yys != yystackp->yysplitPoint;
-           yys = yys->yypred, yyn += 1)
-        continue;
-      YYCHK (yyresolveStates (yystackp->yytops.yystates[0], yyn, yystackp
-                             , comp_units));
-    }
-  return yyok;
-}
-
-/** Called when returning to deterministic operation to clean up the extra
- * stacks. */
-static void
-yycompressStack (yyGLRStack* yystackp)
-{
-  /* yyr is the state after the split point.  */
-  yyGLRState *yyr;
-
-  if (yystackp->yytops.yysize != 1 || yystackp->yysplitPoint == YY_NULLPTR)
-    return;
-
-  {
-    yyGLRState *yyp, *yyq;
-    for (yyp = yystackp->yytops.yystates[0], yyq = yyp->yypred, yyr = YY_NULLPTR;
-         yyp != yystackp->yysplitPoint;
-         yyr = yyp, yyp = yyq, yyq = yyp->yypred)
-      yyp->yypred = yyr;
-  }
-
-  yystackp->yyspaceLeft += yystackp->yynextFree - yystackp->yyitems;
-  yystackp->yynextFree = YY_REINTERPRET_CAST (yyGLRStackItem*, yystackp->yysplitPoint) + 1;
-  yystackp->yyspaceLeft -= yystackp->yynextFree - yystackp->yyitems;
-  yystackp->yysplitPoint = YY_NULLPTR;
-  yystackp->yylastDeleted = YY_NULLPTR;
-
-  while (yyr != YY_NULLPTR)
-    {
-      yystackp->yynextFree->yystate = *yyr;
-      yyr = yyr->yypred;
-      yystackp->yynextFree->yystate.yypred = &yystackp->yynextFree[-1].yystate;
-      yystackp->yytops.yystates[0] = &yystackp->yynextFree->yystate;
-      yystackp->yynextFree += 1;
-      yystackp->yyspaceLeft -= 1;
-    }
-}
-
-static YYRESULTTAG
-yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
-                   YYPTRDIFF_T yyposn, std::shared_ptr<CompUnits> comp_units)
-{
-  while (yystackp->yytops.yystates[yyk] != YY_NULLPTR)
-    {
-      yy_state_t yystate = yystackp->yytops.yystates[yyk]->yylrState;
-      YY_DPRINTF ((stderr, "Stack %ld Entering state %d\n",
-                   YY_CAST (long, yyk), yystate));
-
-      YY_ASSERT (yystate != YYFINAL);
-
-      if (yyisDefaultedState (yystate))
-        {
-          YYRESULTTAG yyflag;
-          yyRuleNum yyrule = yydefaultAction (yystate);
-          if (yyrule == 0)
-            {
-              YY_DPRINTF ((stderr, "Stack %ld dies.\n", YY_CAST (long, yyk)));
-              yymarkStackDeleted (yystackp, yyk);
-              return yyok;
-            }
-          yyflag = yyglrReduce (yystackp, yyk, yyrule, yyimmediate[yyrule], comp_units);
-          if (yyflag == yyerr)
-            {
-              YY_DPRINTF ((stderr,
-                           "Stack %ld dies "
-                           "(predicate failure or explicit user error).\n",
-                           YY_CAST (long, yyk)));
-              yymarkStackDeleted (yystackp, yyk);
-              return yyok;
-            }
-          if (yyflag != yyok)
-            return yyflag;
-        }
-      else
-        {
-          yysymbol_kind_t yytoken = yygetToken (&yychar, comp_units);
-          const short* yyconflicts;
-          const int yyaction = yygetLRActions (yystate, yytoken, &yyconflicts);
-          yystackp->yytops.yylookaheadNeeds[yyk] = yytrue;
-
-          for (/* nothing */; *yyconflicts; yyconflicts += 1)
-            {
-              YYRESULTTAG yyflag;
-              YYPTRDIFF_T yynewStack = yysplitStack (yystackp, yyk);
-              YY_DPRINTF ((stderr, "Splitting off stack %ld from %ld.\n",
-                           YY_CAST (long, yynewStack), YY_CAST (long, yyk)));
-              yyflag = yyglrReduce (yystackp, yynewStack,
-                                    *yyconflicts,
-                                    yyimmediate[*yyconflicts], comp_units);
-              if (yyflag == yyok)
-                YYCHK (yyprocessOneStack (yystackp, yynewStack,
-                                          yyposn, comp_units));
-              else if (yyflag == yyerr)
-                {
-                  YY_DPRINTF ((stderr, "Stack %ld dies.\n", YY_CAST (long, yynewStack)));
-                  yymarkStackDeleted (yystackp, yynewStack);
-                }
-              else
-                return yyflag;
-            }
-
-          if (yyisShiftAction (yyaction))
-            break;
-          else if (yyisErrorAction (yyaction))
-            {
-              YY_DPRINTF ((stderr, "Stack %ld dies.\n", YY_CAST (long, yyk)));
-              yymarkStackDeleted (yystackp, yyk);
-              break;
-            }
-          else
-            {
-              YYRESULTTAG yyflag = yyglrReduce (yystackp, yyk, -yyaction,
-                                                yyimmediate[-yyaction], comp_units);
-              if (yyflag == yyerr)
-                {
-                  YY_DPRINTF ((stderr,
-                               "Stack %ld dies "
-                               "(predicate failure or explicit user error).\n",
-                               YY_CAST (long, yyk)));
-                  yymarkStackDeleted (yystackp, yyk);
-                  break;
-                }
-              else if (yyflag != yyok)
-                return yyflag;
-            }
-        }
-    }
-  return yyok;
-}
-
-
-
-
-
-
-static void
-yyreportSyntaxError (yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units)
-{
-  if (yystackp->yyerrState != 0)
-    return;
-  yyerror (comp_units, YY_("syntax error"));
-  yynerrs += 1;
-}
-
-/* Recover from a syntax error on *YYSTACKP, assuming that *YYSTACKP->YYTOKENP,
-   yylval, and yylloc are the syntactic category, semantic value, and location
-   of the lookahead.  */
-static void
-yyrecoverSyntaxError (yyGLRStack* yystackp, std::shared_ptr<CompUnits> comp_units)
-{
-  if (yystackp->yyerrState == 3)
-    /* We just shifted the error token and (perhaps) took some
-       reductions.  Skip tokens until we can proceed.  */
-    while (yytrue)
-      {
-        yysymbol_kind_t yytoken;
-        int yyj;
-        if (yychar == TK_YYEOF)
-          yyFail (yystackp, comp_units, YY_NULLPTR);
-        if (yychar != TK_YYEMPTY)
-          {
-            yytoken = YYTRANSLATE (yychar);
-            yydestruct ("Error: discarding",
-                        yytoken, &yylval, comp_units);
-            yychar = TK_YYEMPTY;
-          }
-        yytoken = yygetToken (&yychar, comp_units);
-        yyj = yypact[yystackp->yytops.yystates[0]->yylrState];
-        if (yypact_value_is_default (yyj))
-          return;
-        yyj += yytoken;
-        if (yyj < 0 || YYLAST < yyj || yycheck[yyj] != yytoken)
-          {
-            if (yydefact[yystackp->yytops.yystates[0]->yylrState] != 0)
-              return;
-          }
-        else if (! yytable_value_is_error (yytable[yyj]))
-          return;
-      }
-
-  /* Reduce to one stack.  */
-  {
-    YYPTRDIFF_T yyk;
-    for (yyk = 0; yyk < yystackp->yytops.yysize; yyk += 1)
-      if (yystackp->yytops.yystates[yyk] != YY_NULLPTR)
-        break;
-    if (yyk >= yystackp->yytops.yysize)
-      yyFail (yystackp, comp_units, YY_NULLPTR);
-    for (yyk += 1; yyk < yystackp->yytops.yysize; yyk += 1)
-      yymarkStackDeleted (yystackp, yyk);
-    yyremoveDeletes (yystackp);
-    yycompressStack (yystackp);
-  }
-
-  /* Pop stack until we find a state that shifts the error token.  */
-  yystackp->yyerrState = 3;
-  while (yystackp->yytops.yystates[0] != YY_NULLPTR)
-    {
-      yyGLRState *yys = yystackp->yytops.yystates[0];
-      int yyj = yypact[yys->yylrState];
-      if (! yypact_value_is_default (yyj))
-        {
-          yyj += YYSYMBOL_YYerror;
-          if (0 <= yyj && yyj <= YYLAST && yycheck[yyj] == YYSYMBOL_YYerror
-              && yyisShiftAction (yytable[yyj]))
-            {
-              /* Shift the error token.  */
-              int yyaction = yytable[yyj];
-              YY_SYMBOL_PRINT ("Shifting", yy_accessing_symbol (yyaction),
-                               &yylval, &yyerrloc);
-              yyglrShift (yystackp, 0, yyaction,
-                          yys->yyposn, &yylval);
-              yys = yystackp->yytops.yystates[0];
-              break;
-            }
-        }
-      if (yys->yypred != YY_NULLPTR)
-        yydestroyGLRState ("Error: popping", yys, comp_units);
-      yystackp->yytops.yystates[0] = yys->yypred;
-      yystackp->yynextFree -= 1;
-      yystackp->yyspaceLeft += 1;
-    }
-  if (yystackp->yytops.yystates[0] == YY_NULLPTR)
-    yyFail (yystackp, comp_units, YY_NULLPTR);
-}
-
-#define YYCHK1(YYE)                             \
-  do {                                          \
-    switch (YYE) {                              \
-    case yyok:     break;                       \
-    case yyabort:  goto yyabortlab;             \
-    case yyaccept: goto yyacceptlab;            \
-    case yyerr:    goto yyuser_error;           \
-    case yynomem:  goto yyexhaustedlab;         \
-    default:       goto yybuglab;               \
-    }                                           \
-  } while (0)
-
-/*----------.
-| yyparse.  |
-`----------*/
-
-int
-yyparse (std::shared_ptr<CompUnits> comp_units)
-{
-  int yyresult;
-  yyGLRStack yystack;
-  yyGLRStack* const yystackp = &yystack;
-  YYPTRDIFF_T yyposn;
-
-  YY_DPRINTF ((stderr, "Starting parse\n"));
-
-  yychar = TK_YYEMPTY;
-  yylval = yyval_default;
-
-  if (! yyinitGLRStack (yystackp, YYINITDEPTH))
-    goto yyexhaustedlab;
-  switch (YYSETJMP (yystack.yyexception_buffer))
-    {
-    case 0: break;
-    case 1: goto yyabortlab;
-    case 2: goto yyexhaustedlab;
-    default: goto yybuglab;
-    }
-  yyglrShift (&yystack, 0, 0, 0, &yylval);
-  yyposn = 0;
-
-  while (yytrue)
-    {
-      /* For efficiency, we have two loops, the first of which is
-         specialized to deterministic operation (single stack, no
-         potential ambiguity).  */
-      /* Standard mode. */
-      while (yytrue)
-        {
-          yy_state_t yystate = yystack.yytops.yystates[0]->yylrState;
-          YY_DPRINTF ((stderr, "Entering state %d\n", yystate));
-          if (yystate == YYFINAL)
-            goto yyacceptlab;
-          if (yyisDefaultedState (yystate))
-            {
-              yyRuleNum yyrule = yydefaultAction (yystate);
-              if (yyrule == 0)
-                {
-                  yyreportSyntaxError (&yystack, comp_units);
-                  goto yyuser_error;
-                }
-              YYCHK1 (yyglrReduce (&yystack, 0, yyrule, yytrue, comp_units));
-            }
-          else
-            {
-              yysymbol_kind_t yytoken = yygetToken (&yychar, comp_units);
-              const short* yyconflicts;
-              int yyaction = yygetLRActions (yystate, yytoken, &yyconflicts);
-              if (*yyconflicts)
-                /* Enter nondeterministic mode.  */
-                break;
-              if (yyisShiftAction (yyaction))
-                {
-                  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-                  yychar = TK_YYEMPTY;
-                  yyposn += 1;
-                  yyglrShift (&yystack, 0, yyaction, yyposn, &yylval);
-                  if (0 < yystack.yyerrState)
-                    yystack.yyerrState -= 1;
-                }
-              else if (yyisErrorAction (yyaction))
-                {
-                  /* Issue an error message unless the scanner already
-                     did. */
-                  if (yychar != TK_YYerror)
-                    yyreportSyntaxError (&yystack, comp_units);
-                  goto yyuser_error;
-                }
-              else
-                YYCHK1 (yyglrReduce (&yystack, 0, -yyaction, yytrue, comp_units));
-            }
-        }
-
-      /* Nondeterministic mode. */
-      while (yytrue)
-        {
-          yysymbol_kind_t yytoken_to_shift;
-          YYPTRDIFF_T yys;
-
-          for (yys = 0; yys < yystack.yytops.yysize; yys += 1)
-            yystackp->yytops.yylookaheadNeeds[yys] = yychar != TK_YYEMPTY;
-
-          /* yyprocessOneStack returns one of three things:
-
-              - An error flag.  If the caller is yyprocessOneStack, it
-                immediately returns as well.  When the caller is finally
-                yyparse, it jumps to an error label via YYCHK1.
-
-              - yyok, but yyprocessOneStack has invoked yymarkStackDeleted
-                (&yystack, yys), which sets the top state of yys to NULL.  Thus,
-                yyparse's following invocation of yyremoveDeletes will remove
-                the stack.
-
-              - yyok, when ready to shift a token.
-
-             Except in the first case, yyparse will invoke yyremoveDeletes and
-             then shift the next token onto all remaining stacks.  This
-             synchronization of the shift (that is, after all preceding
-             reductions on all stacks) helps prevent double destructor calls
-             on yylval in the event of memory exhaustion.  */
-
-          for (yys = 0; yys < yystack.yytops.yysize; yys += 1)
-            YYCHK1 (yyprocessOneStack (&yystack, yys, yyposn, comp_units));
-          yyremoveDeletes (&yystack);
-          if (yystack.yytops.yysize == 0)
-            {
-              yyundeleteLastStack (&yystack);
-              if (yystack.yytops.yysize == 0)
-                yyFail (&yystack, comp_units, YY_("syntax error"));
-              YYCHK1 (yyresolveStack (&yystack, comp_units));
-              YY_DPRINTF ((stderr, "Returning to deterministic operation.\n"));
-              yyreportSyntaxError (&yystack, comp_units);
-              goto yyuser_error;
-            }
-
-          /* If any yyglrShift call fails, it will fail after shifting.  Thus,
-             a copy of yylval will already be on stack 0 in the event of a
-             failure in the following loop.  Thus, yychar is set to TK_YYEMPTY
-             before the loop to make sure the user destructor for yylval isn't
-             called twice.  */
-          yytoken_to_shift = YYTRANSLATE (yychar);
-          yychar = TK_YYEMPTY;
-          yyposn += 1;
-          for (yys = 0; yys < yystack.yytops.yysize; yys += 1)
-            {
-              yy_state_t yystate = yystack.yytops.yystates[yys]->yylrState;
-              const short* yyconflicts;
-              int yyaction = yygetLRActions (yystate, yytoken_to_shift,
-                              &yyconflicts);
-              /* Note that yyconflicts were handled by yyprocessOneStack.  */
-              YY_DPRINTF ((stderr, "On stack %ld, ", YY_CAST (long, yys)));
-              YY_SYMBOL_PRINT ("shifting", yytoken_to_shift, &yylval, &yylloc);
-              yyglrShift (&yystack, yys, yyaction, yyposn,
-                          &yylval);
-              YY_DPRINTF ((stderr, "Stack %ld now in state %d\n",
-                           YY_CAST (long, yys),
-                           yystack.yytops.yystates[yys]->yylrState));
-            }
-
-          if (yystack.yytops.yysize == 1)
-            {
-              YYCHK1 (yyresolveStack (&yystack, comp_units));
-              YY_DPRINTF ((stderr, "Returning to deterministic operation.\n"));
-              yycompressStack (&yystack);
-              break;
-            }
-        }
-      continue;
-    yyuser_error:
-      yyrecoverSyntaxError (&yystack, comp_units);
-      yyposn = yystack.yytops.yystates[0]->yyposn;
-    }
-
- yyacceptlab:
-  yyresult = 0;
-  goto yyreturnlab;
-
- yybuglab:
-  YY_ASSERT (yyfalse);
-  goto yyabortlab;
-
- yyabortlab:
-  yyresult = 1;
-  goto yyreturnlab;
-
- yyexhaustedlab:
-  yyerror (comp_units, YY_("memory exhausted"));
-  yyresult = 2;
-  goto yyreturnlab;
-
- yyreturnlab:
-  if (yychar != TK_YYEMPTY)
-    yydestruct ("Cleanup: discarding lookahead",
-                YYTRANSLATE (yychar), &yylval, comp_units);
-
-  /* If the stack is well-formed, pop the stack until it is empty,
-     destroying its entries as we go.  But free the stack regardless
-     of whether it is well-formed.  */
-  if (yystack.yyitems)
-    {
-      yyGLRState** yystates = yystack.yytops.yystates;
-      if (yystates)
-        {
-          YYPTRDIFF_T yysize = yystack.yytops.yysize;
-          YYPTRDIFF_T yyk;
-          for (yyk = 0; yyk < yysize; yyk += 1)
-            if (yystates[yyk])
-              {
-                while (yystates[yyk])
-                  {
-                    yyGLRState *yys = yystates[yyk];
-                    if (yys->yypred != YY_NULLPTR)
-                      yydestroyGLRState ("Cleanup: popping", yys, comp_units);
-                    yystates[yyk] = yys->yypred;
-                    yystack.yynextFree -= 1;
-                    yystack.yyspaceLeft += 1;
-                  }
-                break;
-              }
-        }
-      yyfreeGLRStack (&yystack);
-    }
-
-  return yyresult;
-}
-
-/* DEBUGGING ONLY */
-#if YYDEBUG
-/* Print *YYS and its predecessors. */
-static void
-yy_yypstack (yyGLRState* yys)
-{
-  if (yys->yypred)
-    {
-      yy_yypstack (yys->yypred);
-      YY_FPRINTF ((stderr, " -> "));
-    }
-  YY_FPRINTF ((stderr, "%d@%ld", yys->yylrState, YY_CAST (long, yys->yyposn)));
-}
-
-/* Print YYS (possibly NULL) and its predecessors. */
-static void
-yypstates (yyGLRState* yys)
-{
-  if (yys == YY_NULLPTR)
-    YY_FPRINTF ((stderr, "<null>"));
-  else
-    yy_yypstack (yys);
-  YY_FPRINTF ((stderr, "\n"));
-}
-
-/* Print the stack #YYK.  */
-static void
-yypstack (yyGLRStack* yystackp, YYPTRDIFF_T yyk)
-{
-  yypstates (yystackp->yytops.yystates[yyk]);
-}
-
-/* Print all the stacks.  */
-static void
-yypdumpstack (yyGLRStack* yystackp)
-{
-#define YYINDEX(YYX)                                                    \
-  YY_CAST (long,                                                        \
-           ((YYX)                                                       \
-            ? YY_REINTERPRET_CAST (yyGLRStackItem*, (YYX)) - yystackp->yyitems \
-            : -1))
-
-  yyGLRStackItem* yyp;
-  for (yyp = yystackp->yyitems; yyp < yystackp->yynextFree; yyp += 1)
-    {
-      YY_FPRINTF ((stderr, "%3ld. ",
-                   YY_CAST (long, yyp - yystackp->yyitems)));
-      if (*YY_REINTERPRET_CAST (yybool *, yyp))
-        {
-          YY_ASSERT (yyp->yystate.yyisState);
-          YY_ASSERT (yyp->yyoption.yyisState);
-          YY_FPRINTF ((stderr, "Res: %d, LR State: %d, posn: %ld, pred: %ld",
-                       yyp->yystate.yyresolved, yyp->yystate.yylrState,
-                       YY_CAST (long, yyp->yystate.yyposn),
-                       YYINDEX (yyp->yystate.yypred)));
-          if (! yyp->yystate.yyresolved)
-            YY_FPRINTF ((stderr, ", firstVal: %ld",
-                         YYINDEX (yyp->yystate.yysemantics.yyfirstVal)));
-        }
-      else
-        {
-          YY_ASSERT (!yyp->yystate.yyisState);
-          YY_ASSERT (!yyp->yyoption.yyisState);
-          YY_FPRINTF ((stderr, "Option. rule: %d, state: %ld, next: %ld",
-                       yyp->yyoption.yyrule - 1,
-                       YYINDEX (yyp->yyoption.yystate),
-                       YYINDEX (yyp->yyoption.yynext)));
-        }
-      YY_FPRINTF ((stderr, "\n"));
-    }
-
-  YY_FPRINTF ((stderr, "Tops:"));
-  {
-    YYPTRDIFF_T yyi;
-    for (yyi = 0; yyi < yystackp->yytops.yysize; yyi += 1)
-      YY_FPRINTF ((stderr, "%ld: %ld; ", YY_CAST (long, yyi),
-                   YYINDEX (yystackp->yytops.yystates[yyi])));
-    YY_FPRINTF ((stderr, "\n"));
-  }
-#undef YYINDEX
-}
-#endif
-
-#undef yylval
-#undef yychar
-#undef yynerrs
-
-
-
-
-#line 281 "parser.y"
+#line 282 "parser.y"
 
 
 void yyerror(std::shared_ptr<CompUnits> comp_units, const char *s) {
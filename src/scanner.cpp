@@ -555,7 +555,14 @@ char *yytext;
 #line 4 "scanner.l"
     #include "parser.h"
     #include "error.h"
-#line 559 "src/scanner.cpp"
+    #include "scanner.h"
+    #include <fcntl.h>
+    #include <memory>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <unordered_map>
+#line 566 "src/scanner.cpp"
 /* ident */
 /* decimal integer const */
 /* octal integer const */
@@ -563,7 +570,7 @@ char *yytext;
 /* decimal float const */
 /* hexadecimal float const */
 /* comments */
-#line 567 "src/scanner.cpp"
+#line 574 "src/scanner.cpp"
 
 #define INITIAL 0
 
@@ -780,9 +787,9 @@ YY_DECL
 		}
 
 	{
-#line 43 "scanner.l"
+#line 50 "scanner.l"
 
-#line 786 "src/scanner.cpp"
+#line 793 "src/scanner.cpp"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -851,7 +858,7 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 44 "scanner.l"
+#line 51 "scanner.l"
 {
     yylval.int_val = (int)strtol(yytext, NULL, 10);
     return TK_INT_CONST;
@@ -859,7 +866,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 49 "scanner.l"
+#line 56 "scanner.l"
 {
     yylval.int_val = (int)strtol(yytext, NULL, 8);
     return TK_INT_CONST;
@@ -867,7 +874,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 54 "scanner.l"
+#line 61 "scanner.l"
 {
     yylval.int_val = (int)strtol(yytext, NULL, 16);
     return TK_INT_CONST;
@@ -875,7 +882,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 59 "scanner.l"
+#line 66 "scanner.l"
 {
     yylval.float_val = (float)atof(yytext);
     return TK_FLOAT_CONST;
@@ -883,7 +890,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 64 "scanner.l"
+#line 71 "scanner.l"
 {
     yylval.float_val = (float)atof(yytext);
     return TK_FLOAT_CONST;
@@ -891,156 +898,156 @@ YY_RULE_SETUP
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 69 "scanner.l"
+#line 76 "scanner.l"
 {
     return TK_CONST;
 }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 73 "scanner.l"
+#line 80 "scanner.l"
 {
     return TK_INT;
 }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 77 "scanner.l"
+#line 84 "scanner.l"
 {
     return TK_FLOAT;
 }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 81 "scanner.l"
+#line 88 "scanner.l"
 {
     return TK_VOID;
 }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 85 "scanner.l"
+#line 92 "scanner.l"
 {
     return TK_IF;
 }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 89 "scanner.l"
+#line 96 "scanner.l"
 {
     return TK_ELSE;
 }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 93 "scanner.l"
+#line 100 "scanner.l"
 {
     return TK_WHILE;
 }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 97 "scanner.l"
+#line 104 "scanner.l"
 {
     return TK_BREAK;
 }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 101 "scanner.l"
+#line 108 "scanner.l"
 {
     return TK_CONTINUE;
 }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 105 "scanner.l"
+#line 112 "scanner.l"
 {
     return TK_RETURN;
 }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 109 "scanner.l"
+#line 116 "scanner.l"
 {
     return TK_LE;
 }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 113 "scanner.l"
+#line 120 "scanner.l"
 {
     return TK_GE;
 }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 117 "scanner.l"
+#line 124 "scanner.l"
 {
     return TK_EQ;
 }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 121 "scanner.l"
+#line 128 "scanner.l"
 {
     return TK_NE;
 }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 125 "scanner.l"
+#line 132 "scanner.l"
 {
     return TK_AND;
 }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 129 "scanner.l"
+#line 136 "scanner.l"
 {
     return TK_OR;
 }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 133 "scanner.l"
+#line 140 "scanner.l"
 {
     return yytext[0];
 }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 137 "scanner.l"
+#line 144 "scanner.l"
 {
-    yylval.str_val = strdup(yytext);
+    yylval.ident = intern(std::string_view(yytext, yyleng));
     return TK_IDENT;
 }
 	YY_BREAK
 case 24:
 /* rule 24 can match eol */
 YY_RULE_SETUP
-#line 142 "scanner.l"
+#line 149 "scanner.l"
 { }
 	YY_BREAK
 case 25:
 /* rule 25 can match eol */
 YY_RULE_SETUP
-#line 144 "scanner.l"
+#line 151 "scanner.l"
 { }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 146 "scanner.l"
+#line 153 "scanner.l"
 {
     error(yylineno, "invalid input");
 }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 149 "scanner.l"
+#line 156 "scanner.l"
 ECHO;
 	YY_BREAK
-#line 1044 "src/scanner.cpp"
+#line 1051 "src/scanner.cpp"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2057,6 +2064,107 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 149 "scanner.l"
+#line 156 "scanner.l"
+
+
+/* the buffer scanned from a mapping or a copy of a string, or the stream
+   opened by `scanner_open` */
+static char *mapped = nullptr;
+static size_t mapped_length = 0;
+static YY_BUFFER_STATE buffer = nullptr;
+static FILE *opened = nullptr;
+
+/* identifiers of the file, whose keys view the interned strings themselves */
+static std::unordered_map<std::string_view, std::unique_ptr<std::string>>
+    interned;
+
+bool scanner_open(const std::string &path) {
+    scanner_close();
+    yylineno = 1;
+
+    if (path == "-") {
+        yyin = stdin;
+        yyrestart(yyin);
+        return true;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        // flex needs two NUL bytes after the input, which are the zeros after
+        // the end of file in its last page, or an anonymous page after it
+        size_t size = st.st_size + 2;
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t length = (size + page - 1) / page * page;
+        // the mapping is private and writable, as flex terminates each token
+        // in place
+        auto base = (char *)mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base != MAP_FAILED &&
+            mmap(base, st.st_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+            close(fd);
+            mapped = base;
+            mapped_length = length;
+            buffer = yy_scan_buffer(mapped, size);
+            return true;
+        }
+        if (base != MAP_FAILED) {
+            munmap(base, length);
+        }
+    }
+
+    // pipes, devices and empty files are read as streams
+    opened = fdopen(fd, "r");
+    if (opened == nullptr) {
+        close(fd);
+        return false;
+    }
+    yyin = opened;
+    yyrestart(yyin);
+    return true;
+}
+
+void scanner_open_string(const std::string &source) {
+    scanner_close();
+    yylineno = 1;
+    buffer = yy_scan_bytes(source.data(), source.size());
+}
+
+void scanner_close() {
+    // destroying the scanner deletes its buffers and resets it, so that the
+    // next scan starts afresh, even from a `yyin` set directly
+    yylex_destroy();
+    buffer = nullptr;
+    if (mapped != nullptr) {
+        munmap(mapped, mapped_length);
+        mapped = nullptr;
+        mapped_length = 0;
+    }
+    if (opened != nullptr) {
+        fclose(opened);
+        opened = nullptr;
+    }
+    yyin = nullptr;
+}
 
+void clear_interned(size_t limit) {
+    if (interned.size() > limit) {
+        interned.clear();
+    }
+}
 
+const std::string *intern(std::string_view name) {
+    auto it = interned.find(name);
+    if (it != interned.end()) {
+        return it->second.get();
+    }
+    auto str = std::make_unique<std::string>(name);
+    auto ptr = str.get();
+    interned.emplace(*ptr, std::move(str));
+    return ptr;
+}
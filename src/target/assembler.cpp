@@ -0,0 +1,1056 @@
+#include "target/assembler.h"
+#include "target/utils.h"
+#include <algorithm>
+#include <elf.h>
+#include <stdexcept>
+#include <tuple>
+
+namespace target {
+
+// branches reach +-4KiB, and jumps reach +-1MiB
+static const int64_t BRANCH_MIN = -4096;
+static const int64_t BRANCH_MAX = 4094;
+static const int64_t JUMP_MIN = -(1 << 20);
+static const int64_t JUMP_MAX = (1 << 20) - 2;
+
+enum Format {
+    R,      // op rd, rs1, rs2
+    R1,     // op rd, rs1 (rs2 is fixed)
+    I,      // op rd, rs1, imm
+    SHIFT,  // op rd, rs1, shamt
+    LOAD,   // op rd, imm(rs1)
+    STORE,  // op rs2, imm(rs1)
+    BRANCH, // op rs1, rs2, label
+    JALR,   // op rd, imm(rs1)
+};
+
+struct OpInfo {
+    Format format;
+    uint32_t opcode, funct3;
+    uint32_t funct7 = 0;
+    uint32_t rs2 = 0;    // fixed rs2 of `R1`
+    bool has_rm = false; // whether funct3 is a rounding mode, default dyn
+};
+
+// clang-format off
+static const std::unordered_map<std::string, OpInfo> OPS = {
+    {"add", {R, 0x33, 0, 0x00}},    {"sub", {R, 0x33, 0, 0x20}},
+    {"sll", {R, 0x33, 1, 0x00}},    {"slt", {R, 0x33, 2, 0x00}},
+    {"sltu", {R, 0x33, 3, 0x00}},   {"xor", {R, 0x33, 4, 0x00}},
+    {"srl", {R, 0x33, 5, 0x00}},    {"sra", {R, 0x33, 5, 0x20}},
+    {"or", {R, 0x33, 6, 0x00}},     {"and", {R, 0x33, 7, 0x00}},
+    {"mul", {R, 0x33, 0, 0x01}},    {"mulh", {R, 0x33, 1, 0x01}},
+    {"mulhsu", {R, 0x33, 2, 0x01}}, {"mulhu", {R, 0x33, 3, 0x01}},
+    {"div", {R, 0x33, 4, 0x01}},    {"divu", {R, 0x33, 5, 0x01}},
+    {"rem", {R, 0x33, 6, 0x01}},    {"remu", {R, 0x33, 7, 0x01}},
+    {"addw", {R, 0x3b, 0, 0x00}},   {"subw", {R, 0x3b, 0, 0x20}},
+    {"sllw", {R, 0x3b, 1, 0x00}},   {"srlw", {R, 0x3b, 5, 0x00}},
+    {"sraw", {R, 0x3b, 5, 0x20}},   {"mulw", {R, 0x3b, 0, 0x01}},
+    {"divw", {R, 0x3b, 4, 0x01}},   {"divuw", {R, 0x3b, 5, 0x01}},
+    {"remw", {R, 0x3b, 6, 0x01}},   {"remuw", {R, 0x3b, 7, 0x01}},
+
+    {"addi", {I, 0x13, 0}},         {"slti", {I, 0x13, 2}},
+    {"sltiu", {I, 0x13, 3}},        {"xori", {I, 0x13, 4}},
+    {"ori", {I, 0x13, 6}},          {"andi", {I, 0x13, 7}},
+    {"addiw", {I, 0x1b, 0}},
+
+    {"slli", {SHIFT, 0x13, 1, 0x00}},  {"srli", {SHIFT, 0x13, 5, 0x00}},
+    {"srai", {SHIFT, 0x13, 5, 0x20}},  {"slliw", {SHIFT, 0x1b, 1, 0x00}},
+    {"srliw", {SHIFT, 0x1b, 5, 0x00}}, {"sraiw", {SHIFT, 0x1b, 5, 0x20}},
+
+    {"lb", {LOAD, 0x03, 0}},  {"lh", {LOAD, 0x03, 1}},
+    {"lw", {LOAD, 0x03, 2}},  {"ld", {LOAD, 0x03, 3}},
+    {"lbu", {LOAD, 0x03, 4}}, {"lhu", {LOAD, 0x03, 5}},
+    {"lwu", {LOAD, 0x03, 6}}, {"flw", {LOAD, 0x07, 2}},
+    {"fld", {LOAD, 0x07, 3}},
+    {"sb", {STORE, 0x23, 0}},  {"sh", {STORE, 0x23, 1}},
+    {"sw", {STORE, 0x23, 2}},  {"sd", {STORE, 0x23, 3}},
+    {"fsw", {STORE, 0x27, 2}}, {"fsd", {STORE, 0x27, 3}},
+
+    {"beq", {BRANCH, 0x63, 0}},  {"bne", {BRANCH, 0x63, 1}},
+    {"blt", {BRANCH, 0x63, 4}},  {"bge", {BRANCH, 0x63, 5}},
+    {"bltu", {BRANCH, 0x63, 6}}, {"bgeu", {BRANCH, 0x63, 7}},
+    {"jalr", {JALR, 0x67, 0}},
+
+    {"fadd.s", {R, 0x53, 0, 0x00, 0, true}},
+    {"fsub.s", {R, 0x53, 0, 0x04, 0, true}},
+    {"fmul.s", {R, 0x53, 0, 0x08, 0, true}},
+    {"fdiv.s", {R, 0x53, 0, 0x0c, 0, true}},
+    {"fsqrt.s", {R1, 0x53, 0, 0x2c, 0, true}},
+    {"fsgnj.s", {R, 0x53, 0, 0x10}},  {"fsgnjn.s", {R, 0x53, 1, 0x10}},
+    {"fsgnjx.s", {R, 0x53, 2, 0x10}}, {"fsgnj.d", {R, 0x53, 0, 0x11}},
+    {"fmin.s", {R, 0x53, 0, 0x14}},   {"fmax.s", {R, 0x53, 1, 0x14}},
+    {"feq.s", {R, 0x53, 2, 0x50}},    {"flt.s", {R, 0x53, 1, 0x50}},
+    {"fle.s", {R, 0x53, 0, 0x50}},
+    {"fcvt.w.s", {R1, 0x53, 0, 0x60, 0, true}},
+    {"fcvt.wu.s", {R1, 0x53, 0, 0x60, 1, true}},
+    {"fcvt.l.s", {R1, 0x53, 0, 0x60, 2, true}},
+    {"fcvt.s.w", {R1, 0x53, 0, 0x68, 0, true}},
+    {"fcvt.s.wu", {R1, 0x53, 0, 0x68, 1, true}},
+    {"fcvt.s.l", {R1, 0x53, 0, 0x68, 2, true}},
+    {"fmv.x.w", {R1, 0x53, 0, 0x70}}, {"fclass.s", {R1, 0x53, 1, 0x70}},
+    {"fmv.w.x", {R1, 0x53, 0, 0x78}},
+};
+// clang-format on
+
+enum VectorForm {
+    VV, // op vd, vs2, vs1
+    VX, // op vd, vs2, rs1
+    XS, // op rd, vs2
+    SX, // op vd, rs1
+};
+
+struct VectorOpInfo {
+    VectorForm form;
+    uint32_t funct6, funct3; // funct3 is the category, e.g. OPIVV
+};
+
+// clang-format off
+static const std::unordered_map<std::string, VectorOpInfo> VECTOR_OPS = {
+    {"vadd.vv", {VV, 0x00, 0}},      {"vadd.vx", {VX, 0x00, 4}},
+    {"vsub.vv", {VV, 0x02, 0}},      {"vsub.vx", {VX, 0x02, 4}},
+    {"vrsub.vx", {VX, 0x03, 4}},
+    {"vmul.vv", {VV, 0x25, 2}},      {"vmul.vx", {VX, 0x25, 6}},
+    {"vdiv.vv", {VV, 0x21, 2}},      {"vdiv.vx", {VX, 0x21, 6}},
+    {"vrem.vv", {VV, 0x23, 2}},      {"vrem.vx", {VX, 0x23, 6}},
+    {"vfadd.vv", {VV, 0x00, 1}},     {"vfadd.vf", {VX, 0x00, 5}},
+    {"vfsub.vv", {VV, 0x02, 1}},     {"vfsub.vf", {VX, 0x02, 5}},
+    {"vfrsub.vf", {VX, 0x27, 5}},
+    {"vfmul.vv", {VV, 0x24, 1}},     {"vfmul.vf", {VX, 0x24, 5}},
+    {"vfdiv.vv", {VV, 0x20, 1}},     {"vfdiv.vf", {VX, 0x20, 5}},
+    {"vfrdiv.vf", {VX, 0x21, 5}},
+    {"vfsgnjn.vv", {VV, 0x09, 1}},
+    {"vredsum.vs", {VV, 0x00, 2}},   {"vfredosum.vs", {VV, 0x03, 1}},
+    {"vmv.x.s", {XS, 0x10, 2}},      {"vfmv.f.s", {XS, 0x10, 1}},
+    {"vmv.s.x", {SX, 0x10, 6}},      {"vfmv.s.f", {SX, 0x10, 5}},
+    {"vmv.v.x", {SX, 0x17, 4}},      {"vfmv.v.f", {SX, 0x17, 5}},
+};
+// clang-format on
+
+static const std::unordered_map<std::string, uint32_t> ROUNDING_MODES = {
+    {"rne", 0}, {"rtz", 1}, {"rdn", 2}, {"rup", 3}, {"rmm", 4}, {"dyn", 7}};
+
+static const std::unordered_map<std::string, std::string> INVERSE_BRANCHES = {
+    {"beq", "bne"}, {"bne", "beq"},   {"blt", "bge"},
+    {"bge", "blt"}, {"bltu", "bgeu"}, {"bgeu", "bltu"}};
+
+static uint32_t encode_r(uint32_t opcode, uint32_t funct3, uint32_t funct7,
+                         uint32_t rd, uint32_t rs1, uint32_t rs2) {
+    return funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 |
+           opcode;
+}
+
+static uint32_t encode_i(uint32_t opcode, uint32_t funct3, uint32_t rd,
+                         uint32_t rs1, int64_t imm) {
+    return (imm & 0xfff) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+static uint32_t encode_s(uint32_t opcode, uint32_t funct3, uint32_t rs1,
+                         uint32_t rs2, int64_t imm) {
+    return ((imm >> 5) & 0x7f) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 |
+           (imm & 0x1f) << 7 | opcode;
+}
+
+static uint32_t encode_b(uint32_t funct3, uint32_t rs1, uint32_t rs2,
+                         int64_t imm) {
+    return ((imm >> 12) & 0x1) << 31 | ((imm >> 5) & 0x3f) << 25 | rs2 << 20 |
+           rs1 << 15 | funct3 << 12 | ((imm >> 1) & 0xf) << 8 |
+           ((imm >> 11) & 0x1) << 7 | 0x63;
+}
+
+static uint32_t encode_u(uint32_t opcode, uint32_t rd, int64_t imm) {
+    return (imm & 0xfffff) << 12 | rd << 7 | opcode;
+}
+
+static uint32_t encode_j(uint32_t rd, int64_t imm) {
+    return ((imm >> 20) & 0x1) << 31 | ((imm >> 1) & 0x3ff) << 21 |
+           ((imm >> 11) & 0x1) << 20 | ((imm >> 12) & 0xff) << 12 | rd << 7 |
+           0x6f;
+}
+
+static int64_t sign_extend(uint64_t value, int bits) {
+    return (int64_t)(value << (64 - bits)) >> (64 - bits);
+}
+
+static std::string trim(const std::string &text) {
+    auto begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    auto end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> split_args(const std::string &text) {
+    std::vector<std::string> args;
+    if (trim(text).empty()) {
+        return args;
+    }
+
+    size_t begin = 0;
+    bool in_string = false;
+    for (size_t i = 0; i <= text.size(); i++) {
+        if (i < text.size() && text[i] == '"') {
+            in_string = !in_string;
+        } else if (i == text.size() || (text[i] == ',' && !in_string)) {
+            args.push_back(trim(text.substr(begin, i - begin)));
+            begin = i + 1;
+        }
+    }
+    return args;
+}
+
+static uint32_t get_reg(const MachineOperand &operand) {
+    if (!operand.is_reg() || is_virtual_reg(operand.reg)) {
+        throw std::runtime_error("register expected: " + operand.to_string());
+    }
+    return operand.reg % 32;
+}
+
+static uint32_t get_vector_reg(const MachineOperand &operand) {
+    auto &name = operand.sym;
+    if (operand.is_sym() && name.size() > 1 && name[0] == 'v' &&
+        name.find_first_not_of("0123456789", 1) == std::string::npos) {
+        auto reg = std::stoi(name.substr(1));
+        if (reg < 32) {
+            return reg;
+        }
+    }
+    throw std::runtime_error("vector register expected: " +
+                             operand.to_string());
+}
+
+static int64_t get_imm(const MachineOperand &operand) {
+    if (operand.is_imm()) {
+        return operand.imm;
+    } else if (operand.is_sym() && !operand.sym.empty()) {
+        // 64-bit constants may be written unsigned, as the magic numbers of
+        // division
+        auto &text = operand.sym;
+        try {
+            size_t end;
+            auto imm = text[0] == '-' ? std::stoll(text, &end, 0)
+                                      : (int64_t)std::stoull(text, &end, 0);
+            if (end == text.size()) {
+                return imm;
+            }
+        } catch (const std::logic_error &) {
+            // fall through
+        }
+    }
+    throw std::runtime_error("immediate expected: " + operand.to_string());
+}
+
+// whether the operand is a relocation such as `%hi(sym)`
+static bool is_reloc(const std::string &expr, const std::string &modifier) {
+    return expr.compare(0, modifier.size() + 2, "%" + modifier + "(") == 0;
+}
+
+// splits `sym+off` into the symbol and the addend
+static std::pair<std::string, int64_t> split_symbol(std::string expr) {
+    if (expr[0] == '%') {
+        expr = expr.substr(expr.find('(') + 1);
+        expr.pop_back();
+    }
+    auto pos = expr.find_last_of("+-");
+    if (pos != std::string::npos && pos > 0) {
+        return {expr.substr(0, pos), std::stoll(expr.substr(pos))};
+    }
+    return {expr, 0};
+}
+
+// rewrites pseudo instructions of a fixed size to base instructions
+static MachineInst lower_pseudo(const MachineInst &inst) {
+    static const auto zero = MachineOperand::reg_of(0);
+    static const auto ra = MachineOperand::reg_of(1);
+
+    auto &op = inst.opcode;
+    auto &args = inst.operands;
+    auto make = [](std::string op, std::vector<MachineOperand> operands) {
+        return MachineInst(std::move(op), std::move(operands));
+    };
+
+    if (op == "mv") {
+        return make("addi", {args[0], args[1], MachineOperand::imm_of(0)});
+    } else if (op == "not") {
+        return make("xori", {args[0], args[1], MachineOperand::imm_of(-1)});
+    } else if (op == "neg" || op == "negw") {
+        return make(op == "neg" ? "sub" : "subw", {args[0], zero, args[1]});
+    } else if (op == "seqz") {
+        return make("sltiu", {args[0], args[1], MachineOperand::imm_of(1)});
+    } else if (op == "snez") {
+        return make("sltu", {args[0], zero, args[1]});
+    } else if (op == "sltz") {
+        return make("slt", {args[0], args[1], zero});
+    } else if (op == "sgtz") {
+        return make("slt", {args[0], zero, args[1]});
+    } else if (op == "sext.w") {
+        return make("addiw", {args[0], args[1], MachineOperand::imm_of(0)});
+    } else if (op == "nop") {
+        return make("addi", {zero, zero, MachineOperand::imm_of(0)});
+    } else if (op == "fmv.s" || op == "fneg.s" || op == "fabs.s") {
+        auto base = op == "fmv.s" ? "fsgnj.s"
+                                  : (op == "fneg.s" ? "fsgnjn.s" : "fsgnjx.s");
+        return make(base, {args[0], args[1], args[1]});
+    } else if (op == "fmv.d") {
+        return make("fsgnj.d", {args[0], args[1], args[1]});
+    } else if (op == "beqz" || op == "bnez" || op == "bltz" || op == "bgez") {
+        return make(op.substr(0, 3), {args[0], zero, args[1]});
+    } else if (op == "bgtz" || op == "blez") {
+        return make(op == "bgtz" ? "blt" : "bge", {zero, args[0], args[1]});
+    } else if (op == "bgt" || op == "ble" || op == "bgtu" || op == "bleu") {
+        static const std::unordered_map<std::string, std::string> swapped = {
+            {"bgt", "blt"}, {"ble", "bge"}, {"bgtu", "bltu"}, {"bleu", "bgeu"}};
+        return make(swapped.at(op), {args[1], args[0], args[2]});
+    } else if (op == "jr") {
+        return make("jalr", {zero, MachineOperand::mem_of(args[0].reg, 0)});
+    } else if (op == "ret") {
+        return make("jalr", {zero, MachineOperand::mem_of(ra.reg, 0)});
+    }
+    return inst;
+}
+
+// instructions to load an immediate, see `Assembler::_emit_li`
+static void generate_li(int64_t value,
+                        std::vector<std::pair<std::string, int64_t>> &seq) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+        int64_t hi20 = ((value + 0x800) >> 12) & 0xfffff;
+        int64_t lo12 = sign_extend(value & 0xfff, 12);
+        if (hi20 != 0) {
+            seq.push_back({"lui", hi20});
+        }
+        if (lo12 != 0 || hi20 == 0) {
+            seq.push_back({hi20 != 0 ? "addiw" : "addi", lo12});
+        }
+        return;
+    }
+
+    // the upper bits shifted, and then the lower 12 bits added
+    int64_t lo12 = sign_extend(value & 0xfff, 12);
+    uint64_t upper = (uint64_t)value - (uint64_t)lo12;
+    int shift = 12 + __builtin_ctzll(upper >> 12);
+    generate_li(sign_extend(upper >> shift, 64 - shift), seq);
+    seq.push_back({"slli", shift});
+    if (lo12 != 0) {
+        seq.push_back({"addi", lo12});
+    }
+}
+
+void Assembler::assemble(std::istream &in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        _line++;
+        _parse_line(line);
+    }
+
+    _layout_text();
+    _encode_text();
+}
+
+void Assembler::_parse_line(const std::string &raw) {
+    auto line = raw;
+    if (auto comment = line.find("/*"); comment != std::string::npos) {
+        line = line.substr(0, comment);
+    }
+    line = trim(line);
+    if (line.empty()) {
+        return;
+    }
+
+    if (line.back() == ':') {
+        _define_label(line.substr(0, line.size() - 1));
+        return;
+    }
+
+    auto space = line.find_first_of(" \t");
+    auto name = line.substr(0, space);
+    auto args =
+        split_args(space == std::string::npos ? "" : line.substr(space + 1));
+    if (name[0] == '.') {
+        _parse_directive(name, args);
+        return;
+    }
+
+    if (_current != TEXT) {
+        throw std::runtime_error("instruction outside .text at line " +
+                                 std::to_string(_line));
+    }
+    std::vector<MachineOperand> operands;
+    if (name == "vsetvli" && args.size() > 2) {
+        // the vector type, e.g. `e32, m1, ta, ma`, is kept as symbols
+        for (auto &arg : args) {
+            operands.push_back(MachineOperand::parse(arg));
+        }
+    } else {
+        bool is_target = name == "j" || name == "call" || name == "tail" ||
+                         name == "la" || name[0] == 'b';
+        for (size_t i = 0; i < args.size(); i++) {
+            if (is_target && i == args.size() - 1) {
+                operands.push_back(MachineOperand::sym_of(args[i]));
+            } else {
+                operands.push_back(MachineOperand::parse(args[i]));
+            }
+        }
+    }
+    _text.push_back({lower_pseudo(MachineInst(name, operands)), _line});
+}
+
+void Assembler::_parse_directive(const std::string &name,
+                                 const std::vector<std::string> &args) {
+    if (name == ".text") {
+        _current = TEXT;
+    } else if (name == ".data") {
+        _current = DATA;
+    } else if (name == ".bss") {
+        _current = BSS;
+    } else if (name == ".section") {
+        if (args.empty()) {
+            throw std::runtime_error("missing section name");
+        } else if (args[0] == ".note.GNU-stack") {
+            _has_stack_note = true;
+            _current = NONE;
+        } else if (args[0] == ".rodata" || args[0].rfind(".rodata.", 0) == 0) {
+            _current = RODATA;
+        } else if (args[0] == ".text" || args[0] == ".data" ||
+                   args[0] == ".bss") {
+            _parse_directive(args[0], {});
+        } else {
+            throw std::runtime_error("unsupported section: " + args[0]);
+        }
+    } else if (name == ".global" || name == ".globl") {
+        _get_symbol(args.at(0)).is_global = true;
+    } else if (name == ".type") {
+        auto &symbol = _get_symbol(args.at(0));
+        if (args.at(1) == "@function") {
+            symbol.type = STT_FUNC;
+        } else if (args.at(1) == "@object") {
+            symbol.type = STT_OBJECT;
+        }
+    } else if (name == ".size") {
+        if (args.at(1) != ".-" + args[0] || _current != TEXT) {
+            throw std::runtime_error("unsupported size: " + args[1]);
+        }
+        _text_sizes.push_back({args[0], _text.size()});
+    } else if (name == ".balign" || name == ".align" || name == ".p2align") {
+        auto align = std::stoull(args.at(0), nullptr, 0);
+        if (name != ".balign") {
+            align = 1ULL << align;
+        }
+        if (_current == NONE) {
+            throw std::runtime_error("alignment outside sections");
+        }
+        auto &section = _sections[_current];
+        section.align = std::max(section.align, (uint64_t)align);
+        if (_current == TEXT) {
+            if (align > 4) {
+                throw std::runtime_error("unsupported alignment of .text");
+            }
+        } else if (_current == BSS) {
+            section.size = (section.size + align - 1) / align * align;
+        } else {
+            section.bytes.resize((section.bytes.size() + align - 1) / align *
+                                 align);
+        }
+    } else if (name == ".zero") {
+        auto bytes = std::stoull(args.at(0), nullptr, 0);
+        if (_current == BSS) {
+            _sections[BSS].size += bytes;
+        } else if (_current == DATA || _current == RODATA) {
+            auto &data = _sections[_current].bytes;
+            data.resize(data.size() + bytes);
+        } else {
+            throw std::runtime_error(".zero outside data sections");
+        }
+    } else if (name == ".word" || name == ".quad") {
+        for (auto &arg : args) {
+            _append_data(arg, name == ".word" ? 4 : 8);
+        }
+    } else if (name != ".option" && name != ".file" && name != ".ident") {
+        throw std::runtime_error("unsupported directive: " + name);
+    }
+}
+
+void Assembler::_define_label(const std::string &name) {
+    if (_current == NONE) {
+        throw std::runtime_error("label outside sections: " + name);
+    }
+
+    if (_current == TEXT) {
+        _text_labels[name] = _text.size();
+    } else if (name.rfind(".L", 0) == 0) {
+        auto &section = _sections[_current];
+        _local_labels[name] = {
+            _current, _current == BSS ? section.size : section.bytes.size()};
+    }
+
+    if (name.rfind(".L", 0) != 0) {
+        auto &symbol = _get_symbol(name);
+        auto &section = _sections[_current];
+        symbol.section = _current;
+        symbol.value = _current == BSS ? section.size : section.bytes.size();
+    }
+}
+
+void Assembler::_append_data(const std::string &value, int bytes) {
+    if (_current != DATA && _current != RODATA) {
+        throw std::runtime_error("data outside .data or .rodata");
+    }
+
+    auto &data = _sections[_current].bytes;
+    int64_t number = 0;
+    auto operand = MachineOperand::sym_of(value);
+    try {
+        number = get_imm(operand);
+    } catch (const std::runtime_error &) {
+        auto [symbol, addend] = split_symbol(value);
+        _sections[_current].relocs.push_back(
+            {data.size(), (uint32_t)(bytes == 8 ? R_RISCV_64 : R_RISCV_32),
+             symbol, addend});
+    }
+    for (int i = 0; i < bytes; i++) {
+        data.push_back((number >> (8 * i)) & 0xff);
+    }
+}
+
+int Assembler::_get_size(const TextItem &item) const {
+    auto &op = item.inst.opcode;
+    if (op == "li") {
+        std::vector<std::pair<std::string, int64_t>> seq;
+        generate_li(get_imm(item.inst.operands.at(1)), seq);
+        return seq.size() * 4;
+    } else if (op == "la" || op == "call" || op == "tail" || item.is_relaxed) {
+        return 8;
+    }
+    return 4;
+}
+
+bool Assembler::_is_local_label(const std::string &label) const {
+    return _text_labels.count(label) != 0;
+}
+
+uint64_t Assembler::_get_label_offset(const std::string &label) const {
+    auto index = _text_labels.at(label);
+    if (index < _text.size()) {
+        return _text[index].offset;
+    }
+    return _text.empty() ? 0 : _text.back().offset + _get_size(_text.back());
+}
+
+void Assembler::_layout_text() {
+    // relaxing a branch only grows the code, so this terminates
+    for (bool changed = true; changed;) {
+        changed = false;
+        uint64_t offset = 0;
+        for (auto &item : _text) {
+            item.offset = offset;
+            offset += _get_size(item);
+        }
+
+        for (auto &item : _text) {
+            auto &inst = item.inst;
+            auto info = OPS.find(inst.opcode);
+            if (item.is_relaxed || info == OPS.end() ||
+                info->second.format != BRANCH ||
+                !_is_local_label(inst.operands.at(2).sym)) {
+                continue;
+            }
+            int64_t disp =
+                _get_label_offset(inst.operands[2].sym) - item.offset;
+            if (disp < BRANCH_MIN || disp > BRANCH_MAX) {
+                item.is_relaxed = true;
+                changed = true;
+            }
+        }
+    }
+}
+
+void Assembler::_encode_text() {
+    for (auto &item : _text) {
+        try {
+            _encode(item);
+        } catch (const std::exception &e) {
+            throw std::runtime_error(std::string(e.what()) + " at line " +
+                                     std::to_string(item.line));
+        }
+    }
+
+    for (auto &[label, index] : _text_labels) {
+        if (label.rfind(".L", 0) == 0) {
+            _local_labels[label] = {TEXT, _get_label_offset(label)};
+        } else {
+            _get_symbol(label).value = _get_label_offset(label);
+        }
+    }
+    for (auto &[name, index] : _text_sizes) {
+        auto &symbol = _get_symbol(name);
+        auto end = index < _text.size() ? _text[index].offset
+                                        : _sections[TEXT].bytes.size();
+        symbol.size = end - symbol.value;
+    }
+}
+
+void Assembler::_emit(uint32_t word) {
+    auto &text = _sections[TEXT].bytes;
+    for (int i = 0; i < 4; i++) {
+        text.push_back((word >> (8 * i)) & 0xff);
+    }
+}
+
+void Assembler::_emit_li(int reg, int64_t value) {
+    // as `RISCVMatInt` of LLVM, without its special cases
+    std::vector<std::pair<std::string, int64_t>> seq;
+    generate_li(value, seq);
+
+    int src = 0; // zero
+    for (auto &[op, imm] : seq) {
+        if (op == "lui") {
+            _emit(encode_u(0x37, reg, imm));
+        } else if (op == "slli") {
+            _emit(encode_i(0x13, 1, reg, src, imm));
+        } else {
+            _emit(encode_i(op == "addiw" ? 0x1b : 0x13, 0, reg, src, imm));
+        }
+        src = reg;
+    }
+}
+
+void Assembler::_emit_reloc(uint32_t type, const std::string &expr) {
+    auto [symbol, addend] = split_symbol(expr);
+    _sections[TEXT].relocs.push_back(
+        {_sections[TEXT].bytes.size(), type, symbol, addend});
+}
+
+void Assembler::_encode(const TextItem &item) {
+    auto &inst = item.inst;
+    auto &op = inst.opcode;
+    auto &args = inst.operands;
+
+    if (op == "li") {
+        _emit_li(get_reg(args.at(0)), get_imm(args.at(1)));
+        return;
+    } else if (op == "la") {
+        // the low part refers to the label at the high part
+        auto rd = get_reg(args.at(0));
+        auto label = ".Lpcrel_hi" + std::to_string(_pcrel_count++);
+        auto &symbol = _get_symbol(label);
+        symbol.section = TEXT;
+        symbol.value = _sections[TEXT].bytes.size();
+        _emit_reloc(R_RISCV_PCREL_HI20, args.at(1).sym);
+        _emit(encode_u(0x17, rd, 0));
+        _emit_reloc(R_RISCV_PCREL_LO12_I, label);
+        _emit(encode_i(0x13, 0, rd, rd, 0));
+        return;
+    } else if (op == "call" || op == "tail") {
+        uint32_t link = op == "call" ? 1 : 0; // ra or zero
+        uint32_t scratch = op == "call" ? 1 : 6; // ra or t1
+        _emit_reloc(R_RISCV_CALL_PLT, args.at(0).sym);
+        _emit(encode_u(0x17, scratch, 0));
+        _emit(encode_i(0x67, 0, link, scratch, 0));
+        return;
+    } else if (op == "lui") {
+        auto rd = get_reg(args.at(0));
+        if (args.at(1).is_sym() && is_reloc(args[1].sym, "hi")) {
+            _emit_reloc(R_RISCV_HI20, args[1].sym);
+            _emit(encode_u(0x37, rd, 0));
+        } else {
+            _emit(encode_u(0x37, rd, get_imm(args[1])));
+        }
+        return;
+    } else if (op == "j") {
+        auto &target = args.at(0).sym;
+        if (!_is_local_label(target)) {
+            _emit_reloc(R_RISCV_JAL, target);
+            _emit(encode_j(0, 0));
+            return;
+        }
+        int64_t disp = _get_label_offset(target) - item.offset;
+        if (disp < JUMP_MIN || disp > JUMP_MAX) {
+            throw std::runtime_error("jump out of range: " + target);
+        }
+        _emit(encode_j(0, disp));
+        return;
+    } else if (op[0] == 'v') {
+        _encode_vector(item);
+        return;
+    }
+
+    auto found = OPS.find(op);
+    if (found == OPS.end()) {
+        throw std::runtime_error("unsupported instruction: " + op);
+    }
+    auto &info = found->second;
+
+    auto get_mem = [&](const MachineOperand &operand, uint32_t lo_reloc) {
+        if (!operand.is_mem()) {
+            throw std::runtime_error("memory expected: " + operand.to_string());
+        }
+        if (!operand.sym.empty()) {
+            _emit_reloc(lo_reloc, operand.sym);
+            return (int64_t)0;
+        }
+        return (int64_t)operand.imm;
+    };
+    auto get_rm = [&](size_t index) {
+        if (!info.has_rm) {
+            return info.funct3;
+        } else if (index >= args.size()) {
+            return ROUNDING_MODES.at("dyn");
+        }
+        return ROUNDING_MODES.at(args[index].to_string());
+    };
+
+    switch (info.format) {
+    case R:
+        _emit(encode_r(info.opcode, get_rm(3), info.funct7, get_reg(args.at(0)),
+                       get_reg(args.at(1)), get_reg(args.at(2))));
+        break;
+    case R1:
+        _emit(encode_r(info.opcode, get_rm(2), info.funct7, get_reg(args.at(0)),
+                       get_reg(args.at(1)), info.rs2));
+        break;
+    case I: {
+        int64_t imm;
+        if (args.at(2).is_sym() && is_reloc(args[2].sym, "lo")) {
+            _emit_reloc(R_RISCV_LO12_I, args[2].sym);
+            imm = 0;
+        } else {
+            imm = get_imm(args[2]);
+        }
+        _emit(encode_i(info.opcode, info.funct3, get_reg(args.at(0)),
+                       get_reg(args.at(1)), imm));
+        break;
+    }
+    case SHIFT:
+        _emit(encode_i(info.opcode, info.funct3, get_reg(args.at(0)),
+                       get_reg(args.at(1)),
+                       get_imm(args.at(2)) | info.funct7 << 5));
+        break;
+    case LOAD: {
+        auto imm = get_mem(args.at(1), R_RISCV_LO12_I);
+        _emit(encode_i(info.opcode, info.funct3, get_reg(args.at(0)),
+                       get_reg(MachineOperand::reg_of(args[1].reg)), imm));
+        break;
+    }
+    case STORE: {
+        auto imm = get_mem(args.at(1), R_RISCV_LO12_S);
+        _emit(encode_s(info.opcode, info.funct3,
+                       get_reg(MachineOperand::reg_of(args[1].reg)),
+                       get_reg(args.at(0)), imm));
+        break;
+    }
+    case JALR:
+        _emit(encode_i(info.opcode, 0, get_reg(args.at(0)),
+                       get_reg(MachineOperand::reg_of(args.at(1).reg)),
+                       args[1].imm));
+        break;
+    case BRANCH: {
+        auto rs1 = get_reg(args.at(0));
+        auto rs2 = get_reg(args.at(1));
+        auto &target = args.at(2).sym;
+        if (!_is_local_label(target)) {
+            _emit_reloc(R_RISCV_BRANCH, target);
+            _emit(encode_b(info.funct3, rs1, rs2, 0));
+            break;
+        }
+
+        int64_t disp = _get_label_offset(target) - item.offset;
+        if (item.is_relaxed) {
+            // b<inverse> rs1, rs2, 8; j target
+            auto inverse = OPS.at(INVERSE_BRANCHES.at(op));
+            _emit(encode_b(inverse.funct3, rs1, rs2, 8));
+            disp -= 4;
+            if (disp < JUMP_MIN || disp > JUMP_MAX) {
+                throw std::runtime_error("branch out of range: " + target);
+            }
+            _emit(encode_j(0, disp));
+        } else {
+            _emit(encode_b(info.funct3, rs1, rs2, disp));
+        }
+        break;
+    }
+    }
+}
+
+void Assembler::_encode_vector(const TextItem &item) {
+    auto &op = item.inst.opcode;
+    auto &args = item.inst.operands;
+
+    if (op == "vsetvli") {
+        // e.g. `vsetvli t0, a0, e32, m2, ta, ma`
+        uint32_t vtype = 0;
+        for (size_t i = 2; i < args.size(); i++) {
+            auto field = args[i].to_string();
+            if (field[0] == 'e') {
+                auto sew = std::stoi(field.substr(1));
+                vtype |= (__builtin_ctz(sew) - 3) << 3;
+            } else if (field.rfind("mf", 0) == 0) {
+                vtype |= 8 - __builtin_ctz(std::stoi(field.substr(2)));
+            } else if (field[0] == 'm' && field.size() > 1 &&
+                       isdigit(field[1])) {
+                vtype |= __builtin_ctz(std::stoi(field.substr(1)));
+            } else if (field == "ta") {
+                vtype |= 1 << 6;
+            } else if (field == "ma") {
+                vtype |= 1 << 7;
+            } else if (field != "tu" && field != "mu") {
+                throw std::runtime_error("unsupported vector type: " + field);
+            }
+        }
+        _emit(vtype << 20 | get_reg(args.at(1)) << 15 | 7 << 12 |
+              get_reg(args.at(0)) << 7 | 0x57);
+        return;
+    }
+
+    // unit-stride and strided loads and stores of 32-bit elements, e.g.
+    // `vle32.v v2, (a1)` and `vlse32.v v2, (a1), t1`
+    if (op == "vle32.v" || op == "vse32.v" || op == "vlse32.v" ||
+        op == "vsse32.v") {
+        auto &base = args.at(1).sym;
+        auto rs1 = get_reg(MachineOperand::parse(
+            base.substr(1, base.size() - 2))); // `(reg)`
+        bool is_strided = op[2] == 's';
+        uint32_t opcode = op[1] == 'l' ? 0x07 : 0x27;
+        uint32_t rs2 = is_strided ? get_reg(args.at(2)) : 0;
+        uint32_t mop = is_strided ? 2 : 0;
+        _emit(mop << 26 | 1 << 25 | rs2 << 20 | rs1 << 15 | 6 << 12 |
+              get_vector_reg(args.at(0)) << 7 | opcode);
+        return;
+    }
+
+    auto found = VECTOR_OPS.find(op);
+    if (found == VECTOR_OPS.end()) {
+        throw std::runtime_error("unsupported instruction: " + op);
+    }
+    auto &info = found->second;
+
+    uint32_t rd, src2 = 0, src1 = 0;
+    switch (info.form) {
+    case VV:
+        rd = get_vector_reg(args.at(0));
+        src2 = get_vector_reg(args.at(1));
+        src1 = get_vector_reg(args.at(2));
+        break;
+    case VX:
+        rd = get_vector_reg(args.at(0));
+        src2 = get_vector_reg(args.at(1));
+        src1 = get_reg(args.at(2));
+        break;
+    case XS:
+        rd = get_reg(args.at(0));
+        src2 = get_vector_reg(args.at(1));
+        break;
+    case SX:
+        rd = get_vector_reg(args.at(0));
+        src1 = get_reg(args.at(1));
+        break;
+    }
+    _emit(info.funct6 << 26 | 1 << 25 | src2 << 20 | src1 << 15 |
+          info.funct3 << 12 | rd << 7 | 0x57);
+}
+
+Assembler::Symbol &Assembler::_get_symbol(const std::string &name) {
+    auto [it, inserted] = _symbol_index.insert({name, _symbols.size()});
+    if (inserted) {
+        _symbols.push_back({name});
+    }
+    return _symbols[it->second];
+}
+
+template <typename T>
+static void append_bytes(std::vector<uint8_t> &bytes, const T &value) {
+    auto data = reinterpret_cast<const uint8_t *>(&value);
+    bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+void Assembler::write(std::ostream &out) {
+    // `.L` labels named by directives such as `.type` are local symbols,
+    // other references to them become references to their sections, and
+    // the remaining undefined symbols are external
+    for (auto &symbol : _symbols) {
+        auto label = _local_labels.find(symbol.name);
+        if (symbol.section == NONE && label != _local_labels.end()) {
+            std::tie(symbol.section, symbol.value) = label->second;
+        }
+    }
+    for (auto &section : _sections) {
+        for (auto &reloc : section.relocs) {
+            if (!_symbol_index.count(reloc.symbol) &&
+                !_local_labels.count(reloc.symbol)) {
+                _get_symbol(reloc.symbol).is_global = true;
+            }
+        }
+    }
+
+    struct OutputSection {
+        std::string name;
+        Elf64_Shdr header;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<OutputSection> outputs(1); // the null section
+    auto add_section = [&](const std::string &name, uint32_t type,
+                           uint64_t flags, uint64_t align) {
+        Elf64_Shdr header = {};
+        header.sh_type = type;
+        header.sh_flags = flags;
+        header.sh_addralign = align;
+        outputs.push_back({name, header, {}});
+        return outputs.size() - 1;
+    };
+
+    int section_index[SECTION_COUNT];
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        auto &section = _sections[i];
+        if (i == RODATA && section.bytes.empty()) {
+            section_index[i] = 0;
+            continue;
+        }
+        section_index[i] =
+            add_section(section.name, section.type, section.flags,
+                        section.align);
+        auto &output = outputs.back();
+        output.bytes = section.bytes;
+        output.header.sh_size = i == BSS ? section.size : section.bytes.size();
+    }
+    if (_has_stack_note) {
+        add_section(".note.GNU-stack", SHT_PROGBITS, 0, 1);
+    }
+
+    // symbols: null, sections, locals and then globals
+    std::vector<Elf64_Sym> symtab(1, Elf64_Sym{});
+    std::string strtab(1, '\0');
+    std::vector<int> section_symbols(SECTION_COUNT, 0);
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        if (section_index[i] != 0) {
+            Elf64_Sym sym = {};
+            sym.st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+            sym.st_shndx = section_index[i];
+            section_symbols[i] = symtab.size();
+            symtab.push_back(sym);
+        }
+    }
+    std::vector<int> symbol_output(_symbols.size());
+    int first_global = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            first_global = symtab.size();
+        }
+        for (size_t i = 0; i < _symbols.size(); i++) {
+            auto &symbol = _symbols[i];
+            bool is_global = symbol.is_global || symbol.section == NONE;
+            if (is_global != (pass == 1)) {
+                continue;
+            }
+
+            Elf64_Sym sym = {};
+            sym.st_name = strtab.size();
+            strtab += symbol.name + '\0';
+            sym.st_info = ELF64_ST_INFO(is_global ? STB_GLOBAL : STB_LOCAL,
+                                        symbol.type);
+            sym.st_shndx =
+                symbol.section == NONE ? SHN_UNDEF
+                                       : section_index[symbol.section];
+            sym.st_value = symbol.value;
+            sym.st_size = symbol.size;
+            symbol_output[i] = symtab.size();
+            symtab.push_back(sym);
+        }
+    }
+
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        auto &section = _sections[i];
+        if (section.relocs.empty()) {
+            continue;
+        }
+
+        std::vector<uint8_t> bytes;
+        for (auto &reloc : section.relocs) {
+            Elf64_Rela rela = {};
+            rela.r_offset = reloc.offset;
+            rela.r_addend = reloc.addend;
+            int sym;
+            if (auto it = _symbol_index.find(reloc.symbol);
+                it != _symbol_index.end()) {
+                sym = symbol_output[it->second];
+            } else {
+                auto [label_section, offset] = _local_labels.at(reloc.symbol);
+                sym = section_symbols[label_section];
+                rela.r_addend += offset;
+            }
+            rela.r_info = ELF64_R_INFO(sym, reloc.type);
+            append_bytes(bytes, rela);
+        }
+        auto index = add_section(".rela" + section.name, SHT_RELA, SHF_INFO_LINK,
+                                 8);
+        outputs[index].header.sh_info = section_index[i];
+        outputs[index].header.sh_entsize = sizeof(Elf64_Rela);
+        outputs[index].bytes = std::move(bytes);
+    }
+
+    auto symtab_index = add_section(".symtab", SHT_SYMTAB, 0, 8);
+    for (auto &sym : symtab) {
+        append_bytes(outputs[symtab_index].bytes, sym);
+    }
+    outputs[symtab_index].header.sh_info = first_global;
+    outputs[symtab_index].header.sh_entsize = sizeof(Elf64_Sym);
+
+    auto strtab_index = add_section(".strtab", SHT_STRTAB, 0, 1);
+    outputs[strtab_index].bytes.assign(strtab.begin(), strtab.end());
+    outputs[symtab_index].header.sh_link = strtab_index;
+    for (auto &output : outputs) {
+        if (output.header.sh_type == SHT_RELA) {
+            output.header.sh_link = symtab_index;
+        }
+    }
+
+    auto shstrtab_index = add_section(".shstrtab", SHT_STRTAB, 0, 1);
+    std::string shstrtab(1, '\0');
+    for (auto &output : outputs) {
+        if (!output.name.empty()) {
+            output.header.sh_name = shstrtab.size();
+            shstrtab += output.name + '\0';
+        }
+    }
+    outputs[shstrtab_index].bytes.assign(shstrtab.begin(), shstrtab.end());
+
+    // layout: header, contents of sections, and then section headers
+    std::vector<uint8_t> file(sizeof(Elf64_Ehdr));
+    for (auto &output : outputs) {
+        auto &header = output.header;
+        if (header.sh_type == SHT_NULL) {
+            continue;
+        }
+        auto align = std::max<uint64_t>(header.sh_addralign, 1);
+        file.resize((file.size() + align - 1) / align * align);
+        header.sh_offset = file.size();
+        if (header.sh_type != SHT_NOBITS) {
+            header.sh_size = output.bytes.size();
+            file.insert(file.end(), output.bytes.begin(), output.bytes.end());
+        }
+    }
+    file.resize((file.size() + 7) / 8 * 8);
+    auto shoff = file.size();
+    for (auto &output : outputs) {
+        append_bytes(file, output.header);
+    }
+
+    Elf64_Ehdr ehdr = {};
+    std::copy(ELFMAG, ELFMAG + SELFMAG, ehdr.e_ident);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_RISCV;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = shoff;
+    ehdr.e_flags = EF_RISCV_FLOAT_ABI_DOUBLE;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = outputs.size();
+    ehdr.e_shstrndx = shstrtab_index;
+    std::copy_n(reinterpret_cast<uint8_t *>(&ehdr), sizeof(ehdr), file.begin());
+
+    out.write(reinterpret_cast<const char *>(file.data()), file.size());
+}
+
+} // namespace target
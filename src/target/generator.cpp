@@ -1,13 +1,36 @@
 #include "target/generator.h"
 #include "array"
 #include "target/mem.h"
+#include "target/peephole.h"
 #include "target/regalloc.h"
 #include "target/utils.h"
+#include <algorithm>
 
 namespace target {
 
 #define INDENT "    "
 
+// each vector operand is a group of so many registers
+static const int VECTOR_LMUL = 2;
+
+static MachineOperand reg_of(int reg) { return MachineOperand::reg_of(reg); }
+
+static MachineOperand imm_of(long long imm) {
+    return MachineOperand::imm_of(imm);
+}
+
+static MachineOperand sym_of(std::string sym) {
+    return MachineOperand::sym_of(std::move(sym));
+}
+
+static MachineOperand mem_of(int base, long long disp) {
+    return MachineOperand::mem_of(base, disp);
+}
+
+static MachineOperand label_of(const ir::BlockPtr &block) {
+    return sym_of(".L" + std::to_string(block->id));
+}
+
 void Generator::generate(const ir::Module &module) {
     for (const auto &data : module.datas) {
         generate_data(*data);
@@ -17,6 +40,14 @@ void Generator::generate(const ir::Module &module) {
         generate_func(*func);
     }
 
+    finish(module);
+}
+
+void Generator::finish(const ir::Module &module) {
+    for (const auto &kernel : module.vector_kernels) {
+        generate_vector_kernel(*kernel);
+    }
+
     for (const auto &data : _local_data) {
         generate_data(*data);
     }
@@ -75,15 +106,20 @@ void Generator::generate_data(const ir::Data &data) {
 }
 
 void Generator::generate_func(const ir::Function &func) {
+    auto regalloc_start = std::chrono::steady_clock::now();
     LinearScanAllocator regalloc;
     regalloc.allocate_registers(func);
-
-    bool minimum_stack = true;
+    regalloc_time += std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - regalloc_start)
+                         .count();
 
     _stack_manager = StackManager();
     _stack_manager.run(func);
+    if (_opt) {
+        _stack_manager.shrink_wrap(func);
+    }
 
-    _buffer.clear();
+    _mfunc.clear();
 
     _out << ".text" << std::endl;
 
@@ -93,56 +129,76 @@ void Generator::generate_func(const ir::Function &func) {
 
     _out << func.name << ":" << std::endl;
 
-    int frame_size = _stack_manager.get_frame_size();
-    if (frame_size > 16) {
-        minimum_stack = false;
-    }
-
-    if (is_in_imm12_range(frame_size)) {
-        _buffer.append("addi", "sp", "sp", std::to_string(-frame_size))
-            .set_entry();
-    } else { // since a5-a6 may still store value here, we use t0 as
-             // intermediate reg
-        _buffer.append("li", "t0", std::to_string(frame_size)).set_entry();
-        _buffer.append("sub", "sp", "sp", "t0").set_entry();
-    }
-
+    bool minimum_stack = _stack_manager.get_frame_size() <= 16;
     for (auto [reg, offset] : _stack_manager.get_callee_saved_regs_offset()) {
-        std::string store = (reg >= 32 ? "fsd" : "sd");
         if (reg != 1) {
             minimum_stack = false;
         }
-        if (is_in_imm12_range(offset)) {
-            auto &inst = _buffer.append(store, regno2string(reg),
-                                        std::to_string(offset) + "(sp)");
-            if (reg == 1) { // ra
-                inst.set_entry();
-            }
-        } else {
-            _buffer.append("li", "t0", std::to_string(offset));
-            _buffer.append("add", "t0", "sp", "t0");
-            _buffer.append(store, regno2string(reg), "0(t0)");
+    }
+    // params past a7 are read relative to the adjusted sp
+    int par_total = 0;
+    for (const auto &inst : func.start->insts) {
+        if (inst->insttype == ir::InstType::IPAR && ++par_total > 8) {
+            minimum_stack = false;
         }
     }
 
+    auto prologue_block = _stack_manager.get_prologue_block();
+    if (prologue_block == nullptr && _stack_manager.is_in_frame(func.start)) {
+        _generate_prologue();
+    }
+
+    // deferred params are read from argument registers outside the frame
+    std::unordered_map<ir::TempPtr, int> par_regs;
+    for (auto [temp, arg_reg] : _stack_manager.get_deferred_pars()) {
+        par_regs[temp] = temp->reg;
+    }
+
     for (auto block = func.start; block; block = block->next) {
         _reg_reach =
             decltype(_reg_reach)([](const RegReach &a, const RegReach &b) {
                 return a.end <= b.end;
             });
 
-        _buffer.append(".L" + std::to_string(block->id));
+        _mfunc.append(".L" + std::to_string(block->id));
+        _in_frame = _stack_manager.is_in_frame(block);
+        for (auto [temp, arg_reg] : _stack_manager.get_deferred_pars()) {
+            temp->reg = _in_frame ? par_regs[temp] : arg_reg;
+        }
+        if (block == prologue_block) {
+            _generate_prologue();
+            for (auto [temp, arg_reg] : _stack_manager.get_deferred_pars()) {
+                _mfunc.append(temp->get_type() == ir::Type::S ? "fmv.s" : "mv",
+                              {reg_of(temp->reg), reg_of(arg_reg)});
+            }
+        }
 
         std::vector<ir::ValuePtr> call_args;
         int par_count = 0;
+        bool is_tail_call = false;
+        auto branch_cond = _select_branch(*block);
+        _select_deferred_defs(*block);
         for (const auto &inst : block->insts) {
-            if (inst->insttype == ir::InstType::IARG) {
+            if (inst == branch_cond) {
+                continue; // covered by the branch
+            } else if (inst->to && _deferred_defs.count(inst->to)) {
+                // computed at its use
+            } else if (inst->insttype == ir::InstType::IARG) {
                 call_args.push_back(inst->arg[0]);
             } else if (inst->insttype == ir::InstType::ICALL) {
-                _generate_call_inst(*inst, call_args);
+                if (_opt && inst == block->insts.back() &&
+                    _is_sibling_call(*inst, block->jump, call_args)) {
+                    _generate_tail_call_inst(*inst, call_args);
+                    is_tail_call = true;
+                } else {
+                    _generate_call_inst(*inst, call_args);
+                }
                 call_args.clear();
             } else if (inst->insttype == ir::InstType::IPAR) {
-                _generate_par_inst(*inst, par_count++);
+                if (_in_frame || !par_regs.count(inst->to)) {
+                    _generate_par_inst(*inst, par_count);
+                }
+                par_count++;
             } else {
                 _generate_inst(*inst);
             }
@@ -155,21 +211,287 @@ void Generator::generate_func(const ir::Function &func) {
                 }
             }
         }
-        _generate_jump_inst(block->jump);
+        if (!is_tail_call) {
+            _generate_jump_inst(block->jump, branch_cond);
+        }
+    }
+    for (auto [temp, reg] : par_regs) {
+        temp->reg = reg;
     }
 
+    ScratchRegisterAllocator().allocate(_mfunc);
     if (_opt) {
-        _buffer.optimize(minimum_stack);
+        auto peephole_start = std::chrono::steady_clock::now();
+        PeepholeOptimizer(_mfunc).run(minimum_stack);
+        peephole_time += std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - peephole_start)
+                             .count();
     }
 
-    _buffer.emit(_out);
+    _mfunc.emit(_out);
 
     _out << ".type " << func.name << ", @function" << std::endl;
     _out << ".size " << func.name << ", .-" << func.name << std::endl;
     _out << "/* end function " << func.name << " */" << std::endl << std::endl;
 }
 
+void Generator::generate_vector_kernel(const ir::VectorKernel &kernel) {
+    _mfunc.clear();
+
+    _out << ".text" << std::endl;
+    _out << ".option push" << std::endl;
+    _out << ".option arch, +v" << std::endl;
+    _out << kernel.name << ":" << std::endl;
+
+    bool is_float = kernel.ty == ir::Type::S;
+    auto get_arg_reg = [&kernel](int arg) {
+        return reg_of((kernel.params[arg] == ir::Type::S ? FA0 : A0) + arg);
+    };
+    auto loop_label = sym_of(".L" + kernel.name + ".loop");
+    auto done_label = sym_of(".L" + kernel.name + ".done");
+    auto vtype = sym_of("e32, m" + std::to_string(VECTOR_LMUL) + ", ta, ma");
+    // vector registers are not allocated, so they are kept as symbols
+    auto v1 = sym_of("v1");
+
+    // the accumulator is kept in element 0 of v1
+    if (kernel.acc >= 0) {
+        _mfunc.append("vsetvli",
+                      {reg_of(T0), reg_of(ZERO), sym_of("e32, m1, ta, ma")});
+        _mfunc.append(is_float ? "vfmv.s.f" : "vmv.s.x",
+                      {v1, get_arg_reg(kernel.acc)});
+    }
+
+    // a0 is the count of remaining elements, and t0 is the count of elements
+    // processed in this round
+    _mfunc.append("blez", {reg_of(A0), done_label});
+
+    // t5 is the max count per round, which is 1 if dst overlaps another array
+    // partially, so that the elements are processed in order
+    auto dst_arg = kernel.dst ? kernel.dst->arg : -1;
+    if (kernel.check_overlap) {
+        std::map<int, int> array_strides;
+        std::function<void(const ir::VectorNode &)> collect =
+            [&](const ir::VectorNode &node) {
+                if (node.kind == ir::VectorNode::ARRAY) {
+                    array_strides[node.arg] = node.stride;
+                }
+                if (node.left) {
+                    collect(*node.left);
+                }
+                if (node.right) {
+                    collect(*node.right);
+                }
+            };
+        collect(*kernel.exp);
+
+        auto dst_reg = get_arg_reg(dst_arg);
+        _mfunc.append("li", {reg_of(T5), imm_of(-1)});
+        for (auto [arg, stride] : array_strides) {
+            if (arg == dst_arg) {
+                continue;
+            }
+            auto reg = get_arg_reg(arg);
+            auto next_label =
+                ".L" + kernel.name + ".check" + std::to_string(arg);
+            if (stride == kernel.dst->stride) {
+                _mfunc.append("beq", {reg, dst_reg, sym_of(next_label)});
+            }
+            _mfunc.append("li", {reg_of(T1), imm_of(stride)});
+            _mfunc.append("mul", {reg_of(T1), reg_of(A0), reg_of(T1)});
+            _mfunc.append("add", {reg_of(T1), reg, reg_of(T1)});
+            _mfunc.append("bgeu", {dst_reg, reg_of(T1), sym_of(next_label)});
+            _mfunc.append("li", {reg_of(T1), imm_of(kernel.dst->stride)});
+            _mfunc.append("mul", {reg_of(T1), reg_of(A0), reg_of(T1)});
+            _mfunc.append("add", {reg_of(T1), dst_reg, reg_of(T1)});
+            _mfunc.append("bgeu", {reg, reg_of(T1), sym_of(next_label)});
+            _mfunc.append("li", {reg_of(T5), imm_of(1)});
+            _mfunc.append(next_label);
+        }
+    }
+
+    _mfunc.append(loop_label.sym);
+    if (kernel.check_overlap) {
+        auto avl_label = ".L" + kernel.name + ".avl";
+        _mfunc.append("mv", {reg_of(T3), reg_of(A0)});
+        _mfunc.append("bgeu", {reg_of(T5), reg_of(A0), sym_of(avl_label)});
+        _mfunc.append("mv", {reg_of(T3), reg_of(T5)});
+        _mfunc.append(avl_label);
+        _mfunc.append("vsetvli", {reg_of(T0), reg_of(T3), vtype});
+    } else {
+        _mfunc.append("vsetvli", {reg_of(T0), reg_of(A0), vtype});
+    }
+
+    // v0 is left for masks
+    std::vector<MachineOperand> free_regs;
+    for (int reg = 32 - VECTOR_LMUL; reg >= VECTOR_LMUL; reg -= VECTOR_LMUL) {
+        free_regs.push_back(sym_of("v" + std::to_string(reg)));
+    }
+    auto alloc_reg = [&free_regs]() {
+        if (free_regs.empty()) {
+            throw std::runtime_error("too many vector registers required");
+        }
+        auto reg = free_regs.back();
+        free_regs.pop_back();
+        return reg;
+    };
+
+    std::map<int, int> strides; // array args to advance
+    auto access = [&](const std::string &op, const MachineOperand &reg,
+                      const ir::VectorNode &array) {
+        auto base = sym_of("(" + get_arg_reg(array.arg).to_string() + ")");
+        strides[array.arg] = array.stride;
+        if (array.stride == 4) {
+            _mfunc.append(op + "e32.v", {reg, base});
+        } else {
+            _mfunc.append("li", {reg_of(T1), imm_of(array.stride)});
+            _mfunc.append(op + "se32.v", {reg, base, reg_of(T1)});
+        }
+    };
+    auto broadcast = [&](const MachineOperand &scalar) {
+        auto reg = alloc_reg();
+        _mfunc.append(is_float ? "vfmv.v.f" : "vmv.v.x", {reg, scalar});
+        return reg;
+    };
+
+    // arrays read more than once are loaded at their first read, into
+    // registers never written by the operations
+    std::map<int, MachineOperand> reused_regs;
+    std::set<std::string> reused_names;
+    auto reused = kernel.get_reused_arrays();
+    auto is_owned = [&reused_names](const MachineOperand &reg, bool is_vector) {
+        return is_vector && !reused_names.count(reg.sym);
+    };
+    // a register to write the result of an operation, which is the register
+    // of an operand of its own if any, while the other one is freed
+    auto get_dst = [&](const MachineOperand &reg, bool is_vector,
+                       const MachineOperand &other, bool is_other_vector) {
+        bool is_other_owned = is_owned(other, is_other_vector);
+        if (is_owned(reg, is_vector)) {
+            if (is_other_owned) {
+                free_regs.push_back(other);
+            }
+            return reg;
+        } else if (is_other_owned) {
+            return other;
+        }
+        return alloc_reg();
+    };
+
+    // returns the register and whether it is a vector
+    std::function<std::tuple<MachineOperand, bool>(const ir::VectorNode &)>
+        eval = [&](const ir::VectorNode &node)
+        -> std::tuple<MachineOperand, bool> {
+        static const std::unordered_map<int, std::string> kind2op = {
+            {ir::VectorNode::ADD, "add"}, {ir::VectorNode::SUB, "sub"},
+            {ir::VectorNode::MUL, "mul"}, {ir::VectorNode::DIV, "div"},
+            {ir::VectorNode::REM, "rem"},
+        };
+
+        if (node.kind == ir::VectorNode::SCALAR) {
+            return {get_arg_reg(node.arg), false};
+        } else if (node.kind == ir::VectorNode::ARRAY) {
+            if (reused_regs.count(node.arg)) {
+                return {reused_regs.at(node.arg), true};
+            }
+            auto reg = alloc_reg();
+            access("vl", reg, node);
+            if (std::find(reused.begin(), reused.end(), node.arg) !=
+                reused.end()) {
+                reused_regs.emplace(node.arg, reg);
+                reused_names.insert(reg.sym);
+            }
+            return {reg, true};
+        } else if (node.kind == ir::VectorNode::NEG) {
+            auto [reg, is_vector] = eval(*node.left);
+            auto dst = is_owned(reg, is_vector) ? reg : alloc_reg();
+            if (is_float) {
+                _mfunc.append("vfsgnjn.vv", {dst, reg, reg});
+            } else {
+                _mfunc.append("vrsub.vx", {dst, reg, reg_of(ZERO)});
+            }
+            return {dst, true};
+        }
+
+        auto [left, is_left_vector] = eval(*node.left);
+        auto [right, is_right_vector] = eval(*node.right);
+        auto op = (is_float ? "vf" : "v") + kind2op.at(node.kind);
+        auto vx = is_float ? ".vf" : ".vx";
+        bool is_commutative =
+            node.kind == ir::VectorNode::ADD || node.kind == ir::VectorNode::MUL;
+
+        MachineOperand dst;
+        if (is_left_vector && is_right_vector) {
+            dst = get_dst(left, true, right, true);
+            _mfunc.append(op + ".vv", {dst, left, right});
+        } else if (is_left_vector) {
+            dst = get_dst(left, true, right, false);
+            _mfunc.append(op + vx, {dst, left, right});
+        } else if (is_commutative) {
+            dst = get_dst(right, true, left, false);
+            _mfunc.append(op + vx, {dst, right, left});
+        } else if (node.kind == ir::VectorNode::SUB ||
+                   (is_float && node.kind == ir::VectorNode::DIV)) {
+            // reversed operands, e.g. vrsub.vx computes x - v
+            auto rop = (is_float ? "vfr" : "vr") + kind2op.at(node.kind);
+            dst = get_dst(right, true, left, false);
+            _mfunc.append(rop + vx, {dst, right, left});
+        } else {
+            dst = broadcast(left);
+            _mfunc.append(op + ".vv", {dst, dst, right});
+            if (is_owned(right, true)) {
+                free_regs.push_back(right);
+            }
+        }
+        return {dst, true};
+    };
+
+    auto [result, is_vector] = eval(*kernel.exp);
+    if (kernel.dst) {
+        if (!is_vector) {
+            result = broadcast(result);
+        }
+        access("vs", result, *kernel.dst);
+    } else {
+        _mfunc.append(is_float ? "vfredosum.vs" : "vredsum.vs",
+                      {v1, result, v1});
+    }
+
+    // advance to the next round
+    _mfunc.append("sub", {reg_of(A0), reg_of(A0), reg_of(T0)});
+    _mfunc.append("slli", {reg_of(T2), reg_of(T0), imm_of(2)});
+    for (auto [arg, stride] : strides) {
+        auto reg = get_arg_reg(arg);
+        if (stride == 4) {
+            _mfunc.append("add", {reg, reg, reg_of(T2)});
+        } else {
+            _mfunc.append("li", {reg_of(T1), imm_of(stride)});
+            _mfunc.append("mul", {reg_of(T1), reg_of(T0), reg_of(T1)});
+            _mfunc.append("add", {reg, reg, reg_of(T1)});
+        }
+    }
+    _mfunc.append("bnez", {reg_of(A0), loop_label});
+
+    _mfunc.append(done_label.sym);
+    if (kernel.acc >= 0) {
+        _mfunc.append(is_float ? "vfmv.f.s" : "vmv.x.s",
+                      {reg_of(is_float ? FA0 : A0), v1});
+    }
+    _mfunc.append("jr", {reg_of(RA)});
+
+    _mfunc.emit(_out);
+
+    _out << ".option pop" << std::endl;
+    _out << ".type " << kernel.name << ", @function" << std::endl;
+    _out << ".size " << kernel.name << ", .-" << kernel.name << std::endl;
+    _out << "/* end function " << kernel.name << " */" << std::endl
+         << std::endl;
+}
+
 void Generator::_generate_inst(const ir::Inst &inst) {
+    if (inst.to && inst.to->reg == REMAT) {
+        return; // recomputed at each use
+    }
+
     switch (inst.insttype) {
     case ir::InstType::ISTOREW:
     case ir::InstType::ISTOREL:
@@ -213,6 +535,9 @@ void Generator::_generate_inst(const ir::Inst &inst) {
     case ir::InstType::ISWTOF:
         _generate_convert_inst(inst);
         break;
+    case ir::InstType::ISEL:
+        _generate_select_inst(inst);
+        break;
     case ir::InstType::IALLOC4:
     case ir::InstType::IALLOC8:
     case ir::InstType::INOP:
@@ -231,9 +556,9 @@ void Generator::_generate_load_inst(const ir::Inst &inst) {
     };
 
     auto [to, write_back] = _get_asm_to(inst.to);
-    auto arg = _get_asm_addr(inst.arg[0], 0);
+    auto arg = _get_asm_addr(inst.arg[0], 0, inst.offset);
 
-    _buffer.append(inst2asm.at(inst.insttype), to, arg);
+    _mfunc.append(inst2asm.at(inst.insttype), {to, arg});
 
     write_back(_out);
 }
@@ -249,22 +574,72 @@ void Generator::_generate_store_inst(const ir::Inst &inst) {
             std::dynamic_pointer_cast<ir::ConstBits>(inst.arg[0])) {
         if (auto int_value = std::get_if<int>(&const_arg0->value);
             int_value != nullptr && *int_value == 0) {
-            _buffer.append("sw", "zero", _get_asm_addr(inst.arg[1], 1));
+            _mfunc.append("sw",
+                          {reg_of(ZERO),
+                           _get_asm_addr(inst.arg[1], 1, inst.offset)});
             return;
         } else if (auto float_value = std::get_if<float>(&const_arg0->value);
                    float_value != nullptr && *float_value == 0.0f) {
-            _buffer.append("sw", "zero", _get_asm_addr(inst.arg[1], 1));
+            _mfunc.append("sw",
+                          {reg_of(ZERO),
+                           _get_asm_addr(inst.arg[1], 1, inst.offset)});
             return;
         }
     }
 
     auto arg0 = _get_asm_arg(inst.arg[0], 0);
-    auto arg1 = _get_asm_addr(inst.arg[1], 1);
+    auto arg1 = _get_asm_addr(inst.arg[1], 1, inst.offset);
 
-    _buffer.append(inst2asm.at(inst.insttype), arg0, arg1);
+    _mfunc.append(inst2asm.at(inst.insttype), {arg0, arg1});
+}
+
+// whether the value is an int constant, which is stored to `imm` if so
+static bool get_int_const(ir::ValuePtr value, int &imm) {
+    auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(value);
+    if (constbits == nullptr) {
+        return false;
+    }
+    auto int_value = std::get_if<int>(&constbits->value);
+    if (int_value == nullptr) {
+        return false;
+    }
+    imm = *int_value;
+    return true;
+}
+
+// whether the instruction is `add %x, c`, `add c, %x` or `sub %x, c`, where
+// `%x` is stored to `base` and the constant added to `imm`
+static bool match_add_const(const ir::Inst &inst, ir::ValuePtr &base,
+                            int &imm) {
+    if (inst.insttype == ir::InstType::IADD) {
+        for (int i = 0; i < 2; i++) {
+            if (get_int_const(inst.arg[i], imm)) {
+                base = inst.arg[1 - i];
+                return true;
+            }
+        }
+    } else if (inst.insttype == ir::InstType::ISUB &&
+               get_int_const(inst.arg[1], imm) &&
+               imm != std::numeric_limits<int>::min()) {
+        base = inst.arg[0];
+        imm = -imm;
+        return true;
+    }
+    return false;
 }
 
 void Generator::_generate_arithmetic_inst(const ir::Inst &inst) {
+    if (inst.to->reg == STACK) {
+        return;
+    }
+
+    auto [to, write_back] = _get_asm_to(inst.to);
+    _generate_arithmetic(inst, to);
+    write_back(_out);
+}
+
+void Generator::_generate_arithmetic(const ir::Inst &inst,
+                                     const MachineOperand &to) {
     // clang-format off
     static std::unordered_map<ir::InstType, std::unordered_map<ir::Type, std::string>> inst2asm = {
         {ir::InstType::IADD, {{ir::Type::L, "add"}, {ir::Type::W, "addw"}, {ir::Type::S, "fadd.s"}}},
@@ -275,13 +650,34 @@ void Generator::_generate_arithmetic_inst(const ir::Inst &inst) {
     };
     // clang-format on
 
-    if (inst.to->reg == STACK) {
-        return;
+    auto type = inst.to->get_type();
+    // registers of the strength-reduced sequences
+    auto a5 = reg_of(A5), a6 = reg_of(A6), zero = reg_of(ZERO);
+
+    auto inst_str = inst2asm.at(inst.insttype).at(type);
+
+    // add a constant to an address or by an immediate
+    ir::ValuePtr base;
+    int imm;
+    if (type != ir::Type::S && match_add_const(inst, base, imm)) {
+        auto address = std::dynamic_pointer_cast<ir::Address>(base);
+        if (address && type == ir::Type::L) {
+            _mfunc.append("la", {to, sym_of(address->get_asm_value() +
+                                            (imm < 0 ? "" : "+") +
+                                            std::to_string(imm))});
+            return;
+        } else if (is_in_imm12_range(imm)) {
+            auto arg0 = _get_asm_arg(base, 0);
+            if (imm == 0 && type == ir::Type::L) {
+                _mfunc.append("mv", {to, arg0});
+            } else {
+                _mfunc.append(type == ir::Type::W ? "addiw" : "addi",
+                              {to, arg0, imm_of(imm)});
+            }
+            return;
+        }
     }
 
-    auto [to, write_back] = _get_asm_to(inst.to);
-
-    auto inst_str = inst2asm.at(inst.insttype).at(inst.to->get_type());
     bool wflag = inst_str == "mulw" || inst_str == "divw" || inst_str == "remw";
     if (inst_str == "mulw" || inst_str == "mul") {
         if (auto constbits =
@@ -289,57 +685,59 @@ void Generator::_generate_arithmetic_inst(const ir::Inst &inst) {
             if (auto value = std::get_if<int>(&constbits->value)) {
                 auto arg1 = _get_asm_arg(inst.arg[1], 1);
                 if (is_power_of_two(*value)) {
-                    _buffer.append(wflag ? "slliw" : "slli", to, arg1,
-                                   std::to_string(calculate_exponent(*value)));
+                    _mfunc.append(wflag ? "slliw" : "slli",
+                                  {to, arg1,
+                                   imm_of(calculate_exponent(*value))});
                 } else if (is_power_of_two(*value + 1)) {
-                    _buffer.append(
-                        wflag ? "slliw" : "slli", "a5", arg1,
-                        std::to_string(calculate_exponent(*value + 1)));
-                    _buffer.append(wflag ? "subw" : "sub", to, "a5", arg1);
+                    _mfunc.append(wflag ? "slliw" : "slli",
+                                  {a5, arg1,
+                                   imm_of(calculate_exponent(*value + 1))});
+                    _mfunc.append(wflag ? "subw" : "sub", {to, a5, arg1});
                 } else if (is_power_of_two(*value - 1)) {
-                    _buffer.append(
-                        wflag ? "slliw" : "slli", "a5", arg1,
-                        std::to_string(calculate_exponent(*value - 1)));
-                    _buffer.append(wflag ? "addw" : "add", to, "a5", arg1);
+                    _mfunc.append(wflag ? "slliw" : "slli",
+                                  {a5, arg1,
+                                   imm_of(calculate_exponent(*value - 1))});
+                    _mfunc.append(wflag ? "addw" : "add", {to, a5, arg1});
                 } else {
                     auto arg0 = _get_asm_arg(inst.arg[0], 0);
-                    _buffer.append(inst_str, to, arg0, arg1);
+                    _mfunc.append(inst_str, {to, arg0, arg1});
                 }
             } else {
                 auto arg0 = _get_asm_arg(inst.arg[0], 0);
                 auto arg1 = _get_asm_arg(inst.arg[1], 1);
-                _buffer.append(inst_str, to, arg0, arg1);
+                _mfunc.append(inst_str, {to, arg0, arg1});
             }
         } else if (auto constbits =
                        std::dynamic_pointer_cast<ir::ConstBits>(inst.arg[1])) {
             if (auto value = std::get_if<int>(&constbits->value)) {
                 auto arg0 = _get_asm_arg(inst.arg[0], 0);
                 if (is_power_of_two(*value)) {
-                    _buffer.append(wflag ? "slliw" : "slli", to, arg0,
-                                   std::to_string(calculate_exponent(*value)));
+                    _mfunc.append(wflag ? "slliw" : "slli",
+                                  {to, arg0,
+                                   imm_of(calculate_exponent(*value))});
                 } else if (is_power_of_two(*value + 1)) {
-                    _buffer.append(
-                        wflag ? "slliw" : "slli", "a5", arg0,
-                        std::to_string(calculate_exponent(*value + 1)));
-                    _buffer.append(wflag ? "subw" : "sub", to, "a5", arg0);
+                    _mfunc.append(wflag ? "slliw" : "slli",
+                                  {a5, arg0,
+                                   imm_of(calculate_exponent(*value + 1))});
+                    _mfunc.append(wflag ? "subw" : "sub", {to, a5, arg0});
                 } else if (is_power_of_two(*value - 1)) {
-                    _buffer.append(
-                        wflag ? "slliw" : "slli", "a5", arg0,
-                        std::to_string(calculate_exponent(*value - 1)));
-                    _buffer.append(wflag ? "addw" : "add", to, "a5", arg0);
+                    _mfunc.append(wflag ? "slliw" : "slli",
+                                  {a5, arg0,
+                                   imm_of(calculate_exponent(*value - 1))});
+                    _mfunc.append(wflag ? "addw" : "add", {to, a5, arg0});
                 } else {
                     auto arg1 = _get_asm_arg(inst.arg[1], 1);
-                    _buffer.append(inst_str, to, arg0, arg1);
+                    _mfunc.append(inst_str, {to, arg0, arg1});
                 }
             } else {
                 auto arg0 = _get_asm_arg(inst.arg[0], 0);
                 auto arg1 = _get_asm_arg(inst.arg[1], 1);
-                _buffer.append(inst_str, to, arg0, arg1);
+                _mfunc.append(inst_str, {to, arg0, arg1});
             }
         } else {
             auto arg0 = _get_asm_arg(inst.arg[0], 0);
             auto arg1 = _get_asm_arg(inst.arg[1], 1);
-            _buffer.append(inst_str, to, arg0, arg1);
+            _mfunc.append(inst_str, {to, arg0, arg1});
         }
     } else if (inst_str == "divw") {
         if (auto constbits =
@@ -352,47 +750,47 @@ void Generator::_generate_arithmetic_inst(const ir::Inst &inst) {
                     abs = -abs;
                 }
                 if ((abs & (abs - 1)) == 0) {
-                    _buffer.append(wflag ? "sraiw" : "srai", "a5", arg0, "31");
+                    _mfunc.append(wflag ? "sraiw" : "srai",
+                                  {a5, arg0, imm_of(31)});
                     int l = getCTZ(abs);
-                    _buffer.append(wflag ? "srliw" : "srli", "a5", "a5",
-                                   std::to_string(32 - l));
-                    _buffer.append(wflag ? "addw" : "add", "a5", "a5", arg0);
-                    _buffer.append(wflag ? "sraiw" : "srai", "a5", "a5",
-                                   std::to_string(l));
+                    _mfunc.append(wflag ? "srliw" : "srli",
+                                  {a5, a5, imm_of(32 - l)});
+                    _mfunc.append(wflag ? "addw" : "add", {a5, a5, arg0});
+                    _mfunc.append(wflag ? "sraiw" : "srai",
+                                  {a5, a5, imm_of(l)});
                 } else {
                     auto res = choose_pair(abs, 31);
                     int64_t m = res.first;
                     int sh = res.second;
                     if (m < 2147483648ULL) {
-                        _buffer.append("li", "a5", std::to_string(m));
-                        _buffer.append("mul", "a5", arg0, "a5");
-                        _buffer.append("srli", "a5", "a5", "32");
+                        _mfunc.append("li", {a5, imm_of(m)});
+                        _mfunc.append("mul", {a5, arg0, a5});
+                        _mfunc.append("srli", {a5, a5, imm_of(32)});
                     } else {
-                        _buffer.append("li", "a5",
-                                       std::to_string(m - (1ULL << 32)));
-                        _buffer.append("mul", "a5", arg0, "a5");
-                        _buffer.append("srli", "a5", "a5", "32");
-                        _buffer.append("addw", "a5", arg0, "a5");
+                        _mfunc.append("li", {a5, imm_of(m - (1ULL << 32))});
+                        _mfunc.append("mul", {a5, arg0, a5});
+                        _mfunc.append("srli", {a5, a5, imm_of(32)});
+                        _mfunc.append("addw", {a5, arg0, a5});
                     }
-                    _buffer.append(wflag ? "sraiw" : "srai", "a5", "a5",
-                                   std::to_string(sh));
-                    _buffer.append(wflag ? "srliw" : "srli", "a6", arg0,
-                                   std::to_string(31));
-                    _buffer.append(wflag ? "addw" : "add", "a5", "a5", "a6");
+                    _mfunc.append(wflag ? "sraiw" : "srai",
+                                  {a5, a5, imm_of(sh)});
+                    _mfunc.append(wflag ? "srliw" : "srli",
+                                  {a6, arg0, imm_of(31)});
+                    _mfunc.append(wflag ? "addw" : "add", {a5, a5, a6});
                 }
                 if (value_num < 0) {
-                    _buffer.append(wflag ? "subw" : "sub", "a5", "zero", "a5");
+                    _mfunc.append(wflag ? "subw" : "sub", {a5, zero, a5});
                 }
-                _buffer.append(wflag ? "addw" : "add", to, "zero", "a5");
+                _mfunc.append(wflag ? "addw" : "add", {to, zero, a5});
             } else {
                 auto arg0 = _get_asm_arg(inst.arg[0], 0);
                 auto arg1 = _get_asm_arg(inst.arg[1], 1);
-                _buffer.append(inst_str, to, arg0, arg1);
+                _mfunc.append(inst_str, {to, arg0, arg1});
             }
         } else {
             auto arg0 = _get_asm_arg(inst.arg[0], 0);
             auto arg1 = _get_asm_arg(inst.arg[1], 1);
-            _buffer.append(inst_str, to, arg0, arg1);
+            _mfunc.append(inst_str, {to, arg0, arg1});
         }
     } else if (inst_str == "remw") {
         if (auto constbits =
@@ -405,57 +803,55 @@ void Generator::_generate_arithmetic_inst(const ir::Inst &inst) {
                     abs = -abs;
                 }
                 if ((abs & (abs - 1)) == 0) {
-                    _buffer.append(wflag ? "sraiw" : "srai", "a5", arg0, "31");
+                    _mfunc.append(wflag ? "sraiw" : "srai",
+                                  {a5, arg0, imm_of(31)});
                     int l = getCTZ(abs);
-                    _buffer.append(wflag ? "srliw" : "srli", "a5", "a5",
-                                   std::to_string(32 - l));
-                    _buffer.append(wflag ? "addw" : "add", "a5", "a5", arg0);
-                    _buffer.append(wflag ? "sraiw" : "srai", "a5", "a5",
-                                   std::to_string(l));
+                    _mfunc.append(wflag ? "srliw" : "srli",
+                                  {a5, a5, imm_of(32 - l)});
+                    _mfunc.append(wflag ? "addw" : "add", {a5, a5, arg0});
+                    _mfunc.append(wflag ? "sraiw" : "srai",
+                                  {a5, a5, imm_of(l)});
                 } else {
                     auto res = choose_pair(abs, 31);
                     int64_t m = res.first;
                     int sh = res.second;
                     if (m < 2147483648ULL) {
-                        _buffer.append("li", "a5", std::to_string(m));
-                        _buffer.append("mul", "a5", arg0, "a5");
-                        _buffer.append("srli", "a5", "a5", "32");
+                        _mfunc.append("li", {a5, imm_of(m)});
+                        _mfunc.append("mul", {a5, arg0, a5});
+                        _mfunc.append("srli", {a5, a5, imm_of(32)});
                     } else {
-                        _buffer.append("li", "a5",
-                                       std::to_string(m - (1ULL << 32)));
-                        _buffer.append("mul", "a5", arg0, "a5");
-                        _buffer.append("srli", "a5", "a5", "32");
-                        _buffer.append("addw", "a5", arg0, "a5");
+                        _mfunc.append("li", {a5, imm_of(m - (1ULL << 32))});
+                        _mfunc.append("mul", {a5, arg0, a5});
+                        _mfunc.append("srli", {a5, a5, imm_of(32)});
+                        _mfunc.append("addw", {a5, arg0, a5});
                     }
-                    _buffer.append(wflag ? "sraiw" : "srai", "a5", "a5",
-                                   std::to_string(sh));
-                    _buffer.append(wflag ? "srliw" : "srli", "a6", arg0,
-                                   std::to_string(31));
-                    _buffer.append(wflag ? "addw" : "add", "a5", "a5", "a6");
+                    _mfunc.append(wflag ? "sraiw" : "srai",
+                                  {a5, a5, imm_of(sh)});
+                    _mfunc.append(wflag ? "srliw" : "srli",
+                                  {a6, arg0, imm_of(31)});
+                    _mfunc.append(wflag ? "addw" : "add", {a5, a5, a6});
                 }
                 if (value_num < 0) {
-                    _buffer.append(wflag ? "subw" : "sub", "a5", "zero", "a5");
+                    _mfunc.append(wflag ? "subw" : "sub", {a5, zero, a5});
                 }
-                _buffer.append("li", "a6", std::to_string(value_num));
-                _buffer.append(wflag ? "mulw" : "mul", "a5", "a6", "a5");
-                _buffer.append(wflag ? "subw" : "sub", to, arg0, "a5");
+                _mfunc.append("li", {a6, imm_of(value_num)});
+                _mfunc.append(wflag ? "mulw" : "mul", {a5, a6, a5});
+                _mfunc.append(wflag ? "subw" : "sub", {to, arg0, a5});
             } else {
                 auto arg0 = _get_asm_arg(inst.arg[0], 0);
                 auto arg1 = _get_asm_arg(inst.arg[1], 1);
-                _buffer.append(inst_str, to, arg0, arg1);
+                _mfunc.append(inst_str, {to, arg0, arg1});
             }
         } else {
             auto arg0 = _get_asm_arg(inst.arg[0], 0);
             auto arg1 = _get_asm_arg(inst.arg[1], 1);
-            _buffer.append(inst_str, to, arg0, arg1);
+            _mfunc.append(inst_str, {to, arg0, arg1});
         }
     } else {
         auto arg0 = _get_asm_arg(inst.arg[0], 0);
         auto arg1 = _get_asm_arg(inst.arg[1], 1);
-        _buffer.append(inst_str, to, arg0, arg1);
+        _mfunc.append(inst_str, {to, arg0, arg1});
     }
-
-    write_back(_out);
 }
 
 int getCTZ(int num) {
@@ -468,33 +864,94 @@ int getCTZ(int num) {
     return r;
 }
 
+// the compare with its operands swapped
+static ir::InstType mirror_compare(ir::InstType insttype) {
+    switch (insttype) {
+    case ir::InstType::ICSLEW:
+        return ir::InstType::ICSGEW;
+    case ir::InstType::ICSLTW:
+        return ir::InstType::ICSGTW;
+    case ir::InstType::ICSGEW:
+        return ir::InstType::ICSLEW;
+    case ir::InstType::ICSGTW:
+        return ir::InstType::ICSLTW;
+    default:
+        return insttype;
+    }
+}
+
 void Generator::_generate_compare_inst(const ir::Inst &inst) {
     auto [to, write_back] = _get_asm_to(inst.to);
+
+    // compare with a constant by an immediate, where `a0 > c` is left to the
+    // register form since it has no shorter sequence
+    auto insttype = inst.insttype;
+    auto lhs = inst.arg[0], rhs = inst.arg[1];
+    int imm;
+    if (!get_int_const(rhs, imm) && get_int_const(lhs, imm)) {
+        std::swap(lhs, rhs);
+        insttype = mirror_compare(insttype);
+    }
+    if (get_int_const(rhs, imm) && is_in_imm12_range(imm) &&
+        imm != IMM12_MAX && insttype != ir::InstType::ICSGTW) {
+        auto arg0 = _get_asm_arg(lhs, 0);
+        switch (insttype) {
+        case ir::InstType::ICEQW: // (a0 ^ c) < 1
+            if (imm != 0) {
+                _mfunc.append("xori", {to, arg0, imm_of(imm)});
+                arg0 = to;
+            }
+            _mfunc.append("sltiu", {to, arg0, imm_of(1)});
+            break;
+        case ir::InstType::ICNEW: // 0 < (a0 ^ c)
+            if (imm != 0) {
+                _mfunc.append("xori", {to, arg0, imm_of(imm)});
+                arg0 = to;
+            }
+            _mfunc.append("sltu", {to, reg_of(ZERO), arg0});
+            break;
+        case ir::InstType::ICSLEW: // a0 < c + 1
+            _mfunc.append("slti", {to, arg0, imm_of(imm + 1)});
+            break;
+        case ir::InstType::ICSLTW: // a0 < c
+            _mfunc.append("slti", {to, arg0, imm_of(imm)});
+            break;
+        case ir::InstType::ICSGEW: // !(a0 < c)
+            _mfunc.append("slti", {to, arg0, imm_of(imm)});
+            _mfunc.append("xori", {to, to, imm_of(1)});
+            break;
+        default:
+            throw std::logic_error("unsupported type");
+        }
+        write_back(_out);
+        return;
+    }
+
     auto arg0 = _get_asm_arg(inst.arg[0], 0);
     auto arg1 = _get_asm_arg(inst.arg[1], 1);
 
     switch (inst.insttype) {
     case ir::InstType::ICEQW: // (a0 ^ a1) < 1
-        _buffer.append("xor", to, arg0, arg1);
-        _buffer.append("sltiu", to, to, "1");
+        _mfunc.append("xor", {to, arg0, arg1});
+        _mfunc.append("sltiu", {to, to, imm_of(1)});
         break;
     case ir::InstType::ICNEW: // 0 < (a0 ^ a1)
-        _buffer.append("xor", to, arg0, arg1);
-        _buffer.append("sltu", to, "zero", to);
+        _mfunc.append("xor", {to, arg0, arg1});
+        _mfunc.append("sltu", {to, reg_of(ZERO), to});
         break;
     case ir::InstType::ICSLEW: // !(a1 < a0)
-        _buffer.append("slt", to, arg1, arg0);
-        _buffer.append("xori", to, to, "1");
+        _mfunc.append("slt", {to, arg1, arg0});
+        _mfunc.append("xori", {to, to, imm_of(1)});
         break;
     case ir::InstType::ICSLTW: // a0 < a1
-        _buffer.append("slt", to, arg0, arg1);
+        _mfunc.append("slt", {to, arg0, arg1});
         break;
     case ir::InstType::ICSGEW: // !(a0 < a1)
-        _buffer.append("slt", to, arg0, arg1);
-        _buffer.append("xori", to, to, "1");
+        _mfunc.append("slt", {to, arg0, arg1});
+        _mfunc.append("xori", {to, to, imm_of(1)});
         break;
     case ir::InstType::ICSGTW: // a1 < a0
-        _buffer.append("slt", to, arg1, arg0);
+        _mfunc.append("slt", {to, arg1, arg0});
         break;
     default:
         throw std::logic_error("unsupported type");
@@ -518,9 +975,9 @@ void Generator::_generate_float_compare_inst(const ir::Inst &inst) {
         inst.insttype == ir::InstType::ICGTS) {
         std::swap(arg0, arg1);
     }
-    _buffer.append(inst2asm.at(inst.insttype), to, arg0, arg1);
+    _mfunc.append(inst2asm.at(inst.insttype), {to, arg0, arg1});
     if (inst.insttype == ir::InstType::ICNES) {
-        _buffer.append("xori", to, to, "1");
+        _mfunc.append("xori", {to, to, imm_of(1)});
     }
 
     write_back(_out);
@@ -535,15 +992,74 @@ void Generator::_generate_unary_inst(const ir::Inst &inst) {
     // clang-format on
 
     auto [to, write_back] = _get_asm_to(inst.to);
+
+    if (inst.insttype == ir::InstType::ICOPY) {
+        _generate_move(to, inst.arg[0]);
+        write_back(_out);
+        return;
+    }
+
     auto arg = _get_asm_arg(inst.arg[0], 0);
 
     auto inst_str = inst2asm.at(inst.insttype).at(inst.to->get_type());
 
-    _buffer.append(inst_str, to, arg);
+    _mfunc.append(inst_str, {to, arg});
 
     write_back(_out);
 }
 
+void Generator::_generate_move(
+    const MachineOperand &to, ir::ValuePtr value,
+    std::function<int(ir::Type, int)> get_temp_reg) {
+    // load constants and addresses to the destination directly
+    auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(value);
+    if (constbits && constbits->get_type() == ir::Type::S) {
+        _generate_float_const(to, constbits);
+    } else if (constbits) {
+        _mfunc.append("li", {to, imm_of(std::get<int>(constbits->value))});
+    } else if (auto addr = std::dynamic_pointer_cast<ir::Address>(value)) {
+        _mfunc.append("la", {to, sym_of(addr->get_asm_value())});
+    } else if (auto def = _deferred_defs.find(
+                   std::dynamic_pointer_cast<ir::Temp>(value));
+               def != _deferred_defs.end()) {
+        if (def->second->insttype == ir::InstType::ICOPY) {
+            _generate_move(to, def->second->arg[0]);
+        } else {
+            _generate_arithmetic(*def->second, to);
+        }
+    } else {
+        auto arg = _get_asm_arg(value, 0, get_temp_reg);
+        _mfunc.append(value->get_type() == ir::Type::S ? "fmv.s" : "mv",
+                      {to, arg});
+    }
+}
+
+void Generator::_generate_float_const(const MachineOperand &reg,
+                                      ir::ConstBitsPtr constbits) {
+    auto value = constbits->get_asm_value();
+    if (value == "0x0") {
+        _mfunc.append("fmv.w.x", {reg, reg_of(ZERO)});
+        return;
+    }
+
+    // each value is stored once in the module
+    auto &name = _float_consts[value];
+    if (name.empty()) {
+        name = ".LC" + std::to_string(_local_data.size());
+        auto local_data =
+            std::shared_ptr<ir::Data>(new ir::Data{false, name, 4, {}});
+        local_data->append_const(ir::Type::S, {constbits});
+        _local_data.push_back(local_data);
+    }
+
+    // the high part goes to a scratch register, so that the constant can be
+    // loaded while the argument registers are being set
+    int base = _mfunc.new_vreg(false, A5);
+    _mfunc.append("lui", {reg_of(base), sym_of("%hi(" + name + ")")});
+    _mfunc.append("flw",
+                  {reg, MachineOperand::mem_of(base, "%lo(" + name + ")")});
+}
+
 void Generator::_generate_convert_inst(const ir::Inst &inst) {
     static std::unordered_map<ir::InstType, std::string> inst2asm = {
         {ir::InstType::IEXTSW, "sext.w"},
@@ -555,14 +1071,73 @@ void Generator::_generate_convert_inst(const ir::Inst &inst) {
     auto arg = _get_asm_arg(inst.arg[0], 0);
 
     if (inst.insttype == ir::InstType::ISTOSI) {
-        _buffer.append(inst2asm.at(inst.insttype), to, arg, "rtz");
+        _mfunc.append(inst2asm.at(inst.insttype), {to, arg, sym_of("rtz")});
     } else {
-        _buffer.append(inst2asm.at(inst.insttype), to, arg);
+        _mfunc.append(inst2asm.at(inst.insttype), {to, arg});
     }
 
     write_back(_out);
 }
 
+// whether the value is always 0 or 1
+static bool _is_boolean(ir::ValuePtr value) {
+    auto temp = std::dynamic_pointer_cast<ir::Temp>(value);
+    if (temp == nullptr || temp->defs.empty()) {
+        return false;
+    }
+    for (auto &def : temp->defs) {
+        auto inst_def = std::get_if<ir::InstDef>(&def);
+        if (inst_def == nullptr) {
+            return false;
+        }
+        auto insttype = inst_def->ins->insttype;
+        if (insttype < ir::InstType::ICEQW || insttype > ir::InstType::ICGTS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Generator::_generate_select_inst(const ir::Inst &inst) {
+    auto [to, write_back] = _get_asm_to(inst.to);
+    auto cond = _get_asm_arg(inst.arg[0], 0);
+
+    auto one = std::dynamic_pointer_cast<ir::ConstBits>(inst.arg[1]);
+    if (one && one->value == std::variant<int, float>(1) &&
+        _is_boolean(inst.arg[0])) {
+        _mfunc.append("mv", {to, cond});
+        write_back(_out);
+        return;
+    }
+
+    // mask = -(cond != 0), then to = value & mask
+    if (_is_boolean(inst.arg[0])) {
+        _mfunc.append("neg", {reg_of(A4), cond});
+    } else {
+        _mfunc.append("snez", {reg_of(A4), cond});
+        _mfunc.append("neg", {reg_of(A4), reg_of(A4)});
+    }
+    auto value = _get_asm_arg(inst.arg[1], 1);
+    _mfunc.append("and", {to, value, reg_of(A4)});
+
+    write_back(_out);
+}
+
+// registers not preserved across calls
+static const std::vector<int> CALLER_SAVED_REGS = {
+    1,  5,  6,  7,  10, 11, 12, 13, 14, 15, 16, 17, 28, 29, 30, 31, // x
+    32, 33, 34, 35, 36, 37, 38, 39, 42, 43, 44, 45, 46, 47, 48, 49, // f
+    60, 61, 62, 63};
+
+// registers holding the arguments of a call
+static std::vector<int> get_arg_regs(const std::vector<ir::ValuePtr> &args) {
+    std::vector<int> regs;
+    for (size_t i = 0; i < args.size() && i < 8; i++) {
+        regs.push_back((args[i]->get_type() == ir::Type::S ? FA0 : A0) + i);
+    }
+    return regs;
+}
+
 void Generator::_generate_call_inst(const ir::Inst &inst,
                                     const std::vector<ir::ValuePtr> &args) {
 
@@ -576,20 +1151,128 @@ void Generator::_generate_call_inst(const ir::Inst &inst,
         auto offset = _stack_manager.get_caller_saved_regs_offset().at(reg);
         auto store = reg >= 32 ? "fsd" : "sd";
         if (is_in_imm12_range(offset)) {
-            _buffer.append(store, regno2string(reg),
-                           std::to_string(offset) + "(sp)");
+            _mfunc.append(store, {reg_of(reg), mem_of(SP, offset)});
+        } else {
+            _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+            _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+            _mfunc.append(store, {reg_of(reg), mem_of(A5, 0)});
+        }
+    }
+
+    _generate_call_args(args);
+
+    auto callee = std::static_pointer_cast<ir::Address>(inst.arg[0])->name;
+    _mfunc.append("call", {sym_of(callee)}).implicit_uses = get_arg_regs(args);
+    _mfunc.insts.back().implicit_defs = CALLER_SAVED_REGS;
+
+    if (inst.to != nullptr && inst.to->uses.size() > 0) {
+        auto [to, write_back] = _get_asm_to(inst.to);
+        switch (inst.to->get_type()) {
+        case ir::Type::W:
+        case ir::Type::L:
+            _mfunc.append("mv", {to, reg_of(A0)});
+            break;
+        case ir::Type::S:
+            _mfunc.append("fmv.s", {to, reg_of(FA0)});
+            break;
+        default:
+            throw std::logic_error("unsupported type");
+        }
+        write_back(_out);
+    }
+
+    // restore caller saved registers
+    for (auto [reg, end] : _reg_reach) {
+        auto offset = _stack_manager.get_caller_saved_regs_offset().at(reg);
+        auto load = reg >= 32 ? "fld" : "ld";
+        if (is_in_imm12_range(offset)) {
+            _mfunc.append(load, {reg_of(reg), mem_of(SP, offset)});
         } else {
-            _buffer.append("li", "a5", std::to_string(offset));
-            _buffer.append("add", "a5", "sp", "a5");
-            _buffer.append(store, regno2string(reg), "0(a5)");
+            _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+            _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+            _mfunc.append(load, {reg_of(reg), mem_of(A5, 0)});
         }
     }
+}
 
+// whether the value may be the address of a local variable in the frame
+static bool may_point_to_frame(ir::ValuePtr value,
+                               std::unordered_set<ir::TempPtr> &visited) {
+    auto temp = std::dynamic_pointer_cast<ir::Temp>(value);
+    if (temp == nullptr || !visited.insert(temp).second) {
+        return false;
+    }
+
+    for (auto &def : temp->defs) {
+        if (auto phi_def = std::get_if<ir::PhiDef>(&def)) {
+            for (auto &[block, arg] : phi_def->phi->args) {
+                if (may_point_to_frame(arg, visited)) {
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        auto inst = std::get<ir::InstDef>(def).ins;
+        switch (inst->insttype) {
+        case ir::InstType::IALLOC4:
+        case ir::InstType::IALLOC8:
+            return true;
+        case ir::InstType::IADD:
+        case ir::InstType::ISUB:
+        case ir::InstType::ICOPY:
+            for (auto arg : inst->arg) {
+                if (may_point_to_frame(arg, visited)) {
+                    return true;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+bool Generator::_is_sibling_call(const ir::Inst &inst, const ir::Jump &jump,
+                                 const std::vector<ir::ValuePtr> &args) {
+    if (jump.type != ir::Jump::RET ||
+        (jump.arg != nullptr && jump.arg != inst.to)) {
+        return false;
+    }
+
+    // the frame is freed before the call, so no argument may live in it
+    if (args.size() > 8) {
+        return false;
+    }
+    std::unordered_set<ir::TempPtr> visited;
+    for (auto arg : args) {
+        if (arg->get_type() == ir::Type::L &&
+            may_point_to_frame(arg, visited)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Generator::_generate_tail_call_inst(const ir::Inst &inst,
+                                         const std::vector<ir::ValuePtr> &args) {
+    // nothing is live after the call, so no caller saved register is saved
+    _generate_call_args(args);
+
+    // a0-a7 hold the arguments now
+    _generate_epilogue(T0);
+
+    auto callee = std::static_pointer_cast<ir::Address>(inst.arg[0])->name;
+    _mfunc.append("tail", {sym_of(callee)}).implicit_uses = get_arg_regs(args);
+}
+
+void Generator::_generate_call_args(const std::vector<ir::ValuePtr> &args) {
     int arg_count = args.size() - 1;
     for (auto it = args.rbegin(); it != args.rend(); it++, arg_count--) {
         auto arg = *it;
         if (arg_count <= 7) {
-            std::function<int(ir::Type, int)> get_temp_reg = _get_temp_reg;
+            std::function<int(ir::Type, int)> get_temp_reg = nullptr;
             if (arg_count < 4) {
                 get_temp_reg = [](ir::Type type, int no) {
                     std::array<int, 2> reg = {10, 11};            // a0, a1
@@ -601,66 +1284,25 @@ void Generator::_generate_call_inst(const ir::Inst &inst,
                     }
                 };
             }
-            auto arg0 = _get_asm_arg(arg, 0, get_temp_reg);
-            switch (arg->get_type()) {
-            case ir::Type::W:
-            case ir::Type::L:
-                _buffer.append("mv", "a" + std::to_string(arg_count), arg0);
-                break;
-            case ir::Type::S:
-                _buffer.append("fmv.s", "fa" + std::to_string(arg_count), arg0);
-                break;
-            default:
-                throw std::logic_error("unsupported type");
-            }
+            _generate_move(reg_of((arg->get_type() == ir::Type::S ? FA0 : A0) +
+                                  arg_count),
+                           arg, get_temp_reg);
         } else {
             static std::unordered_map<ir::Type, std::string> inst2asm = {
                 {ir::Type::W, "sw"}, {ir::Type::L, "sd"}, {ir::Type::S, "fsw"}};
             int offset = (arg_count - 8) * 8;
             auto arg0 = _get_asm_arg(arg, 0);
             if (is_in_imm12_range(offset)) {
-                _buffer.append(inst2asm.at(arg->get_type()), arg0,
-                               std::to_string(offset) + "(sp)");
+                _mfunc.append(inst2asm.at(arg->get_type()),
+                              {arg0, mem_of(SP, offset)});
             } else {
-                _buffer.append("li", "a5", std::to_string(offset));
-                _buffer.append("add", "a5", "sp", "a5");
-                _buffer.append(inst2asm.at(arg->get_type()), arg0, "0(a5)");
+                _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+                _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+                _mfunc.append(inst2asm.at(arg->get_type()),
+                              {arg0, mem_of(A5, 0)});
             }
         }
     }
-
-    _buffer.append("call",
-                   std::static_pointer_cast<ir::Address>(inst.arg[0])->name);
-
-    if (inst.to != nullptr && inst.to->uses.size() > 0) {
-        auto [to, write_back] = _get_asm_to(inst.to);
-        switch (inst.to->get_type()) {
-        case ir::Type::W:
-        case ir::Type::L:
-            _buffer.append("mv", to, "a0");
-            break;
-        case ir::Type::S:
-            _buffer.append("fmv.s", to, "fa0");
-            break;
-        default:
-            throw std::logic_error("unsupported type");
-        }
-        write_back(_out);
-    }
-
-    // restore caller saved registers
-    for (auto [reg, end] : _reg_reach) {
-        auto offset = _stack_manager.get_caller_saved_regs_offset().at(reg);
-        auto load = reg >= 32 ? "fld" : "ld";
-        if (is_in_imm12_range(offset)) {
-            _buffer.append(load, regno2string(reg),
-                           std::to_string(offset) + "(sp)");
-        } else {
-            _buffer.append("li", "a5", std::to_string(offset));
-            _buffer.append("add", "a5", "sp", "a5");
-            _buffer.append(load, regno2string(reg), "0(a5)");
-        }
-    }
 }
 
 void Generator::_generate_arguments(const std::vector<ir::ValuePtr> &args,
@@ -672,15 +1314,15 @@ void Generator::_generate_arguments(const std::vector<ir::ValuePtr> &args,
             if ((arg->get_type() == ir::Type::W) && pass == 2) {
                 auto [arg0, is_const] = _get_asm_arg_or_w_constbits(arg, 0);
                 std::string inst = is_const ? "li" : "mv";
-                _buffer.append(inst, "a" + std::to_string(arg_count), arg0);
+                _mfunc.append(inst, {reg_of(A0 + arg_count), arg0});
             } else if ((arg->get_type() == ir::Type::L) && pass == 0) {
                 auto arg0 = _get_asm_arg(arg, 0);
-                _buffer.append("mv", "a" + std::to_string(arg_count), arg0);
+                _mfunc.append("mv", {reg_of(A0 + arg_count), arg0});
             } else if ((arg->get_type() == ir::Type::S) &&
                        (((pass == 0) && (arg_count != 4)) ||
                         ((pass == 1) && (arg_count == 4)))) {
                 auto arg0 = _get_asm_arg(arg, 0);
-                _buffer.append("fmv.s", "fa" + std::to_string(arg_count), arg0);
+                _mfunc.append("fmv.s", {reg_of(FA0 + arg_count), arg0});
             }
         } else if (pass == 0) {
             static std::unordered_map<ir::Type, std::string> inst2asm = {
@@ -688,19 +1330,20 @@ void Generator::_generate_arguments(const std::vector<ir::ValuePtr> &args,
             int offset = (arg_count - 8) * 8;
             auto arg0 = _get_asm_arg(arg, 0);
             if (is_in_imm12_range(offset)) {
-                _buffer.append(inst2asm.at(arg->get_type()), arg0,
-                               std::to_string(offset) + "(sp)");
+                _mfunc.append(inst2asm.at(arg->get_type()),
+                              {arg0, mem_of(SP, offset)});
             } else {
-                _buffer.append("li", "a5", std::to_string(offset));
-                _buffer.append("add", "a5", "sp", "a5");
-                _buffer.append(inst2asm.at(arg->get_type()), arg0, "0(a5)");
+                _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+                _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+                _mfunc.append(inst2asm.at(arg->get_type()),
+                              {arg0, mem_of(A5, 0)});
             }
         }
     }
 }
 
 void Generator::_generate_par_inst(const ir::Inst &inst, int par_count) {
-    std::function<int(ir::Type, int)> get_temp_reg = _get_temp_reg;
+    std::function<int(ir::Type, int)> get_temp_reg = nullptr;
     if (par_count < 4) {
         get_temp_reg = [](ir::Type type, int no) {
             std::array<int, 2> reg = {10, 11};            // a0, a1
@@ -717,10 +1360,10 @@ void Generator::_generate_par_inst(const ir::Inst &inst, int par_count) {
         switch (inst.to->get_type()) {
         case ir::Type::L:
         case ir::Type::W:
-            _buffer.append("mv", to, "a" + std::to_string(par_count));
+            _mfunc.append("mv", {to, reg_of(A0 + par_count)});
             break;
         case ir::Type::S:
-            _buffer.append("fmv.s", to, "fa" + std::to_string(par_count));
+            _mfunc.append("fmv.s", {to, reg_of(FA0 + par_count)});
             break;
         default:
             break; // unreachable
@@ -728,68 +1371,281 @@ void Generator::_generate_par_inst(const ir::Inst &inst, int par_count) {
     } else {
         static std::unordered_map<ir::Type, std::string> inst2asm = {
             {ir::Type::W, "lw"}, {ir::Type::L, "ld"}, {ir::Type::S, "flw"}};
-        int offset = (par_count - 8) * 8 + _stack_manager.get_frame_size();
+        // sp is only adjusted inside the frame
+        int offset = (par_count - 8) * 8 +
+                     (_in_frame ? _stack_manager.get_frame_size() : 0);
         if (is_in_imm12_range(offset)) {
-            _buffer.append(inst2asm.at(inst.to->get_type()), to,
-                           std::to_string(offset) + "(sp)");
+            _mfunc.append(inst2asm.at(inst.to->get_type()),
+                          {to, mem_of(SP, offset)});
         } else {
-            _buffer.append("li", "a5", std::to_string(offset));
-            _buffer.append("add", "a5", "sp", "a5");
-            _buffer.append(inst2asm.at(inst.to->get_type()), to, "0(a5)");
+            _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+            _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+            _mfunc.append(inst2asm.at(inst.to->get_type()),
+                          {to, mem_of(A5, 0)});
         }
     }
     write_back(_out);
 }
 
-void Generator::_generate_jump_inst(const ir::Jump &jump) {
-    switch (jump.type) {
-    case ir::Jump::NONE:
+void Generator::_generate_prologue() {
+    int frame_size = _stack_manager.get_frame_size();
+    if (is_in_imm12_range(frame_size)) {
+        _mfunc.append("addi", {reg_of(SP), reg_of(SP), imm_of(-frame_size)})
+            .set_entry();
+    } else { // since a5-a6 may still store value here, we use t0 as
+             // intermediate reg
+        _mfunc.append("li", {reg_of(T0), imm_of(frame_size)}).set_entry();
+        _mfunc.append("sub", {reg_of(SP), reg_of(SP), reg_of(T0)}).set_entry();
+    }
+
+    for (auto [reg, offset] : _stack_manager.get_callee_saved_regs_offset()) {
+        std::string store = (reg >= 32 ? "fsd" : "sd");
+        if (is_in_imm12_range(offset)) {
+            auto &inst = _mfunc.append(store,
+                                       {reg_of(reg), mem_of(SP, offset)});
+            if (reg == 1) { // ra
+                inst.set_entry();
+            }
+        } else {
+            _mfunc.append("li", {reg_of(T0), imm_of(offset)});
+            _mfunc.append("add", {reg_of(T0), reg_of(SP), reg_of(T0)});
+            _mfunc.append(store, {reg_of(reg), mem_of(T0, 0)});
+        }
+    }
+}
+
+void Generator::_generate_epilogue(int scratch) {
+    // the frame is not set up yet in blocks before the prologue
+    if (!_in_frame) {
         return;
-    case ir::Jump::RET: {
-        if (jump.arg) {
-            auto arg = _get_asm_arg(jump.arg, 0);
-            if (jump.arg->get_type() == ir::Type::S) {
-                _buffer.append("fmv.s", "fa0", arg);
-            } else {
-                _buffer.append("mv", "a0", arg);
+    }
+
+    // recover saved registers
+    for (auto [reg, offset] :
+         _stack_manager.get_callee_saved_regs_offset()) {
+        std::string load = (reg >= 32 ? "fld" : "ld");
+        if (is_in_imm12_range(offset)) {
+            auto &inst = _mfunc.append(load, {reg_of(reg), mem_of(SP, offset)});
+            if (reg == 1) {
+                inst.set_exit();
             }
+        } else {
+            _mfunc.append("li", {reg_of(scratch), imm_of(offset)});
+            _mfunc.append("add",
+                          {reg_of(scratch), reg_of(SP), reg_of(scratch)});
+            _mfunc.append(load, {reg_of(reg), mem_of(scratch, 0)});
         }
+    }
 
-        // recover saved registers
-        for (auto [reg, offset] :
-             _stack_manager.get_callee_saved_regs_offset()) {
-            std::string load = (reg >= 32 ? "fld" : "ld");
-            if (is_in_imm12_range(offset)) {
-                auto &inst = _buffer.append(load, regno2string(reg),
-                                            std::to_string(offset) + "(sp)");
-                if (reg == 1) {
-                    inst.set_exit();
-                }
-            } else {
-                _buffer.append("li", "a5", std::to_string(offset));
-                _buffer.append("add", "a5", "sp", "a5");
-                _buffer.append(load, regno2string(reg), "0(a5)");
+    auto frame_size = _stack_manager.get_frame_size();
+    if (is_in_imm12_range(frame_size)) {
+        _mfunc.append("addi", {reg_of(SP), reg_of(SP), imm_of(frame_size)})
+            .set_exit();
+    } else {
+        _mfunc.append("li", {reg_of(scratch), imm_of(frame_size)}).set_exit();
+        _mfunc.append("add", {reg_of(SP), reg_of(SP), reg_of(scratch)})
+            .set_exit();
+    }
+}
+
+// a tile covering `jnz %c` and the compare defining `%c`, where the compare
+// is emitted only if `cmp` is set, and the branch is taken if `%c` holds
+struct BranchTile {
+    ir::InstType insttype;
+    const char *cmp;
+    const char *branch;
+    bool swap;        // whether the operands are swapped
+    int cost;         // instructions of the tile
+    int lowered_cost; // instructions of the compare and `bnez` lowered apart
+};
+
+static constexpr BranchTile BRANCH_TILES[] = {
+    {ir::InstType::ICEQW, nullptr, "beq", false, 1, 3},
+    {ir::InstType::ICNEW, nullptr, "bne", false, 1, 3},
+    {ir::InstType::ICSLTW, nullptr, "blt", false, 1, 2},
+    {ir::InstType::ICSGTW, nullptr, "blt", true, 1, 2},
+    {ir::InstType::ICSLEW, nullptr, "bge", true, 1, 3},
+    {ir::InstType::ICSGEW, nullptr, "bge", false, 1, 3},
+    {ir::InstType::ICEQS, "feq.s", "bnez", false, 2, 2},
+    {ir::InstType::ICNES, "feq.s", "beqz", false, 2, 3},
+    {ir::InstType::ICLTS, "flt.s", "bnez", false, 2, 2},
+    {ir::InstType::ICGTS, "flt.s", "bnez", true, 2, 2},
+    {ir::InstType::ICLES, "fle.s", "bnez", false, 2, 2},
+    {ir::InstType::ICGES, "fle.s", "bnez", true, 2, 2},
+};
+
+static constexpr const BranchTile *find_branch_tile(ir::InstType insttype) {
+    for (const auto &tile : BRANCH_TILES) {
+        if (tile.insttype == insttype) {
+            return &tile;
+        }
+    }
+    return nullptr;
+}
+
+ir::InstPtr Generator::_select_branch(const ir::Block &block) {
+    if (!_opt || block.jump.type != ir::Jump::JNZ || block.insts.empty()) {
+        return nullptr;
+    }
+
+    // the operands of the compare must still be in their registers, so it
+    // can only be covered right before the branch
+    auto cond = block.insts.back();
+    if (cond->to == nullptr || cond->to != block.jump.arg ||
+        cond->to->uses.size() != 1) {
+        return nullptr;
+    }
+
+    auto tile = find_branch_tile(cond->insttype);
+    if (tile == nullptr || tile->cost >= tile->lowered_cost) {
+        return nullptr;
+    }
+    return cond;
+}
+
+void Generator::_select_deferred_defs(const ir::Block &block) {
+    _deferred_defs.clear();
+    if (!_opt) {
+        return;
+    }
+
+    // an arithmetic or a constant whose only use is a copy right after it,
+    // the return value or a register argument of the call right after it is
+    // computed into the register of the use, where the operands are still
+    // live
+    int args = 0;
+    for (size_t i = 0; i < block.insts.size(); i++) {
+        auto def = block.insts[i];
+        if (def->insttype == ir::InstType::IARG) {
+            args++;
+        } else if (def->insttype == ir::InstType::ICALL) {
+            args = 0;
+        }
+
+        switch (def->insttype) {
+        case ir::InstType::IADD:
+        case ir::InstType::ISUB:
+        case ir::InstType::IMUL:
+        case ir::InstType::IDIV:
+        case ir::InstType::IREM:
+            break;
+        case ir::InstType::ICOPY:
+            if (std::dynamic_pointer_cast<ir::ConstBits>(def->arg[0]) ||
+                std::dynamic_pointer_cast<ir::Address>(def->arg[0])) {
+                break;
             }
+            continue;
+        default:
+            continue;
+        }
+        if (def->to->uses.size() != 1 || def->to->defs.size() != 1 ||
+            def->to->reg == STACK || def->to->reg == REMAT) {
+            continue;
         }
 
-        auto frame_size = _stack_manager.get_frame_size();
-        if (is_in_imm12_range(frame_size)) {
-            _buffer.append("addi", "sp", "sp", std::to_string(frame_size))
-                .set_exit();
-        } else {
-            _buffer.append("li", "a5", std::to_string(frame_size)).set_exit();
-            _buffer.append("add", "sp", "sp", "a5").set_exit();
+        if (i + 1 == block.insts.size()) {
+            if (block.jump.type == ir::Jump::RET && block.jump.arg == def->to) {
+                _deferred_defs[def->to] = def;
+            }
+            continue;
+        }
+
+        auto use = block.insts[i + 1];
+        if (use->insttype == ir::InstType::ICOPY && use->arg[0] == def->to &&
+            use->to->get_type() == def->to->get_type() &&
+            (use->to->reg >= 0 || use->to->reg == SPILL)) {
+            _deferred_defs[def->to] = def;
+            continue;
         }
 
-        _buffer.append("jr", "ra");
+        // the later arguments are set before, while the strength-reduced
+        // sequences of int mul, div and rem clobber a5 and a6
+        if (!_in_frame) {
+            continue;
+        }
+        int position = -1, arg_count = args;
+        auto j = i + 1;
+        for (; j < block.insts.size() &&
+               block.insts[j]->insttype == ir::InstType::IARG;
+             j++, arg_count++) {
+            if (block.insts[j]->arg[0] == def->to) {
+                position = arg_count;
+            }
+        }
+        if (j == block.insts.size() ||
+            block.insts[j]->insttype != ir::InstType::ICALL || position < 0 ||
+            position > 7) {
+            continue;
+        }
+        bool clobbers_scratch = def->to->get_type() != ir::Type::S &&
+                                (def->insttype == ir::InstType::IMUL ||
+                                 def->insttype == ir::InstType::IDIV ||
+                                 def->insttype == ir::InstType::IREM);
+        if (!clobbers_scratch || arg_count <= 5) {
+            _deferred_defs[def->to] = def;
+        }
+    }
+}
+
+void Generator::_generate_branch(const ir::Inst &cond, const ir::Jump &jump) {
+    auto tile = find_branch_tile(cond.insttype);
+    auto get_arg = [this](ir::ValuePtr arg, int no) {
+        auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(arg);
+        if (constbits && constbits->value == std::variant<int, float>(0)) {
+            return reg_of(ZERO);
+        }
+        return _get_asm_arg(arg, no);
+    };
+    auto arg0 = get_arg(cond.arg[0], 0);
+    auto arg1 = get_arg(cond.arg[1], 1);
+    if (tile->swap) {
+        std::swap(arg0, arg1);
+    }
+
+    // the branch against zero, where `bgtz` and `blez` swap the operands
+    static const std::unordered_map<std::string, std::string> swapped_zops = {
+        {"blt", "bgtz"}, {"bge", "blez"}, {"beq", "beqz"}, {"bne", "bnez"}};
+
+    auto label = label_of(jump.blk[0]);
+    if (tile->cmp) {
+        auto to = reg_of(_get_temp_reg(ir::Type::W, 0));
+        _mfunc.append(tile->cmp, {to, arg0, arg1});
+        _mfunc.append(tile->branch, {to, label});
+    } else if (arg1 == reg_of(ZERO)) {
+        _mfunc.append(std::string(tile->branch) + "z", {arg0, label});
+    } else if (arg0 == reg_of(ZERO)) {
+        _mfunc.append(swapped_zops.at(tile->branch), {arg1, label});
+    } else {
+        _mfunc.append(tile->branch, {arg0, arg1, label});
+    }
+    _mfunc.append("j", {label_of(jump.blk[1])});
+}
+
+void Generator::_generate_jump_inst(const ir::Jump &jump, ir::InstPtr cond) {
+    switch (jump.type) {
+    case ir::Jump::NONE:
+        return;
+    case ir::Jump::RET: {
+        if (jump.arg) {
+            _generate_move(
+                reg_of(jump.arg->get_type() == ir::Type::S ? FA0 : A0),
+                jump.arg);
+        }
+
+        _generate_epilogue(A5);
+        _mfunc.append("jr", {reg_of(RA)});
     } break;
     case ir::Jump::JMP:
-        _buffer.append("j", ".L" + std::to_string(jump.blk[0]->id));
+        _mfunc.append("j", {label_of(jump.blk[0])});
         break;
     case ir::Jump::JNZ: {
+        if (cond) {
+            _generate_branch(*cond, jump);
+            break;
+        }
         auto arg = _get_asm_arg(jump.arg, 0);
-        _buffer.append("bnez", arg, ".L" + std::to_string(jump.blk[0]->id));
-        _buffer.append("j", ".L" + std::to_string(jump.blk[1]->id));
+        _mfunc.append("bnez", {arg, label_of(jump.blk[0])});
+        _mfunc.append("j", {label_of(jump.blk[1])});
     } break;
     default:
         throw std::logic_error("unsupported jump type");
@@ -810,12 +1666,17 @@ static bool is_int_compare(ir::InstType insttype) {
     }
 }
 
-std::string
+MachineOperand
 Generator::_get_asm_arg(ir::ValuePtr arg, int no,
                         std::function<int(ir::Type, int)> get_temp_reg) {
+    if (!get_temp_reg) {
+        get_temp_reg = [this](ir::Type type, int no) {
+            return _get_temp_reg(type, no);
+        };
+    }
     if (auto temp = std::dynamic_pointer_cast<ir::Temp>(arg)) {
         if (temp->reg >= 0) {
-            return regno2string(temp->reg);
+            return reg_of(temp->reg);
         }
         if (temp->reg == SPILL) {
             std::string load;
@@ -834,17 +1695,16 @@ Generator::_get_asm_arg(ir::ValuePtr arg, int no,
             };
             int offset = _stack_manager.get_spilled_temps_offset().at(temp);
             int reg = get_temp_reg(temp->get_type(), no);
-            std::string reg_str = regno2string(reg);
 
             if (is_in_imm12_range(offset)) {
-                _buffer.append(load, reg_str, std::to_string(offset) + "(sp)");
+                _mfunc.append(load, {reg_of(reg), mem_of(SP, offset)});
             } else {
-                _buffer.append("li", "a5", std::to_string(offset));
-                _buffer.append("add", "a5", "sp", "a5");
-                _buffer.append(load, reg_str, "0(a5)");
+                _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+                _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+                _mfunc.append(load, {reg_of(reg), mem_of(A5, 0)});
             }
 
-            return reg_str;
+            return reg_of(reg);
         } else if (temp->reg == STACK) {
             int offset;
             if (auto def_inst = std::get<ir::InstDef>(temp->defs[0]).ins;
@@ -860,88 +1720,96 @@ Generator::_get_asm_arg(ir::ValuePtr arg, int no,
                 offset = _stack_manager.get_local_var_offset().at(temp);
             }
             int reg = get_temp_reg(temp->get_type(), no);
-            std::string reg_str = regno2string(reg);
 
             if (is_in_imm12_range(offset)) {
-                _buffer.append("addi", reg_str, "sp", std::to_string(offset));
+                _mfunc.append("addi",
+                              {reg_of(reg), reg_of(SP), imm_of(offset)});
             } else {
-                _buffer.append("li", reg_str, std::to_string(offset));
-                _buffer.append("add", reg_str, "sp", reg_str);
+                _mfunc.append("li", {reg_of(reg), imm_of(offset)});
+                _mfunc.append("add", {reg_of(reg), reg_of(SP), reg_of(reg)});
+            }
+
+            return reg_of(reg);
+        } else if (temp->reg == REMAT) {
+            auto def_inst = std::get<ir::InstDef>(temp->defs[0]).ins;
+            if (def_inst->insttype == ir::InstType::ICOPY) {
+                return _get_asm_arg(def_inst->arg[0], no, get_temp_reg);
             }
 
-            return reg_str;
+            // address plus offset
+            auto addr = std::dynamic_pointer_cast<ir::Address>(def_inst->arg[0]);
+            auto offset = def_inst->arg[1];
+            if (addr == nullptr) {
+                addr = std::static_pointer_cast<ir::Address>(def_inst->arg[1]);
+                offset = def_inst->arg[0];
+            }
+            int reg = get_temp_reg(temp->get_type(), no);
+            auto value = std::get<int>(
+                std::static_pointer_cast<ir::ConstBits>(offset)->value);
+            _mfunc.append("la", {reg_of(reg),
+                                 sym_of(addr->get_asm_value() +
+                                        (value < 0 ? "" : "+") +
+                                        std::to_string(value))});
+
+            return reg_of(reg);
         } else {
             throw std::logic_error("no register");
         }
     } else if (auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(arg)) {
         int reg = get_temp_reg(constbits->get_type(), no);
-        std::string reg_str = regno2string(reg);
 
         if (constbits->get_type() == ir::Type::S) {
-            if (constbits->get_asm_value() == "0x0") {
-                _buffer.append("fmv.w.x", reg_str, "zero");
-            } else {
-                std::string local_data_name =
-                    ".LC" + std::to_string(_local_data.size());
-
-                auto local_data = std::shared_ptr<ir::Data>(
-                    new ir::Data{false, local_data_name, 4});
-                local_data->append_const(ir::Type::S, {constbits});
-                _local_data.push_back(local_data);
-
-                _buffer.append("lui", "a5", "%hi(" + local_data_name + ")");
-                _buffer.append("flw", reg_str,
-                               "%lo(" + local_data_name + ")(a5)");
-            }
+            _generate_float_const(reg_of(reg), constbits);
         } else {
-            _buffer.append("li", reg_str, constbits->get_asm_value());
+            _mfunc.append("li", {reg_of(reg),
+                                 imm_of(std::get<int>(constbits->value))});
         }
 
-        return reg_str;
+        return reg_of(reg);
     } else if (auto addr = std::dynamic_pointer_cast<ir::Address>(arg)) {
         int reg = get_temp_reg(addr->get_type(), no);
-        std::string reg_str = regno2string(reg);
 
-        _buffer.append("la", reg_str, addr->get_asm_value());
+        _mfunc.append("la", {reg_of(reg), sym_of(addr->get_asm_value())});
 
-        return reg_str;
+        return reg_of(reg);
     } else {
         throw std::logic_error("unsupported type");
     }
 }
 
-std::tuple<std::string, bool>
+std::tuple<MachineOperand, bool>
 Generator::_get_asm_arg_or_w_constbits(ir::ValuePtr arg, int no) {
     if (auto constbits = std::dynamic_pointer_cast<ir::ConstBits>(arg)) {
         if (constbits->get_type() == ir::Type::W) {
-            return std::make_tuple(constbits->get_asm_value(), true);
+            return std::make_tuple(imm_of(std::get<int>(constbits->value)),
+                                   true);
         }
     }
     return std::make_tuple(_get_asm_arg(arg, no), false);
 }
 
-std::string Generator::_get_asm_addr(ir::ValuePtr arg, int no) {
+MachineOperand Generator::_get_asm_addr(ir::ValuePtr arg, int no,
+                                      int offset) {
     if (auto temp = std::dynamic_pointer_cast<ir::Temp>(arg)) {
         if (temp->reg >= 0) {
-            return "0(" + regno2string(temp->reg) + ")";
+            return mem_of(temp->reg, offset);
         }
 
         if (temp->reg == SPILL) {
             int reg = _get_temp_reg(temp->get_type(), no);
-            int offset = _stack_manager.get_spilled_temps_offset().at(temp);
-            std::string reg_str = regno2string(reg);
+            int spill_offset =
+                _stack_manager.get_spilled_temps_offset().at(temp);
 
-            if (is_in_imm12_range(offset)) {
-                _buffer.append("ld", reg_str, std::to_string(offset) + "(sp)");
+            if (is_in_imm12_range(spill_offset)) {
+                _mfunc.append("ld", {reg_of(reg), mem_of(SP, spill_offset)});
             } else {
-                _buffer.append("li", "a5", std::to_string(offset));
-                _buffer.append("add", "a5", "sp", "a5");
-                _buffer.append("ld", reg_str, "0(a5)");
+                _mfunc.append("li", {reg_of(A5), imm_of(spill_offset)});
+                _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+                _mfunc.append("ld", {reg_of(reg), mem_of(A5, 0)});
             }
 
-            return "0(" + reg_str + ")";
+            return mem_of(reg, offset);
         } else if (temp->reg == STACK) {
-            int offset;
             if (auto def_inst = std::get<ir::InstDef>(temp->defs[0]).ins;
                 def_inst->insttype == ir::InstType::IADD) {
                 auto alloc_temp =
@@ -949,37 +1817,46 @@ std::string Generator::_get_asm_addr(ir::ValuePtr arg, int no) {
                 auto add_const = std::get<int>(
                     std::static_pointer_cast<ir::ConstBits>(def_inst->arg[1])
                         ->value);
-                offset = _stack_manager.get_local_var_offset().at(alloc_temp) +
-                         add_const;
+                offset += _stack_manager.get_local_var_offset().at(alloc_temp) +
+                          add_const;
             } else {
-                offset = _stack_manager.get_local_var_offset().at(temp);
+                offset += _stack_manager.get_local_var_offset().at(temp);
             }
             if (is_in_imm12_range(offset)) {
-                return std::to_string(offset) + "(sp)";
+                return mem_of(SP, offset);
             } else {
                 int reg = _get_temp_reg(temp->get_type(), no);
-                std::string reg_str = regno2string(reg);
-                _buffer.append("li", reg_str, std::to_string(offset));
-                _buffer.append("add", reg_str, "sp", reg_str);
-                return "0(" + reg_str + ")";
+                    _mfunc.append("li", {reg_of(reg), imm_of(offset)});
+                _mfunc.append("add", {reg_of(reg), reg_of(SP), reg_of(reg)});
+                return mem_of(reg, 0);
             }
+        } else if (temp->reg == REMAT) {
+            return mem_of(_get_asm_arg(temp, no).reg, offset);
         } else {
             throw std::logic_error("no register");
         }
     } else if (auto addr = std::dynamic_pointer_cast<ir::Address>(arg)) {
         auto name = addr->get_asm_value();
-        _buffer.append("lui", "a5", "%hi(" + name + ")");
-        return "%lo(" + name + ")(a5)";
+        if (offset != 0) {
+            name += (offset < 0 ? "" : "+") + std::to_string(offset);
+        }
+        _mfunc.append("lui", {reg_of(A5), sym_of("%hi(" + name + ")")});
+        return MachineOperand::mem_of(A5, "%lo(" + name + ")");
     } else {
         throw std::logic_error("unsupported type");
     }
 }
 
-std::tuple<std::string, std::function<void(std::ostream &)>>
+std::tuple<MachineOperand, std::function<void(std::ostream &)>>
 Generator::_get_asm_to(ir::TempPtr to,
                        std::function<int(ir::Type, int)> get_temp_reg) {
+    if (!get_temp_reg) {
+        get_temp_reg = [this](ir::Type type, int no) {
+            return _get_temp_reg(type, no);
+        };
+    }
     if (to->reg >= 0) {
-        return std::make_tuple(regno2string(to->reg),
+        return std::make_tuple(reg_of(to->reg),
                                [](std::ostream &out) { /* nop */ });
     }
     if (to->reg != SPILL) {
@@ -1002,27 +1879,27 @@ Generator::_get_asm_to(ir::TempPtr to,
     }
     int offset = _stack_manager.get_spilled_temps_offset().at(to);
     int reg = get_temp_reg(to->get_type(), 0);
-    std::string reg_str = regno2string(reg);
 
     return std::make_tuple(
-        reg_str, [store, reg_str, offset, this](std::ostream &out) {
+        reg_of(reg), [store, reg, offset, this](std::ostream &) {
             if (is_in_imm12_range(offset)) {
-                _buffer.append(store, reg_str, std::to_string(offset) + "(sp)");
+                _mfunc.append(store, {reg_of(reg), mem_of(SP, offset)});
             } else {
-                _buffer.append("li", "a5", std::to_string(offset));
-                _buffer.append("add", "a5", "sp", "a5");
-                _buffer.append(store, reg_str, "0(a5)");
+                _mfunc.append("li", {reg_of(A5), imm_of(offset)});
+                _mfunc.append("add", {reg_of(A5), reg_of(SP), reg_of(A5)});
+                _mfunc.append(store, {reg_of(reg), mem_of(A5, 0)});
             }
         });
 }
 
 int Generator::_get_temp_reg(ir::Type type, int no) {
+    // a virtual register, preferring a4 and a5 (fa4 and fa5) for operands
     std::array<int, 2> reg = {14, 15};            // a4, a5
     std::array<int, 2> freg = {32 + 14, 32 + 15}; // fa4, fa5
     if (type == ir::Type::S) {
-        return freg[no];
+        return _mfunc.new_vreg(true, freg[no]);
     } else {
-        return reg[no];
+        return _mfunc.new_vreg(false, reg[no]);
     }
 }
 
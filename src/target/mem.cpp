@@ -1,5 +1,9 @@
 #include "target/mem.h"
+#include "opt/pass/loop.h"
 #include "target/regalloc.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
 #include <set>
 
 namespace target {
@@ -8,6 +12,9 @@ namespace target {
 
 void StackManager::run(const ir::Function &func) {
     _collect_function_info(func);
+    _fill_cfg(func);
+    _fill_block_weights(func);
+    _fill_local_var_lives(func);
 
     _frame_size = 0;
 
@@ -22,17 +29,21 @@ void StackManager::run(const ir::Function &func) {
     }
 
     // size of local variables
-    for (auto [temp, var] : _local_vars) {
-        _frame_size += var.bytes;
-        _frame_size = ROUND(_frame_size, var.align);
-        _local_var_offset[temp] = -_frame_size;
+    for (auto &slot : _color_local_vars()) {
+        _frame_size += slot.bytes;
+        _frame_size = ROUND(_frame_size, slot.align);
+        for (auto temp : slot.temps) {
+            _local_var_offset[temp] = -_frame_size;
+        }
     }
 
     // size of spilled registers
     _frame_size = ROUND(_frame_size, 8);
-    for (auto temp : _spilled_temps) {
+    for (auto &slot : _color_spilled_temps()) {
         _frame_size += 8;
-        _spilled_temps_offset[temp] = -_frame_size;
+        for (auto temp : slot.temps) {
+            _spilled_temps_offset[temp] = -_frame_size;
+        }
     }
 
     // size of caller saved registers
@@ -153,4 +164,387 @@ void StackManager::_collect_block_info(const ir::Block &block) {
     }
 }
 
+void StackManager::_fill_cfg(const ir::Function &func) {
+    for (auto block = func.start; block; block = block->next) {
+        _frame_blocks.insert(block);
+        if (block->jump.type == ir::Jump::NONE && block->next) {
+            _succs[block] = {block->next};
+        } else if (block->jump.type != ir::Jump::RET) {
+            for (auto succ : block->jump.blk) {
+                if (succ) {
+                    _succs[block].push_back(succ);
+                }
+            }
+        }
+        for (auto succ : _succs[block]) {
+            _preds[succ].push_back(block);
+        }
+    }
+}
+
+void StackManager::_fill_block_weights(const ir::Function &func) {
+    if (func.start->freq >= 0) {
+        for (auto block = func.start; block; block = block->next) {
+            _block_weights[block] = std::max(block->freq, 0LL);
+        }
+        return;
+    }
+
+    // estimated by loop depth, as in the passes
+    auto loop_depth = opt::get_loop_depth(func, opt::find_natural_loops(func));
+    for (auto block = func.start; block; block = block->next) {
+        _block_weights[block] = opt::get_loop_weight(loop_depth[block]);
+    }
+}
+
+void StackManager::_fill_local_var_lives(const ir::Function &func) {
+    // addresses computed from each local variable
+    std::unordered_map<ir::ValuePtr, std::unordered_set<ir::TempPtr>> roots;
+    for (auto &[temp, var] : _local_vars) {
+        roots[temp].insert(temp);
+    }
+    bool changed;
+    do {
+        changed = false;
+        for (auto block = func.start; block; block = block->next) {
+            for (auto inst : block->insts) {
+                if (inst->insttype != ir::InstType::IADD &&
+                    inst->insttype != ir::InstType::ISUB &&
+                    inst->insttype != ir::InstType::ICOPY) {
+                    continue;
+                }
+                for (auto arg : inst->arg) {
+                    auto it = roots.find(arg);
+                    if (it == roots.end()) {
+                        continue;
+                    }
+                    auto from = it->second;
+                    auto &to = roots[inst->to];
+                    for (auto root : from) {
+                        changed |= to.insert(root).second;
+                    }
+                }
+            }
+        }
+    } while (changed);
+
+    // blocks accessing each local variable
+    std::unordered_map<ir::TempPtr, std::vector<ir::BlockPtr>> accesses;
+    for (auto block = func.start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            std::unordered_set<ir::TempPtr> accessed;
+            for (auto arg : inst->arg) {
+                if (auto it = roots.find(arg); it != roots.end()) {
+                    accessed.insert(it->second.begin(), it->second.end());
+                }
+            }
+            for (auto temp : accessed) {
+                accesses[temp].push_back(block);
+                _local_vars[temp].weight += _block_weights[block];
+            }
+        }
+    }
+
+    // a local variable is live between its accesses, i.e. in blocks reachable
+    // from an access and reaching an access
+    auto reach = [](const std::vector<ir::BlockPtr> &from,
+                    std::unordered_map<ir::BlockPtr, std::vector<ir::BlockPtr>>
+                        &edges) {
+        std::unordered_set<ir::BlockPtr> visited;
+        std::queue<ir::BlockPtr> queue;
+        for (auto block : from) {
+            queue.push(block);
+        }
+        while (!queue.empty()) {
+            auto block = queue.front();
+            queue.pop();
+            if (visited.insert(block).second) {
+                for (auto next : edges[block]) {
+                    queue.push(next);
+                }
+            }
+        }
+        return visited;
+    };
+    for (auto &[temp, blocks] : accesses) {
+        auto forward = reach(blocks, _succs);
+        auto backward = reach(blocks, _preds);
+        for (auto block : forward) {
+            if (backward.count(block)) {
+                _local_vars[temp].lives.insert(block);
+            }
+        }
+    }
+}
+
+std::vector<StackManager::Slot> StackManager::_color_local_vars() {
+    // pack larger ones first
+    std::vector<ir::TempPtr> temps;
+    for (auto &[temp, var] : _local_vars) {
+        temps.push_back(temp);
+    }
+    std::sort(temps.begin(), temps.end(), [this](auto &a, auto &b) {
+        auto &var_a = _local_vars[a], &var_b = _local_vars[b];
+        if (var_a.bytes != var_b.bytes) {
+            return var_a.bytes > var_b.bytes;
+        }
+        return a->id < b->id;
+    });
+
+    auto is_disjoint = [](const std::unordered_set<ir::BlockPtr> &a,
+                          const std::unordered_set<ir::BlockPtr> &b) {
+        for (auto block : a) {
+            if (b.count(block)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<std::unordered_set<ir::BlockPtr>> slot_lives;
+    for (auto temp : temps) {
+        auto &var = _local_vars[temp];
+        size_t i = 0;
+        while (i < slots.size() && !is_disjoint(var.lives, slot_lives[i])) {
+            i++;
+        }
+        if (i == slots.size()) {
+            slots.push_back({var.align, var.bytes, 0, {}});
+            slot_lives.emplace_back();
+        }
+        auto &slot = slots[i];
+        slot.align = std::max(slot.align, var.align);
+        slot.bytes = std::max(slot.bytes, var.bytes);
+        slot.weight += var.weight;
+        slot.temps.push_back(temp);
+        slot_lives[i].insert(var.lives.begin(), var.lives.end());
+    }
+
+    // slots placed later are closer to sp, so place the densely accessed ones
+    // later, to keep them in the range of 12-bit offsets
+    std::stable_sort(slots.begin(), slots.end(), [](auto &a, auto &b) {
+        return (double)a.weight / a.bytes < (double)b.weight / b.bytes;
+    });
+    return slots;
+}
+
+std::vector<StackManager::Slot> StackManager::_color_spilled_temps() {
+    struct Range {
+        int start;
+        int end;
+    };
+    std::unordered_map<ir::TempPtr, long long> weights;
+    std::unordered_map<ir::TempPtr, Range> ranges;
+    for (auto temp : _spilled_temps) {
+        // each def stores to the slot, even if it is never used
+        Range range = {temp->interval.start, temp->interval.end};
+        long long weight = 0;
+        for (auto &def : temp->defs) {
+            if (auto inst_def = std::get_if<ir::InstDef>(&def)) {
+                range.start = std::min(range.start, inst_def->ins->number);
+                range.end = std::max(range.end, inst_def->ins->number);
+                weight += _block_weights[inst_def->blk];
+            }
+        }
+        for (auto &use : temp->uses) {
+            if (auto inst_use = std::get_if<ir::InstUse>(&use)) {
+                weight += _block_weights[inst_use->blk];
+            } else if (auto jump_use = std::get_if<ir::JmpUse>(&use)) {
+                weight += _block_weights[jump_use->blk];
+            }
+        }
+        ranges[temp] = range;
+        weights[temp] = weight;
+    }
+
+    // color the most accessed ones first
+    std::vector<ir::TempPtr> temps(_spilled_temps.begin(), _spilled_temps.end());
+    std::sort(temps.begin(), temps.end(), [&weights](auto &a, auto &b) {
+        if (weights[a] != weights[b]) {
+            return weights[a] > weights[b];
+        }
+        return a->id < b->id;
+    });
+
+    std::vector<Slot> slots;
+    for (auto temp : temps) {
+        auto range = ranges[temp];
+        auto is_disjoint = [&range, &ranges](const Slot &slot) {
+            for (auto other : slot.temps) {
+                auto other_range = ranges[other];
+                if (range.start < other_range.end &&
+                    other_range.start < range.end) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        auto it = std::find_if(slots.begin(), slots.end(), is_disjoint);
+        if (it == slots.end()) {
+            slots.push_back({8, 8, 0, {}});
+            it = std::prev(slots.end());
+        }
+        it->weight += weights[temp];
+        it->temps.push_back(temp);
+    }
+
+    std::stable_sort(slots.begin(), slots.end(), [](auto &a, auto &b) {
+        return a.weight < b.weight;
+    });
+    return slots;
+}
+
+void StackManager::shrink_wrap(const ir::Function &func) {
+    std::vector<ir::BlockPtr> rpo;
+    std::unordered_map<ir::BlockPtr, int> rpo_index;
+    std::unordered_set<ir::BlockPtr> visited;
+    std::function<void(ir::BlockPtr)> dfs = [&](ir::BlockPtr block) {
+        visited.insert(block);
+        for (auto succ : _succs[block]) {
+            if (!visited.count(succ)) {
+                dfs(succ);
+            }
+        }
+        rpo.push_back(block);
+    };
+    dfs(func.start);
+    std::reverse(rpo.begin(), rpo.end());
+    for (size_t i = 0; i < rpo.size(); i++) {
+        rpo_index[rpo[i]] = i;
+    }
+
+    // see Cooper et al., "A Simple, Fast Dominance Algorithm"
+    std::unordered_map<ir::BlockPtr, ir::BlockPtr> idom;
+    auto intersect = [&](ir::BlockPtr a, ir::BlockPtr b) {
+        while (a != b) {
+            while (rpo_index[a] > rpo_index[b]) {
+                a = idom[a];
+            }
+            while (rpo_index[b] > rpo_index[a]) {
+                b = idom[b];
+            }
+        }
+        return a;
+    };
+    idom[func.start] = func.start;
+    bool changed;
+    do {
+        changed = false;
+        for (auto block : rpo) {
+            if (block == func.start) {
+                continue;
+            }
+            ir::BlockPtr new_idom = nullptr;
+            for (auto pred : _preds[block]) {
+                if (idom.count(pred)) {
+                    new_idom = new_idom ? intersect(pred, new_idom) : pred;
+                }
+            }
+            if (idom[block] != new_idom) {
+                idom[block] = new_idom;
+                changed = true;
+            }
+        }
+    } while (changed);
+
+    // params in callee saved registers stay in their argument registers until
+    // the prologue, since only calls and scratch registers clobber them
+    int par_count = 0;
+    for (auto inst : func.start->insts) {
+        if (inst->insttype != ir::InstType::IPAR) {
+            continue;
+        }
+        int index = par_count++;
+        int arg_reg = (inst->to->get_type() == ir::Type::S ? 32 : 0) + 10 +
+                      index;
+        if (index < 8 && _callee_saved_regs.count(inst->to->reg) &&
+            !ScratchRegisterAllocator::is_scratch(arg_reg)) {
+            _deferred_pars[inst->to] = arg_reg;
+        }
+    }
+
+    // the prologue dominates every block needing the frame
+    ir::BlockPtr prologue = nullptr;
+    for (auto block : rpo) {
+        if (_is_frame_needed(*block)) {
+            prologue = prologue ? intersect(prologue, block) : block;
+        }
+    }
+    if (prologue == nullptr) {
+        _prologue_block = nullptr;
+        _frame_blocks.clear();
+        return;
+    }
+
+    // and the blocks it dominates may only leave the frame by returning, and
+    // are never back to it
+    auto dominates = [&](ir::BlockPtr a, ir::BlockPtr b) {
+        while (b != a && b != func.start) {
+            b = idom[b];
+        }
+        return b == a;
+    };
+    auto is_closed = [&](ir::BlockPtr head) {
+        for (auto block : rpo) {
+            if (!dominates(head, block)) {
+                continue;
+            }
+            for (auto succ : _succs[block]) {
+                if (!dominates(head, succ) || succ == head) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    while (prologue != func.start && !is_closed(prologue)) {
+        prologue = idom[prologue];
+    }
+    if (prologue == func.start) {
+        _deferred_pars.clear();
+        return;
+    }
+
+    _prologue_block = prologue;
+    _frame_blocks.clear();
+    for (auto block : rpo) {
+        if (dominates(prologue, block)) {
+            _frame_blocks.insert(block);
+        }
+    }
+}
+
+bool StackManager::_is_frame_needed(const ir::Block &block) {
+    auto is_in_frame = [this](ir::ValuePtr value) {
+        auto temp = std::dynamic_pointer_cast<ir::Temp>(value);
+        return temp && !_deferred_pars.count(temp) &&
+               (temp->reg == SPILL || temp->reg == STACK ||
+                _callee_saved_regs.count(temp->reg));
+    };
+
+    int par_count = 0;
+    for (auto inst : block.insts) {
+        switch (inst->insttype) {
+        case ir::InstType::ICALL:
+            return true;
+        case ir::InstType::IPAR:
+            if (par_count++ >= 8) { // passed on the stack
+                return true;
+            }
+            break;
+        case ir::InstType::IALLOC4:
+        case ir::InstType::IALLOC8:
+            continue;
+        default:
+            break;
+        }
+        if (is_in_frame(inst->to) || is_in_frame(inst->arg[0]) ||
+            is_in_frame(inst->arg[1])) {
+            return true;
+        }
+    }
+    return is_in_frame(block.jump.arg);
+}
+
 } // namespace target
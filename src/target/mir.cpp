@@ -0,0 +1,167 @@
+#include "target/mir.h"
+#include "target/utils.h"
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace target {
+
+#define INDENT "    "
+
+static bool is_number(const std::string &text) {
+    size_t start = (!text.empty() && text[0] == '-') ? 1 : 0;
+    return text.size() > start && text.size() - start <= 18 &&
+           text.find_first_not_of("0123456789", start) == std::string::npos;
+}
+
+MachineOperand MachineOperand::parse(const std::string &text) {
+    if (auto reg = string2regno(text); reg >= 0) {
+        return reg_of(reg);
+    } else if (is_number(text)) {
+        return imm_of(std::stoll(text));
+    }
+
+    // `disp(base)`, where the displacement is a number or `%lo(...)`; a bare
+    // `(base)` only appears in vector code and is kept as symbol
+    auto open = text.rfind('(');
+    if (open != std::string::npos && open > 0 && text.back() == ')') {
+        auto disp = text.substr(0, open);
+        auto base = string2regno(text.substr(open + 1, text.size() - open - 2));
+        if (base >= 0 && is_number(disp)) {
+            return mem_of(base, std::stoll(disp));
+        } else if (base >= 0 && disp.back() == ')') {
+            return mem_of(base, disp);
+        }
+    }
+    return sym_of(text);
+}
+
+std::string MachineOperand::to_string() const {
+    switch (kind) {
+    case REG:
+        return regno2string(reg);
+    case IMM:
+        return std::to_string(imm);
+    case MEM:
+        return (sym.empty() ? std::to_string(imm) : sym) + "(" +
+               regno2string(reg) + ")";
+    default:
+        return sym;
+    }
+}
+
+std::string MachineInst::to_string() const {
+    if (type == LABEL) {
+        return opcode + ":";
+    }
+
+    std::string str = opcode;
+    for (size_t i = 0; i < operands.size(); i++) {
+        str += (i == 0 ? " " : ", ") + operands[i].to_string();
+    }
+    return str;
+}
+
+// whether the opcode is a vector store, such as `vse32.v`, `vsse32.v`,
+// `vsuxei32.v`, `vsseg2e32.v`, `vs1r.v` and `vsm.v`, which reads its first
+// operand; other opcodes starting with `vs`, such as `vsub.vv` and `vsetvli`,
+// write it
+static bool is_vector_store(const std::string &opcode) {
+    // each prefix is followed by a digit
+    static const char *prefixes[] = {"vse",    "vsse",    "vsuxei",
+                                     "vsoxei", "vsseg",   "vssseg",
+                                     "vsuxseg", "vsoxseg", "vs"};
+    for (auto prefix : prefixes) {
+        auto size = std::char_traits<char>::length(prefix);
+        if (opcode.compare(0, size, prefix) == 0 && opcode.size() > size &&
+            std::isdigit(opcode[size])) {
+            return true;
+        }
+    }
+    return opcode == "vsm.v";
+}
+
+bool MachineInst::_has_def() const {
+    static const std::unordered_set<std::string> no_def_ops = {
+        "sb", "sh",  "sw",  "sd",   "fsw",  "fsd",
+        "j",  "jr", "ret", "call", "tail"};
+
+    if (type == LABEL || operands.empty() || !operands[0].is_reg()) {
+        return false;
+    }
+    if (opcode[0] == 'b') {
+        return false; // branches
+    }
+    return no_def_ops.count(opcode) == 0 && !is_vector_store(opcode);
+}
+
+std::vector<int> MachineInst::uses() const {
+    std::vector<int> regs;
+    bool has_def = _has_def();
+    for (size_t i = 0; i < operands.size(); i++) {
+        if (operands[i].is_mem() ||
+            (operands[i].is_reg() && (i > 0 || !has_def))) {
+            regs.push_back(operands[i].reg);
+        }
+    }
+    regs.insert(regs.end(), implicit_uses.begin(), implicit_uses.end());
+    return regs;
+}
+
+std::vector<int> MachineInst::defs() const {
+    std::vector<int> regs;
+    if (_has_def()) {
+        regs.push_back(operands[0].reg);
+    }
+    regs.insert(regs.end(), implicit_defs.begin(), implicit_defs.end());
+    return regs;
+}
+
+std::vector<MachineBlock> MachineFunction::blocks() {
+    std::vector<MachineBlock> blocks;
+    std::unordered_map<std::string, int> label_blocks;
+    for (auto it = insts.begin(); it != insts.end(); it++) {
+        if (blocks.empty() || it->is_label()) {
+            if (!blocks.empty()) {
+                blocks.back().end = it;
+            }
+            blocks.push_back({it, insts.end(), {}});
+        }
+        if (it->is_label()) {
+            label_blocks[it->opcode] = blocks.size() - 1;
+        }
+    }
+
+    static const std::unordered_set<std::string> no_fallthrough_ops = {
+        "j", "jr", "ret", "tail"};
+    for (size_t i = 0; i < blocks.size(); i++) {
+        auto &block = blocks[i];
+        auto last = block.begin;
+        for (auto it = block.begin; it != block.end; last = it++) {
+            bool is_jump = it->opcode[0] == 'b' || it->opcode == "j";
+            if (it->is_inst() && is_jump && !it->operands.empty()) {
+                // jumps out of the function have no successor
+                auto target = label_blocks.find(it->operands.back().sym);
+                if (target != label_blocks.end()) {
+                    block.succs.push_back(target->second);
+                }
+            }
+        }
+        if (i + 1 < blocks.size() &&
+            !(last->is_inst() && no_fallthrough_ops.count(last->opcode))) {
+            block.succs.push_back(i + 1);
+        }
+    }
+    return blocks;
+}
+
+void MachineFunction::emit(std::ostream &out) const {
+    for (const auto &inst : insts) {
+        if (inst.is_inst()) {
+            out << INDENT;
+        }
+        out << inst.to_string() << std::endl;
+    }
+}
+
+} // namespace target
@@ -1,5 +1,6 @@
 #include "target/regalloc.h"
 #include <algorithm>
+#include <bitset>
 #include <limits>
 #include <set>
 
@@ -111,16 +112,26 @@ void LinearScanAllocator::_allocate_temps_with_intervals(
             }
 
         if (reg_set.empty()) {
-            if (active.size() > 0 && (*std::prev(active.end()))->interval.end >=
-                                         interval.end) { // spill other temp
+            bool spill_active =
+                active.size() > 0 &&
+                (*std::prev(active.end()))->interval.end >= interval.end;
+            // with profile, spill the one accessed less at runtime instead
+            if (active.size() > 0 && func.start->freq >= 0) {
+                auto active_cost = _get_spill_cost(*std::prev(active.end()));
+                auto temp_cost = _get_spill_cost(temp);
+                if (active_cost != temp_cost) {
+                    spill_active = active_cost < temp_cost;
+                }
+            }
+            if (spill_active) { // spill other temp
                 auto back_active = *std::prev(active.end());
                 active.erase(std::prev(active.end()));
 
                 temp->reg = back_active->reg;
-                back_active->reg = SPILL; // in memory
+                back_active->reg = _get_spill_mode(back_active);
                 active.insert(temp);
-            } else {               // spill current temp
-                temp->reg = SPILL; // in memory
+            } else { // spill current temp
+                temp->reg = _get_spill_mode(temp);
             }
         } else {
             // allocate register
@@ -152,6 +163,67 @@ void LinearScanAllocator::_find_intervals(
     }
 }
 
+long long LinearScanAllocator::_get_spill_cost(const ir::TempPtr &temp) {
+    // each def and use is a memory access after spilling
+    auto freq = [](const ir::BlockPtr &block) {
+        return std::max(block->freq, 0LL);
+    };
+    long long cost = 0;
+    for (auto def : temp->defs) {
+        if (auto inst_def = std::get_if<ir::InstDef>(&def); inst_def) {
+            cost += freq(inst_def->blk);
+        } else if (auto phi_def = std::get_if<ir::PhiDef>(&def); phi_def) {
+            cost += freq(phi_def->blk);
+        }
+    }
+    for (auto use : temp->uses) {
+        if (auto inst_use = std::get_if<ir::InstUse>(&use); inst_use) {
+            cost += freq(inst_use->blk);
+        } else if (auto phi_use = std::get_if<ir::PhiUse>(&use); phi_use) {
+            cost += freq(phi_use->blk);
+        } else if (auto jump_use = std::get_if<ir::JmpUse>(&use); jump_use) {
+            cost += freq(jump_use->blk);
+        }
+    }
+    return cost;
+}
+
+int LinearScanAllocator::_get_spill_mode(const ir::TempPtr &temp) {
+    // a constant or global address is recomputed at each use, which saves
+    // the spill slot and the store
+    return _is_rematerializable(temp) ? REMAT : SPILL;
+}
+
+bool LinearScanAllocator::_is_rematerializable(const ir::TempPtr &temp) {
+    if (temp->defs.size() != 1) {
+        return false;
+    }
+    auto inst_def = std::get_if<ir::InstDef>(&temp->defs[0]);
+    if (inst_def == nullptr) {
+        return false;
+    }
+
+    // copy of a constant or an address, or an address plus an offset
+    auto inst = inst_def->ins;
+    auto is_const = [](ir::ValuePtr value) {
+        return std::dynamic_pointer_cast<ir::ConstBits>(value) ||
+               std::dynamic_pointer_cast<ir::Address>(value);
+    };
+    if (inst->insttype == ir::InstType::ICOPY) {
+        return is_const(inst->arg[0]);
+    } else if (inst->insttype == ir::InstType::IADD &&
+               inst->to->get_type() == ir::Type::L) {
+        auto addr = std::dynamic_pointer_cast<ir::Address>(inst->arg[0]);
+        auto offset = std::dynamic_pointer_cast<ir::ConstBits>(inst->arg[1]);
+        if (addr == nullptr) {
+            addr = std::dynamic_pointer_cast<ir::Address>(inst->arg[1]);
+            offset = std::dynamic_pointer_cast<ir::ConstBits>(inst->arg[0]);
+        }
+        return addr && offset && std::get_if<int>(&offset->value);
+    }
+    return false;
+}
+
 bool LinearScanAllocator::_is_local(const ir::TempPtr &temp) {
     std::unordered_set<ir::BlockPtr> blocks;
     for (auto def : temp->defs) {
@@ -177,4 +249,179 @@ bool LinearScanAllocator::_is_local(const ir::TempPtr &temp) {
     return blocks.size() <= 1;
 }
 
+// registers never allocated to temps, in the order of preference
+static const std::vector<int> SCRATCH_REGS = {14, 15, 16, 17};   // a4-a7
+static const std::vector<int> F_SCRATCH_REGS = {46, 47, 48, 49}; // fa4-fa7
+
+bool ScratchRegisterAllocator::is_scratch(int reg) {
+    auto &pool = reg >= 32 ? F_SCRATCH_REGS : SCRATCH_REGS;
+    return std::find(pool.begin(), pool.end(), reg) != pool.end();
+}
+
+void ScratchRegisterAllocator::allocate(MachineFunction &func) {
+    if (func.vregs.empty()) {
+        return;
+    }
+
+    _busy.clear();
+    _fill_scratch_ranges(func);
+    _fill_vreg_ranges(func);
+
+    std::vector<int> order;
+    for (int i = 0; i < (int)func.vregs.size(); i++) {
+        if (_vreg_ranges[i].begin >= 0) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return _vreg_ranges[a].begin < _vreg_ranges[b].begin;
+    });
+
+    std::vector<int> regs(func.vregs.size(), NO_REGISTER);
+    for (auto i : order) {
+        auto &vreg = func.vregs[i];
+        auto range = _vreg_ranges[i];
+
+        std::vector<int> candidates;
+        if (vreg.hint >= 0) {
+            candidates.push_back(vreg.hint);
+        }
+        auto &pool = vreg.is_float ? F_SCRATCH_REGS : SCRATCH_REGS;
+        candidates.insert(candidates.end(), pool.begin(), pool.end());
+
+        auto is_free = [&](int reg) {
+            return std::none_of(
+                _busy[reg].begin(), _busy[reg].end(),
+                [&](const Range &other) { return other.overlaps(range); });
+        };
+        for (auto reg : candidates) {
+            if (is_free(reg)) {
+                _busy[reg].push_back(range);
+                regs[i] = reg;
+                break;
+            }
+        }
+        if (regs[i] == NO_REGISTER) {
+            throw std::runtime_error("no scratch register");
+        }
+    }
+
+    for (auto &inst : func.insts) {
+        for (auto &operand : inst.operands) {
+            if (operand.has_reg() && is_virtual_reg(operand.reg)) {
+                operand.reg = regs[operand.reg - FIRST_VIRTUAL_REG];
+            }
+        }
+    }
+    func.vregs.clear();
+}
+
+void ScratchRegisterAllocator::_fill_scratch_ranges(MachineFunction &func) {
+    using RegSet = std::bitset<FIRST_VIRTUAL_REG>;
+
+    auto blocks = func.blocks();
+    std::vector<RegSet> uses(blocks.size()), defs(blocks.size());
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (auto it = blocks[i].begin; it != blocks[i].end; it++) {
+            for (auto reg : it->uses()) {
+                if (!is_virtual_reg(reg) && !defs[i][reg]) {
+                    uses[i][reg] = true;
+                }
+            }
+            for (auto reg : it->defs()) {
+                if (!is_virtual_reg(reg)) {
+                    defs[i][reg] = true;
+                }
+            }
+        }
+    }
+
+    std::vector<RegSet> live_in(blocks.size()), live_out(blocks.size());
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int i = blocks.size() - 1; i >= 0; i--) {
+            for (auto succ : blocks[i].succs) {
+                live_out[i] |= live_in[succ];
+            }
+            auto in = uses[i] | (live_out[i] & ~defs[i]);
+            if (in != live_in[i]) {
+                live_in[i] = in;
+                changed = true;
+            }
+        }
+    }
+
+    int index = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        // the range each live scratch register is in, as index in `_busy`
+        std::unordered_map<int, int> current;
+        auto open_range = [&](int reg, Range range) {
+            _busy[reg].push_back(range);
+            current[reg] = _busy[reg].size() - 1;
+        };
+        for (int reg = 0; reg < FIRST_VIRTUAL_REG; reg++) {
+            if (is_scratch(reg) && live_in[i][reg]) {
+                open_range(reg, {index, index});
+            }
+        }
+
+        for (auto it = blocks[i].begin; it != blocks[i].end; it++, index++) {
+            for (auto reg : it->uses()) {
+                if (auto found = current.find(reg); found != current.end()) {
+                    auto &range = _busy[reg][found->second];
+                    range.end = std::max(range.end, index);
+                }
+            }
+            for (auto reg : it->defs()) {
+                if (is_scratch(reg)) {
+                    open_range(reg, {index, index + 1});
+                }
+            }
+        }
+
+        for (auto [reg, range] : current) {
+            if (live_out[i][reg]) {
+                _busy[reg][range].end = index;
+            }
+        }
+    }
+}
+
+void ScratchRegisterAllocator::_fill_vreg_ranges(MachineFunction &func) {
+    _vreg_ranges.assign(func.vregs.size(), Range{-1, -1});
+
+    int index = 0;
+    for (auto &block : func.blocks()) {
+        int block_begin = index;
+        for (auto it = block.begin; it != block.end; it++, index++) {
+            for (auto reg : it->uses()) {
+                if (!is_virtual_reg(reg)) {
+                    continue;
+                }
+                auto &range = _vreg_ranges[reg - FIRST_VIRTUAL_REG];
+                if (range.begin < block_begin) {
+                    throw std::logic_error("virtual register used before def");
+                }
+                range.end = std::max(range.end, index);
+            }
+            for (auto reg : it->defs()) {
+                if (!is_virtual_reg(reg)) {
+                    continue;
+                }
+                // a virtual register may be redefined, such as adding to
+                // the offset loaded into it
+                auto &range = _vreg_ranges[reg - FIRST_VIRTUAL_REG];
+                if (range.begin < 0) {
+                    range = {index, index + 1};
+                } else if (range.begin < block_begin) {
+                    throw std::logic_error(
+                        "virtual register live across blocks");
+                } else {
+                    range.end = std::max(range.end, index + 1);
+                }
+            }
+        }
+    }
+}
+
 } // namespace target
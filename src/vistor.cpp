@@ -1,9 +1,21 @@
 #include "ast.h"
 #include "error.h"
+#include "opt/pass/ssa.h"
 #include "utils.h"
 #include "visitor.h"
+#include <functional>
 #include <variant>
 
+// zero runs in local array initializer longer than this are filled by memset
+static const int MEMSET_MIN_ELEMENTS = 16;
+
+// args of a vector kernel are all passed in registers
+static const int MAX_VECTOR_KERNEL_ARGS = 8;
+
+// register groups of LMUL=2 left to a vector kernel, as v0-v1 hold the mask
+// and the accumulator
+static const int MAX_VECTOR_KERNEL_REGS = 15;
+
 sym::TypePtr Visitor::_asttype2symtype(ASTType type) {
     switch (type) {
     case ASTType::INT:
@@ -31,14 +43,18 @@ ir::Type Visitor::_symtype2irtype(const sym::Type &type) {
 
 void Visitor::visit(const CompUnits &node) {
     for (auto &elm : node) {
-        std::visit(overloaded{
-                       [this](const Decl &node) { visit_decl(node); },
-                       [this](const FuncDef &node) { visit_func_def(node); },
-                   },
-                   *elm);
+        visit_comp_unit(*elm);
     }
 }
 
+void Visitor::visit_comp_unit(const CompUnit &node) {
+    std::visit(overloaded{
+                   [this](const Decl &node) { visit_decl(node); },
+                   [this](const FuncDef &node) { visit_func_def(node); },
+               },
+               node);
+}
+
 void Visitor::visit_decl(const Decl &node) {
     for (auto &elm : *node.var_defs) {
         bool is_const = (node.type == Decl::CONST);
@@ -233,6 +249,365 @@ bool Visitor::_has_control_stmt(const Stmt &node) {
         node);
 }
 
+// get the identifier if the expression is a plain variable
+static const Ident *get_ident(const Exp &exp) {
+    auto lval_exp = std::get_if<LValExp>(&exp);
+    return lval_exp ? std::get_if<Ident>(lval_exp->lval.get()) : nullptr;
+}
+
+// match `while (i < n) { <assign>; i = i + 1; }` and return the assignment
+static const AssignStmt *match_counted_loop(const WhileStmt &node,
+                                            const CompareExp *&cmp,
+                                            const Ident *&i) {
+    auto exp = std::get_if<Exp>(node.cond.get());
+    cmp = exp ? std::get_if<CompareExp>(exp) : nullptr;
+    if (cmp == nullptr || cmp->op != CompareExp::LT) {
+        return nullptr;
+    }
+    i = get_ident(*cmp->left);
+    if (i == nullptr) {
+        return nullptr;
+    }
+
+    auto block_stmt = std::get_if<BlockStmt>(node.stmt.get());
+    if (block_stmt == nullptr || block_stmt->block->size() != 2) {
+        return nullptr;
+    }
+    auto first = std::get_if<Stmt>(block_stmt->block->at(0).get());
+    auto second = std::get_if<Stmt>(block_stmt->block->at(1).get());
+    auto assign = first ? std::get_if<AssignStmt>(first) : nullptr;
+    auto step = second ? std::get_if<AssignStmt>(second) : nullptr;
+    if (assign == nullptr || step == nullptr) {
+        return nullptr;
+    }
+
+    // i = i + 1
+    auto step_ident = std::get_if<Ident>(step->lval.get());
+    auto add = std::get_if<BinaryExp>(step->exp.get());
+    if (step_ident == nullptr || *step_ident != *i || add == nullptr ||
+        add->op != BinaryExp::ADD) {
+        return nullptr;
+    }
+    auto add_ident = get_ident(*add->left);
+    auto one = std::get_if<Number>(add->right.get());
+    if (add_ident == nullptr || *add_ident != *i || one == nullptr ||
+        std::get_if<int>(one) == nullptr || std::get<int>(*one) != 1) {
+        return nullptr;
+    }
+
+    return assign;
+}
+
+bool Visitor::_vectorize_loop(const WhileStmt &node) {
+    // while (i < n) { a[i] = <exp>; i = i + 1; }
+    // while (i < n) { s = s + <exp>; i = i + 1; }
+    const CompareExp *cmp;
+    const Ident *i;
+    auto assign = match_counted_loop(node, cmp, i);
+    if (assign == nullptr) {
+        return false;
+    }
+
+    auto get_scalar = [this](const Ident &ident) -> sym::SymbolPtr {
+        auto symbol = std::dynamic_pointer_cast<sym::VariableSymbol>(
+            _current_scope->get_symbol(ident));
+        if (symbol == nullptr ||
+            !(symbol->type->is_int32() || symbol->type->is_float())) {
+            return nullptr;
+        }
+        return symbol;
+    };
+
+    auto i_symbol = get_scalar(*i);
+    if (i_symbol == nullptr || !i_symbol->type->is_int32()) {
+        return false;
+    }
+
+    // s = s + <exp> or s = <exp> + s
+    const Ident *acc = nullptr;
+    const Exp *acc_exp = nullptr, *vec_exp = assign->exp.get();
+    if (auto ident = std::get_if<Ident>(assign->lval.get())) {
+        auto add = std::get_if<BinaryExp>(assign->exp.get());
+        if (*ident == *i || get_scalar(*ident) == nullptr || add == nullptr ||
+            add->op != BinaryExp::ADD) {
+            return false;
+        }
+        acc = ident;
+        if (auto left = get_ident(*add->left); left && *left == *acc) {
+            acc_exp = add->left.get();
+            vec_exp = add->right.get();
+        } else if (auto right = get_ident(*add->right); right && *right == *acc) {
+            acc_exp = add->right.get();
+            vec_exp = add->left.get();
+        } else {
+            return false;
+        }
+    }
+
+    // scalar expression not changed in the loop, which is float if any of its
+    // leaves is float
+    std::function<bool(const Exp &, bool &)> is_invariant =
+        [&](const Exp &exp, bool &is_float) {
+            if (auto number = std::get_if<Number>(&exp)) {
+                is_float |= std::holds_alternative<float>(*number);
+                return true;
+            } else if (auto ident = get_ident(exp)) {
+                auto symbol = get_scalar(*ident);
+                if (symbol == nullptr || *ident == *i ||
+                    (acc && *ident == *acc)) {
+                    return false;
+                }
+                is_float |= symbol->type->is_float();
+                return true;
+            } else if (auto binary = std::get_if<BinaryExp>(&exp)) {
+                return is_invariant(*binary->left, is_float) &&
+                       is_invariant(*binary->right, is_float);
+            } else if (auto unary = std::get_if<UnaryExp>(&exp)) {
+                return unary->op != UnaryExp::NOT &&
+                       is_invariant(*unary->exp, is_float);
+            }
+            return false;
+        };
+
+    bool is_float_bound = false;
+    if (!is_invariant(*cmp->right, is_float_bound) || is_float_bound) {
+        return false;
+    }
+
+    // an element of array, with i as exactly one of the indices
+    struct ArrayRef {
+        sym::SymbolPtr symbol;
+        std::vector<const Exp *> indices;
+        const LVal *lval;
+        int stride;
+        int arg;
+    };
+    auto get_array_ref = [&](const LVal &lval,
+                             ArrayRef &ref) -> sym::TypePtr {
+        ref.lval = &lval;
+        auto cur = &lval;
+        while (auto index = std::get_if<Index>(cur)) {
+            ref.indices.insert(ref.indices.begin(), index->exp.get());
+            cur = index->lval.get();
+        }
+        ref.symbol = std::dynamic_pointer_cast<sym::VariableSymbol>(
+            _current_scope->get_symbol(std::get<Ident>(*cur)));
+        if (ref.symbol == nullptr) {
+            return nullptr;
+        }
+
+        auto type = ref.symbol->type;
+        int i_count = 0;
+        for (auto index : ref.indices) {
+            if (!type->is_array() && !type->is_pointer()) {
+                return nullptr;
+            }
+            type = std::static_pointer_cast<sym::IndirectType>(type)
+                       ->get_base_type();
+            bool is_float = false;
+            if (auto ident = get_ident(*index); ident && *ident == *i) {
+                ref.stride = type->get_size();
+                i_count++;
+            } else if (!is_invariant(*index, is_float) || is_float) {
+                return nullptr;
+            }
+        }
+        if (i_count != 1 || !(type->is_int32() || type->is_float())) {
+            return nullptr;
+        }
+        return type;
+    };
+    auto is_same_ref = [](const ArrayRef &a, const ArrayRef &b) {
+        if (a.symbol != b.symbol || a.indices.size() != b.indices.size()) {
+            return false;
+        }
+        for (size_t k = 0; k < a.indices.size(); k++) {
+            auto ident_a = get_ident(*a.indices[k]);
+            auto ident_b = get_ident(*b.indices[k]);
+            auto number_a = std::get_if<Number>(a.indices[k]);
+            auto number_b = std::get_if<Number>(b.indices[k]);
+            if (!(ident_a && ident_b && *ident_a == *ident_b) &&
+                !(number_a && number_b && *number_a == *number_b)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto kernel = std::make_shared<ir::VectorKernel>();
+    kernel->params.push_back(ir::Type::W);
+    std::vector<std::variant<const LVal *, const Exp *>> sources;
+    std::vector<ArrayRef> arrays;
+    ArrayRef dst;
+
+    auto make_node = [](ir::VectorNode::Kind kind, int arg = -1,
+                        ir::VectorNodePtr left = nullptr,
+                        ir::VectorNodePtr right = nullptr) {
+        auto node = std::make_shared<ir::VectorNode>();
+        node->kind = kind;
+        node->arg = arg;
+        node->left = left;
+        node->right = right;
+        return node;
+    };
+
+    auto add_array = [&](ArrayRef &ref) -> ir::VectorNodePtr {
+        for (auto &array : arrays) {
+            if (is_same_ref(array, ref)) {
+                ref.arg = array.arg;
+                auto node = make_node(ir::VectorNode::ARRAY, ref.arg);
+                node->stride = ref.stride;
+                return node;
+            }
+        }
+        // distinct arrays never overlap, but pointer params or other elements
+        // of dst may do
+        if (!acc && !arrays.empty() &&
+            (ref.symbol == dst.symbol || !ref.symbol->type->is_array() ||
+             !dst.symbol->type->is_array())) {
+            kernel->check_overlap = true;
+        }
+
+        sources.push_back(ref.lval);
+        kernel->params.push_back(ir::Type::L);
+        ref.arg = sources.size();
+        arrays.push_back(ref);
+        auto node = make_node(ir::VectorNode::ARRAY, ref.arg);
+        node->stride = ref.stride;
+        return node;
+    };
+
+    sym::TypePtr elm_type;
+    if (acc) {
+        elm_type = get_scalar(*acc)->type;
+    } else {
+        elm_type = get_array_ref(*assign->lval, dst);
+        if (elm_type == nullptr) {
+            return false;
+        }
+        kernel->dst = add_array(dst);
+    }
+    kernel->ty = _symtype2irtype(*elm_type);
+
+    std::function<ir::VectorNodePtr(const Exp &)> build =
+        [&](const Exp &exp) -> ir::VectorNodePtr {
+        bool is_float = false;
+        if (is_invariant(exp, is_float)) {
+            if (is_float && !elm_type->is_float()) {
+                return nullptr;
+            }
+            sources.push_back(&exp);
+            kernel->params.push_back(kernel->ty);
+            return make_node(ir::VectorNode::SCALAR, sources.size());
+        }
+
+        if (auto lval_exp = std::get_if<LValExp>(&exp)) {
+            ArrayRef ref;
+            auto type = get_array_ref(*lval_exp->lval, ref);
+            if (type == nullptr || type->is_float() != elm_type->is_float()) {
+                return nullptr;
+            }
+            return add_array(ref);
+        } else if (auto binary = std::get_if<BinaryExp>(&exp)) {
+            static const std::unordered_map<int, ir::VectorNode::Kind>
+                op2kind = {
+                    {BinaryExp::ADD, ir::VectorNode::ADD},
+                    {BinaryExp::SUB, ir::VectorNode::SUB},
+                    {BinaryExp::MULT, ir::VectorNode::MUL},
+                    {BinaryExp::DIV, ir::VectorNode::DIV},
+                    {BinaryExp::MOD, ir::VectorNode::REM},
+                };
+            if (binary->op == BinaryExp::MOD && elm_type->is_float()) {
+                return nullptr;
+            }
+            auto left = build(*binary->left);
+            auto right = left ? build(*binary->right) : nullptr;
+            if (right == nullptr) {
+                return nullptr;
+            }
+            return make_node(op2kind.at(binary->op), -1, left, right);
+        } else if (auto unary = std::get_if<UnaryExp>(&exp)) {
+            if (unary->op == UnaryExp::NOT) {
+                return nullptr;
+            }
+            auto operand = build(*unary->exp);
+            if (operand == nullptr || unary->op == UnaryExp::ADD) {
+                return operand;
+            }
+            return make_node(ir::VectorNode::NEG, -1, operand);
+        }
+        return nullptr;
+    };
+
+    kernel->exp = build(*vec_exp);
+    if (kernel->exp == nullptr || (acc && arrays.empty())) {
+        return false;
+    }
+    if (acc) {
+        kernel->params.push_back(kernel->ty);
+        kernel->acc = kernel->params.size() - 1;
+    }
+    if (kernel->params.size() > MAX_VECTOR_KERNEL_ARGS ||
+        kernel->count_vector_regs() > MAX_VECTOR_KERNEL_REGS) {
+        return false;
+    }
+
+    // share kernels of the same shape
+    std::ostringstream key;
+    kernel->emit(key);
+    auto &cached = _vector_kernels[key.str()];
+    if (cached == nullptr) {
+        kernel->name = "__vec." + std::to_string(_module.vector_kernels.size());
+        _module.vector_kernels.push_back(kernel);
+        cached = kernel;
+    }
+    kernel = cached;
+
+    // before: while (i < n) { ... }
+    // after: if (i < n) { <kernel>(n - i, &a[i], ...); i = n; }
+    auto [jmp_to_true, jmp_to_false] = visit_cond(*node.cond);
+    auto true_block = _builder.create_label("vector_loop");
+
+    auto [i_type, i_val] = visit_exp(*cmp->left);
+    auto [n_type, n_val] = visit_exp(*cmp->right);
+    std::vector<ir::ValuePtr> args = {
+        _builder.create_sub(ir::Type::W, n_val, i_val)};
+    for (auto &source : sources) {
+        if (auto lval = std::get_if<const LVal *>(&source)) {
+            auto [type, addr] = visit_lval(**lval);
+            args.push_back(addr);
+        } else {
+            auto [type, val] = visit_exp(*std::get<const Exp *>(source));
+            args.push_back(_convert_if_needed(*elm_type, *type, val));
+        }
+    }
+    if (acc) {
+        auto [acc_type, acc_val] = visit_exp(*acc_exp);
+        args.push_back(acc_val);
+    }
+
+    auto result = _builder.create_call(acc ? kernel->ty : ir::Type::X,
+                                       kernel->get_address(), args);
+    if (acc) {
+        auto [acc_type, acc_addr] = visit_lval(*assign->lval);
+        _builder.create_store(kernel->ty, result, acc_addr);
+        _last_store.erase(acc_addr);
+    }
+    auto [i_lval_type, i_addr] = visit_lval(LVal(*i));
+    _builder.create_store(ir::Type::W, n_val, i_addr);
+    _last_store.erase(i_addr);
+
+    auto join_block = _builder.create_label("vector_join");
+    for (auto &jmp_block : jmp_to_true) {
+        jmp_block->jump.blk[0] = true_block;
+    }
+    for (auto &jmp_block : jmp_to_false) {
+        jmp_block->jump.blk[1] = join_block;
+    }
+
+    return true;
+}
+
 void Visitor::visit_var_def(const VarDef &node, ASTType btype, bool is_const) {
     auto type = visit_dims(*node.dims, btype);
 
@@ -272,7 +647,46 @@ void Visitor::visit_var_def(const VarDef &node, ASTType btype, bool is_const) {
 
         if (symbol->initializer) {
             auto values = symbol->initializer->get_values();
+            auto is_zero = [&values](int index) {
+                auto it = values.find(index);
+                if (it == values.end()) {
+                    return true;
+                }
+                auto const_val =
+                    std::dynamic_pointer_cast<ir::ConstBits>(std::get<1>(it->second));
+                if (const_val == nullptr) {
+                    return false;
+                }
+                if (auto int_val = std::get_if<int>(&const_val->value)) {
+                    return *int_val == 0;
+                }
+                auto float_val = std::get<float>(const_val->value);
+                return *reinterpret_cast<int *>(&float_val) == 0;
+            };
+
             for (int index = 0; index < initializer->get_space(); index++) {
+                // fill a long run of zeros at once
+                int zeros = 0;
+                while (index + zeros < initializer->get_space() &&
+                       is_zero(index + zeros)) {
+                    zeros++;
+                }
+                // small arrays are left to be split into scalars
+                if (zeros >= MEMSET_MIN_ELEMENTS &&
+                    type->get_size() >
+                        opt::ScalarReplacementPass::MAX_BYTES) {
+                    auto offset =
+                        ir::ConstBits::get(elm_type->get_size() * index);
+                    auto elm_addr =
+                        _builder.create_add(ir::Type::L, symbol->value, offset);
+                    _builder.create_call(
+                        ir::Type::X, ir::Address::get("memset"),
+                        {elm_addr, ir::ConstBits::get(0),
+                         ir::ConstBits::get(elm_type->get_size() * zeros)});
+                    index += zeros - 1;
+                    continue;
+                }
+
                 // if no init value, just store zero
                 sym::TypePtr val_type = elm_type;
                 ir::ValuePtr val = val_type->is_float()
@@ -449,6 +863,9 @@ void Visitor::visit_func_def(const FuncDef &node) {
     _builder.set_function(nullptr);
 
     _current_return_type = nullptr;
+
+    // values stored in this function are unknown to others
+    _last_store.clear();
 }
 
 std::vector<sym::SymbolPtr>
@@ -582,6 +999,11 @@ void Visitor::visit_while_stmt(const WhileStmt &node) {
         bool is_mini_loop;
         auto can_unroll_loop =
             !_in_unroll_loop && _can_unroll_loop(node, from, to, is_mini_loop);
+        // vectorized loop is preferred unless it is very short
+        if (_vectorize && !(can_unroll_loop && to - from <= 10) &&
+            _vectorize_loop(node)) {
+            return;
+        }
         if (can_unroll_loop &&
             (to - from <= 10 || (is_mini_loop && to - from <= 110))) {
             _in_unroll_loop = true;
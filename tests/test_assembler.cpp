@@ -0,0 +1,36 @@
+#include "target/assembler.h"
+#include <doctest.h>
+#include <sstream>
+
+TEST_CASE("testing assembling to elf") {
+    std::stringstream in(".text\n"
+                         ".global f\n"
+                         "f:\n"
+                         "    addi sp, sp, -16\n"
+                         "    lw a0, 8(sp)\n"
+                         "    bnez a0, .L1\n"
+                         "    call g\n"
+                         ".L1:\n"
+                         "    ret\n");
+    target::Assembler assembler;
+    assembler.assemble(in);
+
+    std::stringstream out;
+    assembler.write(out);
+    auto elf = out.str();
+    REQUIRE(elf.size() > 64 + 24);
+    CHECK_EQ(elf.substr(0, 4), "\x7f"
+                               "ELF");
+
+    // .text follows the header; the call is left to the linker
+    const unsigned char text[] = {
+        0x13, 0x01, 0x01, 0xff, // addi sp, sp, -16
+        0x03, 0x25, 0x81, 0x00, // lw a0, 8(sp)
+        0x63, 0x16, 0x05, 0x00, // bnez a0, .L1
+        0x97, 0x00, 0x00, 0x00, // auipc ra, 0
+        0xe7, 0x80, 0x00, 0x00, // jalr ra
+        0x67, 0x80, 0x00, 0x00, // ret
+    };
+    CHECK_EQ(elf.substr(64, sizeof(text)),
+             std::string(text, text + sizeof(text)));
+}
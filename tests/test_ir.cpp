@@ -174,4 +174,38 @@ TEST_CASE("testing function call") {
     std::ostringstream out;
     module.emit(out);
     CHECK_EQ(out.str(), EXPECTED5);
-}
\ No newline at end of file
+}
+
+TEST_CASE("testing function release") {
+    auto module = ir::Module();
+
+    auto [func, params] = ir::Function::create(
+        false, "func", ir::Type::W, {ir::Type::W}, module);
+    func->is_pure = true;
+
+    auto builder = ir::IRBuilder(func);
+
+    // a loop, whose block and temps refer to each other
+    auto body = builder.create_label("body");
+    auto add = builder.create_add(ir::Type::W, params[0], params[0]);
+    auto jnz = builder.create_jnz(add, body, nullptr);
+    auto exit = builder.create_label("exit");
+    auto ret = builder.create_ret(add);
+    jnz->jump.blk[1] = exit;
+    body->preds = {func->start, body};
+    exit->preds = {body};
+
+    std::weak_ptr<ir::Block> weak_body = body;
+    std::weak_ptr<ir::Value> weak_add = add;
+    body = exit = jnz = ret = nullptr;
+    add = nullptr;
+    params.clear();
+
+    func->release();
+
+    CHECK(weak_body.expired());
+    CHECK(weak_add.expired());
+    CHECK_EQ(func->start, nullptr);
+    CHECK_EQ(func->name, "func");
+    CHECK(func->is_pure);
+}
@@ -1,8 +1,11 @@
+#include "error.h"
 #include "parser.h"
+#include "scanner.h"
 #include <cstdio>
 #include <cstdlib>
 #include <doctest.h>
 #include <sstream>
+#include <unistd.h>
 
 extern FILE *yyin;
 
@@ -68,3 +71,99 @@ TEST_CASE("testing lexical and syntax analysis") {
         "14e-10,\"right\":298240,\"binary_op\":0}}]}}]},{\"btype\":2,\"ident\":"
         "\"func\",\"func_fparams\":[],\"block\":[{\"exp\":0}]}]}");
 }
+
+TEST_CASE("testing parsing conflicts and errors") {
+    // else binds to the nearest if, binary operators associate to the left,
+    // and unary ones bind tighter
+    reset_error();
+    auto root = std::make_shared<CompUnits>();
+    scanner_open_string("int f(int a, int b) {\n"
+                        "    if (a) if (b) return 1; else return 2;\n"
+                        "    return a - b - -a * !b % 3;\n"
+                        "}\n");
+    CHECK_EQ(yyparse(root), 0);
+    scanner_close();
+    CHECK_FALSE(has_error());
+
+    std::ostringstream ss;
+    print_ast(ss, *root);
+    CHECK_EQ(
+        ss.str(),
+        "{\"comp_units\":[{\"btype\":0,\"ident\":\"f\",\"func_fparams\":[{"
+        "\"btype\":0,\"ident\":\"a\",\"dims\":[]},{\"btype\":0,\"ident\":"
+        "\"b\",\"dims\":[]}],\"block\":[{\"cond\":\"a\",\"if_stmt\":{"
+        "\"cond\":\"b\",\"if_stmt\":{\"exp\":1},\"else_stmt\":{\"exp\":2}},"
+        "\"else_stmt\":null},{\"exp\":{\"left\":{\"left\":\"a\",\"right\":"
+        "\"b\",\"binary_op\":1},\"right\":{\"left\":{\"left\":{\"exp\":"
+        "\"a\",\"unary_op\":2},\"right\":{\"exp\":\"b\",\"unary_op\":0},"
+        "\"binary_op\":2},\"right\":3,\"binary_op\":4},\"binary_op\":1}}]}]}");
+
+    // a syntax error is reported, and stops the parse
+    reset_error();
+    root = std::make_shared<CompUnits>();
+    scanner_open_string("int f() { return 1; }\n"
+                        "int g() { return 1 +; }\n");
+    CHECK_NE(yyparse(root), 0);
+    scanner_close();
+    CHECK(has_error());
+    reset_error();
+}
+
+TEST_CASE("testing scanning files") {
+    // parse the content written to `path`, which is read from the standard
+    // input if `from_stdin`
+    auto parse_file = [](const std::string &path, const std::string &content,
+                         bool from_stdin = false) {
+        FILE *file = fopen(path.c_str(), "w");
+        fwrite(content.data(), 1, content.size(), file);
+        fclose(file);
+
+        int saved_stdin = dup(STDIN_FILENO);
+        if (from_stdin) {
+            REQUIRE_NE(freopen(path.c_str(), "r", stdin), nullptr);
+        }
+        reset_error();
+        auto root = std::make_shared<CompUnits>();
+        REQUIRE(scanner_open(from_stdin ? "-" : path));
+        yyparse(root);
+        scanner_close();
+        dup2(saved_stdin, STDIN_FILENO);
+        close(saved_stdin);
+        clearerr(stdin);
+        remove(path.c_str());
+
+        std::ostringstream ss;
+        print_ast(ss, *root);
+        return ss.str();
+    };
+
+    // an empty file is read as a stream, and has no comp unit
+    CHECK_EQ(parse_file("test_empty.sy", ""), "{\"comp_units\":[]}");
+    CHECK(has_error());
+
+    // a file filling its last page, so that the NUL bytes flex needs are in
+    // another page, ending in the middle of a line
+    size_t page = sysconf(_SC_PAGESIZE);
+    std::string source = "int a = 1;", last = "int b = 2;";
+    auto padded =
+        source + std::string(page - source.size() - last.size(), ' ') + last;
+    CHECK_EQ(parse_file("test_page.sy", padded),
+             "{\"comp_units\":[{\"type\":1,\"btype\":0,\"var_defs\":[{"
+             "\"ident\":\"a\",\"dims\":[],\"init_val\":1}]},{\"type\":1,"
+             "\"btype\":0,\"var_defs\":[{\"ident\":\"b\",\"dims\":[],"
+             "\"init_val\":2}]}]}");
+    CHECK_FALSE(has_error());
+
+    // the same file is scanned again from the start
+    CHECK_EQ(parse_file("test_page.sy", source),
+             "{\"comp_units\":[{\"type\":1,\"btype\":0,\"var_defs\":[{"
+             "\"ident\":\"a\",\"dims\":[],\"init_val\":1}]}]}");
+
+    // the standard input is read as a stream
+    CHECK_EQ(parse_file("test_stdin.sy", source, true),
+             "{\"comp_units\":[{\"type\":1,\"btype\":0,\"var_defs\":[{"
+             "\"ident\":\"a\",\"dims\":[],\"init_val\":1}]}]}");
+    CHECK_FALSE(has_error());
+
+    CHECK_FALSE(scanner_open("test_missing.sy"));
+}
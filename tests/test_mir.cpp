@@ -0,0 +1,62 @@
+#include "target/mir.h"
+#include "target/regalloc.h"
+#include "target/utils.h"
+#include <doctest.h>
+#include <sstream>
+
+TEST_CASE("testing machine operand parsing") {
+    using target::MachineOperand;
+
+    CHECK(MachineOperand::parse("a5").is_reg());
+    CHECK_EQ(MachineOperand::parse("-16").imm, -16);
+    CHECK(MachineOperand::parse("8(sp)") == MachineOperand::mem_of(2, 8));
+    CHECK(MachineOperand::parse(".L3").is_sym());
+
+    for (auto text : {"fa4", "%lo(arr+8)(a5)", "%hi(arr)", "(a0)", "-4(s1)"}) {
+        CHECK_EQ(MachineOperand::parse(text).to_string(), text);
+    }
+}
+
+TEST_CASE("testing machine instruction defs") {
+    using target::MachineInst;
+    using target::MachineOperand;
+
+    auto t0 = MachineOperand::reg_of(target::T0);
+    auto a0 = MachineOperand::reg_of(target::A0);
+    auto vtype = MachineOperand::sym_of("e32, m2, ta, ma");
+    CHECK_EQ(MachineInst("vsetvli", {t0, a0, vtype}).defs(),
+             std::vector<int>{target::T0});
+    // ops starting with `vs` write the first operand unless they are stores
+    CHECK_EQ(MachineInst("vsub.vx", {t0, t0, a0}).defs(),
+             std::vector<int>{target::T0});
+    CHECK(MachineInst("sw", {t0, MachineOperand::mem_of(target::SP, 8)})
+              .defs()
+              .empty());
+    CHECK(MachineInst("vse32.v", {t0, MachineOperand::sym_of("(a0)")})
+              .defs()
+              .empty());
+}
+
+TEST_CASE("testing scratch register allocation") {
+    using target::MachineOperand;
+
+    target::MachineFunction func;
+    // a4 holds an argument until the call, so the reload goes elsewhere
+    auto vreg = MachineOperand::reg_of(func.new_vreg(false, target::A4));
+    auto a4 = MachineOperand::reg_of(target::A4);
+    auto a5 = MachineOperand::reg_of(target::A5);
+    func.append("mv", {a4, MachineOperand::reg_of(target::S1)});
+    func.append("ld", {vreg, MachineOperand::mem_of(target::SP, 8)});
+    func.append("mv", {a5, vreg});
+    func.append("call", {MachineOperand::sym_of("f")}).implicit_uses = {
+        target::A4, target::A5};
+
+    target::ScratchRegisterAllocator().allocate(func);
+
+    std::stringstream out;
+    func.emit(out);
+    CHECK_EQ(out.str(), "    mv a4, s1\n"
+                        "    ld a5, 8(sp)\n"
+                        "    mv a5, a5\n"
+                        "    call f\n");
+}
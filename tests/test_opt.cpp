@@ -0,0 +1,735 @@
+#include "error.h"
+#include "opt/pass/pipelines.h"
+#include "parser.h"
+#include "scanner.h"
+#include "target/generator.h"
+#include "target/regalloc.h"
+#include "visitor.h"
+#include <cstdio>
+#include <doctest.h>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+// lower the source to IR, as the driver does with -O1 by default, or with
+// -march=rv64gcv if `vectorize`
+static void lower(const std::string &source, ir::Module &module,
+                  bool optimize = true, bool vectorize = false) {
+    reset_error();
+    ir::Address::clear_cache();
+    ir::ConstBits::clear_cache();
+
+    auto root = std::make_shared<CompUnits>();
+    scanner_open_string(source);
+    yyparse(root);
+    scanner_close();
+
+    Visitor visitor(module, optimize, vectorize);
+    visitor.visit(*root);
+    REQUIRE_FALSE(has_error());
+}
+
+static std::string emit(const ir::Module &module) {
+    std::ostringstream ss;
+    module.emit(ss);
+    return ss.str();
+}
+
+static std::string emit(const ir::Module &module, const std::string &name) {
+    for (auto &func : module.functions) {
+        if (func->name == name) {
+            std::ostringstream ss;
+            func->emit(ss);
+            return ss.str();
+        }
+    }
+    FAIL("no function " << name);
+    return "";
+}
+
+static size_t count(const std::string &text, const std::string &pattern) {
+    size_t n = 0;
+    for (auto pos = text.find(pattern); pos != std::string::npos;
+         pos = text.find(pattern, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+// run the passes before memoization, and memoization itself
+static void memoize(ir::Module &module) {
+    opt::SSAPasses().run(module);
+    opt::MemoizationPasses().run(module);
+    opt::MemoizationPass().run(module);
+}
+
+// run all passes and generate the assembly, as the driver does with -O1, or
+// with the passes seeing one function at a time as with --stream
+static std::string compile(const std::string &source, bool stream = false) {
+    ir::Module module;
+    lower(source, module);
+    if (stream) {
+        opt::StreamSSAPasses().run(module);
+    } else {
+        opt::SSAPasses().run(module);
+    }
+    opt::Passes().run(module);
+    opt::InstSelectPasses().run(module);
+    opt::RegisterPasses().run(module);
+
+    std::ostringstream ss;
+    target::Generator generator(ss, true);
+    generator.generate(module);
+    return ss.str();
+}
+
+TEST_CASE("testing memoization") {
+    ir::Module module;
+    lower("int fib(int n) {\n"
+          "    if (n < 2) return n;\n"
+          "    return fib(n - 1) + fib(n - 2);\n"
+          "}\n"
+          "int main() { return fib(20); }\n",
+          module);
+    memoize(module);
+
+    // one entry of flag and value for each n in [0, 20]
+    CHECK_NE(emit(module).find("data $fib.memo = align 4 { z 168, }"),
+             std::string::npos);
+    auto fib = emit(module, "fib");
+    CHECK_NE(fib.find("@memo_hit"), std::string::npos);
+    CHECK_NE(fib.find("storew 1,"), std::string::npos);
+
+    // the range of n is unknown
+    ir::Module unbounded;
+    lower("int fib(int n) {\n"
+          "    if (n < 2) return n;\n"
+          "    return fib(n - 1) + fib(n - 2);\n"
+          "}\n"
+          "int main() { return fib(getint()); }\n",
+          unbounded);
+    memoize(unbounded);
+    CHECK_EQ(emit(unbounded).find(".memo"), std::string::npos);
+}
+
+TEST_CASE("testing accumulative tail recursion") {
+    ir::Module module;
+    lower("int fact(int n) {\n"
+          "    if (n == 0) return 1;\n"
+          "    return n * fact(n - 1);\n"
+          "}\n"
+          "int g(int x) {\n"
+          "    if (x <= 0) return 0;\n"
+          "    return g(x - 1) + 2;\n"
+          "}\n"
+          "int f(int n, int x) {\n"
+          "    if (n == 0) return 0;\n"
+          "    return f(n - 1, x) + g(x);\n"
+          "}\n"
+          "int main() { return fact(getint()) + f(getint(), getint()); }\n",
+          module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+
+    auto fact = emit(module, "fact");
+    CHECK_EQ(fact.find("call $fact"), std::string::npos);
+    CHECK_NE(fact.find("%acc"), std::string::npos);
+
+    // the pure call after the recursive one is moved before it
+    auto f = emit(module, "f");
+    CHECK_EQ(f.find("call $f("), std::string::npos);
+    CHECK_NE(f.find("call $g("), std::string::npos);
+    CHECK_NE(f.find("%acc"), std::string::npos);
+}
+
+TEST_CASE("testing global promotion") {
+    ir::Module module;
+    lower("int sum;\n"
+          "int add(int n) {\n"
+          "    int i = 0;\n"
+          "    while (i < n) {\n"
+          "        sum = sum + i;\n"
+          "        i = i + 1;\n"
+          "    }\n"
+          "    return sum;\n"
+          "}\n"
+          "int main() {\n"
+          "    int i = 0;\n"
+          "    while (i < 10) {\n"
+          "        sum = sum + i;\n"
+          "        i = i + 1;\n"
+          "    }\n"
+          "    return add(getint());\n"
+          "}\n",
+          module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+
+    // loaded at entry and stored on return, not in the loop
+    auto add = emit(module, "add");
+    CHECK_EQ(count(add, "loadw $sum"), 1);
+    CHECK_EQ(count(add, "storew"), 1);
+
+    // main starts from the initial value and never writes it back, even
+    // with the call inlined
+    auto main = emit(module, "main");
+    CHECK_EQ(count(main, "$sum"), 0);
+}
+
+TEST_CASE("testing scalar replacement") {
+    ir::Module module;
+    lower("int main() {\n"
+          "    int a[3] = {1, 2, 3};\n"
+          "    a[1] = a[0] + a[2];\n"
+          "    return a[1];\n"
+          "}\n",
+          module);
+    opt::SSAPasses().run(module);
+
+    // the elements are promoted to registers
+    auto main = emit(module, "main");
+    CHECK_EQ(main.find("alloc4"), std::string::npos);
+    CHECK_EQ(main.find("load"), std::string::npos);
+    CHECK_NE(main.find("ret 4"), std::string::npos);
+
+    // the elements and variables never stored are read as zero
+    CHECK_NOTHROW(compile("int main() { int b[3]; return b[1]; }\n"));
+    CHECK_NOTHROW(compile("int main() { int x; return x; }\n"));
+    CHECK_NOTHROW(compile("int main() {\n"
+                          "    float f[2];\n"
+                          "    int a[4] = {1};\n"
+                          "    if (getint()) f[0] = 1.0;\n"
+                          "    putfloat(f[0] + f[1]);\n"
+                          "    return a[0] + a[3];\n"
+                          "}\n"));
+}
+
+TEST_CASE("testing loop idioms") {
+    ir::Module module;
+    lower("int a[100];\n"
+          "int b[100];\n"
+          "int main() {\n"
+          "    int n = getint();\n"
+          "    int i = 0;\n"
+          "    while (i < n) { a[i] = 0; i = i + 1; }\n"
+          "    putint(i);\n"
+          "    i = getint();\n"
+          "    while (i < n) { b[i] = a[i]; i = i + 1; }\n"
+          "    i = getint();\n"
+          "    while (i < 2.5) { a[i] = 0; i = i + 1; }\n"
+          "    return i;\n"
+          "}\n",
+          module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+
+    // the loop with a float bound is left as it is
+    auto main = emit(module, "main");
+    CHECK_EQ(count(main, "call $memset(l $a, w 0,"), 1);
+    CHECK_EQ(count(main, "call $memcpy("), 1);
+    CHECK_EQ(count(main, "call $mem"), 2);
+    CHECK_NE(main.find("clts"), std::string::npos);
+
+    // small arrays are left to scalar replacement instead of memset
+    ir::Module initializers;
+    lower("int main() {\n"
+          "    int small[32] = {1};\n"
+          "    int large[33] = {1};\n"
+          "    return small[1] + large[1];\n"
+          "}\n",
+          initializers);
+    CHECK_EQ(count(emit(initializers, "main"), "call $memset("), 1);
+}
+
+TEST_CASE("testing profile") {
+    const std::string source = "int main() {\n"
+                               "    int i = 0;\n"
+                               "    while (i < 3) i = i + 1;\n"
+                               "    return i;\n"
+                               "}\n";
+    ir::Module module;
+    lower(source, module);
+    opt::ProfileInstrumentPass("test.profdata").run(module);
+
+    // a counter for each block, after a header of magic, checksum and count
+    auto text = emit(module);
+    int magic, checksum, blocks;
+    std::string table = "data $__sysyc.prof = align 8 { w ";
+    auto pos = text.find(table);
+    REQUIRE_NE(pos, std::string::npos);
+    std::istringstream header(text.substr(pos + table.size()));
+    header >> magic >> checksum >> blocks;
+    CHECK_EQ(magic, 0x464f5250);
+    CHECK_EQ(count(text, "loadl"), blocks);
+    CHECK_NE(text.find("call $atexit(l $__sysyc.prof.dump, )"),
+             std::string::npos);
+    CHECK_NE(text.find("call $fwrite("), std::string::npos);
+
+    // the profile written by the program is loaded into the blocks in order
+    {
+        std::ofstream out("test.profdata", std::ios::binary);
+        int words[] = {magic, checksum, blocks, 0};
+        out.write((char *)words, sizeof(words));
+        for (long long i = 0; i < blocks; i++) {
+            long long freq = i + 1;
+            out.write((char *)&freq, sizeof(freq));
+        }
+    }
+    opt::ProfileAnnotatePass annotate;
+    REQUIRE(annotate.load("test.profdata"));
+
+    ir::Module annotated;
+    lower(source, annotated);
+    CHECK(annotate.run(annotated));
+    long long freq = 1;
+    for (auto block = annotated.functions[0]->start; block;
+         block = block->next) {
+        CHECK_EQ(block->freq, freq++);
+    }
+
+    // the profile of another program is ignored
+    ir::Module other;
+    lower("int main() { return 0; }\n", other);
+    CHECK_FALSE(annotate.run(other));
+    CHECK_EQ(other.functions[0]->start->freq, -1);
+
+    // a broken profile matches nothing, and a missing one is not loaded
+    {
+        std::ofstream out("test.profdata", std::ios::binary);
+        out << "broken";
+    }
+    REQUIRE(annotate.load("test.profdata"));
+    ir::Module broken;
+    lower(source, broken);
+    CHECK_FALSE(annotate.run(broken));
+    std::remove("test.profdata");
+    CHECK_FALSE(annotate.load("test.profdata"));
+}
+
+TEST_CASE("testing if-conversion") {
+    ir::Module module;
+    lower("int main() {\n"
+          "    int a = getint(), b = getint(), m;\n"
+          "    if (a > b) m = a; else m = b;\n"
+          "    int c = 0;\n"
+          "    if (a == 3) c = c + 5;\n"
+          "    return m + c;\n"
+          "}\n",
+          module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+
+    // both diamonds and triangles become selects
+    auto main = emit(module, "main");
+    CHECK_EQ(main.find("jnz"), std::string::npos);
+    CHECK_EQ(count(main, " sel "), 2);
+
+    // x is undefined if the branch is not taken
+    std::string text;
+    REQUIRE_NOTHROW(text = compile("int main() {\n"
+                                   "    int x;\n"
+                                   "    if (getint()) x = 1;\n"
+                                   "    return x;\n"
+                                   "}\n"));
+    CHECK_NE(text.find("li a0, 1"), std::string::npos);
+}
+
+TEST_CASE("testing loop rotation") {
+    // the visitor emits loops testing at the top without -O1
+    ir::Module module;
+    lower("int main() {\n"
+          "    int i = 0, s = 0;\n"
+          "    while (i < getint()) {\n"
+          "        s = s + i;\n"
+          "        i = i + 1;\n"
+          "    }\n"
+          "    return s;\n"
+          "}\n",
+          module, false);
+    opt::PassPipeline<opt::FillPredsPass, opt::FillReversePostOrderPass,
+                      opt::CooperFillDominatorsPass, opt::LoopRotationPass>()
+        .run(module);
+
+    // the test is copied into a guard, and the loop is entered through a
+    // preheader, so the header is only reached from the latch
+    auto main = emit(module, "main");
+    CHECK_EQ(count(main, "call $getint()"), 2);
+    CHECK_NE(main.find("jmp @loop_guard"), std::string::npos);
+    CHECK_NE(main.find("@pre_header"), std::string::npos);
+    CHECK_EQ(count(main, "jmp @while_cond"), 1);
+    CHECK_EQ(count(main, "jnz"), 2);
+}
+
+TEST_CASE("testing address folding") {
+    ir::Module module;
+    lower("int a[100];\n"
+          "int main() {\n"
+          "    int i = getint();\n"
+          "    a[5] = 1;\n"
+          "    a[i + 1] = a[i] + a[i + 2];\n"
+          "    return a[7] + a[i + 3];\n"
+          "}\n",
+          module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+    opt::InstSelectPasses().run(module);
+
+    // constant offsets go into the displacement of the accesses, and a[i + c]
+    // shares the address of a[i]
+    auto main = emit(module, "main");
+    CHECK_EQ(count(main, "add $a"), 1);
+    std::vector<int> offsets;
+    for (auto block = module.functions[0]->start; block; block = block->next) {
+        for (auto inst : block->insts) {
+            if (inst->insttype == ir::InstType::ILOADW ||
+                inst->insttype == ir::InstType::ISTOREW) {
+                offsets.push_back(inst->offset);
+            }
+        }
+    }
+    CHECK_EQ(offsets, std::vector<int>{20, 0, 8, 4, 28, 12});
+}
+
+TEST_CASE("testing instruction selection") {
+    std::string text;
+    REQUIRE_NOTHROW(text = compile("int f(int x, int y) {\n"
+                                   "    if (x < 0) return x - 3;\n"
+                                   "    int b = 0, c = 1;\n"
+                                   "    if (x < 5) b = 1;\n"
+                                   "    if (x != 7) c = 2;\n"
+                                   "    putint(x + y);\n"
+                                   "    return b + c;\n"
+                                   "}\n"
+                                   "int main() { return f(getint(), 2); }\n"));
+
+    // constants go into immediates and zeros into the branches against zero
+    CHECK_NE(text.find("bgez a0"), std::string::npos);
+    CHECK_NE(text.find("slti"), std::string::npos);
+    CHECK_NE(text.find("xori"), std::string::npos);
+    CHECK_EQ(count(text, " li "), 0);
+
+    // the return values and the arguments are computed into a0
+    CHECK_NE(text.find("addiw a0, a0, -3"), std::string::npos);
+    CHECK_NE(text.find("addiw a0, s11, 2"), std::string::npos);
+    CHECK_EQ(count(text, "addw a0, "), 2);
+}
+
+TEST_CASE("testing stream compilation") {
+    // not inlined with --stream, the leaf reads its last params from the
+    // caller's frame
+    std::string text;
+    REQUIRE_NOTHROW(
+        text = compile("int f(int a, int b, int c, int d, int e, int f,\n"
+                       "      int g, int h, int i, int j) {\n"
+                       "    return a + j;\n"
+                       "}\n"
+                       "int main() {\n"
+                       "    return f(1, 2, 3, 4, 5, 6, 7, 8, 9, getint());\n"
+                       "}\n",
+                       true));
+
+    auto leaf = text.substr(0, text.find("main:"));
+    REQUIRE_NE(leaf.find("f:"), std::string::npos);
+    auto adjust = leaf.find("addi sp, sp, -");
+    int frame = adjust == std::string::npos
+                    ? 0
+                    : std::stoi(leaf.substr(adjust + 14));
+    CHECK_EQ(count(leaf, "addi sp, sp, "), frame ? 2 : 0);
+    CHECK_NE(leaf.find(", " + std::to_string(frame + 8) + "(sp)"),
+             std::string::npos);
+}
+
+TEST_CASE("testing vectorization") {
+    // b[i] + b[i] * (b[i] + ...), or b[i] * 1 + (b[i] * 2 + ...)
+    auto nest = [](bool scaled) {
+        std::string exp = scaled ? "b[i] * 17" : "b[i]";
+        for (int k = 16; k > 0; k--) {
+            auto leaf = scaled ? "b[i] * " + std::to_string(k) : "b[i]";
+            exp = leaf + (k % 2 ? " + (" : " * (") + exp + ")";
+        }
+        return exp;
+    };
+
+    ir::Module module;
+    lower("int a[100], b[100];\n"
+          "int main() {\n"
+          "    int i = 0, n = getint(), s = 0;\n"
+          "    while (i < n) { a[i] = " +
+              nest(false) +
+              "; i = i + 1; }\n"
+              "    i = 0;\n"
+              "    while (i < n) { s = s + a[i] * 2; i = i + 1; }\n"
+              "    i = 0;\n"
+              "    while (i < n) { a[i] = " +
+              nest(true) +
+              "; i = i + 1; }\n"
+              "    return s;\n"
+              "}\n",
+          module, true, true);
+
+    // the kernel, the reduction, and the loop left scalar as it needs more
+    // vector registers than there are
+    REQUIRE_EQ(module.vector_kernels.size(), 2);
+    auto &kernel = *module.vector_kernels[0];
+    auto &reduction = *module.vector_kernels[1];
+    CHECK_NE(kernel.dst, nullptr);
+    CHECK_EQ(kernel.get_reused_arrays(), std::vector<int>{2});
+    CHECK_EQ(kernel.count_vector_regs(), 2);
+    CHECK_EQ(reduction.dst, nullptr);
+    CHECK_EQ(reduction.count_vector_regs(), 1);
+    auto text = emit(module, "main");
+    CHECK_EQ(count(text, "call $__vec."), 2);
+    CHECK_EQ(count(text, "\n@while_body"), 1);
+
+    // the array read by every leaf is loaded once
+    std::ostringstream ss;
+    target::Generator generator(ss, true);
+    REQUIRE_NOTHROW(generator.generate_vector_kernel(kernel));
+    CHECK_EQ(count(ss.str(), "vle32.v"), 1);
+    CHECK_EQ(count(ss.str(), "v6"), 0);
+}
+
+TEST_CASE("testing block layout") {
+    ir::Module module;
+    lower("int a[100];\n"
+          "int f(int n) {\n"
+          "    int i = 0;\n"
+          "    while (i < n) {\n"
+          "        int j = 0;\n"
+          "        while (j < i) {\n"
+          "            if (a[j] == i) {\n"
+          "                putint(j);\n"
+          "                return j;\n"
+          "            }\n"
+          "            j = j + 1;\n"
+          "        }\n"
+          "        i = i + 1;\n"
+          "    }\n"
+          "    return -1;\n"
+          "}\n"
+          "int main() { return f(getint()); }\n",
+          module, false);
+    opt::PassPipeline<opt::FillPredsPass, opt::FillReversePostOrderPass,
+                      opt::CooperFillDominatorsPass>()
+        .run(module);
+
+    // the loops are found from their back edges, and blocks weighted by depth
+    auto &func = *module.functions[0];
+    std::unordered_map<std::string, ir::BlockPtr> blocks;
+    for (auto block = func.start; block; block = block->next) {
+        blocks[block->name + "." + std::to_string(block->id)] = block;
+    }
+    auto loops = opt::find_natural_loops(func);
+    REQUIRE_EQ(loops.size(), 2);
+    CHECK_EQ(loops[0].header, blocks.at("while_cond.3"));
+    CHECK_EQ(loops[0].blocks.size(), 6);
+    CHECK_EQ(loops[1].blocks.size(), 3);
+    auto loop_depth = opt::get_loop_depth(func, loops);
+    CHECK_EQ(loop_depth.at(blocks.at("if_false.8")), 2);
+    CHECK_EQ(loop_depth.at(blocks.at("if_true.7")), 0);
+    CHECK_EQ(opt::get_loop_weight(loop_depth.at(blocks.at("if_false.8"))), 64);
+    CHECK_EQ(opt::get_loop_weight(9), 4096);
+
+    // the inner loop falls through its body and branches at the bottom, and
+    // the returning block is moved out of it
+    opt::BlockLayoutPass().run(module);
+    auto f = emit(module, "f");
+    auto body = f.find("\n@while_body.6\n");
+    auto latch = f.find("\n@if_false.8\n");
+    auto header = f.find("\n@while_cond.5\n");
+    auto exit = f.find("\n@if_true.7\n");
+    CHECK_LT(body, latch);
+    CHECK_LT(latch, header);
+    CHECK_LT(header, exit);
+    CHECK_NE(exit, std::string::npos);
+}
+
+TEST_CASE("testing stack slot sharing") {
+    // values live across calls in two phases, more than the callee saved
+    // registers can hold
+    std::string source = "int main() {\n";
+    for (auto phase : {"a", "b"}) {
+        std::string sum = "0";
+        for (int k = 0; k < 24; k++) {
+            auto name = phase + std::to_string(k);
+            source += "    int " + name + " = getint();\n";
+            sum += " + " + name + " * " + std::to_string(k + 1);
+        }
+        source += "    putint(" + sum + ");\n";
+    }
+    source += "    return 0;\n}\n";
+
+    ir::Module module;
+    lower(source, module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+    opt::InstSelectPasses().run(module);
+    opt::RegisterPasses().run(module);
+    auto &func = *module.functions[0];
+    target::LinearScanAllocator().allocate_registers(func);
+    target::StackManager stack_manager;
+    stack_manager.run(func);
+
+    auto &spilled = stack_manager.get_spilled_temps_offset();
+    std::set<int> offsets;
+    for (auto [temp, offset] : spilled) {
+        offsets.insert(offset);
+    }
+    // the spills of one phase are dead in the other, so they share slots
+    CHECK_GT(spilled.size(), 0);
+    CHECK_LE(offsets.size() * 2, spilled.size());
+}
+
+TEST_CASE("testing sibling calls") {
+    // compiled as with --stream, so that the callees are not inlined
+    std::string text;
+    REQUIRE_NOTHROW(
+        text = compile("int a[10];\n"
+                       "int g(int b[], int n) {\n"
+                       "    putint(b[n]);\n"
+                       "    return n;\n"
+                       "}\n"
+                       "int h(int a, int b, int c, int d, int e, int f,\n"
+                       "      int x, int y, int z) {\n"
+                       "    putint(a + z);\n"
+                       "    return a;\n"
+                       "}\n"
+                       "int many(int x) {\n"
+                       "    return h(x, x, x, x, x, x, x, x, x);\n"
+                       "}\n"
+                       "int local(int x) {\n"
+                       "    int b[2] = {x, x};\n"
+                       "    return g(b, 1);\n"
+                       "}\n"
+                       "int global(int x) { return g(a, x); }\n"
+                       "int main() {\n"
+                       "    return many(getint()) + local(1) + global(2);\n"
+                       "}\n",
+                       true));
+
+    auto get_func = [&text](const std::string &name) {
+        auto begin = text.find("\n" + name + ":\n");
+        REQUIRE_NE(begin, std::string::npos);
+        return text.substr(begin, text.find("/* end function", begin) - begin);
+    };
+
+    // a call returning its result jumps to the callee with the frame freed
+    auto global = get_func("global");
+    CHECK_EQ(count(global, "tail g"), 1);
+    CHECK_EQ(count(global, "call "), 0);
+    CHECK_EQ(count(global, "jr ra"), 0);
+
+    // unless args are passed in the frame, or point into it
+    CHECK_EQ(count(get_func("many"), "call h"), 1);
+    CHECK_EQ(count(get_func("local"), "call g"), 1);
+    CHECK_EQ(count(text, "tail "), 1);
+}
+
+TEST_CASE("testing rematerialization") {
+    // more values live in the loop than registers, with the addresses of the
+    // slots of `a` hoisted out of it
+    std::string source = "int a[24];\n"
+                         "int main() {\n"
+                         "    int i = 0, s = 0;\n";
+    std::string body, sum;
+    for (int k = 0; k < 24; k++) {
+        auto v = "v" + std::to_string(k), slot = "a[" + std::to_string(k) + "]";
+        source += "    int " + v + " = getint();\n";
+        body += "        " + slot + " = " + slot + " + " + v + " * i;\n";
+        sum += "    s = s + " + v + " + " + slot + ";\n";
+    }
+    source += "    while (i < 100) {\n" + body +
+              "        i = i + 1;\n"
+              "    }\n" +
+              sum +
+              "    putint(s);\n"
+              "    return 0;\n"
+              "}\n";
+
+    ir::Module module;
+    lower(source, module);
+    opt::SSAPasses().run(module);
+    opt::Passes().run(module);
+    opt::InstSelectPasses().run(module);
+    opt::RegisterPasses().run(module);
+    auto &func = *module.functions[0];
+    target::LinearScanAllocator().allocate_registers(func);
+    target::StackManager stack_manager;
+    stack_manager.run(func);
+
+    // addresses are recomputed at their uses instead of taking stack slots
+    auto &offsets = stack_manager.get_spilled_temps_offset();
+    int remat = 0;
+    for (auto temp : func.temps_in_func) {
+        if (temp->reg == REMAT) {
+            remat++;
+            CHECK_EQ(offsets.count(temp), 0);
+        }
+    }
+    CHECK_GT(remat, 0);
+    CHECK_GT(offsets.size(), 0);
+
+    std::ostringstream ss;
+    target::Generator(ss, true).generate(module);
+    CHECK_GE(count(ss.str(), ", a+"), 2 * remat);
+}
+
+TEST_CASE("testing shrink-wrapping") {
+    std::string text;
+    REQUIRE_NOTHROW(text = compile("int a[64];\n"
+                                   "int mx(int l, int r) {\n"
+                                   "    if (l == r) return a[l];\n"
+                                   "    int m = (l + r) / 2;\n"
+                                   "    int x = mx(l, m), y = mx(m + 1, r);\n"
+                                   "    if (x > y) return x;\n"
+                                   "    return y;\n"
+                                   "}\n"
+                                   "int main() { return mx(0, 63); }\n"));
+    auto begin = text.find("\nmx:\n");
+    REQUIRE_NE(begin, std::string::npos);
+    auto mx = text.substr(begin, text.find("/* end function", begin) - begin);
+
+    // the base case is tested before the prologue, and returns without
+    // touching the frame
+    auto branch = mx.find("    beq a0, a1, ");
+    REQUIRE_NE(branch, std::string::npos);
+    CHECK_LT(branch, mx.find("addi sp, sp, -"));
+    auto label = mx.substr(branch + 16, mx.find('\n', branch) - branch - 16);
+    auto base = mx.find("\n" + label + ":\n");
+    REQUIRE_NE(base, std::string::npos);
+    auto base_case = mx.substr(base, mx.find("jr ra", base) - base);
+    CHECK_EQ(count(base_case, "sp"), 0);
+    CHECK_EQ(count(mx, "addi sp, sp, -"), 1);
+}
+
+TEST_CASE("testing float constant pool") {
+    std::string text;
+    REQUIRE_NOTHROW(
+        text = compile("float f(float x) { return x * 1.5 + 2.5; }\n"
+                       "int main() {\n"
+                       "    int i = 0;\n"
+                       "    float s = 0.0;\n"
+                       "    while (i < getint()) {\n"
+                       "        s = s * 1.5 + f(s) + 2.5;\n"
+                       "        i = i + 1;\n"
+                       "    }\n"
+                       "    putfloat(s + 1.5);\n"
+                       "    return 0;\n"
+                       "}\n"));
+
+    // one entry for each distinct constant in the module
+    CHECK_EQ(count(text, ".word 0x3fc00000"), 1);
+    CHECK_EQ(count(text, ".word 0x40200000"), 1);
+    CHECK_EQ(count(text, "\n.LC"), 2);
+
+    // the constants are loaded before the loop and kept in registers
+    auto main = text.substr(text.find("\nmain:\n"));
+    auto branch = main.find("    blt ");
+    REQUIRE_NE(branch, std::string::npos);
+    auto end = main.find('\n', branch), space = main.rfind(' ', end);
+    auto label = main.substr(space + 1, end - space - 1);
+    auto loop = main.substr(main.find("\n" + label + ":\n"));
+    loop = loop.substr(0, loop.find("    blt "));
+    CHECK_EQ(count(loop, "fmul.s"), 1);
+    CHECK_EQ(count(loop, "flw"), 0);
+}